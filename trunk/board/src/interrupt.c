@@ -14,6 +14,7 @@
 #include <soc.h>
 #include <drv/gpio.h>
 #include <drv/uart.h>
+#include <drv/iic.h>
 #include <drv/adc.h>
 #include <drv/pin.h>
 #include "board_config.h"
@@ -24,332 +25,147 @@
 #include <drv/gpio.h>
 
 #include "rtc.h"
+#include <drv/irq.h>
 
 /* externs function--------------------------------------------------------*/
 extern void tick_irq_handler(void *arg);		//system coret 
-extern void apt_uart_irqhandler(csp_uart_t *ptUartBase,uint8_t byIdx);
+extern void apt_uart_irqhandler(csp_uart_t *ptUartBase);
 extern void apt_adc_irqhandler(csp_adc_t *ptAdcBase);
 extern void apt_sio_irqhandler(csp_sio_t *ptSioBase);
+extern void apt_ifc_irqhandler(csp_ifc_t *ptIfcBase);
 
 /* private function--------------------------------------------------------*/
+static void syscon_irqhandler(void *pArg);
+static void ept_irqhandler(void *pArg);
+static void rtc_irqhandler(void *pArg);
+static void exi_irqhandler(void *pArg);
+static void lpt_irqhandler(void *pArg);
+static void bt_irqhandler(void *pArg);
 
 /* extern variablesr-------------------------------------------------------*/
 
 /* Private variablesr------------------------------------------------------*/
 
-uint32_t g_wAdcData[16];
-uint8_t g_byAdcDone;
+/// board default handler of every irq, do_irq() calls g_tIrqVector[irq].handler(pArg).
+/// Applications install their own with csi_irq_attach(); an irq without handler is
+/// disabled by do_irq() when it occurs.
+csi_irq_vector_t g_tIrqVector[CONFIG_IRQ_NUM] = {
+	[CORET_IRQn]	= {tick_irq_handler,								NULL},
+	[SYSCON_IRQn]	= {syscon_irqhandler,								(void *)APB_SYS_BASE},
+	[IFC_IRQn]		= {(csi_irq_handler_t)apt_ifc_irqhandler,			(void *)APB_IFC_BASE},
+	[ADC_IRQn]		= {(csi_irq_handler_t)apt_adc_irqhandler,			(void *)APB_ADC0_BASE},
+	[EPT0_IRQn]		= {ept_irqhandler,									(void *)APB_EPT0_BASE},
+	[EXI0_IRQn]		= {exi_irqhandler,									(void *)APB_SYS_BASE},
+	[EXI1_IRQn]		= {exi_irqhandler,									(void *)APB_SYS_BASE},
+	[RTC_IRQn]		= {rtc_irqhandler,									(void *)APB_RTC_BASE},
+	[UART0_IRQn]	= {(csi_irq_handler_t)apt_uart_irqhandler,			(void *)APB_UART0_BASE},
+	[UART1_IRQn]	= {(csi_irq_handler_t)apt_uart_irqhandler,			(void *)APB_UART1_BASE},
+	[UART2_IRQn]	= {(csi_irq_handler_t)apt_uart_irqhandler,			(void *)APB_UART2_BASE},
+	[I2C_IRQn]		= {(csi_irq_handler_t)csi_iic_master_irqhandler,	(void *)APB_I2C0_BASE},		//slave mode: attach csi_iic_slave_receive_send
+	[SPI_IRQn]		= {(csi_irq_handler_t)spi_irqhandler,				(void *)APB_SPI0_BASE},
+	[SIO_IRQn]		= {(csi_irq_handler_t)apt_sio_irqhandler,			(void *)APB_SIO0_BASE},
+	[EXI2_IRQn]		= {exi_irqhandler,									(void *)APB_SYS_BASE},		//EXI2~3
+	[EXI3_IRQn]		= {exi_irqhandler,									(void *)APB_SYS_BASE},		//EXI4~9
+	[EXI4_IRQn]		= {exi_irqhandler,									(void *)APB_SYS_BASE},		//EXI10~15
+	[LPT_IRQn]		= {lpt_irqhandler,									(void *)APB_LPT_BASE},
+	[BT0_IRQn]		= {bt_irqhandler,									(void *)APB_BT0_BASE},
+	[BT1_IRQn]		= {bt_irqhandler,									(void *)APB_BT1_BASE},
+};
+
 /*************************************************************/
-//CORET Interrupt
-//EntryParameter:NONE
+//SYSCON Interrupt
+//EntryParameter:SYSCON
 //ReturnValue:NONE
 /*************************************************************/
-
-void CORETHandler(void) 
-{
-    // ISR content ...
-	//CK801->CORET_CVR = 0x0;			// Clear counter and flag
-	tick_irq_handler(NULL);
-	//csi_pin_toggle(PA01);
-}
-
-void SYSCONIntHandler(void) 
+static void syscon_irqhandler(void *pArg)
 {
     // ISR content ...
+	csp_syscon_t *ptSysconBase = (csp_syscon_t *)pArg;
 	volatile uint32_t wSysIntSta; 
-	wSysIntSta = csp_syscon_get_int_st(SYSCON);		
+	wSysIntSta = csp_syscon_get_int_st(ptSysconBase);		
 	
 	if(wSysIntSta & (IWDT_INT))			//iwdt 
 	{
 		nop;
-		csp_syscon_int_clr(SYSCON, IWDT_INT);
+		csp_syscon_int_clr(ptSysconBase, IWDT_INT);
 		
 	}
 }
 
-void IFCIntHandler(void) 
-{	
-    // ISR content ...
-}
-
-void ADCIntHandler(void) 
+/*************************************************************/
+//EPT Interrupt, clears what is pending; attach an application
+//handler to use the events
+//EntryParameter:EPT0
+//ReturnValue:NONE
+/*************************************************************/
+static void ept_irqhandler(void *pArg)
 {
-	//csi_gpio_port_toggle(GPIOA0, 2);
-	apt_adc_irqhandler(ADC0);
-}
-
-
-#define		PINMASK_PA02		(0x01ul << 2)	
-uint32_t val_BUFF[4];
-
-void EPT0IntHandler(void) 
-{	
-	if(((csp_ept_get_emmisr(EPT0) & EPT_INT_EP7))==EPT_INT_EP7)
-	{
-	 g_byAdcDone+=1;
-	 
-	 csp_ept_clr_emint(EPT0,EPT_INT_EP7);	
-	}
-	
-	if(((csp_ept_get_misr(EPT0) & EPTINT_TRGEV0))==EPTINT_TRGEV0)
-	{	csi_gpio_port_write(GPIOA0,(0x01ul << 2), 0);//gpio_port low	
-	  g_byAdcDone+=1;
-	  csp_ept_clr_int(EPT0, EPTINT_TRGEV0);
-	    csi_gpio_port_write(GPIOA0, (0x01ul << 2), 1);//gpio_port high		
-	}
-	
-    if(((csp_ept_get_misr(EPT0) & EPTINT_CAPLD0))==EPTINT_CAPLD0)
-	{		
-	 g_byAdcDone+=1;
-		
-		
-	 csp_ept_clr_int(EPT0, EPTINT_CAPLD0);			
-	}
-	if(((csp_ept_get_misr(EPT0) & EPTINT_CAPLD1))==EPTINT_CAPLD1)
-	{		
-	    g_byAdcDone+=1;
-	 csp_ept_clr_int(EPT0, EPTINT_CAPLD1);			
-	}
-	if(((csp_ept_get_misr(EPT0) & EPTINT_CAPLD2))==EPTINT_CAPLD2)
-	{		
-	    g_byAdcDone+=1;
-	 csp_ept_clr_int(EPT0, EPTINT_CAPLD2);			
-	}
-	if(((csp_ept_get_misr(EPT0) & EPTINT_CAPLD3))==EPTINT_CAPLD3)
-	{		
-	    g_byAdcDone+=1;
-		val_BUFF[0]=csp_ept_get_cmpa(EPT0);
-		val_BUFF[1]=csp_ept_get_cmpb(EPT0);
-		val_BUFF[2]=csp_ept_get_cmpc(EPT0);
-		val_BUFF[3]=csp_ept_get_cmpd(EPT0);
-//		csp_ept_set_crrearm(EPT0);
-	 csp_ept_clr_int(EPT0, EPTINT_CAPLD3);			
-	}
+	csp_ept_t *ptEptBase = (csp_ept_t *)pArg;
 	
+	csp_ept_clr_emint(ptEptBase, csp_ept_get_emmisr(ptEptBase));
+	csp_ept_clr_int(ptEptBase, csp_ept_get_misr(ptEptBase));
 }
-void EPT0EMIntHandler(void)
-{
-	 // ISR content ...
-}
-void WWDTHandler(void)
-{
-	// ISR content ...
-}
-void GPT0IntHandler(void) 
-{
-    // ISR content ...
-}
+
 extern csi_rtc_alm_t tAlmA;
-void RTCIntHandler(void) 
+static void rtc_irqhandler(void *pArg)
 {
+	csp_rtc_t *ptRtcBase = (csp_rtc_t *)pArg;
+	
     // AlarmB is used to fix a known bug
-	if (csp_rtc_get_int_st(RTC) & (RTC_INT_ALMB)) {
-		csp_rtc_int_clr(RTC, RTC_INT_ALMB);
-		csp_rtc_stop(RTC);
-		csp_rtc_wr_key(RTC);
-		csp_rtc_set_time_hour(RTC, 0, 0x10);
-		csp_rtc_set_time_min(RTC, 0x0);
-		csp_rtc_set_time_sec(RTC, 0x0);
-		csp_rtc_run(RTC);
-	}
-	if (csp_rtc_get_int_st(RTC) & (RTC_INT_ALMA)) {
+	if (csp_rtc_get_int_st(ptRtcBase) & (RTC_INT_ALMB)) {
+		csp_rtc_int_clr(ptRtcBase, RTC_INT_ALMB);
+		csp_rtc_stop(ptRtcBase);
+		csp_rtc_wr_key(ptRtcBase);
+		csp_rtc_set_time_hour(ptRtcBase, 0, 0x10);
+		csp_rtc_set_time_min(ptRtcBase, 0x0);
+		csp_rtc_set_time_sec(ptRtcBase, 0x0);
+		csp_rtc_run(ptRtcBase);
+	}
+	if (csp_rtc_get_int_st(ptRtcBase) & (RTC_INT_ALMA)) {
 		tAlmA.byAlmSt = 1;
-		csp_rtc_int_clr(RTC,RTC_INT_ALMA);
+		csp_rtc_int_clr(ptRtcBase,RTC_INT_ALMA);
 	}
 	
-	if (csp_rtc_get_int_st(RTC) & RTC_INT_CPRD) {
-		csp_rtc_int_clr(RTC,RTC_INT_CPRD);
+	if (csp_rtc_get_int_st(ptRtcBase) & RTC_INT_CPRD) {
+		csp_rtc_int_clr(ptRtcBase,RTC_INT_CPRD);
 	}
 }
 
-
-
-void UART0IntHandler(void) 
-{
-	// ISR content ...
-	apt_uart_irqhandler(UART0, 0);
-}
-void UART1IntHandler(void) 
-{
-    // ISR content ...
-	apt_uart_irqhandler(UART1, 1);
-}
-void UART2IntHandler(void) 
-{
-    // ISR content ...
-	apt_uart_irqhandler(UART2, 2);
-}
-void I2CIntHandler(void) 
-{
-    // ISR content ...
-}
-void SPI0IntHandler(void) 
-{
-    // ISR content ...
-	spi_irqhandler(SPI0);
-
-}
-void SIO0IntHandler(void) 
-{
-   // ISR content ...
-   apt_sio_irqhandler(SIO0);
-}
-void EXI0IntHandler(void) 
+/*************************************************************/
+//EXI Interrupt, all EXI vectors share it; the groups are
+//reported in one status register
+//EntryParameter:SYSCON
+//ReturnValue:NONE
+/*************************************************************/
+static void exi_irqhandler(void *pArg)
 {
 	// ISR content ...
+	csp_syscon_t *ptSysconBase = (csp_syscon_t *)pArg;
 	volatile uint32_t wExiSta; 
-	wExiSta = csp_exi_get_port_irq(SYSCON);
+	wExiSta = csp_exi_get_port_irq(ptSysconBase);
 	
-	switch(wExiSta)
-	{
-		case STATUS_EXI0:						//int group0
-			break;
-		case STATUS_EXI16:						//int group16
-			break;
-	}
-	csp_exi_clr_port_irq(SYSCON,wExiSta);		//clear interrput 
-   
+	csp_exi_clr_port_irq(ptSysconBase,wExiSta);		//clear interrput 
 }
-void EXI1IntHandler(void) 
-{
-    // ISR content ...
-	volatile uint32_t wExiSta; 
-	wExiSta = csp_exi_get_port_irq(SYSCON);
-	
-	switch(wExiSta)
-	{
-		case STATUS_EXI1:						//int group1
-			break;
-		case STATUS_EXI17:						//int group17
-			break;
-	}
-	csp_exi_clr_port_irq(SYSCON,wExiSta);		//clear interrput 
-}
-void EXI2to3IntHandler(void) 
-{
-    // ISR content ...
-	volatile uint32_t wExiSta; 
-	wExiSta = csp_exi_get_port_irq(SYSCON);
-	
-	switch(wExiSta)
-	{
-		case STATUS_EXI2:						//int group2
-			break;
-		case STATUS_EXI3:						//int group3
-			break;
-		case STATUS_EXI18:						//int group18
-			break;
-		case STATUS_EXI19:						//int group19
-			break;
-	}
-	csp_exi_clr_port_irq(SYSCON,wExiSta);		//clear interrput 
-}
-void EXI4to9IntHandler(void) 
-{
-    // ISR content ...
-	volatile uint32_t wExiSta; 
-	wExiSta = csp_exi_get_port_irq(SYSCON);
-	
-	switch(wExiSta)
-	{
-		case STATUS_EXI4:						//int group4
-			break;
-		case STATUS_EXI5:						//int group5
-			break;
-		case STATUS_EXI6:						//int group6
-			break;
-		case STATUS_EXI7:						//int group7
-			break;
-		case STATUS_EXI8:						//int group8
-			break;
-		case STATUS_EXI9:						//int group9
-			break;
-	}
-	csp_exi_clr_port_irq(SYSCON,wExiSta);		//clear interrput 
-}
-void EXI10to15IntHandler(void) 
-{
-    // ISR content ...
-	volatile uint32_t wExiSta; 
-	wExiSta = csp_exi_get_port_irq(SYSCON);
-	
-	switch(wExiSta)
-	{
-		case STATUS_EXI10:						//int grou10
-			break;
-		case STATUS_EXI11:						//int group11
-			break;
-		case STATUS_EXI12:						//int group12
-			break;
-		case STATUS_EXI13:						//int group13
-			break;
-		case STATUS_EXI14:						//int group14
-			break;
-		case STATUS_EXI15:						//int group15
-			break;
-	}
-	csp_exi_clr_port_irq(SYSCON,wExiSta);		//clear interrput 
-}
-
-void CNTAIntHandler(void) 
-{
-    // ISR content ...
-	csi_pin_toggle(PA011);
 
-}
-void TKEYIntHandler(void) 
+static void lpt_irqhandler(void *pArg)
 {
     // ISR content ...
+	csp_lpt_clr_all_int((csp_lpt_t *)pArg);
 }
 
-void LPTIntHandler(void) 
+static void bt_irqhandler(void *pArg)
 {
     // ISR content ...
-	csp_lpt_clr_all_int(LPT);
-	csi_pin_toggle(PA01);
-}
-
-void BT0IntHandler(void) 
-{
-    // ISR content ...
-	volatile uint32_t wMisr = csp_bt_get_isr(BT0);
+	csp_bt_t *ptBtBase = (csp_bt_t *)pArg;
+	volatile uint32_t wMisr = csp_bt_get_isr(ptBtBase);
 	
 	if(wMisr & BT_PEND_INT)					//PEND interrupt
-	{
-		csp_bt_clr_isr(BT0, BT_PEND_INT);
-		csi_pin_toggle(PA01);
-		//csp_gpio_set_high(GPIOA0, 1);
-	}
+		csp_bt_clr_isr(ptBtBase, BT_PEND_INT);
 	
 	if(wMisr & BT_CMP_INT)					//CMP interrupt
-	{
-		csp_bt_clr_isr(BT0, BT_CMP_INT);
-		csi_pin_toggle(PA01);
-		//csp_gpio_set_low(GPIOA0, 1);
-	}
-	
+		csp_bt_clr_isr(ptBtBase, BT_CMP_INT);
 }
 
-void BT1IntHandler(void) 
-{
-    // ISR content ...
-	// ISR content ...
-	volatile uint32_t wMisr = csp_bt_get_isr(BT1);
-	
-	if(wMisr & BT_PEND_INT)				//PEND interrupt
-	{
-		csp_bt_clr_isr(BT1, BT_PEND_INT);
-		csi_pin_toggle(PA01);
-		//csp_gpio_set_high(GPIOA0, 1);
-	}
-	
-	if(wMisr & BT_CMP_INT)				//CMP interrupt
-	{
-		csp_bt_clr_isr(BT1, BT_CMP_INT);
-		csi_pin_toggle(PA01);
-		//csp_gpio_set_low(GPIOA0, 1);
-	}
-}
 /*************************************************************/
 /*************************************************************/
 /*************************************************************/
@@ -16,6 +16,8 @@
 #include <sys_clk.h>
 #include "csp_common.h"
 #include "drv/gpio.h"
+#include <drv/bt.h>
+#include <drv/etb.h>
 
 #include "csp_adc.h"
 /* Private macro-----------------------------------------------------------*/
@@ -26,6 +28,84 @@
 /* Private variablesr------------------------------------------------------*/
 csi_adc_samp_t	g_tAdcSamp;
 
+/// double buffered acquisition, write position kept as pointer + strides(no index math per sample)
+typedef struct {
+	uint16_t			*phwBuf;		//block 0, block 1 follows
+	uint16_t			*phwWr;			//first sample of the current round
+	csi_adc_stream_cb_t	callback;
+	void				*pArg;
+	uint32_t			wOverrun;		//rounds lost(OVR)
+	uint16_t			hwBlkSize;		//samples per block
+	uint16_t			hwDepth;		//rounds per block
+	uint16_t			hwRound;		//rounds in the current block
+	uint16_t			hwChStep;		//distance of two channels of one round
+	uint16_t			hwRoundStep;	//distance of two rounds of one channel
+	uint8_t				byRndChnl;		//channels of one round
+	uint8_t				byRounds;		//rounds in the sequence(one interrupt)
+	uint8_t				byBlk;			//block being filled
+	bool				bActive;
+} adc_stream_t;
+
+static adc_stream_t s_tAdcStream;
+
+/// timer paced acquisition, the BT and the ETCB channel it uses
+typedef struct {
+	csp_bt_t			*ptBtBase;		//NULL: not running
+	csi_etb_graph_t		tGraph;
+	uint8_t				byTrgIn;
+} adc_sampler_t;
+
+static adc_sampler_t s_tAdcSmpl;
+
+/** \brief store the rounds of the sequence to the stream block, SEQ_END(last sequence entry) interrupt
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \param[in] wIntStat: interrupt status
+ *  \return none
+ */ 
+static void apt_adc_stream_isr(csp_adc_t *ptAdcBase, uint32_t wIntStat)
+{
+	adc_stream_t *ptStrm = &s_tAdcStream;
+	uint8_t byChnlNum = g_tAdcSamp.byChnlNum;
+	uint16_t *phwWr;
+	uint16_t *phwBlk;
+	uint8_t i, j, k = 0;
+	
+	if(!(wIntStat & ADC12_SEQ(byChnlNum - 1)))
+		return;
+	
+	if(csp_adc_get_sr(ptAdcBase) & ADC12_OVR)							//a round was overwritten before this read
+	{
+		ptStrm->wOverrun++;
+		csp_adc_clr_sr(ptAdcBase, ADC12_OVR);
+	}
+	
+	for(i = 0; i < ptStrm->byRounds; i++)
+	{
+		phwWr = ptStrm->phwWr;
+		for(j = 0; j < ptStrm->byRndChnl; j++)
+		{
+			*phwWr = csp_adc_get_data(ptAdcBase, k++);
+			phwWr += ptStrm->hwChStep;
+		}
+		ptStrm->phwWr += ptStrm->hwRoundStep;
+	}
+	csp_adc_clr_sr(ptAdcBase, (adc_sr_e)ADC12_SEQ_MSK);					//all entries of the sequence are read
+	
+	ptStrm->hwRound += ptStrm->byRounds;
+	if(ptStrm->hwRound < ptStrm->hwDepth)
+		return;
+	
+	//block full: switch first, the callback may take as long as the next block
+	phwBlk = ptStrm->phwBuf + (ptStrm->byBlk ? ptStrm->hwBlkSize : 0);
+	ptStrm->byBlk ^= 1;
+	ptStrm->phwWr = ptStrm->phwBuf + (ptStrm->byBlk ? ptStrm->hwBlkSize : 0);
+	ptStrm->hwRound = 0;
+	
+	if(ptStrm->callback)
+		ptStrm->callback(ptAdcBase, phwBlk, ptStrm->byBlk ^ 1, ptStrm->pArg);
+}
+
 /** \brief adc interrupt handle function
  * 
  *  \param[in] ptAdcBase: pointer of adc register structure
@@ -53,6 +133,12 @@ void apt_adc_irqhandler(csp_adc_t *ptAdcBase)
 			break;
 	}
 	
+	if(s_tAdcStream.bActive)
+	{
+		apt_adc_stream_isr(ptAdcBase, wIntStat);
+		return;
+	}
+	
 	//ADC SEQ_END interrupt
 	switch(g_tAdcSamp.hwSampCnt)				
 	{
@@ -449,8 +535,7 @@ csi_error_t csi_adc_set_sync(csp_adc_t *ptAdcBase, csi_adc_trgin_e eTrgIn, csi_a
 		return CSI_ERROR;
 	
 	//set sync trgin and trgmode
-	ptAdcBase->SYNCR = ptAdcBase->SYNCR & (~(0x01 << (8 + eTrgIn)));
-	ptAdcBase->SYNCR |= ((0x01ul << eTrgIn) | (eTrgMode << (8 + eTrgIn)));
+	csp_adc_set_sync(ptAdcBase, (adc_sync_e)eTrgIn, (adc_evtrg_mode_e)eTrgMode);
 	
 	return CSI_OK;
 }
@@ -524,4 +609,220 @@ void csi_adc_fvrout_enable(csp_adc_t *ptAdcBase, csi_adc_fvrsel_e eLvl, bool bEn
  void csi_adc_bufout_enable(csp_adc_t *ptAdcBase, bool bEnable)
  {
 	csp_adc_bufout_enable(ptAdcBase, bEnable);
- }
\ No newline at end of file
+ }
+
+/** \brief set up the stream state and the SEQ_END interrupt of the configured sequence
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \param[in] ptStreamCfg: pointer of stream config, checked by the caller
+ *  \param[in] byRndChnl: channels of one round
+ *  \param[in] byRounds: rounds in the sequence, hwDepth is a multiple of it
+ *  \return none
+ */
+static void apt_adc_stream_setup(csp_adc_t *ptAdcBase, csi_adc_stream_config_t *ptStreamCfg, uint8_t byRndChnl, uint8_t byRounds)
+{
+	adc_stream_t *ptStrm = &s_tAdcStream;
+	uint8_t byChnlNum = g_tAdcSamp.byChnlNum;
+	
+	ptStrm->phwBuf = ptStreamCfg->phwBuf;
+	ptStrm->phwWr = ptStreamCfg->phwBuf;
+	ptStrm->callback = ptStreamCfg->callback;
+	ptStrm->pArg = ptStreamCfg->pArg;
+	ptStrm->wOverrun = 0;
+	ptStrm->hwDepth = ptStreamCfg->hwDepth;
+	ptStrm->hwBlkSize = ptStreamCfg->hwDepth * byRndChnl;
+	ptStrm->hwRound = 0;
+	ptStrm->byRndChnl = byRndChnl;
+	ptStrm->byRounds = byRounds;
+	ptStrm->byBlk = 0;
+	if(ptStreamCfg->byLayout == ADC_LAYOUT_PLANAR)
+	{
+		ptStrm->hwChStep = ptStreamCfg->hwDepth;
+		ptStrm->hwRoundStep = 1;
+	}
+	else
+	{
+		ptStrm->hwChStep = 1;
+		ptStrm->hwRoundStep = byRndChnl;
+	}
+	
+	csp_adc_clr_sr(ptAdcBase, (adc_sr_e)(ADC12_SEQ_MSK | ADC12_OVR));
+	csp_adc_int_enable(ptAdcBase, (adc_int_e)ADC12_SEQ_MSK, DISABLE);	//one interrupt per round
+	csp_adc_int_enable(ptAdcBase, (adc_int_e)ADC12_SEQ(byChnlNum - 1), ENABLE);
+	ptStrm->bActive = true;
+	csi_irq_enable((uint32_t *)ptAdcBase);
+	
+	g_tAdcSamp.byConvStat = ADC_STATE_DOING;
+}
+
+/** \brief start double buffered acquisition of the configured sequence
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \param[in] ptStreamCfg: pointer of stream config
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_adc_stream_start(csp_adc_t *ptAdcBase, csi_adc_stream_config_t *ptStreamCfg)
+{
+	uint8_t byChnlNum = g_tAdcSamp.byChnlNum;
+	
+	if(NULL == ptStreamCfg || NULL == ptStreamCfg->phwBuf || ptStreamCfg->hwDepth == 0 || byChnlNum == 0)
+		return CSI_ERROR;
+	if((uint32_t)ptStreamCfg->hwDepth * byChnlNum > 0xffff)
+		return CSI_ERROR;
+	
+	csi_adc_stream_stop(ptAdcBase);
+	apt_adc_stream_setup(ptAdcBase, ptStreamCfg, byChnlNum, 1);
+	
+	return csi_adc_start(ptAdcBase);
+}
+
+/** \brief stop double buffered acquisition
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \return none
+ */
+void csi_adc_stream_stop(csp_adc_t *ptAdcBase)
+{
+	if(!s_tAdcStream.bActive)
+		return;
+	
+	if(csp_adc_get_sr(ptAdcBase) & ADC12_CTCVS)							//continuous mode
+		csp_adc_stop(ptAdcBase);
+	csp_adc_int_enable(ptAdcBase, (adc_int_e)ADC12_SEQ_MSK, DISABLE);
+	s_tAdcStream.bActive = false;
+	g_tAdcSamp.byConvStat = ADC_STATE_IDLE;
+}
+
+/** \brief rounds lost because the adc data was overwritten before the interrupt read it
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \return overrun count since csi_adc_stream_start
+ */
+uint32_t csi_adc_stream_get_overrun(csp_adc_t *ptAdcBase)
+{
+	return s_tAdcStream.wOverrun;
+}
+
+
+/** \brief pclk ticks of a period
+ * 
+ *  \param[in] wPeriodUs: period(us)
+ *  \return ticks, 0: does not fit in 32 bit
+ */
+static uint32_t apt_adc_sampler_ticks(uint32_t wPeriodUs)
+{
+	uint32_t wPclk = csi_get_pclk_freq();
+	
+	if(wPeriodUs <= 0xffffffff / (wPclk / 1000))						//exact to 1kHz of pclk
+		return wPclk / 1000 * wPeriodUs / 1000;
+	if(wPclk >= 1000000 && wPeriodUs <= 0xffffffff / (wPclk / 1000000))
+		return wPclk / 1000000 * wPeriodUs;
+	
+	return 0;
+}
+
+/** \brief sample the channels every wPeriodUs, started by a timer through ETCB
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \param[in] ptSmplCfg: pointer of sampler config
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_adc_sampler_start(csp_adc_t *ptAdcBase, csi_adc_sampler_config_t *ptSmplCfg)
+{
+	csi_adc_seq_t tSeq[16];
+	csi_adc_stream_config_t *ptStreamCfg;
+	csi_etb_route_t tRoute;
+	csp_bt_t *ptBtBase;
+	uint32_t wTicks, wClkDiv, wEntry;
+	uint8_t i, j, byChNum, byRounds, byAdcDiv;
+	csi_error_t ret;
+	
+	if(NULL == ptSmplCfg || NULL == ptSmplCfg->ptSeqCfg)
+		return CSI_ERROR;
+	
+	ptBtBase = ptSmplCfg->ptBtBase;
+	ptStreamCfg = &ptSmplCfg->tStream;
+	byChNum = ptSmplCfg->byChNum;
+	if((ptBtBase != BT0 && ptBtBase != BT1) || ptSmplCfg->byTrgIn > ADC_SYNCEN5)
+		return CSI_ERROR;
+	if(byChNum == 0 || byChNum > 16 || NULL == ptStreamCfg->phwBuf || ptStreamCfg->hwDepth == 0)
+		return CSI_ERROR;
+	if((uint32_t)ptStreamCfg->hwDepth * byChNum > 0xffff)
+		return CSI_ERROR;
+	
+	//timer period, shorter than one round of conversions would overrun every round
+	wTicks = apt_adc_sampler_ticks(ptSmplCfg->wPeriodUs);
+	byAdcDiv = csp_adc_get_clk_div(ptAdcBase);
+	wEntry = ((ptAdcBase->SHR & ADC12_SHR_MSK) + 16) * (byAdcDiv ? (byAdcDiv << 1) : 1);	//pclk ticks of one conversion
+	if(wTicks < wEntry * byChNum)
+		return CSI_ERROR;
+	wClkDiv = wTicks / 0x10000 + 1;
+	
+	//as many rounds per sequence as fit in 16 entries and divide the block
+	for(byRounds = 16 / byChNum; ptStreamCfg->hwDepth % byRounds; byRounds--);
+	
+	for(i = 0, j = 0; i < byRounds * byChNum; i++)
+	{
+		tSeq[i] = ptSmplCfg->ptSeqCfg[j];
+		tSeq[i].byTrgSrc = j ? ADCSYNC_NONE : (ADCSYNC_IN0 + ptSmplCfg->byTrgIn);	//first entry of a round waits for the timer
+		if(++j == byChNum)
+			j = 0;
+	}
+	
+	csi_adc_sampler_stop(ptAdcBase);
+	
+	tRoute.bySrc = (ptBtBase == BT0) ? ETB_BT_TRGOUT0 : ETB_BT_TRGOUT1;
+	tRoute.byDst = ETB_ADC_SYNCIN0 + ptSmplCfg->byTrgIn;
+	ret = csi_etb_graph_init(&s_tAdcSmpl.tGraph, &tRoute, 1);
+	if(ret < 0)
+		return ret;
+	s_tAdcSmpl.ptBtBase = ptBtBase;
+	s_tAdcSmpl.byTrgIn = ptSmplCfg->byTrgIn;
+	
+	//adc: continuous mode, the sequence restarts at entry 0 and waits there for the next event
+	csp_adc_set_conv_mode(ptAdcBase, ADC_CONV_CONTINU);
+	csi_adc_set_seqx(ptAdcBase, tSeq, byRounds * byChNum);
+	csi_adc_set_sync(ptAdcBase, ptSmplCfg->byTrgIn, ADC_TRG_CONTINU, 0);
+	apt_adc_stream_setup(ptAdcBase, ptStreamCfg, byChNum, byRounds);
+	
+	//bt: period event only, no interrupt
+	csi_clk_enable((uint32_t *)ptBtBase);
+	csp_bt_soft_rst(ptBtBase);
+	csp_bt_set_cr(ptBtBase, (BT_IMMEDIATE << BT_SHDW_POS) | (BT_CONTINUOUS << BT_OPM_POS) |
+			(BT_PCLKDIV << BT_EXTCKM_POS) | (BT_CNTRLD_EN << BT_CNTRLD_POS) | BT_CLK_EN );
+	csp_bt_set_pscr(ptBtBase, (uint16_t)(wClkDiv - 1));
+	csp_bt_set_prdr(ptBtBase, (uint16_t)(wTicks / wClkDiv));
+	csp_bt_set_cmp(ptBtBase, (uint16_t)(wTicks / wClkDiv / 2));
+	csi_bt_set_evtrg(ptBtBase, 0, BT_TRGSRC_PEND);
+	
+	ret = csi_adc_start(ptAdcBase);
+	if(ret < 0)
+	{
+		csi_adc_sampler_stop(ptAdcBase);
+		return ret;
+	}
+	csi_etb_graph_start(&s_tAdcSmpl.tGraph);
+	csp_bt_start(ptBtBase);
+	
+	return CSI_OK;
+}
+
+/** \brief stop the timer, free its ETCB channel and stop the acquisition
+ * 
+ *  \param[in] ptAdcBase: pointer of adc register structure
+ *  \return none
+ */
+void csi_adc_sampler_stop(csp_adc_t *ptAdcBase)
+{
+	csp_bt_t *ptBtBase = s_tAdcSmpl.ptBtBase;
+	
+	if(ptBtBase)
+	{
+		csp_bt_stop(ptBtBase);
+		csi_bt_set_evtrg(ptBtBase, 0, BT_TRGSRC_DIS);
+		csi_etb_graph_free(&s_tAdcSmpl.tGraph);
+		csp_adc_sync_dis(ptAdcBase, (adc_sync_e)s_tAdcSmpl.byTrgIn);
+		s_tAdcSmpl.ptBtBase = NULL;
+	}
+	csi_adc_stream_stop(ptAdcBase);
+}
\ No newline at end of file
@@ -0,0 +1,458 @@
+/***********************************************************************//**
+ * \file  capture.c
+ * \brief  period/duty/frequency measurement on the capture unit of EPT0 or GPTA0
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-28 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+#include <string.h>
+#include <soc.h>
+#include <sys_clk.h>
+#include <csp_ept.h>
+#include <csp_gpta.h>
+#include <drv/capture.h>
+#include <drv/ept.h>
+#include <drv/gpta.h>
+#include <drv/etb.h>
+#include <drv/pin.h>
+#include <drv/irq.h>
+
+/* Private macro------------------------------------------------------*/
+//interrupt bits, same in EPT and GPTA
+#define CAP_INT_CAPLD0		(0x01ul << 4)
+#define CAP_INT_CAPLD_ALL	(0x0Ful << 4)
+#define CAP_INT_CAPLD3		(0x01ul << 7)
+#define CAP_INT_PEND		(0x01ul << 16)
+
+#define CAP_IDLE_OVF		6				//wraps without four edges: signal lost(four periods of wMinFreq take at most 5)
+#define CAP_START_RETRY		4
+
+//byState
+#define CAP_ST_RISE			(0x01)			//wRise valid
+#define CAP_ST_FALL			(0x02)			//wFall valid
+#define CAP_ST_AFALL		(0x04)			//CMPA/CMPC hold falling edges(CAPTURE_EDGE_BOTH)
+
+/* externs function---------------------------------------------------*/
+/* externs variablesr-------------------------------------------------*/
+/* Private variablesr-------------------------------------------------*/
+
+/** \brief read the four capture registers
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[out] hwCap: CMPA~CMPD
+ *  \return none
+ */
+static void apt_capture_read_cmp(csi_capture_t *ptCap, uint16_t hwCap[4])
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+	{
+		csp_ept_t *ptEptBase = (csp_ept_t *)ptCap->ptTimer;
+
+		hwCap[0] = csp_ept_get_cmpa(ptEptBase);
+		hwCap[1] = csp_ept_get_cmpb(ptEptBase);
+		hwCap[2] = csp_ept_get_cmpc(ptEptBase);
+		hwCap[3] = csp_ept_get_cmpd(ptEptBase);
+	}
+	else
+	{
+		csp_gpta_t *ptGptaBase = (csp_gpta_t *)ptCap->ptTimer;
+
+		hwCap[0] = csp_gpta_get_cmpa(ptGptaBase);
+		hwCap[1] = csp_gpta_get_cmpb(ptGptaBase);
+		hwCap[2] = csp_gpta_get_cmpc(ptGptaBase);
+		hwCap[3] = csp_gpta_get_cmpd(ptGptaBase);
+	}
+}
+
+static inline uint32_t apt_capture_get_risr(csi_capture_t *ptCap)
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+		return csp_ept_get_risr((csp_ept_t *)ptCap->ptTimer);
+	else
+		return csp_gpta_get_risr((csp_gpta_t *)ptCap->ptTimer);
+}
+
+static inline uint16_t apt_capture_get_cnt(csi_capture_t *ptCap)
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+		return (uint16_t)((csp_ept_t *)ptCap->ptTimer)->CNT;
+	else
+		return (uint16_t)((csp_gpta_t *)ptCap->ptTimer)->CNT;
+}
+
+static inline uint32_t apt_capture_get_misr(csi_capture_t *ptCap)
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+		return csp_ept_get_misr((csp_ept_t *)ptCap->ptTimer);
+	else
+		return csp_gpta_get_misr((csp_gpta_t *)ptCap->ptTimer);
+}
+
+static inline void apt_capture_clr_int(csi_capture_t *ptCap, uint32_t wInt)
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+		csp_ept_clr_int((csp_ept_t *)ptCap->ptTimer, (csp_ept_int_e)wInt);
+	else
+		csp_gpta_clr_int((csp_gpta_t *)ptCap->ptTimer, (csp_gpta_int_e)wInt);
+}
+
+/** \brief stop the counter and rearm the capture sequence at CMPA
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return none
+ */
+static void apt_capture_halt(csi_capture_t *ptCap)
+{
+	if(ptCap->byTimer == CAPTURE_EPT0)
+	{
+		csp_ept_stop((csp_ept_t *)ptCap->ptTimer);
+		csp_ept_set_crrearm((csp_ept_t *)ptCap->ptTimer);
+	}
+	else
+	{
+		csp_gpta_stop((csp_gpta_t *)ptCap->ptTimer);
+		((csp_gpta_t *)ptCap->ptTimer)->CR |= GPTA_CAPREARM;
+	}
+}
+
+/** \brief clear edge tracking and averages(irq masked or interrupt context)
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return none
+ */
+static void apt_capture_clr_avg(csi_capture_t *ptCap)
+{
+	ptCap->byState &= CAP_ST_AFALL;
+	ptCap->wPrdSum = 0;
+	ptCap->wHighSum = 0;
+	ptCap->byAvgIdx = 0;
+	ptCap->byAvgCnt = 0;
+	memset(ptCap->hwPrdHist, 0, sizeof(ptCap->hwPrdHist));
+	memset(ptCap->hwHighHist, 0, sizeof(ptCap->hwHighHist));
+}
+
+/** \brief one edge: a period ends at every period start edge after the first
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[in] wTime: edge time, 32 bit ticks
+ *  \param[in] bStart: period start edge(rising); false: opposite edge
+ *  \return none
+ */
+static void apt_capture_edge(csi_capture_t *ptCap, uint32_t wTime, bool bStart)
+{
+	csi_capture_sample_t tSample;
+	uint32_t wPrd;
+	uint8_t byIdx;
+
+	if(!bStart)
+	{
+		if(ptCap->byState & CAP_ST_RISE)
+		{
+			ptCap->wFall = wTime;
+			ptCap->byState |= CAP_ST_FALL;
+		}
+		return;
+	}
+
+	wPrd = wTime - ptCap->wRise;
+	if((ptCap->byState & CAP_ST_RISE) && wPrd <= 0xFFFF)
+	{
+		tSample.wStamp   = ptCap->wRise;
+		tSample.hwPeriod = (uint16_t)wPrd;
+		tSample.hwHigh   = (ptCap->byState & CAP_ST_FALL) ? (uint16_t)(ptCap->wFall - ptCap->wRise) : 0;
+
+		byIdx = ptCap->byAvgIdx;
+		ptCap->wPrdSum  += tSample.hwPeriod - ptCap->hwPrdHist[byIdx];
+		ptCap->wHighSum += tSample.hwHigh - ptCap->hwHighHist[byIdx];
+		ptCap->hwPrdHist[byIdx]  = tSample.hwPeriod;
+		ptCap->hwHighHist[byIdx] = tSample.hwHigh;
+		ptCap->byAvgIdx = (byIdx + 1) & (CAPTURE_AVG_LEN - 1);
+		if(ptCap->byAvgCnt < CAPTURE_AVG_LEN)
+			ptCap->byAvgCnt++;
+
+		if(ptCap->tFifo.pbyBuf)
+		{
+			if(ringbuffer_avail(&ptCap->tFifo) >= sizeof(tSample))
+				ringbuffer_in(&ptCap->tFifo, &tSample, sizeof(tSample));
+			else
+				ptCap->wLost++;
+		}
+	}
+
+	ptCap->wRise = wTime;
+	ptCap->byState = (ptCap->byState & ~CAP_ST_FALL) | CAP_ST_RISE;
+}
+
+/** \brief capture interrupt: four edges per CAPLD3, counter wraps per PEND
+ *
+ *  \param[in] pArg: measurement object
+ *  \return none
+ */
+static void apt_capture_irqhandler(void *pArg)
+{
+	csi_capture_t *ptCap = (csi_capture_t *)pArg;
+	uint32_t wMisr = apt_capture_get_misr(ptCap);
+	uint32_t wTime[4];
+	uint32_t wHi;
+	uint16_t hwCap[4];
+	uint16_t hwNow;
+	bool bStart;
+	int i;
+
+	if(wMisr & CAP_INT_CAPLD3)
+	{
+		apt_capture_clr_int(ptCap, CAP_INT_CAPLD_ALL);
+		apt_capture_read_cmp(ptCap, hwCap);
+		hwNow = apt_capture_get_cnt(ptCap);
+		ptCap->byIdleOvf = 0;
+
+		//CMPA already holds the next edge(younger than CMPD): drop the group, the slot polarity does not change.
+		//A group spanning close to a multiple of 0x10000 counts looks the same and is dropped as well.
+		if((apt_capture_get_risr(ptCap) & CAP_INT_CAPLD0) || (uint16_t)(hwNow - hwCap[0]) < (uint16_t)(hwNow - hwCap[3]))
+		{
+			ptCap->wOverrun++;
+			ptCap->byState &= ~(CAP_ST_RISE | CAP_ST_FALL);
+		}
+		else
+		{
+			//wrap not counted yet: a small CMPD was captured after it
+			wHi = ptCap->wOvf;
+			if((apt_capture_get_risr(ptCap) & CAP_INT_PEND) && hwCap[3] < 0x8000)
+				wHi++;
+
+			wTime[3] = (wHi << 16) | hwCap[3];
+			for(i = 2; i >= 0; i--)
+				wTime[i] = wTime[i+1] - (uint16_t)(hwCap[i+1] - hwCap[i]);
+
+			for(i = 0; i < 4; i++)
+			{
+				bStart = true;
+				if(ptCap->byEdge == CAPTURE_EDGE_BOTH)
+					bStart = ((i & 1) != 0) == ((ptCap->byState & CAP_ST_AFALL) != 0);
+				apt_capture_edge(ptCap, wTime[i], bStart);
+			}
+		}
+	}
+
+	if(wMisr & CAP_INT_PEND)
+	{
+		apt_capture_clr_int(ptCap, CAP_INT_PEND);
+		ptCap->wOvf++;
+		if(ptCap->byIdleOvf < CAP_IDLE_OVF)
+		{
+			if(++ptCap->byIdleOvf == CAP_IDLE_OVF)
+				apt_capture_clr_avg(ptCap);
+		}
+	}
+}
+
+/** \brief set up the timer in capture mode, the ETB route of the edge events and the interrupt
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[in] ptCfg: configuration \ref csi_capture_config_t
+ *  \return error code \ref csi_error_t, on error neither the timer nor an ETB channel is taken
+ */
+csi_error_t csi_capture_init(csi_capture_t *ptCap, csi_capture_config_t *ptCfg)
+{
+	csi_etb_config_t tEtbCfg;
+	uint32_t wDiv;
+	int32_t iEtbCh;
+
+	if(ptCfg->wMinFreq == 0 || ptCfg->byTimer > CAPTURE_GPTA0 || ptCfg->byEdge > CAPTURE_EDGE_BOTH)
+		return CSI_ERROR;
+	if(ptCfg->ptBuf && (!RINGBUF_IS_POW2(ptCfg->hwBufLen) || ptCfg->hwBufLen > RINGBUF_MAX_SIZE / sizeof(csi_capture_sample_t)))
+		return CSI_ERROR;
+
+	//one period of wMinFreq within 0xFFFF counts
+	wDiv = csi_get_pclk_freq() / ptCfg->wMinFreq / 0xFFFF + 1;
+	if(wDiv > 0x10000)
+		return CSI_ERROR;
+
+	//ETB route before the timer: the only step that can fail, its channel is freed again
+	tEtbCfg.byChType  = ETB_ONE_TRG_ONE;
+	tEtbCfg.bySrcIp   = ptCfg->bySrc;
+	tEtbCfg.bySrcIp1  = SRC_NOT_USE;
+	tEtbCfg.bySrcIp2  = SRC_NOT_USE;
+	tEtbCfg.byDstIp   = (ptCfg->byTimer == CAPTURE_EPT0) ? ETB_EPT0_SYNCIN2 : ETB_GPT0_SYNCIN2;
+	tEtbCfg.byDstIp1  = DST_NOT_USE;
+	tEtbCfg.byDstIp2  = DST_NOT_USE;
+	tEtbCfg.byTrgMode = ETB_HARDWARE_TRG;
+
+	csi_etb_init();
+	iEtbCh = csi_etb_ch_alloc(ETB_ONE_TRG_ONE);
+	if(iEtbCh < 0)
+		return CSI_ERROR;
+	if(csi_etb_ch_config((csi_etb_chid_e)iEtbCh, &tEtbCfg) != CSI_OK)
+	{
+		csi_etb_ch_free((csi_etb_chid_e)iEtbCh);
+		return CSI_ERROR;
+	}
+
+	memset(ptCap, 0, sizeof(csi_capture_t));
+	ptCap->byTimer = ptCfg->byTimer;
+	ptCap->byEdge  = ptCfg->byEdge;
+	ptCap->byPin   = ptCfg->byPin;
+	if(ptCfg->ptBuf)
+		ringbuffer_init(&ptCap->tFifo, (uint8_t *)ptCfg->ptBuf, ptCfg->hwBufLen * sizeof(csi_capture_sample_t));
+	ptCap->wTickFreq = csi_get_pclk_freq() / wDiv;
+
+	if(ptCap->byTimer == CAPTURE_EPT0)
+	{
+		csi_ept_captureconfig_t tCapCfg;
+
+		memset(&tCapCfg, 0, sizeof(tCapCfg));
+		tCapCfg.byWorkmod         = EPT_CAPTURE;
+		tCapCfg.byCountingMode    = EPT_UPCNT;
+		tCapCfg.byOneshotMode     = EPT_OP_CONT;
+		tCapCfg.byStartSrc        = EPT_SYNC_START;
+		tCapCfg.byPscld           = EPT_LDPSCR_ZRO;
+		tCapCfg.byCaptureCapmd    = EPT_CAP_CONT;
+		tCapCfg.byCaptureStopWrap = 4 - 1;						//CMPA~CMPD
+		ptCap->ptTimer = EPT0;
+		csi_ept_capture_init(EPT0, &tCapCfg);
+		csp_ept_set_pscr(EPT0, (uint16_t)(wDiv - 1));
+		csi_ept_set_sync(EPT0, EPT_TRGIN_SYNCEN2, EPT_TRG_CONTINU, EPT_AUTO_REARM_DIS);
+		csp_ept_int_enable(EPT0, (csp_ept_int_e)(CAP_INT_CAPLD3 | CAP_INT_PEND), true);
+	}
+	else
+	{
+		csi_gpta_captureconfig_t tCapCfg;
+
+		memset(&tCapCfg, 0, sizeof(tCapCfg));
+		tCapCfg.byWorkmod         = GPTA_CAPTURE;
+		tCapCfg.byCountingMode    = GPTA_UPCNT;
+		tCapCfg.byOneshotMode     = GPTA_OP_CONT;
+		tCapCfg.byStartSrc        = GPTA_SYNC_START;
+		tCapCfg.byPscld           = GPTA_LDPSCR_ZRO;
+		tCapCfg.byCaptureCapmd    = GPTA_CAP_CONT;
+		tCapCfg.byCaptureStopWrap = 4 - 1;
+		ptCap->ptTimer = GPT0;
+		csi_gpta_capture_init(GPT0, &tCapCfg);
+		csp_gpta_set_pscr(GPT0, (uint16_t)(wDiv - 1));
+		csi_gpta_set_sync(GPT0, GPTA_TRGIN_SYNCEN2, GPTA_TRG_CONTINU, GPTA_AUTO_REARM_DIS);
+		csp_gpta_int_enable(GPT0, (csp_gpta_int_e)(CAP_INT_CAPLD3 | CAP_INT_PEND), true);
+	}
+
+	csi_irq_attach(csi_irq_num((uint32_t *)ptCap->ptTimer), apt_capture_irqhandler, ptCap);
+	csi_irq_enable((uint32_t *)ptCap->ptTimer);
+
+	return CSI_OK;
+}
+
+/** \brief clear samples and averages and start the counter
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_capture_start(csi_capture_t *ptCap)
+{
+	uint32_t wIrqSta, wLevel;
+	uint8_t i;
+
+	for(i = 0; i < CAP_START_RETRY; i++)
+	{
+		wIrqSta = csi_irq_save();
+		apt_capture_halt(ptCap);
+		apt_capture_clr_int(ptCap, CAP_INT_CAPLD_ALL | CAP_INT_PEND);
+		ptCap->wOvf = 0;
+		ptCap->byIdleOvf = 0;
+		ptCap->byState = 0;
+		apt_capture_clr_avg(ptCap);
+		if(ptCap->tFifo.pbyBuf)
+			ringbuffer_out(&ptCap->tFifo, NULL, ringbuffer_len(&ptCap->tFifo));
+
+		//first edge falls when the input is high at start, CMPA/CMPC then hold the falling edges
+		wLevel = csi_pin_read((pin_name_e)ptCap->byPin);
+		if(ptCap->byTimer == CAPTURE_EPT0)
+			csi_ept_start((csp_ept_t *)ptCap->ptTimer);
+		else
+			csi_gpta_start((csp_gpta_t *)ptCap->ptTimer);
+		if(ptCap->byEdge == CAPTURE_EDGE_RISE || wLevel == csi_pin_read((pin_name_e)ptCap->byPin))
+		{
+			if(ptCap->byEdge == CAPTURE_EDGE_BOTH && wLevel)
+				ptCap->byState = CAP_ST_AFALL;
+			csi_irq_restore(wIrqSta);
+			return CSI_OK;
+		}
+		csi_irq_restore(wIrqSta);							//edge during start, polarity unknown
+	}
+
+	apt_capture_halt(ptCap);
+	return CSI_ERROR;
+}
+
+/** \brief stop the counter, averages and samples are kept
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return none
+ */
+void csi_capture_stop(csi_capture_t *ptCap)
+{
+	apt_capture_halt(ptCap);
+}
+
+/** \brief take the oldest sample, consumer side of the sample buffer(lock free)
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[out] ptSample: sample
+ *  \return true: one sample read; false: buffer empty
+ */
+bool csi_capture_read(csi_capture_t *ptCap, csi_capture_sample_t *ptSample)
+{
+	if(ptCap->tFifo.pbyBuf == NULL || ringbuffer_len(&ptCap->tFifo) < sizeof(csi_capture_sample_t))
+		return false;
+
+	ringbuffer_out(&ptCap->tFifo, ptSample, sizeof(csi_capture_sample_t));
+	return true;
+}
+
+/** \brief frequency averaged over the last CAPTURE_AVG_LEN periods
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return frequency in 0.01Hz, 0 = no signal(or below wMinFreq)
+ */
+uint32_t csi_capture_get_freq(csi_capture_t *ptCap)
+{
+	uint32_t wIrqSta, wSum, wNum;
+	uint8_t byCnt;
+
+	wIrqSta = csi_irq_save();
+	wSum  = ptCap->wPrdSum;
+	byCnt = ptCap->byAvgCnt;
+	csi_irq_restore(wIrqSta);
+
+	if(byCnt == 0 || wSum == 0)
+		return 0;
+
+	//tick freq * periods stays in 32 bits for CONFIG_CAPTURE_AVG_SHIFT <= 4
+	wNum = ptCap->wTickFreq * byCnt;
+	return (wNum / wSum) * 100 + (wNum % wSum) * 100 / wSum;
+}
+
+/** \brief duty averaged over the last CAPTURE_AVG_LEN periods, CAPTURE_EDGE_BOTH mode
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return high time / period in Q15(0x8000 = 100%), 0 = no signal
+ */
+uint32_t csi_capture_get_duty_q15(csi_capture_t *ptCap)
+{
+	uint32_t wIrqSta, wPrd, wHigh;
+
+	wIrqSta = csi_irq_save();
+	wPrd  = ptCap->wPrdSum;
+	wHigh = ptCap->wHighSum;
+	csi_irq_restore(wIrqSta);
+
+	while(wPrd > 0xFFFF)										//wHigh << 15 within 32 bits
+	{
+		wPrd  >>= 1;
+		wHigh >>= 1;
+	}
+	if(wPrd == 0)
+		return 0;
+
+	return (wHigh << 15) / wPrd;
+}
@@ -1,4 +1,4 @@
-/***********************************************************************//** 
+/***********************************************************************//**
  * \file  crc.c
  * \brief  CRC driver
  * \copyright Copyright (C) 2015-2020 @ APTCHIP
@@ -17,28 +17,224 @@
 
 //#define CRC_BASE_ADDRESS (csp_crc_t *)AHB_CRC_BASE
 
+#define CRC_DATAIN_ADDR		(AHB_CRC_BASE + 0x14)
+
+/// per type setting: hardware poly select, bit order, width and the nibble table of the software path
+typedef struct {
+	uint8_t			byPoly;			//CR.POLY
+	uint8_t			byRef;			//1: refin = refout = 1, LSB first
+	uint8_t			byWidth;		//16/32
+	const void		*pTbl;
+} crc_type_info_t;
+
+//nibble tables, 16 entries per type keeps the software path small in flash
+static const uint16_t s_hwCrc16Tbl[16] = {		//0x8005 reflected
+	0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+	0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+static const uint16_t s_hwCcittTbl[16] = {		//0x1021 reflected
+	0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+	0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F
+};
+static const uint16_t s_hwItuTbl[16] = {		//0x1021
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+static const uint32_t s_wCrc32Tbl[16] = {		//0x04c11db7
+	0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+	0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+};
+
+static const crc_type_info_t s_tCrcInfo[] = {
+	[CRC_TYPE_CRC16]	= {2, 1, 16, s_hwCrc16Tbl},
+	[CRC_TYPE_CCITT]	= {0, 1, 16, s_hwCcittTbl},
+	[CRC_TYPE_ITU]		= {0, 0, 16, s_hwItuTbl},
+	[CRC_TYPE_CRC32_BE]	= {3, 0, 32, s_wCrc32Tbl},
+};
+
+static volatile bool s_bCrcBusy = false;		//hardware owned by a running calculation
+
+/** \brief software crc, nibble table driven
+ *
+ *  \param[in] ptInfo: type setting
+ *  \param[in] wCrc: running crc(seed)
+ *  \param[in] pbyData: data
+ *  \param[in] wSize: data size
+ *  \return crc without xorout
+ */
+static uint32_t apt_crc_soft(const crc_type_info_t *ptInfo, uint32_t wCrc, const uint8_t *pbyData, uint32_t wSize)
+{
+	if(ptInfo->byRef)									//reflected, low nibble first
+	{
+		const uint16_t *phwTbl = (const uint16_t *)ptInfo->pTbl;
+
+		while(wSize--)
+		{
+			uint8_t byData = *pbyData++;
+
+			wCrc = (wCrc >> 4) ^ phwTbl[(wCrc ^ byData) & 0x0F];
+			wCrc = (wCrc >> 4) ^ phwTbl[(wCrc ^ (byData >> 4)) & 0x0F];
+		}
+	}
+	else if(ptInfo->byWidth == 16)						//MSB first, high nibble first
+	{
+		const uint16_t *phwTbl = (const uint16_t *)ptInfo->pTbl;
+
+		while(wSize--)
+		{
+			uint8_t byData = *pbyData++;
+
+			wCrc = ((wCrc << 4) & 0xFFFF) ^ phwTbl[((wCrc >> 12) ^ (byData >> 4)) & 0x0F];
+			wCrc = ((wCrc << 4) & 0xFFFF) ^ phwTbl[((wCrc >> 12) ^ byData) & 0x0F];
+		}
+	}
+	else
+	{
+		const uint32_t *pwTbl = (const uint32_t *)ptInfo->pTbl;
+
+		while(wSize--)
+		{
+			uint8_t byData = *pbyData++;
+
+			wCrc = (wCrc << 4) ^ pwTbl[((wCrc >> 28) ^ (byData >> 4)) & 0x0F];
+			wCrc = (wCrc << 4) ^ pwTbl[((wCrc >> 28) ^ byData) & 0x0F];
+		}
+	}
+
+	return wCrc;
+}
+
+/** \brief hardware crc, 32 bit writes on the aligned part of the buffer
+ *
+ *  A word is taken in LSB first when refin is set, so the little endian load
+ *  is already in stream order. MSB first types take the most significant byte
+ *  first, the word is byte swapped for them.
+ *
+ *  \param[in] ptInfo: type setting
+ *  \param[in] wCrc: running crc(seed)
+ *  \param[in] pbyData: data
+ *  \param[in] wSize: data size
+ *  \return crc without xorout
+ */
+static uint32_t apt_crc_hw(const crc_type_info_t *ptInfo, uint32_t wCrc, const uint8_t *pbyData, uint32_t wSize)
+{
+	uint32_t i = 0;
+	uint32_t wWord;
+
+	csp_crc_set_poly(CRC, ptInfo->byPoly);
+	csp_crc_refin_enable(CRC, ptInfo->byRef);
+	csp_crc_refout_enable(CRC, ptInfo->byRef);
+	csp_crc_xorout_enable(CRC, DISABLE);
+	csp_crc_xorin_enable(CRC, DISABLE);
+	csp_crc_set_seed(CRC, wCrc);
+
+	for(; i < wSize && ((uint32_t)pbyData & 0x03); i++)				//head, up to word alignment
+		*(volatile uint8_t *)(CRC_DATAIN_ADDR + (i & 0x03)) = *pbyData++;
+
+	for(; i + 4 <= wSize; i += 4)										//body, one write per word
+	{
+		wWord = *(const uint32_t *)pbyData;
+		pbyData += 4;
+		CRC->DATAIN = ptInfo->byRef ? wWord : __builtin_bswap32(wWord);
+	}
+
+	for(; i < wSize; i++)												//tail
+		*(volatile uint8_t *)(CRC_DATAIN_ADDR + (i & 0x03)) = *pbyData++;
+
+	wCrc = csp_crc_get_result(CRC);
+	return (ptInfo->byWidth == 16) ? (wCrc & 0xFFFF) : wCrc;
+}
+
+/** \brief crc on the hardware if it is free and clocked, else in software
+ *
+ *  \param[in] eType: crc type
+ *  \param[in] wCrc: running crc(seed)
+ *  \param[in] pbyData: data
+ *  \param[in] wSize: data size
+ *  \return crc without xorout
+ */
+static uint32_t apt_crc_calc(csi_crc_type_e eType, uint32_t wCrc, const uint8_t *pbyData, uint32_t wSize)
+{
+	const crc_type_info_t *ptInfo = &s_tCrcInfo[eType];
+	uint32_t wIrqFlag;
+	bool bHw = false;
+
+	wIrqFlag = csi_irq_save();
+	if(!s_bCrcBusy && (CRC->CEDR & CRC_CLKEN))						//not shared with an interrupted caller
+	{
+		s_bCrcBusy = true;
+		bHw = true;
+	}
+	csi_irq_restore(wIrqFlag);
+
+	if(!bHw)
+		return apt_crc_soft(ptInfo, wCrc, pbyData, wSize);
+
+	wCrc = apt_crc_hw(ptInfo, wCrc, pbyData, wSize);
+	s_bCrcBusy = false;
+	return wCrc;
+}
 
 /**
- * \brief       Initialize CRC Interface. 1. Initializes the resources needed for the CRC interface  
+ * \brief       Initialize CRC Interface. 1. Initializes the resources needed for the CRC interface
  * \return      \ref csi_error_t
  */
 void csi_crc_init(void)
-{	
+{
 	csp_crc_clk_enable(CRC, ENABLE); //enable crc clock
 	csp_crc_rst(CRC);                //software reset
 }
 
 
 /**
- * \brief    Reset CRC Interface. 1.Reset the CRC module 
+ * \brief    Reset CRC Interface. 1.Reset the CRC module
  * \return   none
  */
 void csi_crc_rst(void)
 {
 	csp_crc_rst(CRC);               //software reset
-}  
+}
+
+/**
+ * \brief start a streaming calculation
+ * \param[in] ptCtx     :calculation context
+ * \param[in] eType     :crc type
+ * \param[in] wCrcSeed  :CRC seed value
+ * \return    none
+ */
+void csi_crc_start(csi_crc_ctx_t *ptCtx, csi_crc_type_e eType, uint32_t wCrcSeed)
+{
+	ptCtx->byType = (uint8_t)eType;
+	ptCtx->wCrc = (s_tCrcInfo[eType].byWidth == 16) ? (wCrcSeed & 0xFFFF) : wCrcSeed;
+}
+
+/**
+ * \brief feed the next part of the data, on the hardware when it is free, else in software
+ * \param[in] ptCtx     :calculation context
+ * \param[in] pData     :data buf to be calculate
+ * \param[in] wSize     :data size
+ * \return    none
+ */
+void csi_crc_update(csi_crc_ctx_t *ptCtx, const void *pData, uint32_t wSize)
+{
+	ptCtx->wCrc = apt_crc_calc((csi_crc_type_e)ptCtx->byType, ptCtx->wCrc, (const uint8_t *)pData, wSize);
+}
 
+/**
+ * \brief Compute a CRC in software only, same results as the hardware
+ * \param[in] eType     :crc type
+ * \param[in] wCrcSeed  :CRC seed value
+ * \param[in] pData     :data buf to be calculate
+ * \param[in] wSize     :data size
+ * \return    The computed CRC without xorout
+ */
+uint32_t csi_crc_soft(csi_crc_type_e eType, uint32_t wCrcSeed, const void *pData, uint32_t wSize)
+{
+	if(s_tCrcInfo[eType].byWidth == 16)
+		wCrcSeed &= 0xFFFF;
 
+	return apt_crc_soft(&s_tCrcInfo[eType], wCrcSeed, (const uint8_t *)pData, wSize);
+}
 
 /**
  * \brief Compute the CRC-16 checksum of a buffer.
@@ -50,19 +246,7 @@ void csi_crc_rst(void)
  */
 uint16_t csi_crc16(uint16_t hwCrcSeed, uint8_t* pbyData, uint32_t wSize)
 {
-	uint32_t i;
-
-	csp_crc_set_poly(CRC, 2);              //Set CRC-16 
-	csp_crc_refin_enable(CRC, ENABLE);     //Enables bitwise reversal of control of CRC input data
-	csp_crc_refout_enable(CRC, ENABLE);    //Enables bitwise reversal of control of CRC output data
-	csp_crc_xorout_enable(CRC, DISABLE);   //Disable XOR control of CRC output data
-	csp_crc_set_seed(CRC, hwCrcSeed);      //Set CRC seed value
-	for (i=0; i<wSize; i++)                
-	{
-		*(uint8_t *)(AHB_CRC_BASE + 0x14 + (i%4)) = *pbyData; //Write data
-		pbyData ++;
-	}
-	return ((uint16_t)csp_crc_get_result(CRC));  //Return the result of calculation
+	return (uint16_t)apt_crc_calc(CRC_TYPE_CRC16, hwCrcSeed, pbyData, wSize);
 }
 
 
@@ -76,20 +260,7 @@ uint16_t csi_crc16(uint16_t hwCrcSeed, uint8_t* pbyData, uint32_t wSize)
  */
 uint16_t csi_crc16_ccitt( uint16_t hwCrcSeed, uint8_t *pbyData, uint32_t wSize)
 {
-	uint32_t i;
-  
-	csp_crc_set_poly(CRC, 0);            //Set CRC-CCITT
-	csp_crc_refin_enable(CRC, ENABLE);   //Enables bitwise reversal of control of CRC input data
-	csp_crc_refout_enable(CRC, ENABLE);  //Enables bitwise reversal of control of CRC output data
-	csp_crc_xorout_enable(CRC, DISABLE); //Disable XOR control of CRC output data
-	csp_crc_xorin_enable(CRC, DISABLE);  //Enables XOR control of CRC input data
-	csp_crc_set_seed(CRC, hwCrcSeed);    //Set CRC seed value
-	for (i=0; i<wSize; i++)
-	{
-		*(uint8_t *)(AHB_CRC_BASE + 0x14 + (i%4)) = *pbyData; //Write data
-		pbyData ++;
-	}
-	return ((uint16_t)csp_crc_get_result(CRC));  //Return the result of calculation
+	return (uint16_t)apt_crc_calc(CRC_TYPE_CCITT, hwCrcSeed, pbyData, wSize);
 }
 
 
@@ -103,19 +274,7 @@ uint16_t csi_crc16_ccitt( uint16_t hwCrcSeed, uint8_t *pbyData, uint32_t wSize)
  */
 uint16_t csi_crc16_itu(uint16_t hwCrcSeed, uint8_t* pbyData, uint32_t wSize)
 {
-	uint32_t i;
-  
-	csp_crc_set_poly(CRC, 0);            //Set CRC-CCITT
-	csp_crc_refin_enable(CRC, DISABLE);  //Enables bitwise reversal of control of CRC input data
-	csp_crc_refout_enable(CRC, DISABLE); //Enables bitwise reversal of control of CRC output data
-	csp_crc_xorout_enable(CRC, DISABLE); //Disable XOR control of CRC output data
-	csp_crc_set_seed(CRC, hwCrcSeed);    //Set CRC seed value
-	for (i=0; i<wSize; i++)
-	{
-		*(uint8_t *)(AHB_CRC_BASE + 0x14 + (i%4)) = *pbyData;  //Write data
-		pbyData ++;
-	}
-	return ((uint16_t)csp_crc_get_result(CRC));  //Return the result of calculation
+	return (uint16_t)apt_crc_calc(CRC_TYPE_ITU, hwCrcSeed, pbyData, wSize);
 }
 
 
@@ -129,17 +288,5 @@ uint16_t csi_crc16_itu(uint16_t hwCrcSeed, uint8_t* pbyData, uint32_t wSize)
  */
 uint32_t csi_crc32_be(uint32_t wCrcSeed, uint8_t* pbyData, uint32_t wSize)
 {
-	uint32_t i;
-
-	csp_crc_set_poly(CRC, 3);            //Set CRC-32
-	csp_crc_refin_enable(CRC, DISABLE);  //Disable bitwise reversal of control of CRC input data
-	csp_crc_refout_enable(CRC, DISABLE); //Disable bitwise reversal of control of CRC output data
-	csp_crc_xorout_enable(CRC, DISABLE); //Disable XOR control of CRC output data
-	csp_crc_set_seed(CRC, wCrcSeed);     //Set CRC seed value
-	for (i=0; i<wSize; i++) 
-	{
-		*(uint8_t *)(AHB_CRC_BASE + 0x14 + (i%4)) = *pbyData; //Write data
-		pbyData++;
-	}
-	return (csp_crc_get_result(CRC)); //Return the result of calculation
-}
\ No newline at end of file
+	return apt_crc_calc(CRC_TYPE_CRC32_BE, wCrcSeed, pbyData, wSize);
+}
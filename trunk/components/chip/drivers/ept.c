@@ -8,16 +8,21 @@
  * </table>
  * *********************************************************************
 */
+#include <string.h>
 #include "sys_clk.h"
 #include "drv/common.h"
 #include "drv/ept.h"
 #include "csp_ept.h"
 #include "drv/pin.h"
 #include <drv/irq.h>
+#include <drv/etb.h>
 #include <sys_clk.h>
 
 uint32_t gEptPrd;
 
+static csi_ept_mc_hook_t s_pfEptMcHook;
+static void *s_pEptMcArg;
+
  /**
  \brief  Basic configuration
  \param  ptEptBase    	pointer of ept register structure
@@ -471,7 +476,7 @@ csi_error_t csi_ept_global_config(csp_ept_t *ptEptBase,csi_ept_Global_load_contr
 */
 csi_error_t csi_ept_global_sw(csp_ept_t *ptEptBase)
 {
-	csp_ept_set_gldcr2(ptEptBase,0x01);
+	csp_ept_set_gldcr2(ptEptBase,EPT_SW_GLD);
 	return CSI_OK;
 }
 /**
@@ -481,7 +486,7 @@ csi_error_t csi_ept_global_sw(csp_ept_t *ptEptBase)
 */
 csi_error_t csi_ept_global_rearm(csp_ept_t *ptEptBase)
 {
-	csp_ept_set_gldcr2(ptEptBase,0x02);
+	csp_ept_set_gldcr2(ptEptBase,EPT_OSREARM_EN);
 	return CSI_OK;
 }
 /** \brief start ept
@@ -570,6 +575,176 @@ csi_error_t csi_ept_change_ch_duty(csp_ept_t *ptEptBase, csi_ept_chtype_e eCh, u
     return (0);
 }
 
+/**
+ \brief write CMPA~CMPD and trigger the global load
+ \param ptEptBase    pointer of ept register structure
+ \param hwCmp        compare values of channel A~D
+*/
+void csi_ept_update_cmp(csp_ept_t *ptEptBase, const uint16_t hwCmp[4])
+{
+	ptEptBase->CMPA = hwCmp[0];
+	ptEptBase->CMPB = hwCmp[1];
+	ptEptBase->CMPC = hwCmp[2];
+	ptEptBase->CMPD = hwCmp[3];
+	csi_ept_global_sw(ptEptBase);
+}
+
+/**
+ \brief change the duty of channel A~D, Q15
+ \param ptEptBase    pointer of ept register structure
+ \param hwDuty       duty of channel A~D in Q15
+*/
+void csi_ept_update_duty_q15(csp_ept_t *ptEptBase, const uint16_t hwDuty[4])
+{
+	ptEptBase->CMPA = csi_ept_duty_q15_to_cmp(hwDuty[0]);
+	ptEptBase->CMPB = csi_ept_duty_q15_to_cmp(hwDuty[1]);
+	ptEptBase->CMPC = csi_ept_duty_q15_to_cmp(hwDuty[2]);
+	ptEptBase->CMPD = csi_ept_duty_q15_to_cmp(hwDuty[3]);
+	csi_ept_global_sw(ptEptBase);
+}
+
+/**
+ \brief  EPT interrupt of the motor control profile, calls the period hook at ZRO(TRGEV1)
+ \param  pArg    	pointer of ept register structure
+*/
+static void apt_ept_mc_irqhandler(void *pArg)
+{
+	csp_ept_t *ptEptBase = (csp_ept_t *)pArg;
+	uint32_t wMisr = csp_ept_get_misr(ptEptBase);
+	
+	csp_ept_clr_int(ptEptBase, wMisr);
+	if((wMisr & EPT_INT_TRGEV1) && s_pfEptMcHook)
+		s_pfEptMcHook(s_pEptMcArg);
+}
+
+/**
+ \brief  motor control PWM profile
+ \param  ptEptBase    	pointer of ept register structure
+ \param  ptMcCfg   	    refer to csi_ept_mc_config_t
+ \return CSI_OK /CSI_ERROR
+*/
+csi_error_t csi_ept_mc_init(csp_ept_t *ptEptBase, csi_ept_mc_config_t *ptMcCfg)
+{
+	static const csi_ept_osrchx_e eEmCh[6] = {EMCOAX, EMCOBX, EMCOCX, EMCOAY, EMCOBY, EMCOCY};
+	csi_ept_pwmconfig_t tPwmCfg;
+	csi_ept_pwmchannel_config_t tChCfg;
+	csi_ept_deadzone_config_t tDbCfg;
+	csi_ept_emergency_config_t tEmCfg;
+	csi_ept_Global_load_control_config_t tGldCfg;
+	csi_etb_config_t tEtbCfg;
+	uint32_t wDbTicks;
+	int32_t iEtbCh;
+	uint8_t i;
+	
+	if(ptMcCfg->wFreq == 0)
+		return CSI_ERROR;
+	
+	//counter: up/down, period 1/wFreq, all compare values at duty 0
+	tPwmCfg.byWorkmod      = EPT_WAVE;
+	tPwmCfg.byCountingMode = EPT_UPDNCNT;
+	tPwmCfg.byOneshotMode  = EPT_OP_CONT;
+	tPwmCfg.byStartSrc     = EPT_SYNC_START;
+	tPwmCfg.byPscld        = EPT_LDPSCR_ZRO;
+	tPwmCfg.byDutyCycle    = 0;
+	tPwmCfg.wFreq          = ptMcCfg->wFreq;
+	tPwmCfg.byInter        = 0;
+	csi_ept_wave_init(ptEptBase, &tPwmCfg);
+	
+	//CHx high while CNT >= CMPx: the pulse is centered on PRD
+	memset(&tChCfg, 0, sizeof(tChCfg));							//NA for the other events
+	tChCfg.byActionCau = HI;
+	tChCfg.byActionCad = LO;
+	for(i = 0; i < 3; i++)
+	{
+		tChCfg.byChoiceCasel = EPT_CMPA + i;
+		tChCfg.byChoiceCbsel = EPT_CMPA + i;
+		csi_ept_channel_config(ptEptBase, &tChCfg, (csi_ept_channel_e)(EPT_CHANNEL_A + i));
+	}
+	
+	//dead band: CHxX = PWMx rising edge delayed, CHxY = inverted PWMx falling edge delayed
+	csi_ept_dbldrload_config(ptEptBase, DBCR, EPT_SHDW_IMMEDIATE, EPT_LD_ZRO);
+	csi_ept_dbldrload_config(ptEptBase, DBDTR, EPT_SHDW_IMMEDIATE, EPT_LD_ZRO);
+	csi_ept_dbldrload_config(ptEptBase, DBDTF, EPT_SHDW_IMMEDIATE, EPT_LD_ZRO);
+	csi_ept_dbldrload_config(ptEptBase, DCKPSC, EPT_SHDW_IMMEDIATE, EPT_LD_ZRO);
+	
+	memset(&tDbCfg, 0, sizeof(tDbCfg));
+	tDbCfg.byDcksel         = EPT_DB_DPSC;
+	tDbCfg.byChaDedb        = DB_AR_BF;
+	tDbCfg.byChbDedb        = DB_AR_BF;
+	tDbCfg.byChcDedb        = DB_AR_BF;
+	tDbCfg.byChxOuselS1S0   = E_DBOUT_AR_BF;
+	tDbCfg.byChxPolarityS3S2= E_DB_POL_B;
+	tDbCfg.byChxInselS5S4   = E_DBCHAIN_AR_AF;
+	tDbCfg.byChxOutSwapS8S7 = E_CHOUTX_OUA_OUB;
+	csi_ept_dbcr_config(ptEptBase, &tDbCfg);
+	for(i = 0; i < 3; i++)
+		csi_ept_channelmode_config(ptEptBase, &tDbCfg, (csi_ept_channel_e)(EPT_CHANNEL_A + i));
+	
+	wDbTicks = ((uint32_t)ptMcCfg->hwDeadTimeNs * (csi_get_pclk_freq() / 1000) + 999999) / 1000000;	//DPSC = 0, round up
+	csp_ept_set_dbdtr(ptEptBase, (uint16_t)wDbTicks);
+	csp_ept_set_dbdtf(ptEptBase, (uint16_t)wDbTicks);
+	
+	//emergency: one input on EP0 forces all six outputs
+	if(ptMcCfg->byEbi)
+	{
+		memset(&tEmCfg, 0, sizeof(tEmCfg));
+		tEmCfg.byEpxInt   = ptMcCfg->byEbi;
+		tEmCfg.byPolEbix  = ptMcCfg->byEbiPol;
+		tEmCfg.byEpx      = EP0;
+		tEmCfg.byEpxLckmd = ptMcCfg->byEmLckmd;
+		tEmCfg.byFltpace0 = EPFLT0_2P;
+		tEmCfg.byFltpace1 = EPFLT1_2P;
+		csi_ept_emergency_cfg(ptEptBase, &tEmCfg);
+		for(i = 0; i < 6; i++)
+			csi_ept_emergency_pinxout(ptEptBase, eEmCh[i], ptMcCfg->byEmOut);
+	}
+	
+	//CMPA~CMPC: loaded only by the global load, one shot at ZRO, armed by csi_ept_mc_update_q15
+	csp_ept_set_gldcfg(ptEptBase, EPT_LD_CMPA_MSK | EPT_LD_CMPB_MSK | EPT_LD_CMPC_MSK);
+	tGldCfg.bGlden  = ENABLE;
+	tGldCfg.byGldmd = EPT_LDGLD_ZRO;
+	tGldCfg.bOstmd  = EPT_LDMD_OS;
+	tGldCfg.bGldprd = 0;
+	csi_ept_global_config(ptEptBase, &tGldCfg);
+	csi_ept_global_rearm(ptEptBase);
+	
+	//ADC sync: trigger out 0 -> ETB -> ADC SYNCINx
+	if(ptMcCfg->byAdcTrgSrc != EPT_TRGSRC_DIS)
+	{
+		if(csi_ept_set_evtrg(ptEptBase, EPT_TRG_OUT0, ptMcCfg->byAdcTrgSrc) != CSI_OK)
+			return CSI_ERROR;
+		
+		csi_etb_init();
+		iEtbCh = csi_etb_ch_alloc(ETB_ONE_TRG_ONE);
+		if(iEtbCh < 0)
+			return CSI_ERROR;
+		
+		tEtbCfg.byChType  = ETB_ONE_TRG_ONE;
+		tEtbCfg.bySrcIp   = ETB_ETP0_TRGOUT0;
+		tEtbCfg.bySrcIp1  = SRC_NOT_USE;
+		tEtbCfg.bySrcIp2  = SRC_NOT_USE;
+		tEtbCfg.byDstIp   = ptMcCfg->byAdcSyncIn;
+		tEtbCfg.byDstIp1  = DST_NOT_USE;
+		tEtbCfg.byDstIp2  = DST_NOT_USE;
+		tEtbCfg.byTrgMode = ETB_HARDWARE_TRG;
+		if(csi_etb_ch_config((csi_etb_chid_e)iEtbCh, &tEtbCfg) != CSI_OK)
+			return CSI_ERROR;
+	}
+	
+	//period hook: trigger out 1 at ZRO, interrupt TRGEV1
+	s_pfEptMcHook = ptMcCfg->pfPeriod;
+	s_pEptMcArg   = ptMcCfg->pArg;
+	if(ptMcCfg->pfPeriod)
+	{
+		csi_ept_set_evtrg(ptEptBase, EPT_TRG_OUT1, EPT_TRGSRC_ZRO);
+		csi_irq_attach((uint32_t)csi_irq_num((uint32_t *)ptEptBase), apt_ept_mc_irqhandler, ptEptBase);
+		csp_ept_int_enable(ptEptBase, EPT_INT_TRGEV1, true);
+		csi_irq_enable((uint32_t *)ptEptBase);
+	}
+	
+	return CSI_OK;
+}
+
 /**
  \brief software force lock
  \param ptEpt    pointer of ept register structure
@@ -11,14 +11,32 @@
  * </table>
  * *********************************************************************
 */
+#include <string.h>
 #include <sys_clk.h>
+#include <soc.h>
 #include <drv/etb.h>
 
 /* Private macro------------------------------------------------------*/
+#define ETB_CH_NUM			8
+#define ETB_CH_NONE			0xff
+#define ETB_ID_MAX			0x3f			//6 bit source/destination fields
+
 /* externs function---------------------------------------------------*/
 /* externs variablesr-------------------------------------------------*/
 /* Private variablesr-------------------------------------------------*/
-static uint32_t csi_etb_alloc_status[1];
+static uint8_t s_byEtbAlloc;				//bit n: channel n allocated
+static uint8_t s_byEtbCfg;					//bit n: channel n configured by its owner, destination fields valid
+
+/// one to one routes: channels 3~7 first, then the multi source/destination channels
+static const uint8_t s_byEtbOneOrder[ETB_CH_NUM] = {3, 4, 5, 6, 7, 1, 2, 0};
+
+/// EXI group -> interrupt, as in csi_pin_irq_enable
+static const uint8_t s_byExiGrpIrq[20] = {
+	EXI0_IRQn, EXI1_IRQn, EXI2_IRQn, EXI2_IRQn,
+	EXI3_IRQn, EXI3_IRQn, EXI3_IRQn, EXI3_IRQn, EXI3_IRQn, EXI3_IRQn,
+	EXI4_IRQn, EXI4_IRQn, EXI4_IRQn, EXI4_IRQn, EXI4_IRQn, EXI4_IRQn,
+	EXI0_IRQn, EXI1_IRQn, EXI2_IRQn, EXI2_IRQn
+};
 
 
 /** \brief etb channel[0->7] check
@@ -28,20 +46,7 @@ static uint32_t csi_etb_alloc_status[1];
  */ 
 static int32_t check_is_alloced(csi_etb_chid_e eChId)
 {
-    uint32_t ch_offset, ch_group;
-    int32_t ret = 0;
-    uint8_t status = 0U;
-
-    ch_group = (uint32_t)((uint32_t)eChId / 8U);
-    ch_offset = (uint32_t)((uint32_t)eChId % 8U);
-
-    status = csi_etb_alloc_status[ch_group];
-    status &= (uint8_t)(1U << (uint8_t)ch_offset);
-
-    if (status != 0U)
-        ret = -1;
-
-    return ret;
+    return (s_byEtbAlloc & (1U << eChId)) ? -1 : 0;
 }
 /** \brief etb channel[0->7] status 
  * 
@@ -51,16 +56,11 @@ static int32_t check_is_alloced(csi_etb_chid_e eChId)
  */ 
 static void set_ch_alloc_status(csi_etb_chid_e eChId, uint32_t status)
 {
-    uint32_t ch_offset, ch_group;
-
-    ch_group = (uint32_t)((uint32_t)eChId / 8U);
-    ch_offset = (uint32_t)((uint32_t)eChId % 8U);
-
     if (status == 1U) 
-        csi_etb_alloc_status[ch_group] |= (uint8_t)(1U << (uint8_t)ch_offset);
+        s_byEtbAlloc |= (uint8_t)(1U << eChId);
 	else if (status == 0U) 
-        csi_etb_alloc_status[ch_group] &= ~(uint8_t)(1U << (uint8_t)ch_offset);
-		
+        s_byEtbAlloc &= (uint8_t)~(1U << eChId);
+	s_byEtbCfg &= (uint8_t)~(1U << eChId);				//new owner or none, not configured yet
 }
 /** \brief etb channel[0->7] enable/disable 
  * 
@@ -88,7 +88,7 @@ static void etb_channel_enable(csp_etb_t *ptEtbBase, csi_etb_chid_e byChId, bool
 			break;
 	}
 }
-/** \brief etb more source trigger one destination
+/** \brief etb more source trigger one destination, channel left disabled
  * 
  *  \param[in] ptEtbBase: pionter of etb reg structure.
  *  \param[in] bySrc0: trigger source 0
@@ -111,15 +111,14 @@ static void etb_more_trg_one_set(csp_etb_t *ptEtbBase, uint8_t bySrc0, uint8_t b
 	else
 		ptEtbBase->CFG0_CH0 &= ~ETB_CH0_SRC1_EN_MSK;
 		
-	if(bySrc1 != SRC_NOT_USE)
+	if(bySrc2 != SRC_NOT_USE)
 		ptEtbBase->CFG0_CH0 |= (ETB_CH0_SRC2_EN << ETB_CH0_SRC2_EN_POS);
 	else
 		ptEtbBase->CFG0_CH0 &= ~ETB_CH0_SRC2_EN_MSK;
 		
 	ptEtbBase->CFG1_CH0 = (eTrgMode << ETB_CH_TRG_MODE_POS) | ETB_CH0_TRG_DST(byDst); 
-	ptEtbBase->CFG1_CH0  |= ETB_CH_EN;		//enable etb channel
 }
-/** \brief etb one source trigger more destination
+/** \brief etb one source trigger more destination, channel left disabled
  * 
  *  \param[in] ptEtbBase: pionter of etb reg structure.
  *  \param[in] byChNum: channel number= [1:2]
@@ -149,7 +148,6 @@ static void etb_one_trg_more_set(csp_etb_t *ptEtbBase, uint8_t byChNum, uint8_t
 		ptEtbBase->CH1_2[byChNum-1].CFG0 &= ~ETB_CH1_2_DST2_EN_MSK;
 		
 	ptEtbBase->CH1_2[byChNum-1].CFG1 = (eTrgMode << ETB_CH_TRG_MODE_POS) | ETB_CH1_2_TRG_SRC(bySrc);
-	ptEtbBase->CH1_2[byChNum-1].CFG1 |= ETB_CH_EN;	//enable etb channel
 }
 /** \brief initialize etb; enable etb and etb clk
  * 
@@ -236,6 +234,7 @@ csi_error_t csi_etb_ch_config(csi_etb_chid_e eChId, csi_etb_config_t *ptConfig)
 {
     CSI_PARAM_CHK(ptConfig, CSI_ERROR);
 	csi_error_t ret = CSI_OK;
+	uint32_t wIrqSta;
 	
 	switch(ptConfig->byChType)
 	{
@@ -251,14 +250,20 @@ csi_error_t csi_etb_ch_config(csi_etb_chid_e eChId, csi_etb_config_t *ptConfig)
 			break;
 		case ETB_ONE_TRG_MORE:					//channel num = [1:2]		
 			if((eChId == ETB_CH1_ID) || (eChId == ETB_CH2_ID))
+			{
 				etb_one_trg_more_set(ETCB, eChId, ptConfig->bySrcIp, ptConfig->byDstIp, ptConfig->byDstIp1, ptConfig->byDstIp2,ptConfig->byTrgMode);
+				etb_channel_enable(ETCB, eChId, ENABLE);
+			}
 			else
 				ret = CSI_ERROR;
 				
 			break;
 		case ETB_MORE_TRG_ONE:					//channel num = 0
 			if(eChId == ETB_CH0_ID)
+			{
 				etb_more_trg_one_set(ETCB,ptConfig->bySrcIp, ptConfig->bySrcIp1, ptConfig->bySrcIp2, ptConfig->byDstIp, ptConfig->byTrgMode);
+				etb_channel_enable(ETCB, eChId, ENABLE);
+			}
 			else
 				ret = CSI_ERROR;
 			
@@ -267,6 +272,13 @@ csi_error_t csi_etb_ch_config(csi_etb_chid_e eChId, csi_etb_config_t *ptConfig)
 			ret = CSI_ERROR;
 			break;
 	}
+	
+	if(ret == CSI_OK)
+	{
+		wIrqSta = csi_irq_save();
+		s_byEtbCfg |= (uint8_t)(1U << eChId);
+		csi_irq_restore(wIrqSta);
+	}
 
     return ret;
 }
@@ -298,3 +310,320 @@ void csi_etb_ch_stop(csi_etb_chid_e eChId)
 {
     etb_channel_enable(ETCB, eChId, DISABLE);
 }
+
+/** \brief channel drives a destination(read back from its configuration)
+ * 
+ *  The destination fields of channel 0 and 3~7 reset to 0(a valid destination)
+ *  and have no enable bit of their own: they count once the channel is configured.
+ * 
+ *  \param[in] byCh: channel id = [0:7]
+ *  \param[in] byDst: trigger destination
+ *  \return true: byDst is a destination of byCh
+ */ 
+static bool apt_etb_ch_drives(uint8_t byCh, uint8_t byDst)
+{
+	uint32_t wCfg;
+	
+	if(!(s_byEtbCfg & (1U << byCh)))
+		return false;
+	if(byCh == ETB_CH0_ID)
+		return ((ETCB->CFG1_CH0 & ETB_CH0_TRG_DST_MSK) >> ETB_CH0_TRG_DST_POS) == byDst;
+	
+	if(byCh <= ETB_CH2_ID)
+	{
+		wCfg = ETCB->CH1_2[byCh-1].CFG0;
+		return ((wCfg & ETB_CH1_2_DST0_EN_MSK) && ((wCfg & ETB_CH1_2_TRG_DST0_MSK) >> ETB_CH1_2_TRG_DST0_POS) == byDst) ||
+			((wCfg & ETB_CH1_2_DST1_EN_MSK) && ((wCfg & ETB_CH1_2_TRG_DST1_MSK) >> ETB_CH1_2_TRG_DST1_POS) == byDst) ||
+			((wCfg & ETB_CH1_2_DST2_EN_MSK) && ((wCfg & ETB_CH1_2_TRG_DST2_MSK) >> ETB_CH1_2_TRG_DST2_POS) == byDst);
+	}
+	
+	return ((ETCB->CFG_CHX[byCh-3] & ETB_CHX_TRG_DST_MSK) >> ETB_CHX_TRG_DST_POS) == byDst;
+}
+/** \brief interrupt of the peripheral behind an event source
+ * 
+ *  \param[in] bySrc: trigger source
+ *  \return IRQ number, 0xff: none
+ */ 
+static uint8_t apt_etb_src_irq(uint8_t bySrc)
+{
+	uint8_t byOut, byGrp;
+	
+	if(bySrc >= ETB_EXI_TRGOUT0 && bySrc <= ETB_EXI_TRGOUT5)
+	{
+		byOut = bySrc - ETB_EXI_TRGOUT0;					//EXI group selected by csi_exi_set_evtrg
+		if(byOut < 4)
+			byGrp = (SYSCON->EVTRG & TRG_SRC0_3_MSK(byOut)) >> TRG_SRC0_3_POS(byOut);
+		else
+			byGrp = 16 + ((SYSCON->EVTRG & TRG_SRC4_5_MSK(byOut)) >> TRG_SRC4_5_POS(byOut));
+		return s_byExiGrpIrq[byGrp];
+	}
+	
+	switch(bySrc)
+	{
+		case ETB_LPT_TRGOUT0:		return LPT_IRQn;
+		case ETB_RTC_TRGOUT0:
+		case ETB_RTC_TRGOUT1:		return RTC_IRQn;
+		case ETB_BT_TRGOUT0:		return BT0_IRQn;
+		case ETB_BT_TRGOUT1:		return BT1_IRQn;
+		case ETB_ETP0_TRGOUT0:
+		case ETB_ETP0_TRGOUT1:
+		case ETB_ETP0_TRGOUT2:
+		case ETB_ETP0_TRGOUT3:		return EPT0_IRQn;
+		case ETB_GPT0_TRGOUT0:
+		case ETB_GPT0_TRGOUT1:		return GPT0_IRQn;
+		case ETB_ADC_TRGOUT0:
+		case ETB_ADC_TRGOUT1:		return ADC_IRQn;
+		case ETB_TOUCH_TRGOUT:		return TKEY_IRQn;
+		default:					return 0xff;
+	}
+}
+/** \brief map routes onto free channels, least channels first
+ * 
+ *  \param[in] ptRoute: route table
+ *  \param[in] byNum: routes in the table
+ *  \param[in] byFree: free channels, bit n: channel n
+ *  \param[out] byRtCh: channel of each route
+ *  \return error code \ref csi_error_t
+ */ 
+static csi_error_t apt_etb_graph_plan(const csi_etb_route_t *ptRoute, uint8_t byNum, uint8_t byFree, uint8_t *byRtCh)
+{
+	uint8_t i, j, k, byCnt, byBest, byBestCnt, byCh;
+	
+	memset(byRtCh, ETB_CH_NONE, byNum);
+	
+	//many to one: one destination with 2~3 sources, channel 0 only
+	for(i = 0; i < byNum; i++)
+	{
+		if(byRtCh[i] != ETB_CH_NONE)
+			continue;
+		
+		byCnt = 0;
+		for(j = 0; j < byNum; j++)
+		{
+			if(ptRoute[j].byDst == ptRoute[i].byDst)
+				byCnt++;
+		}
+		if(byCnt < 2)
+			continue;
+		if(byCnt > 3 || !(byFree & (1U << ETB_CH0_ID)))
+			return CSI_ERROR;
+		
+		for(j = i; j < byNum; j++)
+		{
+			if(ptRoute[j].byDst == ptRoute[i].byDst)
+				byRtCh[j] = ETB_CH0_ID;
+		}
+		byFree &= ~(1U << ETB_CH0_ID);
+	}
+	
+	//one to many: the source with the most destinations left, up to 3 per channel
+	while(byFree & ((1U << ETB_CH1_ID) | (1U << ETB_CH2_ID)))
+	{
+		byBest = 0;
+		byBestCnt = 0;
+		for(i = 0; i < byNum; i++)
+		{
+			if(byRtCh[i] != ETB_CH_NONE)
+				continue;
+			
+			byCnt = 0;
+			for(j = i; j < byNum; j++)
+			{
+				if(byRtCh[j] == ETB_CH_NONE && ptRoute[j].bySrc == ptRoute[i].bySrc)
+					byCnt++;
+			}
+			if(byCnt > byBestCnt)
+			{
+				byBest = i;
+				byBestCnt = byCnt;
+			}
+		}
+		if(byBestCnt < 2)
+			break;
+		
+		byCh = (byFree & (1U << ETB_CH1_ID)) ? ETB_CH1_ID : ETB_CH2_ID;
+		byFree &= ~(1U << byCh);
+		for(j = byBest, byCnt = 0; j < byNum && byCnt < 3; j++)
+		{
+			if(byRtCh[j] == ETB_CH_NONE && ptRoute[j].bySrc == ptRoute[byBest].bySrc)
+			{
+				byRtCh[j] = byCh;
+				byCnt++;
+			}
+		}
+	}
+	
+	//one to one
+	for(i = 0; i < byNum; i++)
+	{
+		if(byRtCh[i] != ETB_CH_NONE)
+			continue;
+		
+		for(k = 0; k < ETB_CH_NUM; k++)
+		{
+			if(byFree & (1U << s_byEtbOneOrder[k]))
+				break;
+		}
+		if(k == ETB_CH_NUM)
+			return CSI_ERROR;
+		
+		byRtCh[i] = s_byEtbOneOrder[k];
+		byFree &= ~(1U << byRtCh[i]);
+	}
+	
+	return CSI_OK;
+}
+/** \brief validate a route table, allocate and configure its channels(stopped)
+ * 
+ *  \param[out] ptGraph: graph object
+ *  \param[in] ptRoute: route table
+ *  \param[in] byNum: routes in the table, 1~ETB_GRAPH_ROUTE_MAX
+ *  \return error code \ref csi_error_t
+ */ 
+csi_error_t csi_etb_graph_init(csi_etb_graph_t *ptGraph, const csi_etb_route_t *ptRoute, uint8_t byNum)
+{
+	uint8_t byRtCh[ETB_GRAPH_ROUTE_MAX];
+	uint8_t bySrc[3], byDst[3];
+	uint8_t i, j, byCh, byCnt, byIrq;
+	uint32_t wIrqSta;
+	csi_error_t ret;
+	
+	CSI_PARAM_CHK(ptGraph, CSI_ERROR);
+	CSI_PARAM_CHK(ptRoute, CSI_ERROR);
+	
+	ptGraph->byChMsk = 0;
+	ptGraph->wIrqMsk = 0;
+	if(byNum == 0 || byNum > ETB_GRAPH_ROUTE_MAX)
+		return CSI_ERROR;
+	
+	for(i = 0; i < byNum; i++)
+	{
+		if(ptRoute[i].bySrc > ETB_ID_MAX || ptRoute[i].byDst > ETB_ID_MAX)
+			return CSI_ERROR;
+		for(j = 0; j < i; j++)
+		{
+			if(ptRoute[j].bySrc == ptRoute[i].bySrc && ptRoute[j].byDst == ptRoute[i].byDst)
+				return CSI_ERROR;
+		}
+	}
+	
+	csi_etb_init();
+	
+	wIrqSta = csi_irq_save();
+	
+	//destination already driven by a channel of someone else
+	for(byCh = 0; byCh < ETB_CH_NUM; byCh++)
+	{
+		if(check_is_alloced(byCh) == 0)
+			continue;
+		for(i = 0; i < byNum; i++)
+		{
+			if(apt_etb_ch_drives(byCh, ptRoute[i].byDst))
+			{
+				csi_irq_restore(wIrqSta);
+				return CSI_ERROR;
+			}
+		}
+	}
+	
+	ret = apt_etb_graph_plan(ptRoute, byNum, (uint8_t)~s_byEtbAlloc, byRtCh);
+	if(ret != CSI_OK)
+	{
+		csi_irq_restore(wIrqSta);
+		return ret;
+	}
+	
+	for(i = 0; i < byNum; i++)
+		ptGraph->byChMsk |= (uint8_t)(1U << byRtCh[i]);
+	s_byEtbAlloc |= ptGraph->byChMsk;
+	csi_irq_restore(wIrqSta);
+	
+	//configure every channel disabled, csi_etb_graph_start enables them together
+	for(byCh = 0; byCh < ETB_CH_NUM; byCh++)
+	{
+		if(!(ptGraph->byChMsk & (1U << byCh)))
+			continue;
+		
+		memset(bySrc, SRC_NOT_USE, sizeof(bySrc));
+		memset(byDst, DST_NOT_USE, sizeof(byDst));
+		for(i = 0, byCnt = 0; i < byNum; i++)
+		{
+			if(byRtCh[i] != byCh)
+				continue;
+			bySrc[byCnt] = ptRoute[i].bySrc;
+			byDst[byCnt] = ptRoute[i].byDst;
+			byCnt++;
+		}
+		
+		etb_channel_enable(ETCB, byCh, DISABLE);
+		if(byCh == ETB_CH0_ID)
+			etb_more_trg_one_set(ETCB, bySrc[0], bySrc[1], bySrc[2], byDst[0], ETB_CH_TRG_HARD);
+		else if(byCh <= ETB_CH2_ID)
+			etb_one_trg_more_set(ETCB, byCh, bySrc[0], byDst[0], byDst[1], byDst[2], ETB_CH_TRG_HARD);
+		else
+			csp_etb_one_trg_one_set(ETCB, byCh, bySrc[0], byDst[0], ETB_CH_TRG_HARD);
+	}
+	wIrqSta = csi_irq_save();
+	s_byEtbCfg |= ptGraph->byChMsk;
+	csi_irq_restore(wIrqSta);
+	
+	for(i = 0; i < byNum; i++)
+	{
+		byIrq = apt_etb_src_irq(ptRoute[i].bySrc);
+		if(byIrq < 32)
+			ptGraph->wIrqMsk |= (0x01ul << byIrq);
+	}
+	
+	return CSI_OK;
+}
+/** \brief enable all channels of a graph with interrupts masked
+ * 
+ *  \param[in] ptGraph: graph object
+ *  \return none
+ */ 
+void csi_etb_graph_start(csi_etb_graph_t *ptGraph)
+{
+	uint32_t wIrqSta = csi_irq_save();
+	uint8_t byCh;
+	
+	for(byCh = 0; byCh < ETB_CH_NUM; byCh++)
+	{
+		if(ptGraph->byChMsk & (1U << byCh))
+			etb_channel_enable(ETCB, byCh, ENABLE);
+	}
+	csi_irq_restore(wIrqSta);
+}
+/** \brief disable all channels of a graph with interrupts masked
+ * 
+ *  \param[in] ptGraph: graph object
+ *  \return none
+ */ 
+void csi_etb_graph_stop(csi_etb_graph_t *ptGraph)
+{
+	uint32_t wIrqSta = csi_irq_save();
+	uint8_t byCh;
+	
+	for(byCh = 0; byCh < ETB_CH_NUM; byCh++)
+	{
+		if(ptGraph->byChMsk & (1U << byCh))
+			etb_channel_enable(ETCB, byCh, DISABLE);
+	}
+	csi_irq_restore(wIrqSta);
+}
+/** \brief stop a graph and free its channels
+ * 
+ *  \param[in] ptGraph: graph object
+ *  \return none
+ */ 
+void csi_etb_graph_free(csi_etb_graph_t *ptGraph)
+{
+	uint32_t wIrqSta;
+	
+	csi_etb_graph_stop(ptGraph);
+	wIrqSta = csi_irq_save();
+	s_byEtbAlloc &= (uint8_t)~ptGraph->byChMsk;
+	s_byEtbCfg &= (uint8_t)~ptGraph->byChMsk;
+	csi_irq_restore(wIrqSta);
+	ptGraph->byChMsk = 0;
+	ptGraph->wIrqMsk = 0;
+}
@@ -283,7 +283,7 @@ csi_error_t csi_gpta_global_config(csp_gpta_t *ptGptaBase,csi_gpta_Global_load_c
 */
 csi_error_t csi_gpta_global_sw(csp_gpta_t *ptGptaBase)
 {
-	csp_gpta_set_gldcr2(ptGptaBase,0x01);
+	csp_gpta_set_gldcr2(ptGptaBase,GPTA_SW_GLD);
 	return CSI_OK;
 }
 /**
@@ -293,7 +293,7 @@ csi_error_t csi_gpta_global_sw(csp_gpta_t *ptGptaBase)
 */
 csi_error_t csi_gpta_global_rearm(csp_gpta_t *ptGptaBase)
 {
-	csp_gpta_set_gldcr2(ptGptaBase,0x02);
+	csp_gpta_set_gldcr2(ptGptaBase,GPTA_OSREARM_EN);
 	return CSI_OK;
 }
 /** \brief start gpta
@@ -353,6 +353,33 @@ uint16_t csi_gpta_get_prdr(csp_gpta_t *ptgptaBase)
 	return csp_gpta_get_prdr(ptgptaBase);
 }
 
+/**
+ \brief Q15 duty to compare value, see csi_ept_duty_q15_to_cmp
+ \param hwDuty   duty in Q15
+ \return compare value
+*/
+static inline uint16_t apt_gpta_duty_q15_to_cmp(uint16_t hwDuty)
+{
+	uint32_t wScale = gGptaPrd + 1;
+	
+	if(hwDuty > GPTA_DUTY_Q15_MAX)
+		hwDuty = GPTA_DUTY_Q15_MAX;
+	
+	return (uint16_t)(wScale - ((wScale * hwDuty) >> 15));
+}
+
+/**
+ \brief change the duty of channel A and B, Q15
+ \param ptGptaBase   pointer of gpta register structure
+ \param hwDuty       duty of channel A, B in Q15
+*/
+void csi_gpta_update_duty_q15(csp_gpta_t *ptGptaBase, const uint16_t hwDuty[2])
+{
+	ptGptaBase->CMPA = apt_gpta_duty_q15_to_cmp(hwDuty[0]);
+	ptGptaBase->CMPB = apt_gpta_duty_q15_to_cmp(hwDuty[1]);
+	csi_gpta_global_sw(ptGptaBase);
+}
+
 /**
  \brief change gpta output dutycycle. 
  \param ptGptaBase    pointer of ept register structure
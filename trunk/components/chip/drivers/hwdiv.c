@@ -1,5 +1,5 @@
 
-/***********************************************************************//** 
+/***********************************************************************//**
  * \file  hwdiv.c
  * \brief  to replace div functions in stdio
  * \copyright Copyright (C) 2015-2020 @ APTCHIP
@@ -12,70 +12,165 @@
 
 #include "soc.h"
 #include "csp_hwdiv.h"
+#include <drv/hwdiv.h>
 
 #define HWDIV_REG_BASE	(csp_hwdiv_t *)APB_HWD_BASE
 
-//!!!This function is to replace the div function in stdio.h
-//!!!This function will be called AUTOMATICALLY when "/" is used.
-int __divsi3(int wDividend, int wDivisor)
+/** \brief mask interrupts around one HWDIV operation
+ *
+ *  Inside an ISR(or any other section running with IE cleared) the PSR
+ *  is left alone, the interrupted code can not reach the divider anyway.
+ *
+ *  \return true: interrupts were masked here and must be re-enabled
+ */
+static inline bool apt_hwdiv_lock(void)
+{
+	if(__get_PSR() & PSR_IE_Msk)
+	{
+		__disable_irq();
+		return true;
+	}
+	return false;
+}
+
+static inline void apt_hwdiv_unlock(bool bLocked)
+{
+	if(bLocked)
+		__enable_irq();
+}
+
+/** \brief hardware division, result read before interrupts are re-enabled
+ *
+ *  \param[in] byMode: 0 = signed, 1 = unsigned(CR register)
+ *  \param[in] wDividend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \param[out] pwRem: remainder, NULL = not needed
+ *  \return quotient
+ */
+static inline uint32_t apt_hwdiv_calc(uint8_t byMode, uint32_t wDividend, uint32_t wDivisor, uint32_t *pwRem)
 {
-	uint32_t wPsr;
-	wPsr = __get_PSR();
-	__disable_excp_irq(); 
-	
 	csp_hwdiv_t * ptHwdivBase = (csp_hwdiv_t *)HWDIV_REG_BASE;
-	ptHwdivBase->CR = 0;
-	
+	uint32_t wQuot;
+	bool bLocked = apt_hwdiv_lock();
+
+	ptHwdivBase->CR = byMode;
 	ptHwdivBase->DIVIDEND = wDividend;
 	ptHwdivBase->DIVISOR = wDivisor;
-	__set_PSR(wPsr);
-	return (ptHwdivBase->QUOTIENT);
+	wQuot = ptHwdivBase->QUOTIENT;
+	if(pwRem)
+		*pwRem = ptHwdivBase->REMAIN;
+
+	apt_hwdiv_unlock(bLocked);
+	return wQuot;
+}
+
+//!!!This function is to replace the div function in stdio.h
+//!!!This function will be called AUTOMATICALLY when "/" is used.
+int __divsi3(int wDividend, int wDivisor)
+{
+	return (int)apt_hwdiv_calc(0, (uint32_t)wDividend, (uint32_t)wDivisor, NULL);
 }
 
 //!!!This function is to replace the mod function in stdio.h
 //!!!This function will be called AUTOMATICALLY when "%" is used.
 int __modsi3(int wDividend, int wDivisor)
 {
-	uint32_t wPsr;
-	wPsr = __get_PSR();
-	__disable_excp_irq();  
-	csp_hwdiv_t * ptHwdivBase = (csp_hwdiv_t *)HWDIV_REG_BASE;
-	ptHwdivBase->CR = 0;
-	
-	ptHwdivBase->DIVIDEND = wDividend;
-	ptHwdivBase->DIVISOR = wDivisor;
-	__set_PSR(wPsr);
-	return (ptHwdivBase->REMAIN);
+	uint32_t wRem;
+
+	apt_hwdiv_calc(0, (uint32_t)wDividend, (uint32_t)wDivisor, &wRem);
+	return (int)wRem;
 }
 
 //!!!This function is to replace the div function in stdio.h
 //!!!This function will be called AUTOMATICALLY when "/" is used.
 unsigned int __udivsi3(unsigned int wDividend, unsigned int wDivisor)
 {
-	uint32_t wPsr;
-	wPsr = __get_PSR();
-	__disable_excp_irq(); 
-	csp_hwdiv_t * ptHwdivBase = (csp_hwdiv_t *)HWDIV_REG_BASE;
-	ptHwdivBase->CR = 1;
-	
-	ptHwdivBase->DIVIDEND = wDividend;
-	ptHwdivBase->DIVISOR = wDivisor;
-	__set_PSR(wPsr);
-	return (ptHwdivBase->QUOTIENT);
+	return apt_hwdiv_calc(1, wDividend, wDivisor, NULL);
 }
 
 //!!!This function is to replace the mod function in stdio.h
 //!!!This function will be called AUTOMATICALLY when "%" is used.
 unsigned int __umodsi3(unsigned int wDividend, unsigned int wDivisor)
 {
-	uint32_t wPsr;
-	wPsr = __get_PSR();
-	__disable_excp_irq(); 
-	csp_hwdiv_t * ptHwdivBase = (csp_hwdiv_t *)HWDIV_REG_BASE;
-	ptHwdivBase->CR = 1;
-	
-	ptHwdivBase->DIVIDEND = wDividend;
-	ptHwdivBase->DIVISOR = wDivisor;
-	__set_PSR(wPsr);
-	return (ptHwdivBase->REMAIN);
-}
\ No newline at end of file
+	uint32_t wRem;
+
+	apt_hwdiv_calc(1, wDividend, wDivisor, &wRem);
+	return wRem;
+}
+
+/** \brief unsigned division, quotient and remainder from one HWDIV operation
+ *
+ *  \param[in] wDiviend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \return hwdiv_urslt_t
+ */
+hwdiv_urslt_t csi_hwdiv_unsigned_calc(uint32_t wDiviend, uint32_t wDivisor)
+{
+	hwdiv_urslt_t tRslt;
+
+	tRslt.wQuot = apt_hwdiv_calc(1, wDiviend, wDivisor, &tRslt.wRem);
+	return tRslt;
+}
+
+/** \brief signed division, quotient and remainder from one HWDIV operation
+ *
+ *  \param[in] wDiviend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \return hwdiv_rslt_t
+ */
+hwdiv_rslt_t csi_hwdiv_signed_calc(int wDiviend, int wDivisor)
+{
+	hwdiv_rslt_t tRslt;
+	uint32_t wRem;
+
+	tRslt.wQuot = (int)apt_hwdiv_calc(0, (uint32_t)wDiviend, (uint32_t)wDivisor, &wRem);
+	tRslt.wRem = (int)wRem;
+	return tRslt;
+}
+
+/** \brief precompute the multiply-shift reciprocal of a divisor
+ *
+ *  Round-up method(Granlund-Montgomery), exact for every 32 bit dividend.
+ *  The 2^(32+l)/d step is a plain shift-subtract loop, so this function
+ *  itself does not go through the divider either.
+ *
+ *  \param[out] ptDiv: reciprocal to be filled
+ *  \param[in] wDivisor: divisor, must not be 0
+ *  \return none
+ */
+void csi_udiv_init(csi_udiv_t *ptDiv, uint32_t wDivisor)
+{
+	uint8_t byLog2 = 31 - __builtin_clz(wDivisor);
+	uint32_t wRem = 1U << byLog2;
+	uint32_t wMul = 0;
+	uint8_t i;
+
+	ptDiv->byShift = byLog2;
+	ptDiv->byAdd = 0;
+	ptDiv->wMul = 0;
+
+	if(CSI_DIV_IS_POW2(wDivisor))				//shift only
+		return;
+
+	for(i = 0; i < 32; i++)						//wMul = 2^(32+l) / d, wRem = 2^(32+l) % d
+	{
+		bool bCarry = (wRem >> 31) != 0;
+		wRem <<= 1;
+		wMul <<= 1;
+		if(bCarry || wRem >= wDivisor)
+		{
+			wRem -= wDivisor;
+			wMul |= 1;
+		}
+	}
+
+	if((wDivisor - wRem) >= (1U << byLog2))		//33 bit multiplier, use the add/shift fixup
+	{
+		uint32_t wRem2 = wRem + wRem;
+		wMul += wMul;
+		if(wRem2 >= wDivisor || wRem2 < wRem)
+			wMul++;
+		ptDiv->byAdd = 1;
+	}
+	ptDiv->wMul = wMul + 1;
+}
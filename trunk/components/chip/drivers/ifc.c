@@ -14,20 +14,61 @@
 #include "irq.h"
 #include "soc.h"
 #include "ifc.h"
+#include <string.h>
 
 /* externs function--------------------------------------------------------*/
+/* private types-----------------------------------------------------------*/
+/// page steps, each one is advanced by apt_ifc_irqhandler at the end of the one before
+typedef enum {
+	IFC_STEP_IDLE = 0,
+	IFC_STEP_START,							//claimed by csi_ifc_program_async, page not started
+	IFC_STEP_LAT_CLR,						//step1
+	IFC_STEP_PRE_PGM,						//step3, after the latches are loaded(step2)
+	IFC_STEP_PRE_PROGRAM,					//step4
+	IFC_STEP_ERASE,							//step5
+	IFC_STEP_PROGRAM						//step6, then the page check
+} ifc_step_e;
+
+/// program engine, the head request is worked one page at a time
+typedef struct {
+	csi_ifc_xfer_t	*ptHead;				//request being programmed
+	csi_ifc_xfer_t	*ptTail;
+	uint32_t		wPageStAddr;			//page being erased/programmed
+	uint32_t		wPageOfs;				//first request word in the page
+	uint32_t		wPageNum;				//request words in the page
+	uint32_t		wKeepSum;				//checksum of the words kept by read-modify-write
+	uint32_t		wEndInt;				//end interrupt of the running step, 0: none(CR polled)
+	volatile uint8_t byStep;				//ifc_step_e
+	volatile bool	bBusy;					//engine claimed, cleared when the queue runs empty
+} ifc_pgm_t;
+
 /* private function--------------------------------------------------------*/
-static void apt_ifc_step_sync(csp_ifc_t * ptIfcBase, ifc_cmd_e eStepn, uint32_t wPageStAddr);
-static void apt_ifc_step_async(csp_ifc_t * ptIfcBase, ifc_cmd_e eStepn, uint32_t wPageStAddr);
-static csp_error_t apt_ifc_wr_nword(csp_ifc_t * ptIfcBase, uint8_t bFlashType, uint32_t wAddr, uint32_t wDataNum, uint32_t *pwData);
+static void apt_ifc_step_issue(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm, uint8_t byStep, ifc_cmd_e eCmd, uint32_t wEndInt);
+static bool apt_ifc_step_end(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm);
+static void apt_ifc_step_next(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm);
+static void apt_ifc_page_start(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm);
+static void apt_ifc_page_load(ifc_pgm_t *ptPgm);
+static bool apt_ifc_page_check(ifc_pgm_t *ptPgm);
+static void apt_ifc_xfer_end(ifc_pgm_t *ptPgm, uint8_t byState);
 
 /* externs variablesr------------------------------------------------------*/
 
 /* Private variablesr------------------------------------------------------*/
-bool g_bFlashCheckPass = 1;
-bool g_bFlashPgmDne = 1;
-static uint32_t g_wPageStAddr;
-static uint32_t wBuffForCheck[DFLASH_PAGE_SZ];
+volatile bool g_bFlashCheckPass = 1;
+volatile bool g_bFlashPgmDne = 1;
+
+static ifc_pgm_t s_tIfcPgm;
+
+/** \brief checksum of the words a read-modify-write keeps, catches any
+ *         single word that changed
+ *  \param[in] wSum: checksum so far
+ *  \param[in] wData: next word
+ *  \return checksum
+ */
+static inline uint32_t apt_ifc_sum(uint32_t wSum, uint32_t wData)
+{
+	return ((wSum << 1) | (wSum >> 31)) ^ wData;
+}
 
 
 /// csi API
@@ -76,88 +117,114 @@ csi_error_t csi_ifc_read(csp_ifc_t *ptIfcBase, uint32_t wAddr, uint32_t *wData,
 }
 
 /**
-  \brief       Program data to Flash.
+  \brief       Program data to Flash, waits for the end of the program.
+               Polls the IFC handler itself when interrupts are masked.
   \param[in]   ptIfcBase IFC base address
   \param[in]   Data address (SHOULD BE WORD ALLIGNED)
   \param[in]   data  Pointer to a buffer containing the data to be programmed to Flash.
-  \param[in]   wDataNum   Number of data(BYTES) items to program.
+  \param[in]   wDataNum   Number of data(WORDS) items to program.
   \return      error code
 */
 csi_error_t csi_ifc_program(csp_ifc_t *ptIfcBase, uint32_t wAddr, uint32_t *pwData, uint32_t wDataNum)
 {
-	csi_error_t tRet = CSI_OK;
-	uint32_t *wData = (uint32_t *)pwData;
-	uint32_t i, wFullPageNum, wLen0,wLen1, wPageSize, wFlashType,wOffset;
+	csi_ifc_xfer_t tXfer;
+	csi_error_t tRet;
 	
-	//return error when address is not word alligned, or addr goes beyond DFLASH space
-	if (wAddr % 4 != 0 )
+	memset(&tXfer, 0, sizeof(csi_ifc_xfer_t));
+	tXfer.wAddr = wAddr;
+	tXfer.pwData = pwData;
+	tXfer.wDataNum = wDataNum;
+	tRet = csi_ifc_program_async(ptIfcBase, &tXfer);
+	if (tRet != CSI_OK)
+		return tRet;
+	
+	return csi_ifc_wait(ptIfcBase, &tXfer);
+}
+
+/**
+  \brief       Wait for the end of a request, polls the IFC handler itself when interrupts are masked.
+  \param[in]   ptIfcBase IFC base address
+  \param[in]   ptXfer  request submitted with csi_ifc_program_async
+  \return      error code
+*/
+csi_error_t csi_ifc_wait(csp_ifc_t *ptIfcBase, csi_ifc_xfer_t *ptXfer)
+{
+	while (csi_ifc_xfer_busy(ptXfer))
 	{
-		return CSI_ERROR;
-	}	
-	else if (((wAddr >= PFLASHBASE) && ((wAddr + wDataNum)>PFLASHLIMIT) )|| ((wAddr>PFLASHBASE)&& ((wAddr + wDataNum)> PFLASHSIZE))) {
-		return CSI_ERROR;
+		if (!(__get_PSR() & PSR_IE_Msk))						//called from an ISR/critical section
+			apt_ifc_irqhandler(ptIfcBase);
 	}
-
-	/*if (wDataNum%4 == 0)
-		wDataNum = wDataNum/4;
-	else
-		wDataNum = wDataNum/4 + 1;*/
 	
-	if (wAddr<PFLASHLIMIT){
-		wPageSize = PFLASH_PAGE_SZ;
-		wFlashType = PFLASH;
-		wOffset = wAddr >> 2;
-	}
-	else {
-		wPageSize = DFLASH_PAGE_SZ;
-		wFlashType = DFLASH;
-		wOffset = (wAddr - DFLASHBASE)>>2;
-	}
-		
-	if (wDataNum > (wPageSize-wOffset%wPageSize)){
-			wLen0 = wPageSize-wOffset%wPageSize;
-			wFullPageNum = (wDataNum - wLen0)/wPageSize;
-			if (wDataNum > ((wFullPageNum*wPageSize) + wLen0)) {
-				wLen1 = wDataNum - ((wFullPageNum*wPageSize) + wLen0);
-			}
-			else
-				wLen1 = 0;
+	return (ptXfer->byState == IFC_XFER_DONE) ? CSI_OK : CSI_ERROR;
+}
 
-	}
-	else {
-			wLen0 = wDataNum;
-			wFullPageNum = 0;
-			wLen1 = 0;
-	}
+/**
+  \brief       Queue a program request, the pages are erased/programmed/checked in the IFC interrupt.
+               DFLASH requests switch DFLASH to para mode. An idle engine is claimed here
+               and started by the IFC interrupt, nothing waits with interrupts masked.
+  \param[in]   ptIfcBase IFC base address
+  \param[in]   ptXfer  request, must stay valid until byState is DONE/ERROR
+  \return      error code, CSI_BUSY = ptXfer is still queued
+*/
+csi_error_t csi_ifc_program_async(csp_ifc_t *ptIfcBase, csi_ifc_xfer_t *ptXfer)
+{
+	ifc_pgm_t *ptPgm = &s_tIfcPgm;
+	uint32_t wEnd, wIrqFlag;
+	bool bStart;
 	
-   
+	if (ptXfer == NULL || ptXfer->pwData == NULL || ptXfer->wDataNum == 0 || (ptXfer->wAddr % 4) != 0)
+		return CSI_ERROR;
 	
-	//first page PGM 
-	tRet = (csi_error_t)apt_ifc_wr_nword(ptIfcBase, wFlashType, wAddr, wLen0, wData);	
-	while (csi_ifc_get_status(ptIfcBase).busy);
-	if (tRet == CSI_ERROR)
-	return tRet;
+	wEnd = ptXfer->wAddr + (ptXfer->wDataNum << 2);
+	if (!((ptXfer->wAddr < PFLASHLIMIT && wEnd <= PFLASHLIMIT) || 
+		(ptXfer->wAddr >= DFLASHBASE && wEnd <= DFLASHLIMIT && wEnd > DFLASHBASE)))
+		return CSI_ERROR;
+	if (csi_ifc_xfer_busy(ptXfer))
+		return CSI_BUSY;
+	
+	ptXfer->ptNext = NULL;
+	ptXfer->wDone = 0;
+	ptXfer->byState = IFC_XFER_QUEUED;
 	
-	//middle pages PGM if has	
-	for (i=0; i<wFullPageNum; i++)
+	wIrqFlag = csi_irq_save();
+	if (ptPgm->ptTail)
+		ptPgm->ptTail->ptNext = ptXfer;
+	else
+		ptPgm->ptHead = ptXfer;
+	ptPgm->ptTail = ptXfer;
+	
+	bStart = !ptPgm->bBusy;									//IFC idle
+	if (bStart)
 	{
-		tRet = (csi_error_t)apt_ifc_wr_nword(ptIfcBase, wFlashType, wAddr+ (wLen0<<2)+(wPageSize<<2)*i, wPageSize, & *wData+(wLen0+wPageSize*i));
-		while (csi_ifc_get_status(ptIfcBase).busy);	
-		if (tRet == CSI_ERROR)
-			return tRet;
+		ptPgm->bBusy = true;
+		ptPgm->byStep = IFC_STEP_START;
+		g_bFlashPgmDne = 0;
 	}
+	csi_irq_restore(wIrqFlag);
 	
-	//last page PGM if has
-	if (wLen1){
-		tRet = (csi_error_t)apt_ifc_wr_nword(ptIfcBase, wFlashType, wAddr+(wLen0<<2) + wFullPageNum*(wPageSize<<2), wLen1, & *wData+(wLen0+wPageSize*wFullPageNum));
-		while (csi_ifc_get_status(ptIfcBase).busy);	
-		if (tRet == CSI_ERROR)
-			return tRet;
+	if (bStart)
+	{
+		NVIC_EnableIRQ(IFC_IRQn);
+		NVIC_SetPendingIRQ(IFC_IRQn);						//page start in the IFC interrupt
 	}
 	
+	return CSI_OK;
+}
+
+/** \brief ifc interrupt handle function, runs the queued program requests
+ * 
+ *  Works from the raw flags and the step state only, csi_ifc_wait calls it
+ *  in a loop when interrupts are masked.
+ * 
+ *  \param ptIfcBase ifc handle to operate.
+ *  \return none
+ */
+void apt_ifc_irqhandler(csp_ifc_t *ptIfcBase)
+{
+	ifc_pgm_t *ptPgm = &s_tIfcPgm;
 	
-	return tRet;
-	
+	while (apt_ifc_step_end(ptIfcBase, ptPgm))
+		apt_ifc_step_next(ptIfcBase, ptPgm);
 }
 
 /** \brief get flash status
@@ -186,118 +253,242 @@ csi_ifc_status_t csi_ifc_get_status(csp_ifc_t *ptIfcBase)
 
 ///static functions
 
-static void apt_ifc_step_sync(csp_ifc_t * ptIfcBase, ifc_cmd_e eStepn, uint32_t wPageStAddr)
+/** \brief issue one page step, its end is seen by apt_ifc_step_end
+ *
+ *  \param[in] ptIfcBase: pointer of IFC reg structure
+ *  \param[in] ptPgm: program engine
+ *  \param[in] byStep: ifc_step_e of the command
+ *  \param[in] eCmd: IFC command
+ *  \param[in] wEndInt: end interrupt of the command, 0: command without one
+ *  \return none
+ */
+static void apt_ifc_step_issue(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm, uint8_t byStep, ifc_cmd_e eCmd, uint32_t wEndInt)
 {
+	ptPgm->byStep = byStep;
+	ptPgm->wEndInt = wEndInt;
+	
 	csp_ifc_unlock(ptIfcBase);
-	csp_ifc_wr_cmd(ptIfcBase, eStepn);
-	csp_ifc_addr(ptIfcBase, wPageStAddr);
+	if (wEndInt)
+	{
+		csp_ifc_clr_int(ptIfcBase, (ifc_int_e)wEndInt);			//raw flag left by an earlier step
+		csp_ifc_int_enable(ptIfcBase, (ifc_int_e)wEndInt, ENABLE);
+	}
+	csp_ifc_wr_cmd(ptIfcBase, eCmd);
+	csp_ifc_addr(ptIfcBase, ptPgm->wPageStAddr);
 	csp_ifc_start(ptIfcBase);
+}
+
+/** \brief end of the running step
+ *
+ *  PAGE_LAT_CLR and PRE_PGM have no end interrupt, they only take a few IFC
+ *  clocks: while CR is still set the IFC interrupt is pended again and the
+ *  check is repeated once the other pending interrupts are served.
+ *
+ *  \param[in] ptIfcBase: pointer of IFC reg structure
+ *  \param[in] ptPgm: program engine
+ *  \return true: step ended, go on with the next one
+ */
+static bool apt_ifc_step_end(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm)
+{
+	if (ptPgm->byStep == IFC_STEP_IDLE)
+		return false;
+	if (ptPgm->byStep == IFC_STEP_START)
+		return true;
 	
-	///TODO do NOT support all sync operations for now
-	if (eStepn == PROGRAM && ((ptIfcBase -> MR) & DFLASH_PMODE) && (wPageStAddr >= 0x10000000) ){
-		while(ptIfcBase->RISR != IFCINT_PEP_END); /*// Wait for operation done*/
-		csp_ifc_clr_int(ptIfcBase, IFCINT_PEP_END);
-	}
-	else {
-		while(ptIfcBase->CR != 0);
+	if (ptPgm->wEndInt == 0)
+	{
+		if (ptIfcBase->CR == 0)
+			return true;
+		NVIC_SetPendingIRQ(IFC_IRQn);
+		return false;
 	}
-} 
+	
+	if (!(csp_ifc_get_risr(ptIfcBase) & ptPgm->wEndInt))
+		return false;
+	csp_ifc_int_enable(ptIfcBase, (ifc_int_e)ptPgm->wEndInt, DISABLE);
+	csp_ifc_clr_int(ptIfcBase, (ifc_int_e)ptPgm->wEndInt);
+	return true;
+}
 
-static void apt_ifc_step_async(csp_ifc_t * ptIfcBase, ifc_cmd_e eStepn, uint32_t wPageStAddr)
+/** \brief start the step after the one that just ended
+ *
+ *  \param[in] ptIfcBase: pointer of IFC reg structure
+ *  \param[in] ptPgm: program engine
+ *  \return none
+ */
+static void apt_ifc_step_next(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm)
 {
-	csp_ifc_unlock(ptIfcBase);
-	switch (eStepn)
+	csi_ifc_xfer_t *ptXfer = ptPgm->ptHead;
+	uint32_t wPreEnd;
+	
+	switch (ptPgm->byStep)
 	{
-		case (PAGE_ERASE):
-			csp_ifc_int_enable(ptIfcBase, IFCINT_ERS_END, ENABLE);
+		case IFC_STEP_START:
+			apt_ifc_page_start(ptIfcBase, ptPgm);
+			///step1
+			apt_ifc_step_issue(ptIfcBase, ptPgm, IFC_STEP_LAT_CLR, PAGE_LAT_CLR, 0);
+			break;
+		case IFC_STEP_LAT_CLR:
+			///step2
+			apt_ifc_page_load(ptPgm);
+			///step3
+			apt_ifc_step_issue(ptIfcBase, ptPgm, IFC_STEP_PRE_PGM, PRE_PGM, 0);
+			break;
+		case IFC_STEP_PRE_PGM:
+			///step4, DFLASH para mode reports it with PEP_END
+			if (ptPgm->wPageStAddr >= DFLASHBASE && csp_ifc_get_dflash_paramode(ptIfcBase))
+				wPreEnd = IFCINT_PEP_END;
+			else
+				wPreEnd = IFCINT_PGM_END;
+			apt_ifc_step_issue(ptIfcBase, ptPgm, IFC_STEP_PRE_PROGRAM, PROGRAM, wPreEnd);
 			break;
-		case (PROGRAM):
-			csp_ifc_int_enable(ptIfcBase, IFCINT_PGM_END, ENABLE);
+		case IFC_STEP_PRE_PROGRAM:
+			///step5
+			apt_ifc_step_issue(ptIfcBase, ptPgm, IFC_STEP_ERASE, PAGE_ERASE, IFCINT_ERS_END);
 			break;
-		default: 
+		case IFC_STEP_ERASE:
+			///step6
+			apt_ifc_step_issue(ptIfcBase, ptPgm, IFC_STEP_PROGRAM, PROGRAM, IFCINT_PGM_END);
+			break;
+		case IFC_STEP_PROGRAM:
+			if (apt_ifc_page_check(ptPgm) == false)
+			{
+				g_bFlashCheckPass = 0;
+				apt_ifc_xfer_end(ptPgm, IFC_XFER_ERROR);
+				break;
+			}
+			ptXfer->wDone += ptPgm->wPageNum;
+			if (ptXfer->wDone < ptXfer->wDataNum)
+				ptPgm->byStep = IFC_STEP_START;
+			else
+			{
+				g_bFlashCheckPass = 1;
+				apt_ifc_xfer_end(ptPgm, IFC_XFER_DONE);
+			}
+			break;
+		default:
 			break;
 	}
-	NVIC_EnableIRQ(IFC_IRQn);
-	
-	csp_ifc_wr_cmd(ptIfcBase, eStepn);
-	csp_ifc_addr(ptIfcBase, wPageStAddr);
-	csp_ifc_start(ptIfcBase);
-} 
-
+}
 
-static csp_error_t apt_ifc_wr_nword(csp_ifc_t * ptIfcBase, uint8_t bFlashType, uint32_t wAddr, uint32_t wDataNum, uint32_t *pwData)
+/** \brief set up the next page of the head request
+ *
+ *  \param[in] ptIfcBase: pointer of IFC reg structure
+ *  \param[in] ptPgm: program engine
+ *  \return none
+ */
+static void apt_ifc_page_start(csp_ifc_t * ptIfcBase, ifc_pgm_t *ptPgm)
 {
-	uint32_t i, j, wPageStAddr, wBuff[PFLASH_PAGE_SZ];
-	uint8_t bPageSize = DFLASH_PAGE_SZ;
-	csp_error_t tRet = CSP_SUCCESS;
-	
-	while(!g_bFlashPgmDne);
-	g_bFlashPgmDne = 0;
+	csi_ifc_xfer_t *ptXfer = ptPgm->ptHead;
+	uint32_t wAddr = ptXfer->wAddr + (ptXfer->wDone << 2);
+	uint32_t wPageSize;
 	
-	if (bFlashType == PFLASH) {
-		bPageSize = PFLASH_PAGE_SZ;
-		wPageStAddr = wAddr & 0xffffff00;
-	}
+	ptXfer->byState = IFC_XFER_BUSY;
+	if (wAddr < PFLASHLIMIT)
+		wPageSize = PFLASH_PAGE_SZ;
 	else {
-		bPageSize = DFLASH_PAGE_SZ;
-		wPageStAddr = wAddr & 0xffffffc0;
+		wPageSize = DFLASH_PAGE_SZ;
+		csp_ifc_dflash_paramode_enable(ptIfcBase, ENABLE);
 	}
 	
-	wAddr -= wPageStAddr;
-	wAddr = wAddr >> 2;
-//	wPageStAddr = wAddr & 0xffffffc0;
-//	wAddr = wAddr >> 2 & 0xf;
+	ptPgm->wPageStAddr = wAddr & ~((wPageSize << 2) - 1);
+	ptPgm->wPageOfs = (wAddr - ptPgm->wPageStAddr) >> 2;
+	ptPgm->wPageNum = wPageSize - ptPgm->wPageOfs;
+	if (ptPgm->wPageNum > ptXfer->wDataNum - ptXfer->wDone)
+		ptPgm->wPageNum = ptXfer->wDataNum - ptXfer->wDone;
 	
 	csp_ifc_clk_enable(ptIfcBase, ENABLE);
-	///step1
-	apt_ifc_step_sync(ptIfcBase, PAGE_LAT_CLR, wPageStAddr);
-	///step2
-	for(i=0; i< bPageSize; i++) {
-      if( i == wAddr )
-	  {
-		for(j = 0; j<wDataNum; j++)
-			wBuff[i++] = pwData[j];
-		i--;
-	  }
-      else {
-        wBuff[i] = *(uint32_t *)(wPageStAddr+4*i);
-      }
-    }
-	for(i=0; i<bPageSize; i++) {
-        *(uint32_t *)(wPageStAddr+4*i) = wBuff[i];
-    }
-	///step3
-	apt_ifc_step_sync(ptIfcBase, PRE_PGM, wPageStAddr);
-	///step4
-	apt_ifc_step_sync(ptIfcBase, PROGRAM, wPageStAddr);
+}
 
-	if (bFlashType == DFLASH && csp_ifc_get_dflash_paramode(ptIfcBase) == 1)
+/** \brief load the page latches, after PAGE_LAT_CLR
+ *
+ *  Words outside the request keep their flash value(read-modify-write), a whole
+ *  aligned page goes straight from the request data to the latches.
+ *
+ *  \param[in] ptPgm: program engine
+ *  \return none
+ */
+static void apt_ifc_page_load(ifc_pgm_t *ptPgm)
+{
+	csi_ifc_xfer_t *ptXfer = ptPgm->ptHead;
+	const uint32_t *pwData = ptXfer->pwData + ptXfer->wDone;
+	volatile uint32_t *pwPage = (volatile uint32_t *)ptPgm->wPageStAddr;
+	uint32_t i, wPageSize, wData, wSum = 0;
+	
+	wPageSize = (ptPgm->wPageStAddr < PFLASHLIMIT) ? PFLASH_PAGE_SZ : DFLASH_PAGE_SZ;
+	if (ptPgm->wPageNum == wPageSize)
 	{
-		///DFLASH step4 
-		for (i=0; i< DFLASH_PAGE_SZ;i++)
-		{
-			wBuffForCheck[i] = wBuff[i];
-		}
-		g_wPageStAddr = wPageStAddr;
-		apt_ifc_step_async(ptIfcBase, PAGE_ERASE, wPageStAddr);
+		for (i = 0; i < wPageSize; i++)
+			pwPage[i] = pwData[i];
 	}
-	else 
+	else
 	{
-	///step5
-		apt_ifc_step_sync(ptIfcBase, PAGE_ERASE, wPageStAddr);
-	///step6
-		apt_ifc_step_sync(ptIfcBase, PROGRAM, wPageStAddr);
-	///whole page check
-		for (i=0; i<bPageSize; i++)
+		for (i = 0; i < wPageSize; i++)
 		{
-			if (*(uint32_t *)(wPageStAddr+4*i) != wBuff[i]){
-				tRet = CSP_FAIL;
-				g_bFlashCheckPass = 0;
+			if (i - ptPgm->wPageOfs < ptPgm->wPageNum)
+				wData = pwData[i - ptPgm->wPageOfs];
+			else {
+				wData = pwPage[i];
+				wSum = apt_ifc_sum(wSum, wData);
 			}
+			pwPage[i] = wData;
 		}
-		if (tRet != CSP_FAIL)
-			g_bFlashPgmDne = 1;
 	}
-	return tRet;
+	ptPgm->wKeepSum = wSum;
 }
 
+/** \brief whole page check of the page just programmed
+ *
+ *  The request words are compared with the request data, the kept words
+ *  with the checksum taken while loading the latches.
+ *
+ *  \param[in] ptPgm: program engine
+ *  \return true: page ok
+ */
+static bool apt_ifc_page_check(ifc_pgm_t *ptPgm)
+{
+	csi_ifc_xfer_t *ptXfer = ptPgm->ptHead;
+	const uint32_t *pwData = ptXfer->pwData + ptXfer->wDone;
+	const uint32_t *pwPage = (const uint32_t *)ptPgm->wPageStAddr;
+	uint32_t i, wPageSize, wSum = 0;
+	
+	wPageSize = (ptPgm->wPageStAddr < PFLASHLIMIT) ? PFLASH_PAGE_SZ : DFLASH_PAGE_SZ;
+	for (i = 0; i < wPageSize; i++)
+	{
+		if (i - ptPgm->wPageOfs < ptPgm->wPageNum) {
+			if (pwPage[i] != pwData[i - ptPgm->wPageOfs])
+				return false;
+		}
+		else
+			wSum = apt_ifc_sum(wSum, pwPage[i]);
+	}
+	
+	return (wSum == ptPgm->wKeepSum);
+}
+
+/** \brief finish the head request, the next one is started by the caller's step loop
+ *         before the callback runs
+ *
+ *  \param[in] ptPgm: program engine
+ *  \param[in] byState: IFC_XFER_DONE/IFC_XFER_ERROR
+ *  \return none
+ */
+static void apt_ifc_xfer_end(ifc_pgm_t *ptPgm, uint8_t byState)
+{
+	csi_ifc_xfer_t *ptXfer = ptPgm->ptHead;
+	
+	ptPgm->ptHead = ptXfer->ptNext;
+	if (ptPgm->ptHead == NULL)
+	{
+		ptPgm->ptTail = NULL;
+		ptPgm->byStep = IFC_STEP_IDLE;
+		ptPgm->bBusy = false;
+		g_bFlashPgmDne = 1;
+	}
+	else
+		ptPgm->byStep = IFC_STEP_START;
+	
+	ptXfer->byState = byState;
+	if (ptXfer->callback)
+		ptXfer->callback(ptXfer, (byState == IFC_XFER_DONE) ? CSI_OK : CSI_ERROR);
+}
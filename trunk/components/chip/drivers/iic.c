@@ -17,10 +17,27 @@
 #include <drv/pin.h>
 #include <drv/porting.h>
 #include <drv/tick.h>
+#include <drv/swtimer.h>
+#include <string.h>
 
 
 
 /* Private macro-----------------------------------------------------------*/
+#define IIC_FIFO_DEPTH		8U
+
+/// queued master transfers, one controller(I2C0)
+typedef struct {
+	csp_i2c_t		*ptIicBase;
+	csi_iic_xfer_t	*ptHead;			//transfer on the bus
+	csi_iic_xfer_t	*ptTail;
+	uint32_t		wCmdIdx;			//commands written to DATA_CMD
+	uint32_t		wCmdNum;			//register address + tx + rx commands
+	uint16_t		hwRxIdx;			//bytes read back
+	uint16_t		hwTaddr;			//slave address in TADDR, 0xffff = none
+	csi_error_t		eResult;
+	csi_swtimer_t	tTimer;				//lost STOP_DET watchdog
+} iic_master_t;
+
 /* externs function--------------------------------------------------------*/
 /* externs variablesr------------------------------------------------------*/
 /* Private variablesr------------------------------------------------------*/
@@ -29,6 +46,7 @@ volatile uint32_t wIicErrorCont = 0;
 volatile uint8_t bySendIndex = 0;
 volatile uint8_t byWriteIndex = 0;
 volatile uint32_t wIicSlaveWriteAddress;
+static iic_master_t s_tIicMst;
 
 
 /** \brief deinit iic 
@@ -206,6 +224,160 @@ csi_error_t csi_iic_slave_init(csp_i2c_t *ptIicBase, csi_iic_slave_config_t *ptI
     return CSI_OK;
 }
 
+/** \brief reset the controller after a stuck bus or a lost transfer
+ * 
+ *  Disabling flushes both FIFOs and returns the master FSM to idle, this is
+ *  the recovery the old blocking functions did after 10000 polls.
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \return none
+ */
+static void apt_iic_bus_reset(csp_i2c_t *ptIicBase)
+{
+	csi_iic_disable(ptIicBase);
+	csp_i2c_clr_all_int(ptIicBase);
+	csi_iic_enable(ptIicBase);
+}
+
+/** \brief drain the RX FIFO into the rx buffer of the current transfer
+ * 
+ *  \param[in] ptMst: master engine
+ *  \return none
+ */
+static void apt_iic_drain_rx(iic_master_t *ptMst)
+{
+	csi_iic_xfer_t *ptXfer = ptMst->ptHead;
+	uint8_t byData;
+	
+	while(csp_i2c_get_status(ptMst->ptIicBase) & I2C_RFNE)
+	{
+		byData = csp_i2c_get_data(ptMst->ptIicBase);
+		if(ptMst->hwRxIdx < ptXfer->hwRxLen)
+			ptXfer->pbyRxData[ptMst->hwRxIdx++] = byData;
+	}
+}
+
+/** \brief write the next commands of the current transfer to DATA_CMD
+ * 
+ *  Read commands are limited to the free RX FIFO entries, the controller
+ *  holds SCL while the TX FIFO is empty, so a throttled transfer waits on
+ *  the bus until RX_FULL drains the FIFO and calls here again.
+ * 
+ *  \param[in] ptMst: master engine
+ *  \return none
+ */
+static void apt_iic_fill_tx(iic_master_t *ptMst)
+{
+	csp_i2c_t *ptIicBase = ptMst->ptIicBase;
+	csi_iic_xfer_t *ptXfer = ptMst->ptHead;
+	uint32_t wWrNum = ptXfer->byRegLen + ptXfer->hwTxLen;
+	uint32_t i;
+	uint16_t hwCmd;
+	bool bThrottle = false;
+	
+	while((ptMst->wCmdIdx < ptMst->wCmdNum) && (csp_i2c_get_status(ptIicBase) & I2C_TFNF))
+	{
+		i = ptMst->wCmdIdx;
+		if(i < ptXfer->byRegLen)														//register address, MSB first
+			hwCmd = I2C_CMD_WRITE | ((ptXfer->wRegAddr >> ((ptXfer->byRegLen - 1 - i) << 3)) & 0xff);
+		else if(i < wWrNum)
+			hwCmd = I2C_CMD_WRITE | ptXfer->pbyTxData[i - ptXfer->byRegLen];
+		else
+		{
+			if((i - wWrNum) - ptMst->hwRxIdx >= IIC_FIFO_DEPTH)							//RX FIFO would overflow
+			{
+				bThrottle = true;
+				break;
+			}
+			hwCmd = I2C_CMD_READ;
+			if(i == wWrNum && i != 0)													//turn the bus around
+				hwCmd |= I2C_CMD_RESTART1;
+		}
+		if(i == ptMst->wCmdNum - 1)
+			hwCmd |= I2C_CMD_STOP;
+		csp_i2c_set_data_cmd(ptIicBase, hwCmd);
+		ptMst->wCmdIdx++;
+	}
+	
+	if(ptMst->wCmdIdx < ptMst->wCmdNum && !bThrottle)
+		csp_i2c_imcr_enable(ptIicBase, I2C_TX_EMPTY_INT);
+	else
+		csp_i2c_imcr_disable(ptIicBase, I2C_TX_EMPTY_INT);
+}
+
+/** \brief put the head of the queue on the bus, called with interrupts disabled
+ * 
+ *  \param[in] ptMst: master engine
+ *  \return none
+ */
+static void apt_iic_xfer_start(iic_master_t *ptMst)
+{
+	csp_i2c_t *ptIicBase = ptMst->ptIicBase;
+	csi_iic_xfer_t *ptXfer = ptMst->ptHead;
+	
+	ptXfer->byState = IIC_XFER_BUSY;
+	ptMst->wCmdIdx = 0;
+	ptMst->wCmdNum = ptXfer->byRegLen + ptXfer->hwTxLen + ptXfer->hwRxLen;
+	ptMst->hwRxIdx = 0;
+	ptMst->eResult = CSI_OK;
+	
+	if(ptMst->hwTaddr != ptXfer->hwDevAddr)					//TADDR is only writable while disabled
+	{
+		csi_iic_disable(ptIicBase);
+		csp_i2c_set_taddr(ptIicBase, ptXfer->hwDevAddr >> 1);
+		ptMst->hwTaddr = ptXfer->hwDevAddr;
+	}
+	csi_iic_enable(ptIicBase);
+	csp_i2c_clr_all_int(ptIicBase);							//drop a late STOP_DET of the previous transfer
+	
+	csi_swtimer_start(&ptMst->tTimer, CONFIG_IIC_XFER_TIMEOUT_MS + (ptMst->wCmdNum >> 3), 0);
+	csp_i2c_set_imcr(ptIicBase, I2C_RX_FULL_INT | I2C_TX_ABRT_INT | I2C_STOP_DET_INT | I2C_SCL_SLOW_INT);
+	apt_iic_fill_tx(ptMst);
+}
+
+/** \brief finish the head of the queue, start the next one, then notify
+ * 
+ *  \param[in] ptMst: master engine
+ *  \param[in] eResult: transfer result
+ *  \return none
+ */
+static void apt_iic_xfer_end(iic_master_t *ptMst, csi_error_t eResult)
+{
+	csi_iic_xfer_t *ptXfer = ptMst->ptHead;
+	
+	csi_swtimer_stop(&ptMst->tTimer);
+	csp_i2c_set_imcr(ptMst->ptIicBase, I2C_INTSRC_NONE);
+	
+	ptMst->ptHead = ptXfer->ptNext;
+	if(ptMst->ptHead == NULL)
+		ptMst->ptTail = NULL;
+	ptXfer->ptNext = NULL;
+	ptXfer->byState = (eResult == CSI_OK) ? IIC_XFER_DONE : IIC_XFER_ERROR;
+	
+	if(ptMst->ptHead)										//chained transfer, no gap for the callback
+		apt_iic_xfer_start(ptMst);
+	
+	if(ptXfer->callback)
+		ptXfer->callback(ptXfer, eResult);
+}
+
+/** \brief transfer did not finish in time(no STOP_DET), runs in the tick interrupt
+ * 
+ *  \param[in] pArg: master engine
+ *  \return none
+ */
+static void apt_iic_xfer_timeout(void *pArg)
+{
+	iic_master_t *ptMst = (iic_master_t *)pArg;
+	
+	if(ptMst->ptHead == NULL)
+		return;
+	
+	ptMst->ptHead->wAbort = csp_i2c_get_tx_abrt(ptMst->ptIicBase);
+	apt_iic_bus_reset(ptMst->ptIicBase);
+	apt_iic_xfer_end(ptMst, CSI_TIMEOUT);
+}
+
 /** \brief initialize iic slave
  * 
  *  \param[in] ptIicBase: pointer of iic register structure
@@ -281,91 +453,176 @@ csi_error_t csi_iic_master_init(csp_i2c_t *ptIicBase, csi_iic_master_config_t *p
 		csp_i2c_sda_hold(ptIicBase,0x8,0x3);
 	}
 	
-	apt_iic_set_rx_flsel(ptIicBase,0x7);
-	apt_iic_set_tx_flsel(ptIicBase,0x7);
+	apt_iic_set_rx_flsel(ptIicBase,IIC_FIFO_DEPTH / 2 - 1);	//RX_FULL at half FIFO
+	apt_iic_set_tx_flsel(ptIicBase,IIC_FIFO_DEPTH / 2 - 1);	//TX_EMPTY at half FIFO
 	apt_iic_set_timeout(ptIicBase,ptIicMasterCfg->wSdaTimeout,ptIicMasterCfg->wSclTimeout);
 	
-	csp_i2c_set_imcr(ptIicBase,ptIicMasterCfg->hwInterrput);
+	if(s_tIicMst.tTimer.callback)								//re-init, unlink the old timer first
+		csi_swtimer_stop(&s_tIicMst.tTimer);
+	memset(&s_tIicMst, 0, sizeof(s_tIicMst));					//queued transfers are dropped
+	s_tIicMst.ptIicBase = ptIicBase;
+	s_tIicMst.hwTaddr = 0xffff;
+	csi_swtimer_init(&s_tIicMst.tTimer, apt_iic_xfer_timeout, &s_tIicMst, SWTIMER_IN_ISR);
+	
+	csp_i2c_set_imcr(ptIicBase,ptIicMasterCfg->hwInterrput);	//the transfer engine owns IMCR while it runs
 	csi_irq_enable((uint32_t *)ptIicBase);
 	
     return CSI_OK;
 }
 
-/** \brief  iic  master  write 1 byte data
+/** \brief queue a master transfer, the bus is driven by the iic interrupt
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \param[in] ptXfer: transfer object
+ *  \return error code \ref csi_error_t, CSI_BUSY = ptXfer is still queued
+ */
+csi_error_t csi_iic_master_xfer_async(csp_i2c_t *ptIicBase, csi_iic_xfer_t *ptXfer)
+{
+	iic_master_t *ptMst = &s_tIicMst;
+	uint32_t wIrqFlag;
+	
+	if((ptIicBase == NULL) || (ptXfer == NULL) || (ptMst->ptIicBase != ptIicBase))	//master not initialized
+		return CSI_ERROR;
+	if((ptXfer->byRegLen > 4) || (ptXfer->byRegLen + ptXfer->hwTxLen + ptXfer->hwRxLen == 0))
+		return CSI_ERROR;
+	if((ptXfer->hwTxLen && ptXfer->pbyTxData == NULL) || (ptXfer->hwRxLen && ptXfer->pbyRxData == NULL))
+		return CSI_ERROR;
+	if(csi_iic_xfer_busy(ptXfer))
+		return CSI_BUSY;
+	
+	ptXfer->ptNext = NULL;
+	ptXfer->wAbort = 0;
+	ptXfer->byState = IIC_XFER_QUEUED;
+	
+	wIrqFlag = csi_irq_save();
+	if(ptMst->ptTail)
+		ptMst->ptTail->ptNext = ptXfer;
+	else
+		ptMst->ptHead = ptXfer;
+	ptMst->ptTail = ptXfer;
+	
+	if(ptMst->ptHead == ptXfer)								//bus idle
+		apt_iic_xfer_start(ptMst);
+	csi_irq_restore(wIrqFlag);
+	
+	return CSI_OK;
+}
+
+/** \brief run a master transfer and wait for it, polls the handler when interrupts are masked
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \param[in] ptXfer: transfer object
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_iic_master_xfer(csp_i2c_t *ptIicBase, csi_iic_xfer_t *ptXfer)
+{
+	iic_master_t *ptMst = &s_tIicMst;
+	csi_iic_xfer_t *ptTimed = NULL;
+	csi_tick_deadline_t tDeadline;
+	csi_error_t ret = csi_iic_master_xfer_async(ptIicBase, ptXfer);
+	
+	if(ret != CSI_OK)
+		return ret;
+	
+	while(csi_iic_xfer_busy(ptXfer))
+	{
+		if(!(__get_PSR() & PSR_IE_Msk))						//called from an ISR/critical section
+		{
+			csi_iic_master_irqhandler(ptIicBase);
+			
+			//the swtimer timeout needs the tick interrupt, time each head transfer on coret instead
+			if(ptMst->ptHead != ptTimed)
+			{
+				ptTimed = ptMst->ptHead;
+				csi_tick_deadline_start(&tDeadline, CONFIG_IIC_XFER_TIMEOUT_MS + (ptMst->wCmdNum >> 3));
+			}
+			else if(ptTimed && csi_tick_deadline_expired(&tDeadline))
+				apt_iic_xfer_timeout(ptMst);
+		}
+	}
+	
+	return (ptXfer->byState == IIC_XFER_DONE) ? CSI_OK : CSI_ERROR;
+}
+
+/** \brief  IIC master handler, installed for I2C_IRQn by default(master mode)
  * 
  *  \param[in] ptIicBase: pointer of iic register structure
- * 	\param[in] wdevaddr: Addrress of slave device
- *  \param[in] wWriteAdds: Write address
- * 	\param[in] byWriteAddrNumByte: Write address length (unit byte)
- * 	\param[in] byData: Write data
  *  \return none
  */ 
-void csi_iic_write_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte, uint8_t byData)
+void csi_iic_master_irqhandler(csp_i2c_t *ptIicBase)
 {
-	uint16_t hwEerorCont=0;
+	iic_master_t *ptMst = &s_tIicMst;
+	uint16_t hwIsr = csp_i2c_get_isr(ptIicBase);
+	uint32_t wAbort;
 	
-	csi_iic_disable(ptIicBase);
-	csp_i2c_set_taddr(ptIicBase,wdevaddr >> 1);
-	csi_iic_enable(ptIicBase);
-	uint8_t byWriteAdds = 0;
-	switch(byWriteAddrNumByte)
+	if(ptMst->ptHead == NULL)									//no transfer, stray interrupt
 	{
-		case 1:
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;
-		case 2:
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;
-		case 3:
-				byWriteAdds = (wWriteAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				
-			break;
-		case 4:
-				byWriteAdds = (wWriteAdds>>24)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;	
-		default:
-			break;
+		csp_i2c_set_imcr(ptIicBase, I2C_INTSRC_NONE);
+		csp_i2c_clr_all_int(ptIicBase);
+		return;
 	}
 	
-	csp_i2c_set_data_cmd(ptIicBase,byData |I2C_CMD_STOP);
-	do
+	if(hwIsr & I2C_SCL_SLOW_INT)								//SCL stuck low, no STOP will come
 	{
-		if(hwEerorCont++>=10000)
-		{
-			hwEerorCont=0;
-			csi_iic_disable(ptIicBase);
-			csi_iic_enable(ptIicBase);
-			break;
-		}
+		ptMst->ptHead->wAbort = csp_i2c_get_tx_abrt(ptIicBase);
+		apt_iic_bus_reset(ptIicBase);
+		apt_iic_xfer_end(ptMst, CSI_ERROR);
+		return;
 	}
-	while( (csp_i2c_get_status(ptIicBase) & I2C_BUSY) != I2C_BUSY ); 		//Wait for FSM working
-	do
+	
+	if(hwIsr & I2C_TX_ABRT_INT)									//NACK/arbitration lost, TX FIFO flushed, STOP follows
 	{
-		if(hwEerorCont++>=10000)
-		{
-			hwEerorCont=0;
-			csi_iic_disable(ptIicBase);
-			csi_iic_enable(ptIicBase);
-			break;
-		}
+		wAbort = csp_i2c_get_tx_abrt(ptIicBase);
+		ptMst->ptHead->wAbort = wAbort;
+		ptMst->eResult = CSI_ERROR;
+		ptMst->wCmdIdx = ptMst->wCmdNum;						//nothing more to send
+		if(wAbort & TX_ABRT_SDA_S_LOW)							//let the controller clock SDA free
+			csp_i2c_recover_en(ptIicBase);
+		csp_i2c_clr_isr(ptIicBase, I2C_TX_ABRT_INT);
+	}
+	
+	if(hwIsr & I2C_RX_FULL_INT)
+		apt_iic_drain_rx(ptMst);
+	if(hwIsr & (I2C_RX_FULL_INT | I2C_TX_EMPTY_INT | I2C_TX_ABRT_INT))
+		apt_iic_fill_tx(ptMst);
+	
+	if(hwIsr & I2C_STOP_DET_INT)								//end of transfer
+	{
+		csp_i2c_clr_isr(ptIicBase, I2C_STOP_DET_INT);
+		apt_iic_drain_rx(ptMst);
+		if((ptMst->wCmdIdx != ptMst->wCmdNum) || (ptMst->hwRxIdx != ptMst->ptHead->hwRxLen))
+			ptMst->eResult = CSI_ERROR;
+		apt_iic_xfer_end(ptMst, ptMst->eResult);
 	}
-	while((csp_i2c_get_status(ptIicBase) & I2C_TFE) != I2C_TFE);
+}
+
+/** \brief fill a transfer for the blocking functions
+ */
+static void apt_iic_xfer_fill(csi_iic_xfer_t *ptXfer, uint32_t wDevAddr, uint32_t wRegAddr, uint8_t byRegLen)
+{
+	memset(ptXfer, 0, sizeof(csi_iic_xfer_t));
+	ptXfer->hwDevAddr = (uint16_t)wDevAddr;
+	ptXfer->wRegAddr = wRegAddr;
+	ptXfer->byRegLen = (byRegLen <= 4) ? byRegLen : 0;		//as before, other lengths send no address
+}
+
+/** \brief  iic  master  write 1 byte data
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ * 	\param[in] wdevaddr: Addrress of slave device
+ *  \param[in] wWriteAdds: Write address
+ * 	\param[in] byWriteAddrNumByte: Write address length (unit byte)
+ * 	\param[in] byData: Write data
+ *  \return none
+ */ 
+void csi_iic_write_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte, uint8_t byData)
+{
+	csi_iic_xfer_t tXfer;
+	
+	apt_iic_xfer_fill(&tXfer, wdevaddr, wWriteAdds, byWriteAddrNumByte);
+	tXfer.pbyTxData = &byData;
+	tXfer.hwTxLen = 1;
+	csi_iic_master_xfer(ptIicBase, &tXfer);
 }
 
 /** \brief  iic  master  write n byte data
@@ -375,86 +632,19 @@ void csi_iic_write_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteA
  *  \param[in] wWriteAdds: Write address
  * 	\param[in] byWriteAddrNumByte: Write address length (unit byte)
  * 	\param[in] pbyIicData: pointer of Write data
- * 	\param[in] wNumByteToWrite: Write data length
- *  \return none
+ * 	\param[in] wNumByteToWrite: Write data length, at most 0xFFFF
+ *  \return error code \ref csi_error_t
  */ 
-void csi_iic_write_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteToWrite)
+csi_error_t csi_iic_write_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteToWrite)
 {
-	uint16_t hwEerorCont=0;
-	uint8_t byWriteAdds = 0;
-	uint32_t i;
-	csi_iic_disable(ptIicBase);
-	csp_i2c_set_taddr(ptIicBase,wdevaddr >> 1);
-	csi_iic_enable(ptIicBase);
+	csi_iic_xfer_t tXfer;
 	
-	switch(byWriteAddrNumByte)
-	{
-		case 1:
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;
-		case 2:
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;
-		case 3:
-				byWriteAdds = (wWriteAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				
-			break;
-		case 4:
-				byWriteAdds = (wWriteAdds>>24)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = (wWriteAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-				byWriteAdds = wWriteAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byWriteAdds);
-			break;	
-		default:
-			break;
-	}
-	for(i=0;i<wNumByteToWrite;i++)
-	{
-		if(i>=wNumByteToWrite-1)
-		{
-			csp_i2c_set_data_cmd(ptIicBase,*(pbyIicData+i) |I2C_CMD_STOP);
-		}
-		else
-		{
-			csp_i2c_set_data_cmd(ptIicBase,*(pbyIicData+i));
-		}
-		do
-		{
-			if(hwEerorCont++>=10000)
-			{
-				hwEerorCont=0;
-				csi_iic_disable(ptIicBase);
-				csi_iic_enable(ptIicBase);
-				break;
-			}
-		}
-		while( (csp_i2c_get_status(ptIicBase) & I2C_BUSY) != I2C_BUSY ); 		//Wait for FSM working
-		do
-		{
-			if(hwEerorCont++>=10000)
-			{
-				hwEerorCont=0;
-				csi_iic_disable(ptIicBase);
-				csi_iic_enable(ptIicBase);
-				break;
-			}
-		}
-		while((csp_i2c_get_status(ptIicBase) & I2C_TFNF) != I2C_TFNF);
-		hwEerorCont=0;
-	}
+	apt_iic_xfer_fill(&tXfer, wdevaddr, wWriteAdds, byWriteAddrNumByte);
+	tXfer.pbyTxData = (const uint8_t *)pbyIicData;
+	if(wNumByteToWrite > 0xFFFFU)							//hwTxLen is 16 bit
+		return CSI_ERROR;
+	tXfer.hwTxLen = (uint16_t)wNumByteToWrite;
+	return csi_iic_master_xfer(ptIicBase, &tXfer);
 }
 
 /** \brief  iic  master  read 1 byte data
@@ -467,71 +657,14 @@ void csi_iic_write_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWrite
  */ 
 uint8_t csi_iic_read_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wReadAdds, uint8_t byReadAddrNumByte)
 {
-	uint8_t byValue;
-	uint16_t hwEerorCont=0;
-	uint8_t byReadAdds = 0;
-	csi_iic_disable(ptIicBase);
-	csp_i2c_set_taddr(ptIicBase,wdevaddr >> 1);
-	csi_iic_enable(ptIicBase);
-	
+	csi_iic_xfer_t tXfer;
+	uint8_t byValue = 0;
 	
-	switch(byReadAddrNumByte)
-	{
-		case 1:
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-			break;
-		case 2:
-				byReadAdds = (wReadAdds>>8)&0xff;				
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				byReadAdds = wReadAdds;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-			break;
-		case 3:
-				byReadAdds = (wReadAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				
-				byReadAdds = (wReadAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				
-			break;
-		case 4:
-				byReadAdds = (wReadAdds>>24)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				
-				byReadAdds = (wReadAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = (wReadAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-			break;	
-		default:
-			break;
-	}
+	apt_iic_xfer_fill(&tXfer, wdevaddr, wReadAdds, byReadAddrNumByte);
+	tXfer.pbyRxData = &byValue;
+	tXfer.hwRxLen = 1;
+	csi_iic_master_xfer(ptIicBase, &tXfer);
 	
-	csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_READ|I2C_CMD_STOP);
-	do
-	{
-		if(hwEerorCont++>=10000)
-		{
-			hwEerorCont=0;
-			break;
-		}
-	}
-	while( (csp_i2c_get_status(ptIicBase)) != I2C_BUSY ); 		//Wait for FSM working
-	do
-	{
-		if(hwEerorCont++>=10000)
-		{
-			hwEerorCont=0;
-			break;
-		}
-	}
-	while( (csp_i2c_get_status(ptIicBase)) != I2C_RFNE ); 		//Wait for RX done
-	byValue=csp_i2c_get_data(ptIicBase);
 	return byValue;
 }
 
@@ -542,102 +675,19 @@ uint8_t csi_iic_read_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wRead
  *  \param[in] wReadAdds: Read address
  * 	\param[in] byReadAddrNumByte: Read address length (unit byte)
  * 	\param[in] pbyIicData: Read the address pointer of the data storage array
- * 	\param[in] wNumByteRead: Read data length
- *  \return none
+ * 	\param[in] wNumByteRead: Read data length, at most 0xFFFF
+ *  \return error code \ref csi_error_t
  */ 
-void csi_iic_read_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wReadAdds, uint8_t byReadAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteRead)
+csi_error_t csi_iic_read_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wReadAdds, uint8_t byReadAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteRead)
 {
-	uint16_t hwEerorCont=0;
-	uint32_t i;
-	uint8_t byreadnum = 0;
-	uint8_t byReadAdds = 0;
-	csi_iic_disable(ptIicBase);
-	csp_i2c_set_taddr(ptIicBase,wdevaddr >> 1);
-	csi_iic_enable(ptIicBase);
-	byreadnum = 1;
-	
-	switch(byReadAddrNumByte)
-	{
-		case 1:
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-			break;
-		case 2:
-				byReadAdds = (wReadAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				byReadAdds = wReadAdds;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-			break;
-		case 3:
-				byReadAdds = (wReadAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				byReadAdds = (wReadAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				
-			break;
-		case 4:
-				byReadAdds = (wReadAdds>>24)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds|I2C_CMD_RESTART1);
-				byReadAdds = (wReadAdds>>16)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = (wReadAdds>>8)&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-				byReadAdds = wReadAdds&0xff;
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_WRITE|byReadAdds);
-			break;	
-		default:
-			break;
-	}
-	for(i=0;i<wNumByteRead;i++)
-	{
-		
-		if(byreadnum == 1)
-		{	
-			if(wNumByteRead > 1)
-			{
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_READ);
-				byreadnum = 0;
-			}				
-		}	
-		if(wNumByteRead == 1)
-		{
-			csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_READ|I2C_CMD_STOP);
-		}else{
-		
-			if(i>=wNumByteRead-2)
-			{
-				if(i == wNumByteRead-2)
-					csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_READ|I2C_CMD_STOP);
-			}
-			else
-			{
-				csp_i2c_set_data_cmd(ptIicBase,I2C_CMD_READ);
-			}
-		}
-		
-		do
-		{
-			if(hwEerorCont++>=10000)
-			{
-				hwEerorCont=0;
-				break;
-			}
-		}
-		while( (csp_i2c_get_status(ptIicBase) & I2C_BUSY) != I2C_BUSY ); 		//Wait for FSM working
-		do
-		{
-			if(hwEerorCont++>=10000)
-			{
-				hwEerorCont=0;
-				break;
-			}
-		}
-		while( (csp_i2c_get_status(ptIicBase) & I2C_RFNE) != I2C_RFNE ); 		//Wait for RX done
-		*(pbyIicData+i)=csp_i2c_get_data(ptIicBase);
-	}
+	csi_iic_xfer_t tXfer;
 	
+	apt_iic_xfer_fill(&tXfer, wdevaddr, wReadAdds, byReadAddrNumByte);
+	tXfer.pbyRxData = (uint8_t *)pbyIicData;
+	if(wNumByteRead > 0xFFFFU)								//hwRxLen is 16 bit
+		return CSI_ERROR;
+	tXfer.hwRxLen = (uint16_t)wNumByteRead;
+	return csi_iic_master_xfer(ptIicBase, &tXfer);
 }
 
 /** \brief  iic  master  read n byte data
@@ -0,0 +1,451 @@
+/***********************************************************************//**
+ * \file  kvstore.c
+ * \brief  log structured key-value store on the DFLASH data region
+ *
+ * Every write programs one whole page at the next position of a ring of
+ * CONFIG_KV_PAGES pages, so erases are spread over the ring instead of
+ * hitting the page of the value. A page holds a header(sequence number)
+ * and records; the newest page is mirrored in RAM and is carried into the
+ * next page together with the new record, until it is full. The live
+ * records of the page after the one being written are carried as well,
+ * so the next victim never holds the only copy of a value and a power
+ * loss during a program loses the unfinished write only.
+ *
+ * page:    word0 sequence, word1 magic | crc16 << 16, records, 0xffffffff
+ *          (crc16 of the sequence and all record words: a page whose program
+ *          was cut by a power loss fails it and counts as free)
+ * record:  key | len << 8 | crc16 << 16, value words(len = 0xff: deleted)
+ *
+ * A delete record stays live(indexed and carried) so older values of the
+ * key left in the ring stay hidden after the next mount.
+ *
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-10 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+#include <string.h>
+#include <soc.h>
+#include <csp.h>
+#include <drv/kvstore.h>
+#include <drv/ifc.h>
+#include <drv/crc.h>
+
+/* Private macro------------------------------------------------------*/
+#define KV_PAGE_WORDS		DFLASH_PAGE_SZ
+#define KV_PAGE_HDR			2U									//header words of a page
+#define KV_PAGE_PAYLOAD		(KV_PAGE_WORDS - KV_PAGE_HDR)
+#define KV_MAGIC			0x4B56U								//"KV"
+#define KV_LEN_DEL			0xFFU
+#define KV_IDX_NONE			0xFFFFU
+#define KV_PAGE_ADDR(p)		(CONFIG_KV_BASE + ((uint32_t)(p) * (KV_PAGE_WORDS << 2)))
+
+#if (CONFIG_KV_PAGES < 3) || (CONFIG_KV_PAGES * DFLASH_PAGE_SZ * 4 > DFLASHSIZE)
+#error "CONFIG_KV_PAGES out of range"
+#endif
+
+/* externs function---------------------------------------------------*/
+/* externs variablesr-------------------------------------------------*/
+/* Private variablesr-------------------------------------------------*/
+typedef struct {
+	uint32_t	wImg[KV_PAGE_WORDS];			//mirror of the newest page, data of tXfer
+	csi_ifc_xfer_t	tXfer;						//program of the newest page
+	uint32_t	wSeq;							//sequence of the next page
+	uint16_t	hwIdx[CONFIG_KV_KEYS];			//page << 4 | word of the latest record
+	uint8_t		byTail;							//newest page
+	uint8_t		byNext;							//page written next
+	bool		bPend;							//program of byTail not checked yet
+} kv_store_t;
+
+static kv_store_t s_tKv;
+
+/** \brief words of a record
+ *
+ *  \param[in] byLen: value length or KV_LEN_DEL
+ *  \return words including the record header
+ */
+static inline uint8_t apt_kv_rec_words(uint8_t byLen)
+{
+	return (byLen == KV_LEN_DEL) ? 1 : (1 + ((byLen + 3) >> 2));
+}
+
+/** \brief crc of a record(key, length, value bytes)
+ *
+ *  \param[in] byKey: key
+ *  \param[in] byLen: value length or KV_LEN_DEL
+ *  \param[in] pValue: value
+ *  \return crc16
+ */
+static uint16_t apt_kv_rec_crc(uint8_t byKey, uint8_t byLen, const void *pValue)
+{
+	uint8_t byHead[2] = {byKey, byLen};
+	uint32_t wCrc = csi_crc_soft(CRC_TYPE_CCITT, 0xffff, byHead, 2);
+
+	if(byLen != KV_LEN_DEL && byLen)
+		wCrc = csi_crc_soft(CRC_TYPE_CCITT, wCrc, pValue, byLen);
+
+	return (uint16_t)wCrc;
+}
+
+/** \brief crc of a page, sequence and record words
+ *
+ *  \param[in] pwPage: page
+ *  \return crc16
+ */
+static uint16_t apt_kv_page_crc(const uint32_t *pwPage)
+{
+	uint32_t wCrc = csi_crc_soft(CRC_TYPE_CCITT, 0xffff, &pwPage[0], 4);
+
+	return (uint16_t)csi_crc_soft(CRC_TYPE_CCITT, wCrc, &pwPage[KV_PAGE_HDR], KV_PAGE_PAYLOAD << 2);
+}
+
+/** \brief check a page header, the crc covers the whole page
+ *
+ *  \param[in] pwPage: page
+ *  \return true: valid page
+ */
+static bool apt_kv_page_valid(const uint32_t *pwPage)
+{
+	if((pwPage[1] & 0xffff) != KV_MAGIC)
+		return false;
+
+	return (pwPage[1] >> 16) == apt_kv_page_crc(pwPage);
+}
+
+/** \brief check the record at a word of a page
+ *
+ *  \param[in] pwPage: page
+ *  \param[in] byPos: word of the record header
+ *  \return words of the record, 0 = no(more) record
+ */
+static uint8_t apt_kv_rec_check(const uint32_t *pwPage, uint8_t byPos)
+{
+	uint32_t wHdr = pwPage[byPos];
+	uint8_t byKey = (uint8_t)wHdr;
+	uint8_t byLen = (uint8_t)(wHdr >> 8);
+	uint8_t byWords;
+
+	if(byKey >= CONFIG_KV_KEYS || (byLen != KV_LEN_DEL && byLen > KV_VALUE_MAX))
+		return 0;
+	byWords = apt_kv_rec_words(byLen);
+	if(byPos + byWords > KV_PAGE_WORDS)
+		return 0;
+	if((wHdr >> 16) != apt_kv_rec_crc(byKey, byLen, &pwPage[byPos + 1]))
+		return 0;
+
+	return byWords;
+}
+
+/** \brief page contents, the newest page is read from its RAM mirror
+ *
+ *  \param[in] byPage: page
+ *  \return page words
+ */
+static inline const uint32_t *apt_kv_page(uint8_t byPage)
+{
+	if(byPage == s_tKv.byTail)
+		return s_tKv.wImg;
+
+	return (const uint32_t *)KV_PAGE_ADDR(byPage);
+}
+
+/** \brief copy(or count) the live records of a page
+ *
+ *  \param[out] pwDst: destination page, NULL = count only
+ *  \param[in] byPos: first free word of the destination
+ *  \param[in] byPage: source page
+ *  \param[in] byExcl: key left out(superseded by the write), 0xff = none
+ *  \return first free word after the records
+ */
+static uint8_t apt_kv_collect(uint32_t *pwDst, uint8_t byPos, uint8_t byPage, uint8_t byExcl)
+{
+	const uint32_t *pwSrc = apt_kv_page(byPage);
+	uint16_t hwIdx;
+	uint8_t byKey, byWords;
+
+	for(byKey = 0; byKey < CONFIG_KV_KEYS; byKey++)
+	{
+		hwIdx = s_tKv.hwIdx[byKey];
+		if(hwIdx == KV_IDX_NONE || (hwIdx >> 4) != byPage || byKey == byExcl)
+			continue;
+
+		byWords = apt_kv_rec_words((uint8_t)(pwSrc[hwIdx & 0x0f] >> 8));
+		if(pwDst)
+			memcpy(&pwDst[byPos], &pwSrc[hwIdx & 0x0f], byWords << 2);
+		byPos += byWords;
+	}
+
+	return byPos;
+}
+
+/** \brief point the index at every record of a page
+ *
+ *  \param[in] pwPage: page
+ *  \param[in] byPage: page number
+ *  \return none
+ */
+static void apt_kv_index_page(const uint32_t *pwPage, uint8_t byPage)
+{
+	uint8_t byPos = KV_PAGE_HDR;
+	uint8_t byWords;
+
+	while(byPos < KV_PAGE_WORDS && (byWords = apt_kv_rec_check(pwPage, byPos)) != 0)
+	{
+		s_tKv.hwIdx[(uint8_t)pwPage[byPos]] = ((uint16_t)byPage << 4) | byPos;
+		byPos += byWords;
+	}
+}
+
+/** \brief wait for the running program, program a failed page once more
+ *
+ *  \param[in] none
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_kv_wait(void)
+{
+	uint8_t byRetry = 1;
+
+	while(s_tKv.bPend)
+	{
+		if(csi_ifc_wait(IFC, &s_tKv.tXfer) == CSI_OK)						//polls the IFC itself when interrupts are masked
+			s_tKv.bPend = false;
+		else if(byRetry--)
+			csi_ifc_program_async(IFC, &s_tKv.tXfer);
+		else
+		{
+			s_tKv.bPend = false;
+			return CSI_ERROR;
+		}
+	}
+
+	return CSI_OK;
+}
+
+/** \brief start the program of a page at byNext, it becomes the newest page
+ *
+ *  \param[in] pwPage: records from word KV_PAGE_HDR on
+ *  \param[in] byPos: first free word
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_kv_write_page(uint32_t *pwPage, uint8_t byPos)
+{
+	csi_error_t tRet;
+
+	pwPage[0] = s_tKv.wSeq;
+	for(; byPos < KV_PAGE_WORDS; byPos++)
+		pwPage[byPos] = 0xffffffff;
+	pwPage[1] = KV_MAGIC | ((uint32_t)apt_kv_page_crc(pwPage) << 16);
+
+	memcpy(s_tKv.wImg, pwPage, sizeof(s_tKv.wImg));
+	s_tKv.tXfer.wAddr = KV_PAGE_ADDR(s_tKv.byNext);
+	s_tKv.tXfer.pwData = s_tKv.wImg;
+	s_tKv.tXfer.wDataNum = KV_PAGE_WORDS;
+	tRet = csi_ifc_program_async(IFC, &s_tKv.tXfer);
+	if(tRet != CSI_OK)
+	{
+		memcpy(s_tKv.wImg, (const void *)KV_PAGE_ADDR(s_tKv.byTail), sizeof(s_tKv.wImg));
+		return tRet;
+	}
+
+	s_tKv.byTail = s_tKv.byNext;
+	s_tKv.byNext = (s_tKv.byNext + 1) % CONFIG_KV_PAGES;
+	s_tKv.wSeq++;
+	s_tKv.bPend = true;
+	apt_kv_index_page(s_tKv.wImg, s_tKv.byTail);
+
+	return CSI_OK;
+}
+
+/** \brief append a record
+ *
+ *  \param[in] byKey: key
+ *  \param[in] byLen: value length or KV_LEN_DEL
+ *  \param[in] pValue: value
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_kv_put(uint8_t byKey, uint8_t byLen, const void *pValue)
+{
+	uint32_t wPage[KV_PAGE_WORDS];
+	uint8_t byNeed = apt_kv_rec_words(byLen);
+	uint8_t byVictim, byCarry, byPos, i;
+	uint16_t hwLive = byNeed;
+	csi_error_t tRet;
+
+	tRet = apt_kv_wait();
+	if(tRet != CSI_OK)
+		return tRet;
+
+	for(i = 0; i < CONFIG_KV_PAGES; i++)									//live words after the write
+		hwLive += apt_kv_collect(NULL, 0, i, byKey);
+	if(hwLive > (CONFIG_KV_PAGES - 2) * KV_PAGE_PAYLOAD)
+		return CSI_ERROR;
+
+	for(i = 0; i < CONFIG_KV_PAGES; i++)
+	{
+		byVictim = (s_tKv.byNext + 1) % CONFIG_KV_PAGES;
+		byCarry = apt_kv_collect(NULL, 0, s_tKv.byNext, byKey);				//only after a broken ring
+		byCarry = apt_kv_collect(NULL, byCarry, byVictim, byKey);
+		byPos = apt_kv_collect(NULL, 0, s_tKv.byTail, byKey);
+
+		if(byPos + byCarry + byNeed <= KV_PAGE_PAYLOAD)						//newest page + carry + record
+			byPos = apt_kv_collect(wPage, KV_PAGE_HDR, s_tKv.byTail, byKey);
+		else if(byCarry + byNeed <= KV_PAGE_PAYLOAD)							//newest page stays as it is
+			byPos = KV_PAGE_HDR;
+		else																	//carry only, record goes to the next page
+		{
+			byPos = apt_kv_collect(wPage, KV_PAGE_HDR, s_tKv.byNext, 0xff);
+			if(apt_kv_collect(NULL, byPos, byVictim, 0xff) <= KV_PAGE_WORDS)
+				byPos = apt_kv_collect(wPage, byPos, byVictim, 0xff);
+			tRet = apt_kv_write_page(wPage, byPos);
+			if(tRet == CSI_OK)
+				tRet = apt_kv_wait();
+			if(tRet != CSI_OK)
+				return tRet;
+			continue;
+		}
+
+		byPos = apt_kv_collect(wPage, byPos, s_tKv.byNext, byKey);
+		byPos = apt_kv_collect(wPage, byPos, byVictim, byKey);
+		wPage[byPos] = byKey | ((uint32_t)byLen << 8) | ((uint32_t)apt_kv_rec_crc(byKey, byLen, pValue) << 16);
+		if(byLen != KV_LEN_DEL && byLen)
+		{
+			wPage[byPos + byNeed - 1] = 0xffffffff;							//pad of the last word
+			memcpy(&wPage[byPos + 1], pValue, byLen);
+		}
+		return apt_kv_write_page(wPage, byPos + byNeed);
+	}
+
+	return CSI_ERROR;
+}
+
+/** \brief mount the store: scan the pages, rebuild the RAM index
+ *
+ *  \param[in] none
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_init(void)
+{
+	const uint32_t *pwPage;
+	uint32_t wMaxSeq = 0;
+	uint8_t byNewest = 0xff;
+	uint8_t i, byPage;
+
+	csi_ifc_dflash_paramode_enable(IFC, ENABLE);
+
+	for(i = 0; i < CONFIG_KV_KEYS; i++)
+		s_tKv.hwIdx[i] = KV_IDX_NONE;
+	s_tKv.bPend = false;
+	s_tKv.byTail = 0xff;														//no RAM mirror while scanning
+
+	for(i = 0; i < CONFIG_KV_PAGES; i++)
+	{
+		pwPage = (const uint32_t *)KV_PAGE_ADDR(i);
+		if(apt_kv_page_valid(pwPage) && (byNewest == 0xff || (int32_t)(pwPage[0] - wMaxSeq) > 0))
+		{
+			byNewest = i;
+			wMaxSeq = pwPage[0];
+		}
+	}
+
+	if(byNewest == 0xff)														//empty store
+	{
+		s_tKv.byTail = CONFIG_KV_PAGES - 1;
+		s_tKv.byNext = 0;
+		s_tKv.wSeq = 1;
+		memset(s_tKv.wImg, 0xff, sizeof(s_tKv.wImg));
+		return CSI_OK;
+	}
+
+	for(i = 1; i <= CONFIG_KV_PAGES; i++)										//oldest first, later records win
+	{
+		byPage = (byNewest + i) % CONFIG_KV_PAGES;
+		pwPage = (const uint32_t *)KV_PAGE_ADDR(byPage);
+		if(apt_kv_page_valid(pwPage))
+			apt_kv_index_page(pwPage, byPage);
+	}
+
+	memcpy(s_tKv.wImg, (const void *)KV_PAGE_ADDR(byNewest), sizeof(s_tKv.wImg));
+	s_tKv.byTail = byNewest;
+	s_tKv.byNext = (byNewest + 1) % CONFIG_KV_PAGES;
+	s_tKv.wSeq = wMaxSeq + 1;
+
+	return CSI_OK;
+}
+
+/** \brief write a value
+ *
+ *  \param[in] byKey: key
+ *  \param[in] pValue: value
+ *  \param[in] byLen: value length(bytes)
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_set(uint8_t byKey, const void *pValue, uint8_t byLen)
+{
+	if(byKey >= CONFIG_KV_KEYS || byLen > KV_VALUE_MAX || (pValue == NULL && byLen))
+		return CSI_ERROR;
+
+	return apt_kv_put(byKey, byLen, pValue);
+}
+
+/** \brief read a value
+ *
+ *  \param[in] byKey: key
+ *  \param[out] pValue: buffer of the value
+ *  \param[in] bySize: buffer size
+ *  \return value length, or CSI_ERROR when the key is not stored
+ */
+int32_t csi_kv_get(uint8_t byKey, void *pValue, uint8_t bySize)
+{
+	const uint32_t *pwRec;
+	uint16_t hwIdx;
+	uint8_t byLen;
+
+	if(byKey >= CONFIG_KV_KEYS || (hwIdx = s_tKv.hwIdx[byKey]) == KV_IDX_NONE)
+		return CSI_ERROR;
+
+	pwRec = &apt_kv_page(hwIdx >> 4)[hwIdx & 0x0f];
+	byLen = (uint8_t)(*pwRec >> 8);
+	if(byLen == KV_LEN_DEL)
+		return CSI_ERROR;
+	if(pValue && bySize)
+		memcpy(pValue, pwRec + 1, (byLen < bySize) ? byLen : bySize);
+
+	return byLen;
+}
+
+/** \brief remove a key
+ *
+ *  \param[in] byKey: key
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_delete(uint8_t byKey)
+{
+	if(byKey >= CONFIG_KV_KEYS)
+		return CSI_ERROR;
+	if(csi_kv_get(byKey, NULL, 0) < 0)											//not stored or deleted already
+		return CSI_OK;
+
+	return apt_kv_put(byKey, KV_LEN_DEL, NULL);
+}
+
+/** \brief wait for the running page program and check it
+ *
+ *  \param[in] none
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_flush(void)
+{
+	return apt_kv_wait();
+}
+
+/** \brief page program of the last write still running
+ *
+ *  \param[in] none
+ *  \return true: busy
+ */
+bool csi_kv_busy(void)
+{
+	return s_tKv.bPend && csi_ifc_xfer_busy(&s_tKv.tXfer);
+}
@@ -16,12 +16,34 @@
   * 
   * \param  [in] ptFifo: The fifo to be emptied.
   * \return None.
+  * \note   Only call it while neither producer nor consumer is running.
   */
 void ringbuffer_reset(ringbuffer_t *ptFifo)
 {
     ptFifo->hwWrite = 0U;
     ptFifo->hwRead  = 0U;
-    ptFifo->hwDataLen = 0U;
+}
+/** \brief  initializes the FIFO on a user buffer.
+  * 
+  * \param  [in] ptFifo: The fifo to be initialized.
+  * \param  [in] pbyBuf: The buffer used to store fifo data.
+  * \param  [in] hwSize: The size of the buffer, a power of two up to RINGBUF_MAX_SIZE.
+  * \return true: done, false: hwSize is 0 or not a power of two, ptFifo is left untouched.
+  * \note   The free running indexes are masked, so no HWDIV access is
+  *         needed on the read/write path and the index difference is the
+  *         data length.
+  */
+bool ringbuffer_init(ringbuffer_t *ptFifo, uint8_t *pbyBuf, uint16_t hwSize)
+{
+    if (!RINGBUF_IS_POW2(hwSize) || hwSize > RINGBUF_MAX_SIZE) {
+        return false;
+    }
+
+    ptFifo->pbyBuf = pbyBuf;
+    ptFifo->hwSize = hwSize;
+    ptFifo->hwMask = hwSize - 1U;
+    ringbuffer_reset(ptFifo);
+    return true;
 }
 /** \brief  puts some data into the FIFO.
   * 
@@ -35,36 +57,26 @@ void ringbuffer_reset(ringbuffer_t *ptFifo)
   */
 uint32_t ringbuffer_in(ringbuffer_t *ptFifo, const void *pDataIn, uint16_t hwLen)
 {
-    uint32_t writelen = 0U, tmplen = 0U;
+    uint16_t hwWrite = ptFifo->hwWrite;
+    uint16_t hwOffset = hwWrite & ptFifo->hwMask;
+    uint16_t hwFree = ptFifo->hwSize - (uint16_t)(hwWrite - ptFifo->hwRead);	//hwRead read once, min() evaluates twice
+    uint32_t writelen, tmplen;
 
-    if (ringbuffer_is_full(ptFifo)) {
-        writelen = 0U;
-    } else {
-        tmplen = ptFifo->hwSize - ptFifo->hwDataLen;
-        writelen = (tmplen > hwLen) ? hwLen : tmplen;
+    writelen = min(hwLen, hwFree);
+    tmplen = min(writelen, (uint32_t)(ptFifo->hwSize - hwOffset));
 
-        if (ptFifo->hwWrite < ptFifo->hwRead) {
-            memcpy((void *)&ptFifo->pbyBuf[ptFifo->hwWrite], (void *)pDataIn, writelen);
-        } else {
-            tmplen = ptFifo->hwSize - ptFifo->hwWrite;
+    memcpy((void *)&ptFifo->pbyBuf[hwOffset], pDataIn, tmplen);
+    memcpy((void *)ptFifo->pbyBuf, (const uint8_t *)pDataIn + tmplen, writelen - tmplen);
 
-            if (writelen <= tmplen) {
-                memcpy((void *)&ptFifo->pbyBuf[ptFifo->hwWrite], (void *)pDataIn, writelen);
-            } else {
-                memcpy((void *)&ptFifo->pbyBuf[ptFifo->hwWrite], (void *)pDataIn, tmplen);
-                memcpy((void *)ptFifo->pbyBuf, (uint8_t *)pDataIn + tmplen, writelen - tmplen);
-            }
-        }
-        ptFifo->hwWrite = (ptFifo->hwWrite + writelen) % ptFifo->hwSize;
-        ptFifo->hwDataLen += writelen;
-    }
+    ringbuffer_barrier();									//data before index
+    ptFifo->hwWrite = hwWrite + writelen;
 
     return writelen;
 }
 /** \brief  gets some data from the FIFO.
   * 
   * \param  [in] ptFifo: The fifo to be used.
-  * \param  [in] pOutBuf: Where the data must be copied.
+  * \param  [in] pOutBuf: Where the data must be copied, NULL to discard.
   * \param  [in] hwLen: The size of the destination buffer.
   * \return The number of copied bytes.
   * \note   This function copies at most @len bytes from the FIFO into
@@ -72,29 +84,23 @@ uint32_t ringbuffer_in(ringbuffer_t *ptFifo, const void *pDataIn, uint16_t hwLen
   */
 uint32_t ringbuffer_out(ringbuffer_t *ptFifo, void *pOutBuf, uint16_t hwLen)
 {
-	uint32_t readlen = 0U, tmplen = 0U;
+	uint16_t hwRead = ptFifo->hwRead;
+	uint16_t hwOffset = hwRead & ptFifo->hwMask;
+	uint16_t hwUsed = ptFifo->hwWrite - hwRead;				//hwWrite read once, min() evaluates twice
+	uint32_t readlen, tmplen;
+	
+	readlen = min(hwLen, hwUsed);
+	tmplen = min(readlen, (uint32_t)(ptFifo->hwSize - hwOffset));
 	
-	if(ringbuffer_is_empty(ptFifo)) 
-        readlen = 0U;
-    else
+	ringbuffer_barrier();									//index before data
+	if(NULL != pOutBuf)
 	{
-		readlen = (hwLen > ptFifo->hwDataLen) ? ptFifo->hwDataLen : hwLen;
-        tmplen = ptFifo->hwSize - ptFifo->hwRead;
-		
-		if(NULL != pOutBuf)
-		{
-			if(readlen < tmplen)
-				memcpy((void *)pOutBuf, (void *)&ptFifo->pbyBuf[ptFifo->hwRead], readlen);
-			else
-			{
-				memcpy((void *)pOutBuf, (void *)&ptFifo->pbyBuf[ptFifo->hwRead], tmplen);
-				memcpy((uint8_t *)pOutBuf + tmplen, (void *)ptFifo->pbyBuf, readlen - tmplen);
-			}
-		}
+		memcpy(pOutBuf, (void *)&ptFifo->pbyBuf[hwOffset], tmplen);
+		memcpy((uint8_t *)pOutBuf + tmplen, (void *)ptFifo->pbyBuf, readlen - tmplen);
 	}
 	
-	ptFifo->hwRead = (ptFifo->hwRead + readlen) % ptFifo->hwSize;
-	ptFifo->hwDataLen -= readlen;
+	ringbuffer_barrier();									//data before index
+	ptFifo->hwRead = hwRead + readlen;
 	
 	return readlen;
 }
@@ -102,18 +108,20 @@ uint32_t ringbuffer_out(ringbuffer_t *ptFifo, void *pOutBuf, uint16_t hwLen)
   * 
   * \param  [in] fifo: The fifo to be used.
   * \param  [in] in:   The data to be added.
-  * \note   This function copies at most @len bytes from the @in into
-  *         the FIFO depending on the free space, and returns the number
-  *         of bytes copied.
+  * \return The number of bytes copied, 0/1
   */
-void ringbuffer_byte_in(ringbuffer_t *ptFifo, uint8_t byDataIn)
+uint8_t ringbuffer_byte_in(ringbuffer_t *ptFifo, uint8_t byDataIn)
 {
-	if(ptFifo->hwDataLen < ptFifo->hwSize)
-	{
-		ptFifo->pbyBuf[ptFifo->hwWrite] = byDataIn;
-		ptFifo->hwWrite = (ptFifo->hwWrite + 1) % ptFifo->hwSize;
-		ptFifo->hwDataLen ++;
-	}
+	uint16_t hwWrite = ptFifo->hwWrite;
+	
+	if((uint16_t)(hwWrite - ptFifo->hwRead) >= ptFifo->hwSize)
+		return 0;
+		
+	ptFifo->pbyBuf[hwWrite & ptFifo->hwMask] = byDataIn;
+	ringbuffer_barrier();
+	ptFifo->hwWrite = hwWrite + 1;
+	
+	return 1;
 }
 
 /** \brief  gets one byte data from the FIFO.
@@ -121,20 +129,76 @@ void ringbuffer_byte_in(ringbuffer_t *ptFifo, uint8_t byDataIn)
   * \param  [in] ptFifo: The fifo to be used.
   * \param  [in] pOutBuf: Where the data must be copied.
   * \return The number of read bytes, 0/1
-  * \note   This function copies at most @len bytes from the FIFO into
-  *         the @out and returns the number of copied bytes.
   */
 uint8_t ringbuffer_byte_out(ringbuffer_t *ptFifo, void *pOutBuf)
 {
-	if(ptFifo->hwDataLen == 0)
+	uint16_t hwRead = ptFifo->hwRead;
+	
+	if(hwRead == ptFifo->hwWrite)
 		return 0;
-	else
-	{
-		*((uint8_t*)pOutBuf) = ptFifo->pbyBuf[ptFifo->hwRead];
-		ptFifo->hwRead = (ptFifo->hwRead + 1) % ptFifo->hwSize;
-		ptFifo->hwDataLen --;
-		
-	}
+	
+	ringbuffer_barrier();
+	*((uint8_t*)pOutBuf) = ptFifo->pbyBuf[hwRead & ptFifo->hwMask];
+	ringbuffer_barrier();
+	ptFifo->hwRead = hwRead + 1;
+	
 	return 1;
 }
-
+/** \brief  gets the contiguous readable span of the FIFO, zero copy.
+  * 
+  * \param  [in] ptFifo: The fifo to be used.
+  * \param  [out] ppbyData: Start of the readable span.
+  * \return The length of the span.
+  * \note   Parse data in place, then release it with ringbuffer_out_commit.
+  *         Data wrapped to the buffer start is returned by the next call.
+  */
+uint16_t ringbuffer_out_span(ringbuffer_t *ptFifo, uint8_t **ppbyData)
+{
+	uint16_t hwRead = ptFifo->hwRead;
+	uint16_t hwOffset = hwRead & ptFifo->hwMask;
+	uint16_t hwLen = ptFifo->hwWrite - hwRead;
+	
+	ringbuffer_barrier();
+	*ppbyData = &ptFifo->pbyBuf[hwOffset];
+	
+	return min(hwLen, (uint16_t)(ptFifo->hwSize - hwOffset));
+}
+/** \brief  releases data returned by ringbuffer_out_span.
+  * 
+  * \param  [in] ptFifo: The fifo to be used.
+  * \param  [in] hwLen: The number of bytes consumed.
+  * \return None.
+  */
+void ringbuffer_out_commit(ringbuffer_t *ptFifo, uint16_t hwLen)
+{
+	ringbuffer_barrier();
+	ptFifo->hwRead += hwLen;
+}
+/** \brief  gets the contiguous writable span of the FIFO, zero copy.
+  * 
+  * \param  [in] ptFifo: The fifo to be used.
+  * \param  [out] ppbyData: Start of the writable span.
+  * \return The length of the span.
+  * \note   Write data in place, then publish it with ringbuffer_in_commit.
+  */
+uint16_t ringbuffer_in_span(ringbuffer_t *ptFifo, uint8_t **ppbyData)
+{
+	uint16_t hwWrite = ptFifo->hwWrite;
+	uint16_t hwOffset = hwWrite & ptFifo->hwMask;
+	uint16_t hwFree = ptFifo->hwSize - (uint16_t)(hwWrite - ptFifo->hwRead);
+	
+	*ppbyData = &ptFifo->pbyBuf[hwOffset];
+	
+	return min(hwFree, (uint16_t)(ptFifo->hwSize - hwOffset));
+}
+/** \brief  publishes data written into the span of ringbuffer_in_span.
+  * 
+  * \param  [in] ptFifo: The fifo to be used.
+  * \param  [in] hwLen: The number of bytes written.
+  * \return None.
+  */
+void ringbuffer_in_commit(ringbuffer_t *ptFifo, uint16_t hwLen)
+{
+	ringbuffer_barrier();
+	ptFifo->hwWrite += hwLen;
+}
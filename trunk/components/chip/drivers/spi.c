@@ -89,6 +89,132 @@ static void apt_spi_int_set(csp_spi_t *ptSpiBase,spi_int_e eSpiInt)
 	}
 }
 
+/** \brief write frames to the tx fifo of the async transfer
+ * 
+ *  Frames in flight(tx fifo + shifter + rx fifo) are kept below the fifo
+ *  depth, so the rx fifo can not overrun and the rx interrupt alone paces
+ *  the transfer: every drain makes room for the next burst.
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \return none
+ */ 
+static void apt_spi_xfer_fill(csp_spi_t *ptSpiBase)
+{
+	csi_spi_transmit_t *ptTrans = &g_tSpiTransmit;
+	
+	while(ptTrans->wTxSize && (ptTrans->wRxSize - ptTrans->wTxSize) < SPI_FIFO_DEPTH && (csp_spi_get_sr(ptSpiBase) & SPI_TNF))
+	{
+		if(ptTrans->pbyTxData)
+			csp_spi_set_data(ptSpiBase, *ptTrans->pbyTxData++);
+		else
+			csp_spi_set_data(ptSpiBase, 0x00);
+		ptTrans->wTxSize--;
+	}
+}
+
+/** \brief end the async transfer: interrupts off, NSS high, callback
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] eEvent: event passed to the callback
+ *  \return none
+ */ 
+static void apt_spi_xfer_end(csp_spi_t *ptSpiBase, csi_spi_event_e eEvent)
+{
+	csi_spi_transmit_t *ptTrans = &g_tSpiTransmit;
+	
+	csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT | SPI_ROTIM_INT | SPI_TXIM_INT, false);
+	if(ptTrans->eNssPin != SPI_NSS_NONE)
+		csi_spi_nss_high(ptTrans->eNssPin);
+	
+	ptTrans->byAsync = 0;
+	ptTrans->tState.writeable = 1U;
+	ptTrans->tState.readable  = 1U;
+	
+	if(ptTrans->callback)
+		ptTrans->callback(ptSpiBase, eEvent, ptTrans->pArg);
+}
+
+/** \brief async transfer interrupt: drain the rx fifo, refill the tx fifo
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] wStatus: masked interrupt status
+ *  \return none
+ */ 
+static void apt_spi_xfer_isr(csp_spi_t *ptSpiBase, uint32_t wStatus)
+{
+	csi_spi_transmit_t *ptTrans = &g_tSpiTransmit;
+	uint8_t byData;
+	
+	if(wStatus & (SPI_RTIM_INT | SPI_ROTIM_INT))
+		csp_spi_clr_isr(ptSpiBase, wStatus & (SPI_RTIM_INT | SPI_ROTIM_INT));
+	
+	if(wStatus & SPI_ROTIM_INT)											//frames lost, the transfer is broken
+	{
+		csi_spi_clr_rxfifo(ptSpiBase);
+		ptTrans->tState.error = 1U;
+		apt_spi_xfer_end(ptSpiBase, SPI_EVENT_ERROR_OVERFLOW);
+		return;
+	}
+	
+	while(ptTrans->wRxSize && (csp_spi_get_sr(ptSpiBase) & SPI_RNE))
+	{
+		byData = (uint8_t)csp_spi_get_data(ptSpiBase);
+		if(ptTrans->pbyRxData)
+			*ptTrans->pbyRxData++ = byData;
+		ptTrans->wRxSize--;
+	}
+	
+	if(ptTrans->wRxSize == 0)												//last frame shifted in
+		apt_spi_xfer_end(ptSpiBase, (csi_spi_event_e)ptTrans->byAsync);
+	else
+		apt_spi_xfer_fill(ptSpiBase);
+}
+
+/** \brief start an async full-duplex transfer
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] pDataout: data to send, NULL = send 0x00
+ *  \param[in] pDatain: buffer of received data, NULL = discard
+ *  \param[in] wSize: number of frames
+ *  \return error code \ref csi_error_t
+ */ 
+static csi_error_t apt_spi_xfer_start(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain, uint32_t wSize)
+{
+	csi_spi_transmit_t *ptTrans = &g_tSpiTransmit;
+	
+	if(wSize == 0)
+		return CSI_ERROR;
+	if((ptTrans->tState.writeable == 0U) || (ptTrans->tState.readable == 0U))
+		return CSI_BUSY;
+	
+	ptTrans->tState.writeable = 0U;
+	ptTrans->tState.readable  = 0U;
+	ptTrans->tState.error = 0U;
+	ptTrans->pbyTxData = (uint8_t *)pDataout;
+	ptTrans->pbyRxData = (uint8_t *)pDatain;
+	ptTrans->wTxSize = wSize;
+	ptTrans->wRxSize = wSize;
+	if(pDataout && pDatain)
+		ptTrans->byAsync = SPI_EVENT_SEND_RECEIVE_COMPLETE;
+	else if(pDataout)
+		ptTrans->byAsync = SPI_EVENT_SEND_COMPLETE;
+	else
+		ptTrans->byAsync = SPI_EVENT_RECEIVE_COMPLETE;
+	
+	csp_spi_set_int(ptSpiBase, SPI_TXIM_INT, false);					//paced by the rx interrupts only
+	csi_spi_clr_rxfifo(ptSpiBase);
+	csp_spi_clr_isr(ptSpiBase, SPI_RTIM_INT | SPI_ROTIM_INT);
+	if(ptTrans->eNssPin != SPI_NSS_NONE)
+		csi_spi_nss_low(ptTrans->eNssPin);
+	csp_spi_en(ptSpiBase);
+	
+	apt_spi_xfer_fill(ptSpiBase);										//first burst
+	csi_irq_enable((uint32_t *)ptSpiBase);
+	csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT | SPI_ROTIM_INT, true);
+	
+	return CSI_OK;
+}
+
 /** \brief initialize spi data structure
  * 
  *  \param[in] ptSpiBase: pointer of spi register structure
@@ -258,13 +384,13 @@ int32_t csi_spi_send(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
 	if((g_tSpiTransmit.tState.writeable == 0U))						
 		return CSI_BUSY;
 	
-	g_tSpiTransmit.byTxSize = wSize;
+	g_tSpiTransmit.wTxSize = wSize;
 	g_tSpiTransmit.tState.writeable = 0U;
 	g_tSpiTransmit.pbyTxData = (uint8_t *)pData;
 	csp_spi_en(ptSpiBase);								//enable spi
 	
 	uint32_t wSendStart;
-	while(g_tSpiTransmit.byTxSize > 0)
+	while(g_tSpiTransmit.wTxSize > 0)
 	{
 		wSendStart = SPI_SEND_TIMEOUT;
 		while(!csp_spi_write_ready(ptSpiBase) && wSendStart --);	//fifo full? wait; 
@@ -275,7 +401,7 @@ int32_t csi_spi_send(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
 		csp_spi_set_data(ptSpiBase, *g_tSpiTransmit.pbyTxData);	//send data
 		g_tSpiTransmit.pbyTxData ++;
 		wCount ++;
-		g_tSpiTransmit.byTxSize --;
+		g_tSpiTransmit.wTxSize --;
 	}
 	
 	wSendStart = SPI_SEND_TIMEOUT;
@@ -300,26 +426,10 @@ int32_t csi_spi_send(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
  */
 csi_error_t csi_spi_send_async(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
 {	
-	csi_error_t tRet = CSI_OK;
-	
-	if((g_tSpiTransmit.tState.writeable == 0U))		// || (g_tSpiTransmit.tState.readable == 0U)) 
-        tRet = CSI_BUSY;
-		
-	if(tRet == CSI_OK)
-	{
-		g_tSpiTransmit.tState.writeable = 0U;
-		g_tSpiTransmit.byTxSize = wSize;
-		g_tSpiTransmit.pbyTxData = (uint8_t *)pData;
-		csp_spi_en(ptSpiBase);											//enable spi
-		csp_spi_set_int(ptSpiBase, g_tSpiTransmit.byInter,true);		//enable tx fifo int
-		csp_spi_set_int(ptSpiBase, SPI_TXIM_INT,true);		//enable tx fifo int
-	}
-	else
-	{
-		tRet = CSI_ERROR;
-	}
+	if(NULL == pData)
+		return CSI_ERROR;
 	
-	return tRet;
+	return apt_spi_xfer_start(ptSpiBase, pData, NULL, wSize);
 }
 
 /** \brief  receiving data from spi receiver, blocking mode
@@ -342,13 +452,13 @@ int32_t csi_spi_receive(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
         }
 		
 		g_tSpiTransmit.tState.readable = 0U;
-		g_tSpiTransmit.byRxSize = wSize;
+		g_tSpiTransmit.wRxSize = wSize;
        
 		g_tSpiTransmit.pbyRxData = (uint8_t *)pData;
 		csp_spi_en(ptSpiBase);										//enable spi
 		
 		uint32_t wTimeStart;
-		while(g_tSpiTransmit.byRxSize)
+		while(g_tSpiTransmit.wRxSize)
 		{
 			wTimeStart = SPI_RECV_TIMEOUT;
 			while(!csp_spi_read_ready(ptSpiBase) && wTimeStart --);		//recv fifo empty? wait	
@@ -361,7 +471,7 @@ int32_t csi_spi_receive(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
 			g_tSpiTransmit.pbyRxData++;
 			wCount ++;
 			
-			g_tSpiTransmit.byRxSize --;
+			g_tSpiTransmit.wRxSize --;
 		}
 	}while(0);
 	
@@ -383,26 +493,10 @@ int32_t csi_spi_receive(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
  */
 csi_error_t csi_spi_receive_async(csp_spi_t *ptSpiBase, void *pData, uint32_t wSize)
 {	
-	csi_error_t tRet = CSI_OK;
-	
-	if ((g_tSpiTransmit.tState.readable == 0U))	// || (g_tSpiTransmit.tState.readable == 0U)) 
-	{
-		tRet = CSI_BUSY;
-	}
+	if(NULL == pData)
+		return CSI_ERROR;
 	
-	if(tRet == CSI_OK)
-	{
-		g_tSpiTransmit.tState.readable = 0U;
-		g_tSpiTransmit.byRxSize = wSize;
-		g_tSpiTransmit.pbyRxData = (uint8_t *)pData;
-		csp_spi_set_int(ptSpiBase, g_tSpiTransmit.byInter,true);
-		csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT,true);//enable rx fifo int
-		csp_spi_en(ptSpiBase);
-	}
-	else
-		tRet = CSI_ERROR;
-	
-	return tRet;
+	return apt_spi_xfer_start(ptSpiBase, NULL, pData, wSize);
 }
 
 /** \brief  receiving data from spi receiver,blocking mode
@@ -426,8 +520,8 @@ int32_t csi_spi_send_receive(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain
             break;
         }
 		
-		g_tSpiTransmit.byTxSize = wSize;
-		g_tSpiTransmit.byRxSize = wSize;
+		g_tSpiTransmit.wTxSize = wSize;
+		g_tSpiTransmit.wRxSize = wSize;
 		
 		g_tSpiTransmit.tState.writeable = 0U;
         g_tSpiTransmit.tState.readable  = 0U;
@@ -435,9 +529,9 @@ int32_t csi_spi_send_receive(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain
 		g_tSpiTransmit.pbyRxData = (uint8_t *)pDatain;
 		csp_spi_en(ptSpiBase);													//enable spi
 		
-		while((g_tSpiTransmit.byTxSize > 0U) || (g_tSpiTransmit.byRxSize > 0U))
+		while((g_tSpiTransmit.wTxSize > 0U) || (g_tSpiTransmit.wRxSize > 0U))
 		{
-			if(g_tSpiTransmit.byTxSize > 0U)
+			if(g_tSpiTransmit.wTxSize > 0U)
 			{
 				wTimeStart = SPI_SEND_TIMEOUT;
 				while(!csp_spi_write_ready(ptSpiBase) && wTimeStart --);		//send fifo full? wait; 
@@ -449,10 +543,10 @@ int32_t csi_spi_send_receive(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain
 				csp_spi_set_data(ptSpiBase,*g_tSpiTransmit.pbyTxData);				//send data
 				g_tSpiTransmit.pbyTxData ++;
 				wCount ++;
-				g_tSpiTransmit.byTxSize --;
+				g_tSpiTransmit.wTxSize --;
 			}
 			
-			if(g_tSpiTransmit.byRxSize > 0U)
+			if(g_tSpiTransmit.wRxSize > 0U)
 			{
 				wTimeStart = SPI_RECV_TIMEOUT;
 				while(!csp_spi_read_ready(ptSpiBase) && wTimeStart --);		//recv fifo empty? wait	
@@ -463,7 +557,7 @@ int32_t csi_spi_send_receive(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain
 		
 				*g_tSpiTransmit.pbyRxData  = csp_spi_get_data(ptSpiBase);			//recv data
 				g_tSpiTransmit.pbyRxData ++;
-				g_tSpiTransmit.byRxSize --;
+				g_tSpiTransmit.wRxSize --;
 			}
 		}
 
@@ -485,53 +579,14 @@ int32_t csi_spi_send_receive(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain
 /** \brief  receiving data from spi receiver, not-blocking mode
  * 
  *  \param[in] ptSpiBase: pointer of spi register structure
- *  \param[in] pDataout: pointer to buffer with data to send to spi transmitter
- *  \param[in] pDatain: number of data to receive(byte)
+ *  \param[in] pDataout: pointer to buffer with data to send to spi transmitter, NULL = send 0x00
+ *  \param[in] pDatain: pointer to buffer with data to receive, NULL = discard
  *  \param[in] wSize: number of data to receive(byte)
  *  \return error code \ref csi_error_t
  */
 csi_error_t csi_spi_send_receive_async(csp_spi_t *ptSpiBase, void *pDataout, void *pDatain, uint32_t wSize)
 {
-    csi_error_t tRet = CSI_OK;
-	
-	if((g_tSpiTransmit.tState.writeable == 0U) || (g_tSpiTransmit.tState.readable == 0U))
-	{ 
-        tRet = CSI_BUSY;
-	}
-		
-	if(tRet == CSI_OK) 
-	{
-		if(pDataout)
-			g_tSpiTransmit.tState.writeable = 0U;
-		else
-			g_tSpiTransmit.tState.writeable = 1U;
-		if(pDatain)
-			g_tSpiTransmit.tState.readable  = 0U;
-		else
-			g_tSpiTransmit.tState.readable  = 1U;
-			
-		g_tSpiTransmit.byTxSize = wSize;
-		g_tSpiTransmit.byRxSize = wSize;
-
-		if(pDataout)
-			g_tSpiTransmit.pbyTxData = (uint8_t *)pDataout;
-		else 
-			g_tSpiTransmit.pbyTxData = NULL;
-
-		if(pDatain)
-			g_tSpiTransmit.pbyRxData = (uint8_t *)pDatain;
-		else
-			g_tSpiTransmit.pbyRxData = NULL;
-
-		csp_spi_set_int(ptSpiBase, g_tSpiTransmit.byInter,true);
-		csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT,true);	//enable rx fifo int
-		csp_spi_set_int(ptSpiBase, SPI_TXIM_INT,true);					//enable tx fifo int
-		csp_spi_en(ptSpiBase);	
-    } 
-	else 
-        tRet = CSI_ERROR;
-		
-	return tRet;
+	return apt_spi_xfer_start(ptSpiBase, pDataout, pDatain, wSize);
 }
 
 /** \brief  transmission variables init ,user not change it
@@ -544,12 +599,16 @@ csi_error_t csi_spi_send_receive_async(csp_spi_t *ptSpiBase, void *pDataout, voi
 csi_error_t csi_spi_Internal_variables_init(spi_rxifl_e eRxLen,uint8_t byInter,csi_spi_mode_e eMode)
 {
 	g_tSpiTransmit.pbyRxData =NULL;
-	g_tSpiTransmit.byRxSize =0;
+	g_tSpiTransmit.wRxSize =0;
 	g_tSpiTransmit.pbyTxData =NULL;
-	g_tSpiTransmit.byTxSize =0;
+	g_tSpiTransmit.wTxSize =0;
 	g_tSpiTransmit.byRxFifoLength = (uint8_t)eRxLen;
 	g_tSpiTransmit.byInter = byInter;
 	g_tSpiTransmit.byWorkMode = (uint8_t)eMode;
+	g_tSpiTransmit.byAsync = 0;
+	g_tSpiTransmit.eNssPin = (eMode == SPI_MASTER) ? PB05 : SPI_NSS_NONE;		//PB05 is set up as NSS gpio in master mode
+	g_tSpiTransmit.callback = NULL;
+	g_tSpiTransmit.pArg = NULL;
 	g_tSpiTransmit.tState.writeable = 1;
 	g_tSpiTransmit.tState.readable  = 1;
 	g_tSpiTransmit.tState.error = 0;
@@ -557,6 +616,30 @@ csi_error_t csi_spi_Internal_variables_init(spi_rxifl_e eRxLen,uint8_t byInter,c
     return CSI_OK;
 }
 
+/** \brief attach the async transfer callback
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] callback: called in the spi interrupt when an async transfer ends, NULL = none
+ *  \param[in] pArg: argument of callback
+ *  \return none
+ */ 
+void csi_spi_attach_callback(csp_spi_t *ptSpiBase, csi_spi_callback_t callback, void *pArg)
+{
+	g_tSpiTransmit.callback = callback;
+	g_tSpiTransmit.pArg = pArg;
+}
+
+/** \brief select the NSS pin the async transfers pull low at start and release at the end
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] eNssPin: gpio used as NSS, SPI_NSS_NONE = leave NSS to the user
+ *  \return none
+ */ 
+void csi_spi_set_nss(csp_spi_t *ptSpiBase, pin_name_e eNssPin)
+{
+	g_tSpiTransmit.eNssPin = eNssPin;
+}
+
 /** \brief clr spi rx fifo
  * 
  *  \param[in] ptSpiBase: pointer of spi register structure
@@ -599,87 +682,6 @@ csi_error_t csi_spi_send_slave(csp_spi_t *ptSpiBase, uint16_t hwDataout)
 //interrupt process,just for reference
 //------------------------------------------------------------------------------------------
 
-/** \brief spi receive data,interrupt call 
- * 
- *  \param[in] ptSpiBase: pointer of SPI reg structure.
- *  \return none
- */ 
-static void apt_spi_intr_recv_data(csp_spi_t *ptSpiBase)
-{
-	if((g_tSpiTransmit.pbyRxData == NULL) || (g_tSpiTransmit.byRxSize == 0U))
-	{
-		
-		if(g_tSpiTransmit.pbyRxData == NULL)
-		{
-			for(uint8_t byIdx = 0; byIdx < g_tSpiTransmit.byRxFifoLength; byIdx++)
-			{
-				csp_spi_get_data(ptSpiBase);								//read fifo 
-				g_tSpiTransmit.byRxSize--;
-				if(g_tSpiTransmit.byRxSize == 0)
-				{
-					break;	
-				}
-			}
-			
-			if(g_tSpiTransmit.byRxSize == 0)
-			{
-				g_tSpiTransmit.tState.readable = 1U;
-				csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT, false);		//disable fifo rx int
-			}
-		}
-		else
-		{
-			csi_spi_clr_rxfifo(SPI0);
-			csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT, false);		//disable fifo rx int
-		}
-	}
-	else
-	{
-		for(uint8_t byIdx = 0; byIdx < g_tSpiTransmit.byRxFifoLength; byIdx++)
-		{
-			*g_tSpiTransmit.pbyRxData = csp_spi_get_data(ptSpiBase);			//receive data
-			g_tSpiTransmit.pbyRxData++;
-			g_tSpiTransmit.byRxSize--;
-			if(g_tSpiTransmit.byRxSize == 0)
-			{
-				break;
-			}
-		}
-		
-		if(g_tSpiTransmit.byRxSize == 0)
-		{
-			g_tSpiTransmit.tState.readable = 1U;
-			csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT, false);			//disable fifo rx int
-		}
-	}
-}
-
-/** \brief spi send data,interrupt call
- * 
- *  \param[in] ptSpiBase: pointer of SPI reg structure.
- *  \return none
- */ 
-static void apt_spi_intr_send_data(csp_spi_t *ptSpiBase)
-{	
-	if(g_tSpiTransmit.pbyTxData)
-	{
-		while(!(csp_spi_get_sr(ptSpiBase) & SPI_TNF));
-		csp_spi_set_data(ptSpiBase,*g_tSpiTransmit.pbyTxData);			//send data
-		g_tSpiTransmit.pbyTxData++;
-	}
-	else
-		csp_spi_set_data(ptSpiBase,0x00);						//send data
-
-	g_tSpiTransmit.byTxSize --;
-	
-    if (g_tSpiTransmit.byTxSize <= 0U) 
-	{
-        g_tSpiTransmit.tState.writeable = 1U;
-		csi_spi_nss_high(PB05);
-		csp_spi_set_int(ptSpiBase, SPI_TXIM_INT, false);			//disable fifo tx int
-    }
-}
-
 /** \brief spi interrupt handle weak function
  * 
  *  \param[in] ptSpiBase: pointer of spi register structure
@@ -689,13 +691,19 @@ __attribute__((weak)) void spi_irqhandler(csp_spi_t *ptSpiBase)
 {	
 	uint32_t wStatus = csp_spi_get_isr(ptSpiBase);
 	uint8_t receive_data[4];
+	
+	if(g_tSpiTransmit.byAsync)										//async transfer running
+	{
+		apt_spi_xfer_isr(ptSpiBase, wStatus);
+		return;
+	}
+	
 	//fifo rx 
 	if(wStatus & SPI_RXIM_INT)
 	{
 		//for reference
 		if(0==g_tSpiTransmit.byWorkMode)
 		{
-			//apt_spi_intr_recv_data(ptSpiBase);//when use"csi_spi_send_receive_async"function need open
 			for(uint8_t byIdx = 0; byIdx < g_tSpiTransmit.byRxFifoLength; byIdx++)
 			{
 				
@@ -713,11 +721,10 @@ __attribute__((weak)) void spi_irqhandler(csp_spi_t *ptSpiBase)
 			}
 		}
 	}
-	//fifo tx 
+	//fifo tx, nothing queued
 	if(wStatus & SPI_TXIM_INT)		
 	{
-		//for reference
-		apt_spi_intr_send_data(ptSpiBase);
+		csp_spi_set_int(ptSpiBase, SPI_TXIM_INT, false);
 	}
 	
 	//fifo overflow
@@ -733,25 +740,6 @@ __attribute__((weak)) void spi_irqhandler(csp_spi_t *ptSpiBase)
 	{	
 		//for reference
 		csp_spi_clr_isr(ptSpiBase, SPI_RTIM_INT);
-		
-		for(uint8_t byIdx = 0; byIdx < g_tSpiTransmit.byRxFifoLength-1; byIdx++)
-		{
-			
-			if(csp_spi_get_sr(ptSpiBase) & SPI_RNE)
-			{
-				*g_tSpiTransmit.pbyRxData = csp_spi_get_data(ptSpiBase);		//receive data
-				g_tSpiTransmit.pbyRxData++;
-			}
-			else
-			{
-				break;
-			}
-			
-		}		
-		g_tSpiTransmit.byRxSize = 0;
-		g_tSpiTransmit.tState.readable = 1U;
-		csp_spi_set_int(ptSpiBase, SPI_RXIM_INT | SPI_RTIM_INT, false);			//disable fifo rx int
-
 	}
 }
 
@@ -892,7 +880,7 @@ csi_error_t csi_spi_send_receive_x8(csp_spi_t *ptSpiBase, void *pDataOut,void *p
 csi_error_t csi_spi_send_receive_d8(csp_spi_t *ptSpiBase, uint8_t *pDataOut,uint8_t *pDataIn, uint32_t wSize)//大于等于八个的发送和读
 {
 		csi_error_t tRet = CSI_OK;
-		uint8_t byTxsize = wSize;
+		uint32_t wTxsize = wSize;
 		uint32_t wTimeStart = SPI_SEND_TIMEOUT;
 		
 		if((g_tSpiTransmit.tState.writeable == 0U) || (g_tSpiTransmit.tState.readable == 0U)) 
@@ -906,48 +894,48 @@ csi_error_t csi_spi_send_receive_d8(csp_spi_t *ptSpiBase, uint8_t *pDataOut,uint
 		g_tSpiTransmit.pbyTxData = (uint8_t *)pDataOut;
 		g_tSpiTransmit.pbyRxData = (uint8_t *)pDataIn;
 #if 1
-		uint8_t byOutidx = 0;
+		uint32_t wOutidx = 0;
 		uint8_t byIdx;
 		uint8_t byRemainder = 0;
-		uint8_t byZheng = 0;
-		uint8_t byLast8Times = 0;
+		uint32_t wZheng = 0;
+		uint32_t wLast8Times = 0;
 		uint8_t byLastTxBuff[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
 		csi_spi_clr_rxfifo(ptSpiBase);
 
-		byZheng = (wSize >> 3);
+		wZheng = (wSize >> 3);
 		byRemainder = wSize & 0x07;
-		byLast8Times = byZheng << 3;//position
+		wLast8Times = wZheng << 3;//position
 		
-		memcpy((void *)byLastTxBuff,(void *)&g_tSpiTransmit.pbyTxData[byLast8Times], byRemainder);
+		memcpy((void *)byLastTxBuff,(void *)&g_tSpiTransmit.pbyTxData[wLast8Times], byRemainder);
 		wTimeStart = SPI_SEND_TIMEOUT;
 		while( ((uint32_t)(ptSpiBase->SR) & SPI_BSY) && (wTimeStart --) ){;} 
 
-		while(byTxsize >=8U)
+		while(wTxsize >=8U)
 		{
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+1];  //csp_spi_set_data(spi_base,*spi->pbyTxData);	//send data
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+2];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+3];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+4];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+5];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+6];
-			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[byOutidx+7];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+1];  //csp_spi_set_data(spi_base,*spi->pbyTxData);	//send data
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+2];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+3];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+4];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+5];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+6];
+			ptSpiBase->DR = g_tSpiTransmit.pbyTxData[wOutidx+7];
 	
 			wTimeStart = SPI_SEND_TIMEOUT;
 			while( ((uint32_t)(ptSpiBase->SR) & SPI_BSY) && (wTimeStart --) ){;} 		
 
-			byTxsize -= 8;
-			g_tSpiTransmit.pbyRxData[byOutidx] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+1] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+2] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+3] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+4] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+5] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+6] = ptSpiBase->DR;
-			g_tSpiTransmit.pbyRxData[byOutidx+7] = ptSpiBase->DR;
+			wTxsize -= 8;
+			g_tSpiTransmit.pbyRxData[wOutidx] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+1] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+2] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+3] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+4] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+5] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+6] = ptSpiBase->DR;
+			g_tSpiTransmit.pbyRxData[wOutidx+7] = ptSpiBase->DR;
 			
-			byOutidx += 8;	
+			wOutidx += 8;	
 		}
 		
 	if(byRemainder != 0){	
@@ -992,14 +980,14 @@ csi_error_t csi_spi_send_receive_d8(csp_spi_t *ptSpiBase, uint8_t *pDataOut,uint
 		while( ((uint32_t)(ptSpiBase->SR) & SPI_BSY) && (wTimeStart --) ){;} 
 
 		for(byIdx=0;byIdx<byRemainder;byIdx++)		//read buffer data
-			g_tSpiTransmit.pbyRxData[byOutidx+byIdx] = ptSpiBase->DR;		
+			g_tSpiTransmit.pbyRxData[wOutidx+byIdx] = ptSpiBase->DR;		
 	}
 
 #else 	
 		csi_spi_clrRx_fifo(ptSpiBase);
-		byTxsize = wSize;
+		wTxsize = wSize;
 
-		while(byTxsize > 0U)
+		while(wTxsize > 0U)
 		{
 			wTimeStart = SPI_SEND_TIMEOUT;
 			while( ((uint32_t)(ptSpiBase->SR) & SPI_BSY) && (wTimeStart --) ){;} 
@@ -1008,7 +996,7 @@ csi_error_t csi_spi_send_receive_d8(csp_spi_t *ptSpiBase, uint8_t *pDataOut,uint
 			wTimeStart = SPI_SEND_TIMEOUT;
 			while( ((uint32_t)(ptSpiBase->SR) & SPI_BSY) && (wTimeStart --) ){;} 
 		
-			byTxsize --;
+			wTxsize --;
 			*g_tSpiTransmit.pbyRxData = ptSpiBase->DR;
 			g_tSpiTransmit.pbyTxData ++;
 			g_tSpiTransmit.pbyRxData ++;
@@ -0,0 +1,819 @@
+/***********************************************************************//**
+ * \file  spiflash.c
+ * \brief  csi spi nor flash driver(25 series) on spi0
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-8 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+#include <soc.h>
+#include <drv/spiflash.h>
+#include <drv/spi.h>
+#include <drv/pin.h>
+#include <drv/tick.h>
+
+#include "csp_spi.h"
+
+/* Private macro------------------------------------------------------*/
+#define SPIFLASH_CMD_WRSR			0x01
+#define SPIFLASH_CMD_PP				0x02
+#define SPIFLASH_CMD_RDSR			0x05
+#define SPIFLASH_CMD_WREN			0x06
+#define SPIFLASH_CMD_FAST_READ		0x0B
+#define SPIFLASH_CMD_SE				0x20		//4K sector erase
+#define SPIFLASH_CMD_BE32			0x52
+#define SPIFLASH_CMD_SFDP			0x5A
+#define SPIFLASH_CMD_RDID			0x9F
+#define SPIFLASH_CMD_RES			0xAB		//release from deep power down
+#define SPIFLASH_CMD_CE				0xC7		//chip erase
+#define SPIFLASH_CMD_BE64			0xD8
+
+#define SPIFLASH_SR_WIP				0x01
+#define SPIFLASH_SR_BP_MSK			0x1C		//BP2..BP0
+
+#define SPIFLASH_SFDP_SIGN			0x50444653	//"SFDP"
+#define SPIFLASH_ADDR_LIMIT			0x1000000UL	//3 byte address
+#define SPIFLASH_PAGE_SIZE			256U
+
+#define SPIFLASH_PP_TIMEOUT_MS		10U
+#define SPIFLASH_WRSR_TIMEOUT_MS	50U
+#define SPIFLASH_ERASE_TIMEOUT_MS	2000U		//per sector/block, chip erase waits without limit
+
+/* externs function---------------------------------------------------*/
+/* externs variablesr-------------------------------------------------*/
+/* Private variablesr-------------------------------------------------*/
+
+/** \brief drive chip select
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] eLevel: GPIO_PIN_LOW = select
+ *  \return none
+ */
+static void apt_spiflash_cs(csi_spiflash_t *ptFlash, csi_gpio_pin_state_e eLevel)
+{
+	if(ptFlash->spi_cs_callback)
+		ptFlash->spi_cs_callback(eLevel);
+	else if(eLevel == GPIO_PIN_LOW)
+		csi_spi_nss_low(PB05);
+	else
+		csi_spi_nss_high(PB05);
+}
+
+/** \brief polled full-duplex transfer, frames in flight are kept below the
+ *         fifo depth so long streams never overrun the rx fifo
+ *
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] pbyTx: data to send, NULL = send 0x00
+ *  \param[out] pbyRx: received data, NULL = discard
+ *  \param[in] wSize: number of bytes
+ *  \return none
+ */
+static void apt_spiflash_xfer(csp_spi_t *ptSpiBase, const uint8_t *pbyTx, uint8_t *pbyRx, uint32_t wSize)
+{
+	uint32_t wTxLeft = wSize;
+	uint32_t wRxLeft = wSize;
+	uint8_t byData;
+
+	while(wRxLeft)
+	{
+		while(wTxLeft && (wRxLeft - wTxLeft) < SPI_FIFO_DEPTH && (csp_spi_get_sr(ptSpiBase) & SPI_TNF))
+		{
+			if(pbyTx)
+				csp_spi_set_data(ptSpiBase, *pbyTx++);
+			else
+				csp_spi_set_data(ptSpiBase, 0x00);
+			wTxLeft--;
+		}
+		while(wRxLeft && (csp_spi_get_sr(ptSpiBase) & SPI_RNE))
+		{
+			byData = (uint8_t)csp_spi_get_data(ptSpiBase);
+			if(pbyRx)
+				*pbyRx++ = byData;
+			wRxLeft--;
+		}
+	}
+}
+
+/** \brief select the flash, send command and address(MSB first)
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] byCmd: command
+ *  \param[in] wAddr: address
+ *  \param[in] wAddrSize: address bytes(0~4)
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_head(csi_spiflash_t *ptFlash, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize)
+{
+	uint8_t byHead[5];
+	uint8_t i;
+	csi_state_t tState;
+
+	csi_spi_get_state(&tState);
+	if((tState.writeable == 0U) || (tState.readable == 0U) || (wAddrSize > 4))		//spi0 used by an async transfer
+		return CSI_BUSY;
+
+	byHead[0] = byCmd;
+	for(i = 0; i < wAddrSize; i++)
+		byHead[1 + i] = (uint8_t)(wAddr >> ((wAddrSize - 1 - i) << 3));
+
+	csi_spi_clr_rxfifo(ptFlash->spi_base);
+	apt_spiflash_cs(ptFlash, GPIO_PIN_LOW);
+	apt_spiflash_xfer(ptFlash->spi_base, byHead, NULL, wAddrSize + 1);
+
+	return CSI_OK;
+}
+
+/** \brief default spi_send hook: command, address, data out
+ *
+ *  \param[in] pSpi: SPIFLASH handle
+ *  \param[in] byCmd: command
+ *  \param[in] wAddr: address
+ *  \param[in] wAddrSize: address bytes, a dummy byte is sent as a 4th address byte
+ *  \param[in] pData: data to send
+ *  \param[in] wSize: number of data
+ *  \return number of data sent or error code
+ */
+static int32_t apt_spiflash_spi_send(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, const void *pData, uint32_t wSize)
+{
+	csi_spiflash_t *ptFlash = (csi_spiflash_t *)pSpi;
+	csi_error_t tRet = apt_spiflash_head(ptFlash, byCmd, wAddr, wAddrSize);
+
+	if(tRet != CSI_OK)
+		return tRet;
+	if(wSize)
+		apt_spiflash_xfer(ptFlash->spi_base, (const uint8_t *)pData, NULL, wSize);
+	apt_spiflash_cs(ptFlash, GPIO_PIN_HIGH);
+
+	return (int32_t)wSize;
+}
+
+/** \brief default spi_receive hook: command, address, data in(one cs, any length)
+ *
+ *  \param[in] pSpi: SPIFLASH handle
+ *  \param[in] byCmd: command
+ *  \param[in] wAddr: address
+ *  \param[in] wAddrSize: address bytes, a dummy byte is sent as a 4th address byte
+ *  \param[out] pData: received data
+ *  \param[in] wSize: number of data
+ *  \return number of data received or error code
+ */
+static int32_t apt_spiflash_spi_receive(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, void *pData, uint32_t wSize)
+{
+	csi_spiflash_t *ptFlash = (csi_spiflash_t *)pSpi;
+	csi_error_t tRet = apt_spiflash_head(ptFlash, byCmd, wAddr, wAddrSize);
+
+	if(tRet != CSI_OK)
+		return tRet;
+	if(wSize)
+		apt_spiflash_xfer(ptFlash->spi_base, NULL, (uint8_t *)pData, wSize);
+	apt_spiflash_cs(ptFlash, GPIO_PIN_HIGH);
+
+	return (int32_t)wSize;
+}
+
+/** \brief read status register 1
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \return status(0~0xff) or error code
+ */
+static int32_t apt_spiflash_read_sr(csi_spiflash_t *ptFlash)
+{
+	uint8_t bySr;
+	int32_t iRet = ptFlash->spi_receive(ptFlash, SPIFLASH_CMD_RDSR, 0, 0, &bySr, 1);
+
+	return (iRet < 0) ? iRet : (int32_t)bySr;
+}
+
+/** \brief wait for the end of program/erase/write status
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] wTimeoutMs: timeout, 0 = wait forever
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_wait_ready(csi_spiflash_t *ptFlash, uint32_t wTimeoutMs)
+{
+	uint32_t wStart = csi_tick_get_ms();
+	int32_t iSr;
+
+	do{
+		iSr = apt_spiflash_read_sr(ptFlash);
+		if(iSr < 0)
+			return (csi_error_t)iSr;
+		if((iSr & SPIFLASH_SR_WIP) == 0)
+			return CSI_OK;
+	}while((wTimeoutMs == 0) || (csi_tick_get_ms() - wStart) < wTimeoutMs);
+
+	return CSI_TIMEOUT;
+}
+
+/** \brief write enable followed by a command
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] byCmd: command
+ *  \param[in] wAddr: address
+ *  \param[in] wAddrSize: address bytes
+ *  \param[in] pData: data to send
+ *  \param[in] wSize: number of data
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_write_cmd(csi_spiflash_t *ptFlash, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, const void *pData, uint32_t wSize)
+{
+	int32_t iRet = ptFlash->spi_send(ptFlash, SPIFLASH_CMD_WREN, 0, 0, NULL, 0);
+
+	if(iRet >= 0)
+		iRet = ptFlash->spi_send(ptFlash, byCmd, wAddr, wAddrSize, pData, wSize);
+
+	return (iRet < 0) ? (csi_error_t)iRet : CSI_OK;
+}
+
+/** \brief read one SFDP dword(little endian)
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] wAddr: SFDP address
+ *  \param[out] pwVal: dword
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_sfdp_word(csi_spiflash_t *ptFlash, uint32_t wAddr, uint32_t *pwVal)
+{
+	uint8_t byBuf[4];
+	int32_t iRet = ptFlash->spi_receive(ptFlash, SPIFLASH_CMD_SFDP, wAddr << 8, 4, byBuf, 4);	//3 address bytes + dummy
+
+	if(iRet < 0)
+		return (csi_error_t)iRet;
+	*pwVal = byBuf[0] | ((uint32_t)byBuf[1] << 8) | ((uint32_t)byBuf[2] << 16) | ((uint32_t)byBuf[3] << 24);
+
+	return CSI_OK;
+}
+
+/** \brief add an erase type, the table stays sorted largest size first
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] byCmd: erase opcode
+ *  \param[in] byShift: log2 of the erase size
+ *  \return none
+ */
+static void apt_spiflash_add_erase(csi_spiflash_t *ptFlash, uint8_t byCmd, uint8_t byShift)
+{
+	uint8_t i, j;
+
+	if(byCmd == 0 || byShift < 8 || byShift > 24)
+		return;
+
+	for(i = 0; i < SPIFLASH_ERASE_TYPES; i++)
+	{
+		if(ptFlash->erase_cmd[i] == 0 || ptFlash->erase_shift[i] < byShift)
+			break;
+		if(ptFlash->erase_shift[i] == byShift)						//same size listed twice
+			return;
+	}
+	if(i == SPIFLASH_ERASE_TYPES)
+		return;
+
+	for(j = SPIFLASH_ERASE_TYPES - 1; j > i; j--)
+	{
+		ptFlash->erase_cmd[j] = ptFlash->erase_cmd[j - 1];
+		ptFlash->erase_shift[j] = ptFlash->erase_shift[j - 1];
+	}
+	ptFlash->erase_cmd[i] = byCmd;
+	ptFlash->erase_shift[i] = byShift;
+}
+
+/** \brief read geometry from the JEDEC basic flash parameter table
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_sfdp(csi_spiflash_t *ptFlash)
+{
+	uint32_t wVal, wPtp, wDw;
+	uint8_t byLen, i;
+
+	if(apt_spiflash_sfdp_word(ptFlash, 0, &wVal) != CSI_OK || wVal != SPIFLASH_SFDP_SIGN)
+		return CSI_UNSUPPORTED;
+	if(apt_spiflash_sfdp_word(ptFlash, 8, &wVal) != CSI_OK || (wVal & 0xff) != 0x00)	//first header is the basic table
+		return CSI_UNSUPPORTED;
+	byLen = (uint8_t)(wVal >> 24);
+	if(byLen < 2 || apt_spiflash_sfdp_word(ptFlash, 12, &wPtp) != CSI_OK)
+		return CSI_UNSUPPORTED;
+	wPtp &= 0xffffff;
+
+	if(apt_spiflash_sfdp_word(ptFlash, wPtp + 4, &wDw) != CSI_OK)				//DW2: density
+		return CSI_UNSUPPORTED;
+	if(wDw & 0x80000000)
+	{
+		wDw &= 0x7fffffff;
+		ptFlash->info.flash_size = (wDw >= 27) ? SPIFLASH_ADDR_LIMIT : (1UL << (wDw - 3));
+	}
+	else
+		ptFlash->info.flash_size = (wDw >> 3) + 1;
+
+	if(byLen >= 9)																//DW8/DW9: erase types 1~4
+	{
+		for(i = 0; i < 2; i++)
+		{
+			if(apt_spiflash_sfdp_word(ptFlash, wPtp + 28 + (i << 2), &wDw) != CSI_OK)
+				return CSI_UNSUPPORTED;
+			apt_spiflash_add_erase(ptFlash, (uint8_t)(wDw >> 8), (uint8_t)wDw);
+			apt_spiflash_add_erase(ptFlash, (uint8_t)(wDw >> 24), (uint8_t)(wDw >> 16));
+		}
+	}
+	if(ptFlash->erase_cmd[0] == 0)												//DW1: 4K erase only
+	{
+		if(apt_spiflash_sfdp_word(ptFlash, wPtp, &wDw) != CSI_OK)
+			return CSI_UNSUPPORTED;
+		if((wDw & 0x03) == 0x01)
+			apt_spiflash_add_erase(ptFlash, (uint8_t)(wDw >> 8), 12);
+	}
+	if(byLen >= 11 && apt_spiflash_sfdp_word(ptFlash, wPtp + 40, &wDw) == CSI_OK)	//DW11: page size
+		ptFlash->info.page_size = 1UL << ((wDw >> 4) & 0x0f);
+
+	return CSI_OK;
+}
+
+/** \brief read JEDEC id and geometry(SFDP, capacity code as fallback)
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_probe(csi_spiflash_t *ptFlash)
+{
+	uint8_t byId[3];
+	uint8_t i;
+	int32_t iRet;
+
+	ptFlash->spi_send(ptFlash, SPIFLASH_CMD_RES, 0, 0, NULL, 0);
+	udelay(30);																	//tRES1
+
+	iRet = ptFlash->spi_receive(ptFlash, SPIFLASH_CMD_RDID, 0, 0, byId, 3);
+	if(iRet < 0)
+		return (csi_error_t)iRet;
+	if((byId[0] == 0x00 && byId[1] == 0x00) || (byId[0] == 0xff && byId[1] == 0xff))		//no flash on the bus
+		return CSI_ERROR;
+
+	ptFlash->info.flash_name = "spi nor";
+	ptFlash->info.flash_id = FLASH_ID_BUILD(byId[0], ((uint32_t)byId[1] << 8) | byId[2]);
+	ptFlash->info.xip_addr = 0;
+	ptFlash->info.flash_size = 0;
+	ptFlash->info.page_size = SPIFLASH_PAGE_SIZE;
+	for(i = 0; i < SPIFLASH_ERASE_TYPES; i++)
+		ptFlash->erase_cmd[i] = 0;
+
+	if(apt_spiflash_sfdp(ptFlash) != CSI_OK || ptFlash->erase_cmd[0] == 0)
+	{
+		for(i = 0; i < SPIFLASH_ERASE_TYPES; i++)
+			ptFlash->erase_cmd[i] = 0;
+		if(byId[2] < 0x10 || byId[2] > 0x18)									//64KB ~ 16MB
+			return CSI_UNSUPPORTED;
+		ptFlash->info.flash_size = 1UL << byId[2];
+		ptFlash->info.page_size = SPIFLASH_PAGE_SIZE;
+		apt_spiflash_add_erase(ptFlash, SPIFLASH_CMD_BE64, 16);
+		apt_spiflash_add_erase(ptFlash, SPIFLASH_CMD_BE32, 15);
+		apt_spiflash_add_erase(ptFlash, SPIFLASH_CMD_SE, 12);
+	}
+
+	if(ptFlash->info.flash_size > SPIFLASH_ADDR_LIMIT)							//3 byte address mode only
+		ptFlash->info.flash_size = SPIFLASH_ADDR_LIMIT;
+
+	for(i = SPIFLASH_ERASE_TYPES; i > 0; i--)									//smallest erase unit
+	{
+		if(ptFlash->erase_cmd[i - 1])
+		{
+			ptFlash->info.sector_size = 1UL << ptFlash->erase_shift[i - 1];
+			break;
+		}
+	}
+
+	return CSI_OK;
+}
+
+/** \brief check a range against the erase unit
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] wOffset: start address
+ *  \param[in] wSize: length
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_erase_check(csi_spiflash_t *ptFlash, uint32_t wOffset, uint32_t wSize)
+{
+	uint32_t wMask = ptFlash->info.sector_size - 1;
+
+	if(wSize == 0 || (wOffset & wMask) || (wSize & wMask))
+		return CSI_ERROR;
+	if(wOffset >= ptFlash->info.flash_size || wSize > ptFlash->info.flash_size - wOffset)
+		return CSI_ERROR;
+
+	return CSI_OK;
+}
+
+/** \brief range covers the whole chip(chip erase), not used when the
+ *         size was cut to the 3 byte address range
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] wOffset: start address
+ *  \param[in] wSize: length
+ *  \return true: whole chip
+ */
+static inline bool apt_spiflash_is_chip(csi_spiflash_t *ptFlash, uint32_t wOffset, uint32_t wSize)
+{
+	return (wOffset == 0) && (wSize == ptFlash->info.flash_size) && (wSize < SPIFLASH_ADDR_LIMIT);
+}
+
+/** \brief erase the largest aligned unit at erase_addr and advance it
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_erase_step(csi_spiflash_t *ptFlash)
+{
+	uint32_t wAddr = ptFlash->erase_addr;
+	uint32_t wLeft = ptFlash->erase_end - wAddr;
+	uint32_t wUnit;
+	csi_error_t tRet;
+	uint8_t i;
+
+	if(apt_spiflash_is_chip(ptFlash, wAddr, wLeft))
+	{
+		tRet = apt_spiflash_write_cmd(ptFlash, SPIFLASH_CMD_CE, 0, 0, NULL, 0);
+		if(tRet == CSI_OK)
+			ptFlash->erase_addr = ptFlash->erase_end;
+		return tRet;
+	}
+
+	for(i = 0; i < SPIFLASH_ERASE_TYPES && ptFlash->erase_cmd[i]; i++)
+	{
+		wUnit = 1UL << ptFlash->erase_shift[i];
+		if((wAddr & (wUnit - 1)) == 0 && wLeft >= wUnit)
+		{
+			tRet = apt_spiflash_write_cmd(ptFlash, ptFlash->erase_cmd[i], wAddr, 3, NULL, 0);
+			if(tRet == CSI_OK)
+				ptFlash->erase_addr += wUnit;
+			return tRet;
+		}
+	}
+
+	return CSI_ERROR;
+}
+
+/** \brief async erase poll, runs on the software timer(deferred)
+ *
+ *  \param[in] pArg: SPIFLASH handle
+ *  \return none
+ */
+static void apt_spiflash_poll(void *pArg)
+{
+	csi_spiflash_t *ptFlash = (csi_spiflash_t *)pArg;
+	csi_error_t tRet = CSI_OK;
+	int32_t iSr = apt_spiflash_read_sr(ptFlash);
+
+	if(iSr == CSI_BUSY || (iSr >= 0 && (iSr & SPIFLASH_SR_WIP)))				//bus taken or still erasing, next poll
+		return;
+
+	if(iSr < 0)
+		tRet = (csi_error_t)iSr;
+	else if(ptFlash->erase_addr < ptFlash->erase_end)
+	{
+		tRet = apt_spiflash_erase_step(ptFlash);
+		if(tRet == CSI_OK || tRet == CSI_BUSY)
+			return;
+	}
+
+	csi_swtimer_stop(&ptFlash->poll_timer);
+	ptFlash->busy = 0;
+	if(ptFlash->callback)
+		ptFlash->callback(ptFlash, tRet, ptFlash->arg);
+}
+
+/** \brief Initialize SPIFLASH with spi0 and probe flash device, spi_send/spi_receive
+ *         already set by the caller are kept and used for the probe
+ *
+ *  \param[in] spiflash: SPIFLASH handle(static, zero initialized)
+ *  \param[in] spi_idx: SPI controler index, 0 only
+ *  \param[in] spi_cs_callback: chip select callback, NULL = PB05 as gpio cs
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_spi_init(csi_spiflash_t *spiflash, uint32_t spi_idx, void *spi_cs_callback)
+{
+	csi_spi_config_t tSpiCfg;
+	csi_error_t tRet;
+
+	if(spi_idx != 0)
+		return CSI_ERROR;
+
+	if(spiflash->poll_timer.callback)
+		csi_swtimer_stop(&spiflash->poll_timer);
+	csi_swtimer_init(&spiflash->poll_timer, apt_spiflash_poll, spiflash, SWTIMER_DEFER);
+
+	spiflash->spi_base = SPI0;
+	spiflash->spi_cs_callback = (void (*)(csi_gpio_pin_state_e))spi_cs_callback;
+	if(spiflash->spi_send == NULL)
+		spiflash->spi_send = apt_spiflash_spi_send;
+	if(spiflash->spi_receive == NULL)
+		spiflash->spi_receive = apt_spiflash_spi_receive;
+	spiflash->busy = 0;
+	spiflash->callback = NULL;
+
+	tSpiCfg.eSpiMode = SPI_MASTER;
+	tSpiCfg.eSpiPolarityPhase = SPI_FORMAT_CPOL0_CPHA0;
+	tSpiCfg.eSpiFrameLen = SPI_FRAME_LEN_8;
+	tSpiCfg.dwSpiBaud = CONFIG_SPIFLASH_BAUD;
+	tSpiCfg.eSpiRxFifoLevel = SPI_RXFIFO_1_2;
+	tSpiCfg.byInter = (uint8_t)SPI_NONE_INT;
+	tRet = csi_spi_init(SPI0, &tSpiCfg);
+	if(tRet != CSI_OK)
+		return tRet;
+	apt_spiflash_cs(spiflash, GPIO_PIN_HIGH);
+
+	return apt_spiflash_probe(spiflash);
+}
+
+/** \brief Initialize SPIFLASH with qspi controler, no qspi on this chip
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] qspi_idx: QSPI controler index
+ *  \return CSI_UNSUPPORTED
+ */
+csi_error_t csi_spiflash_qspi_init(csi_spiflash_t *spiflash, uint32_t qspi_idx)
+{
+	return CSI_UNSUPPORTED;
+}
+
+/** \brief De-initialize SPIFLASH, an async erase is abandoned(the flash finishes it)
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \return none
+ */
+void csi_spiflash_spi_uninit(csi_spiflash_t *spiflash)
+{
+	csi_swtimer_stop(&spiflash->poll_timer);
+	spiflash->busy = 0;
+	apt_spiflash_cs(spiflash, GPIO_PIN_HIGH);
+}
+
+/** \brief De-initialize SPIFLASH based on qspi controler, no qspi on this chip
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \return none
+ */
+void csi_spiflash_qspi_uninit(csi_spiflash_t *spiflash)
+{
+}
+
+/** \brief get flash device infomation
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[out] flash_info: probed flash information
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_get_flash_info(csi_spiflash_t *spiflash, csi_spiflash_info_t *flash_info)
+{
+	*flash_info = spiflash->info;
+	return CSI_OK;
+}
+
+/** \brief read data from flash, fast read(0x0B) in one chip select
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: flash address
+ *  \param[out] data: buffer of read data
+ *  \param[in] size: number of data
+ *  \return number of data read or error code
+ */
+int32_t csi_spiflash_read(csi_spiflash_t *spiflash, uint32_t offset, void *data, uint32_t size)
+{
+	if(spiflash->busy)
+		return CSI_BUSY;
+	if(offset >= spiflash->info.flash_size || size > spiflash->info.flash_size - offset)
+		return CSI_ERROR;
+	if(size == 0)
+		return 0;
+
+	return spiflash->spi_receive(spiflash, SPIFLASH_CMD_FAST_READ, offset << 8, 4, data, size);	//3 address bytes + dummy
+}
+
+/** \brief program data to flash, split at page boundaries
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: flash address
+ *  \param[in] data: data to program
+ *  \param[in] size: number of data
+ *  \return number of data programmed or error code
+ */
+int32_t csi_spiflash_program(csi_spiflash_t *spiflash, uint32_t offset, const void *data, uint32_t size)
+{
+	const uint8_t *pbyData = (const uint8_t *)data;
+	uint32_t wPage = spiflash->info.page_size;
+	uint32_t wDone = 0;
+	uint32_t wChunk;
+	csi_error_t tRet;
+
+	if(spiflash->busy)
+		return CSI_BUSY;
+	if(offset >= spiflash->info.flash_size || size > spiflash->info.flash_size - offset)
+		return CSI_ERROR;
+
+	while(wDone < size)
+	{
+		wChunk = wPage - (offset & (wPage - 1));								//up to the page end
+		if(wChunk > size - wDone)
+			wChunk = size - wDone;
+
+		tRet = apt_spiflash_write_cmd(spiflash, SPIFLASH_CMD_PP, offset, 3, pbyData, wChunk);
+		if(tRet == CSI_OK)
+			tRet = apt_spiflash_wait_ready(spiflash, SPIFLASH_PP_TIMEOUT_MS);
+		if(tRet != CSI_OK)
+			return wDone ? (int32_t)wDone : tRet;
+
+		offset += wChunk;
+		pbyData += wChunk;
+		wDone += wChunk;
+	}
+
+	return (int32_t)wDone;
+}
+
+/** \brief erase flash, every step uses the largest erase unit aligned at the address
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: flash address, sector aligned
+ *  \param[in] size: length, sector aligned
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_erase(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size)
+{
+	csi_error_t tRet;
+
+	if(spiflash->busy)
+		return CSI_BUSY;
+	tRet = apt_spiflash_erase_check(spiflash, offset, size);
+	if(tRet != CSI_OK)
+		return tRet;
+
+	spiflash->erase_addr = offset;
+	spiflash->erase_end = offset + size;
+	while(spiflash->erase_addr < spiflash->erase_end)
+	{
+		tRet = apt_spiflash_erase_step(spiflash);
+		if(tRet == CSI_OK)
+			tRet = apt_spiflash_wait_ready(spiflash, apt_spiflash_is_chip(spiflash, offset, size) ? 0 : SPIFLASH_ERASE_TIMEOUT_MS);
+		if(tRet != CSI_OK)
+			return tRet;
+	}
+
+	return CSI_OK;
+}
+
+/** \brief erase flash without blocking, the WIP bit is polled every
+ *         CONFIG_SPIFLASH_POLL_MS from csi_swtimer_process
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: flash address, sector aligned
+ *  \param[in] size: length, sector aligned
+ *  \param[in] callback: called when done, may be NULL
+ *  \param[in] arg: argument of callback
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_erase_async(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size, csi_spiflash_cb_t callback, void *arg)
+{
+	csi_error_t tRet;
+
+	if(spiflash->busy)
+		return CSI_BUSY;
+	tRet = apt_spiflash_erase_check(spiflash, offset, size);
+	if(tRet != CSI_OK)
+		return tRet;
+
+	spiflash->erase_addr = offset;
+	spiflash->erase_end = offset + size;
+	tRet = apt_spiflash_erase_step(spiflash);
+	if(tRet != CSI_OK)
+		return tRet;
+
+	spiflash->callback = callback;
+	spiflash->arg = arg;
+	spiflash->busy = 1;
+
+	return csi_swtimer_start(&spiflash->poll_timer, CONFIG_SPIFLASH_POLL_MS, CONFIG_SPIFLASH_POLL_MS);
+}
+
+/** \brief read flash register
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] cmd_code: read register command
+ *  \param[out] data: register value
+ *  \param[in] size: register length(byte)
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_read_reg(csi_spiflash_t *spiflash, uint8_t cmd_code, uint8_t *data, uint32_t size)
+{
+	int32_t iRet;
+
+	if(spiflash->busy)
+		return CSI_BUSY;
+	iRet = spiflash->spi_receive(spiflash, cmd_code, 0, 0, data, size);
+
+	return (iRet < 0) ? (csi_error_t)iRet : CSI_OK;
+}
+
+/** \brief write flash register(write enable, command, wait ready)
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] cmd_code: write register command
+ *  \param[in] data: register value
+ *  \param[in] size: register length(byte)
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_write_reg(csi_spiflash_t *spiflash, uint8_t cmd_code, uint8_t *data, uint32_t size)
+{
+	csi_error_t tRet;
+
+	if(spiflash->busy)
+		return CSI_BUSY;
+	tRet = apt_spiflash_write_cmd(spiflash, cmd_code, 0, 0, data, size);
+	if(tRet == CSI_OK)
+		tRet = apt_spiflash_wait_ready(spiflash, SPIFLASH_WRSR_TIMEOUT_MS);
+
+	return tRet;
+}
+
+/** \brief set/clear the BP bits of status register 1
+ *
+ *  \param[in] ptFlash: SPIFLASH handle
+ *  \param[in] byBp: BP bits(SPIFLASH_SR_BP_MSK or 0)
+ *  \return error code \ref csi_error_t
+ */
+static csi_error_t apt_spiflash_set_bp(csi_spiflash_t *ptFlash, uint8_t byBp)
+{
+	int32_t iSr;
+	uint8_t bySr;
+
+	if(ptFlash->busy)
+		return CSI_BUSY;
+	iSr = apt_spiflash_read_sr(ptFlash);
+	if(iSr < 0)
+		return (csi_error_t)iSr;
+
+	bySr = ((uint8_t)iSr & ~SPIFLASH_SR_BP_MSK) | byBp;
+	return csi_spiflash_write_reg(ptFlash, SPIFLASH_CMD_WRSR, &bySr, 1);
+}
+
+/** \brief enable write protection, BP protection tables are vendor specific,
+ *         only the whole array is supported
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: 0
+ *  \param[in] size: flash size
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_lock(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size)
+{
+	if(offset != 0 || size != spiflash->info.flash_size)
+		return CSI_UNSUPPORTED;
+
+	return apt_spiflash_set_bp(spiflash, SPIFLASH_SR_BP_MSK);
+}
+
+/** \brief disable write protection of the whole array
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: 0
+ *  \param[in] size: flash size
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_unlock(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size)
+{
+	if(offset != 0 || size != spiflash->info.flash_size)
+		return CSI_UNSUPPORTED;
+
+	return apt_spiflash_set_bp(spiflash, 0);
+}
+
+/** \brief check flash is locked, only the whole array lock is recognized
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] offset: flash address
+ *  \param[in] size: length
+ *  \return 1: locked; 0: unlocked or partially locked
+ */
+int csi_spiflash_is_locked(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size)
+{
+	int32_t iSr;
+
+	if(spiflash->busy)
+		return 0;
+	iSr = apt_spiflash_read_sr(spiflash);
+
+	return (iSr >= 0 && (iSr & SPIFLASH_SR_BP_MSK) == SPIFLASH_SR_BP_MSK) ? 1 : 0;
+}
+
+/** \brief set data line, spi0 drives one line only
+ *
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] line: SPIFLASH_DATA_1_LINE
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_spiflash_config_data_line(csi_spiflash_t *spiflash, csi_spiflash_data_line_t line)
+{
+	return (line == SPIFLASH_DATA_1_LINE) ? CSI_OK : CSI_UNSUPPORTED;
+}
@@ -0,0 +1,344 @@
+/***********************************************************************//**
+ * \file  swtimer.c
+ * \brief  software timer service on the system tick(hierarchical timer wheel)
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-2 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+#include <soc.h>
+#include <drv/swtimer.h>
+#include <drv/tick.h>
+#include <drv/hwdiv.h>
+
+/* Private macro------------------------------------------------------*/
+#define SWTIMER_SLOTS		(1UL << CONFIG_SWTIMER_WHEEL_BITS)
+#define SWTIMER_MASK		(SWTIMER_SLOTS - 1UL)
+#define SWTIMER_RANGE		(1UL << (CONFIG_SWTIMER_WHEEL_BITS * CONFIG_SWTIMER_WHEEL_LEVELS))
+#define SWTIMER_MAX_TICKS	(0x7FFFFFFFUL)			//expiry compare is signed
+#define SWTIMER_TICK_MS		(1000U / CONFIG_SYSTICK_HZ)
+
+#if (CONFIG_SYSTICK_HZ > 1000) || (1000 % CONFIG_SYSTICK_HZ != 0)
+#error "CONFIG_SYSTICK_HZ has to divide 1000, a tick is a whole number of ms"
+#endif
+
+/* externs function---------------------------------------------------*/
+/* externs variablesr-------------------------------------------------*/
+/* Private variablesr-------------------------------------------------*/
+static dlist_t s_tWheel[CONFIG_SWTIMER_WHEEL_LEVELS][SWTIMER_SLOTS];
+static dlist_t s_tPending;						//expired timers waiting for csi_swtimer_process
+static uint32_t s_wNow = 0;						//next tick to be processed by the wheel
+static uint16_t s_hwArmed = 0;					//timers linked in the wheel
+static bool s_bInit = false;
+
+/** \brief set up the wheel on first use, called with interrupts disabled
+ */
+static void apt_swtimer_service_init(void)
+{
+	uint8_t i, j;
+
+	for(i = 0; i < CONFIG_SWTIMER_WHEEL_LEVELS; i++)
+	{
+		for(j = 0; j < SWTIMER_SLOTS; j++)
+			dlist_init(&s_tWheel[i][j]);
+	}
+	dlist_init(&s_tPending);
+	s_wNow = csi_tick_get() + 1U;
+	s_bInit = true;
+}
+
+/** \brief move all nodes of a list to another(empty) head
+ */
+static inline void apt_swtimer_splice(dlist_t *ptFrom, dlist_t *ptTo)
+{
+	if(dlist_empty(ptFrom))
+	{
+		dlist_init(ptTo);
+		return;
+	}
+	ptTo->next = ptFrom->next;
+	ptTo->prev = ptFrom->prev;
+	ptTo->next->prev = ptTo;
+	ptTo->prev->next = ptTo;
+	dlist_init(ptFrom);
+}
+
+/** \brief link a timer into the wheel slot of its expiry, called with interrupts disabled
+ *
+ *  The level is picked by the distance to s_wNow, the slot by the expiry
+ *  bits of that level. Overdue timers go to the slot processed next, timers
+ *  beyond the wheel span to the farthest slot and are placed again when
+ *  that slot is cascaded.
+ */
+static void apt_swtimer_insert(csi_swtimer_t *ptTimer)
+{
+	uint32_t wDelta = ptTimer->wExpire - s_wNow;
+	uint32_t wSlotTick = ptTimer->wExpire;
+	uint8_t byLvl = 0;
+
+	if((int32_t)wDelta < 0)
+	{
+		wDelta = 0;
+		wSlotTick = s_wNow;
+	}
+	else if(wDelta >= SWTIMER_RANGE)
+	{
+		wDelta = SWTIMER_RANGE - 1U;
+		wSlotTick = s_wNow + wDelta;
+	}
+
+	while(wDelta >= (SWTIMER_SLOTS << (byLvl * CONFIG_SWTIMER_WHEEL_BITS)))
+		byLvl++;
+
+	dlist_add_tail(&ptTimer->tNode, &s_tWheel[byLvl][(wSlotTick >> (byLvl * CONFIG_SWTIMER_WHEEL_BITS)) & SWTIMER_MASK]);
+	s_hwArmed++;
+}
+
+/** \brief re-distribute one slot of an upper level to the levels below
+ */
+static void apt_swtimer_cascade(uint8_t byLvl, uint32_t wSlot)
+{
+	dlist_t tWork;
+
+	apt_swtimer_splice(&s_tWheel[byLvl][wSlot], &tWork);
+	while(!dlist_empty(&tWork))
+	{
+		csi_swtimer_t *ptTimer = dlist_first_entry(&tWork, csi_swtimer_t, tNode);
+
+		dlist_del(&ptTimer->tNode);
+		s_hwArmed--;
+		apt_swtimer_insert(ptTimer);
+	}
+}
+
+/** \brief one timer reached its expiry tick, called in the tick interrupt
+ */
+static void apt_swtimer_expire(csi_swtimer_t *ptTimer)
+{
+	if(ptTimer->wPeriod)
+	{
+		ptTimer->wExpire += ptTimer->wPeriod;
+		if((int32_t)(ptTimer->wExpire - s_wNow) < 0)				//periods missed(debugger halt...), skip them
+			ptTimer->wExpire += (csi_hwdiv_unsigned_calc(s_wNow - ptTimer->wExpire, ptTimer->wPeriod).wQuot + 1U) * ptTimer->wPeriod;
+		apt_swtimer_insert(ptTimer);
+	}
+
+	if(ptTimer->byCtx == SWTIMER_IN_ISR)
+		ptTimer->callback(ptTimer->pArg);
+	else if(dlist_empty(&ptTimer->tPend))							//not queued yet, an overrun is merged
+		dlist_add_tail(&ptTimer->tPend, &s_tPending);
+}
+
+/** \brief ms to ticks, rounded up, at least one tick
+ */
+static uint32_t apt_swtimer_ms_to_tick(uint32_t wMs)
+{
+	uint32_t wTicks = csi_udiv_fast(wMs, SWTIMER_TICK_MS);
+
+	if(wTicks * SWTIMER_TICK_MS < wMs || wTicks == 0U)
+		wTicks++;
+	return (wTicks > SWTIMER_MAX_TICKS) ? SWTIMER_MAX_TICKS : wTicks;
+}
+
+/** \brief initialize a timer object
+ *
+ *  \param[in] ptTimer: timer object
+ *  \param[in] callback: function called on expiry
+ *  \param[in] pArg: argument of callback
+ *  \param[in] eCtx: where the callback runs \ref csi_swtimer_ctx_e
+ *  \return none
+ */
+void csi_swtimer_init(csi_swtimer_t *ptTimer, csi_swtimer_cb_t callback, void *pArg, csi_swtimer_ctx_e eCtx)
+{
+	dlist_init(&ptTimer->tNode);
+	dlist_init(&ptTimer->tPend);
+	ptTimer->wExpire = 0U;
+	ptTimer->wPeriod = 0U;
+	ptTimer->callback = callback;
+	ptTimer->pArg = pArg;
+	ptTimer->byCtx = (uint8_t)eCtx;
+}
+
+/** \brief (re)start a timer, O(1), ISR safe
+ *
+ *  \param[in] ptTimer: timer object
+ *  \param[in] wTimeMs: time to the first expiry(ms), resolution is one tick
+ *  \param[in] wPeriodMs: period after the first expiry(ms), 0 = one shot
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_swtimer_start(csi_swtimer_t *ptTimer, uint32_t wTimeMs, uint32_t wPeriodMs)
+{
+	uint32_t wTicks, wPeriod, wIrqFlag;
+
+	if(NULL == ptTimer || NULL == ptTimer->callback)
+		return CSI_ERROR;
+
+	wTicks = apt_swtimer_ms_to_tick(wTimeMs);
+	wPeriod = wPeriodMs ? apt_swtimer_ms_to_tick(wPeriodMs) : 0U;
+
+	wIrqFlag = csi_irq_save();
+	if(!s_bInit)
+		apt_swtimer_service_init();
+
+	if(!dlist_empty(&ptTimer->tNode))
+	{
+		dlist_del(&ptTimer->tNode);
+		s_hwArmed--;
+	}
+	ptTimer->wPeriod = wPeriod;
+	ptTimer->wExpire = csi_tick_get() + wTicks;
+	apt_swtimer_insert(ptTimer);
+	csi_irq_restore(wIrqFlag);
+
+	return CSI_OK;
+}
+
+/** \brief stop a timer and drop a queued callback, O(1), ISR safe
+ *
+ *  \param[in] ptTimer: timer object
+ *  \return none
+ */
+void csi_swtimer_stop(csi_swtimer_t *ptTimer)
+{
+	uint32_t wIrqFlag = csi_irq_save();
+
+	if(!dlist_empty(&ptTimer->tNode))
+	{
+		dlist_del(&ptTimer->tNode);
+		dlist_init(&ptTimer->tNode);
+		s_hwArmed--;
+	}
+	if(!dlist_empty(&ptTimer->tPend))
+	{
+		dlist_del(&ptTimer->tPend);
+		dlist_init(&ptTimer->tPend);
+	}
+	csi_irq_restore(wIrqFlag);
+}
+
+/** \brief run the deferred callbacks of expired timers, call it from the main loop
+ *
+ *  \param[in] none
+ *  \return none
+ */
+void csi_swtimer_process(void)
+{
+	csi_swtimer_t *ptTimer;
+	uint32_t wIrqFlag;
+
+	if(!s_bInit)
+		return;
+
+	while(1)
+	{
+		wIrqFlag = csi_irq_save();
+		if(dlist_empty(&s_tPending))
+		{
+			csi_irq_restore(wIrqFlag);
+			break;
+		}
+		ptTimer = dlist_first_entry(&s_tPending, csi_swtimer_t, tPend);
+		dlist_del(&ptTimer->tPend);
+		dlist_init(&ptTimer->tPend);
+		csi_irq_restore(wIrqFlag);
+
+		ptTimer->callback(ptTimer->pArg);						//may restart or stop the timer
+	}
+}
+
+/** \brief advance the wheel up to the current tick, called by the tick interrupt
+ *
+ *  \param[in] none
+ *  \return none
+ */
+void csi_swtimer_tick(void)
+{
+	uint32_t wTick = csi_tick_get();
+	uint32_t wIdx, wSlot;
+	uint8_t byLvl;
+	dlist_t tWork;
+
+	if(!s_bInit)
+		return;
+
+	if(0U == s_hwArmed)											//nothing to expire, e.g. after a tickless sleep
+	{
+		s_wNow = wTick + 1U;
+		return;
+	}
+
+	while((int32_t)(wTick - s_wNow) >= 0)
+	{
+		wIdx = s_wNow & SWTIMER_MASK;
+		if(0U == wIdx)											//level 0 wrapped, pull the next slot of the upper levels down
+		{
+			for(byLvl = 1; byLvl < CONFIG_SWTIMER_WHEEL_LEVELS; byLvl++)
+			{
+				wSlot = (s_wNow >> (byLvl * CONFIG_SWTIMER_WHEEL_BITS)) & SWTIMER_MASK;
+				apt_swtimer_cascade(byLvl, wSlot);
+				if(wSlot)
+					break;
+			}
+		}
+		s_wNow++;
+
+		//periodic timers may land in the same slot again, run from a private list
+		apt_swtimer_splice(&s_tWheel[0][wIdx], &tWork);
+		while(!dlist_empty(&tWork))
+		{
+			csi_swtimer_t *ptTimer = dlist_first_entry(&tWork, csi_swtimer_t, tNode);
+
+			dlist_del(&ptTimer->tNode);
+			dlist_init(&ptTimer->tNode);
+			s_hwArmed--;
+			apt_swtimer_expire(ptTimer);
+		}
+	}
+}
+
+/** \brief ticks until the next timer expires(tickless sleep)
+ *
+ *  Walks all armed timers, only meant for the decision before a sleep.
+ *
+ *  \param[in] none
+ *  \return ticks, 0 = expired/deferred callbacks waiting, 0xFFFFFFFF = no timer
+ */
+uint32_t csi_swtimer_idle_ticks(void)
+{
+	uint32_t wTick = csi_tick_get();
+	uint32_t wMin = 0xFFFFFFFFU;
+	uint32_t wIrqFlag;
+	dlist_t *ptNode;
+	uint8_t i, j;
+
+	if(!s_bInit)
+		return wMin;
+
+	wIrqFlag = csi_irq_save();
+	if(!dlist_empty(&s_tPending))
+		wMin = 0U;
+
+	for(i = 0; i < CONFIG_SWTIMER_WHEEL_LEVELS && wMin; i++)
+	{
+		for(j = 0; j < SWTIMER_SLOTS && wMin; j++)
+		{
+			dlist_for_each(ptNode, &s_tWheel[i][j])
+			{
+				int32_t nLeft = (int32_t)(dlist_entry(ptNode, csi_swtimer_t, tNode)->wExpire - wTick);
+
+				if(nLeft <= 0)
+				{
+					wMin = 0U;
+					break;
+				}
+				if((uint32_t)nLeft < wMin)
+					wMin = (uint32_t)nLeft;
+			}
+		}
+	}
+	csi_irq_restore(wIrqFlag);
+
+	return wMin;
+}
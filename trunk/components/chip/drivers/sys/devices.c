@@ -70,36 +70,37 @@
 //    {0, 0, 0, 0}
 //};
 
-const csi_irqmap_t irq_map[] = {
+/// IRQ number + 1 of each apb slot, looked up by csi_irq_num(); CORET is handled there
+#define IRQ_SLOT(base)		(((base) - APB_PERI_BASE) >> 12)
+
+const uint8_t irq_slot_map[IRQ_SLOT_NUM] = {
 	
-	{CK801_ADDR_BASE,			CORET_IRQn		},
-    {APB_SYS_BASE,				SYSCON_IRQn		},
-    {APB_IFC_BASE,              IFC_IRQn		},
-    {APB_ADC0_BASE,             ADC_IRQn		},
-    {APB_EPT0_BASE,           	EPT0_IRQn		},
-    {APB_WWDT_BASE,           	WWDT_IRQn		},
-    {APB_GPTA0_BASE,           	GPT0_IRQn		},
+    [IRQ_SLOT(APB_SYS_BASE)]	= SYSCON_IRQn + 1,
+    [IRQ_SLOT(APB_IFC_BASE)]	= IFC_IRQn + 1,
+    [IRQ_SLOT(APB_ADC0_BASE)]	= ADC_IRQn + 1,
+    [IRQ_SLOT(APB_EPT0_BASE)]	= EPT0_IRQn + 1,
+    [IRQ_SLOT(APB_WWDT_BASE)]	= WWDT_IRQn + 1,
+    [IRQ_SLOT(APB_GPTA0_BASE)]	= GPT0_IRQn + 1,
 #if defined(IS_CHIP_102) || defined(IS_CHIP_1021) || defined(IS_CHIP_1022) || defined(IS_CHIP_1023)
-    {APB_RTC_BASE,           	RTC_IRQn		},
+    [IRQ_SLOT(APB_RTC_BASE)]	= RTC_IRQn + 1,
 #endif
-    {APB_UART0_BASE,           	UART0_IRQn		},
+    [IRQ_SLOT(APB_UART0_BASE)]	= UART0_IRQn + 1,
 #if defined(IS_CHIP_1023)
-    {APB_UART1_BASE,            UART1_IRQn		},
+    [IRQ_SLOT(APB_UART1_BASE)]	= UART1_IRQn + 1,
 #endif
-	{APB_UART2_BASE,           	UART2_IRQn		},
-    {APB_I2C0_BASE,             I2C_IRQn		},
-    {APB_SPI0_BASE,             SPI_IRQn		},
+	[IRQ_SLOT(APB_UART2_BASE)]	= UART2_IRQn + 1,
+    [IRQ_SLOT(APB_I2C0_BASE)]	= I2C_IRQn + 1,
+    [IRQ_SLOT(APB_SPI0_BASE)]	= SPI_IRQn + 1,
 #if defined(IS_CHIP_102) || defined(IS_CHIP_1023)
-    {APB_SIO0_BASE,             SIO_IRQn		},
+    [IRQ_SLOT(APB_SIO0_BASE)]	= SIO_IRQn + 1,
 #endif
-    {APB_CNTA_BASE,            	CNTA_IRQn		},
+    [IRQ_SLOT(APB_CNTA_BASE)]	= CNTA_IRQn + 1,
 #if defined(IS_CHIP_1021) || defined(IS_CHIP_1023)
-    {APB_TKEY_BASE,             TKEY_IRQn		},
+    [IRQ_SLOT(APB_TKEY_BASE)]	= TKEY_IRQn + 1,
 #endif
-    {APB_LPT_BASE,            	LPT_IRQn		},
-    {APB_BT0_BASE,              BT0_IRQn		},
-	{APB_BT1_BASE,              BT1_IRQn		},
-    {0,  						0				}
+    [IRQ_SLOT(APB_LPT_BASE)]	= LPT_IRQn + 1,
+    [IRQ_SLOT(APB_BT0_BASE)]	= BT0_IRQn + 1,
+	[IRQ_SLOT(APB_BT1_BASE)]	= BT1_IRQn + 1,
 };
 
 const csi_clkmap_t clk_map[] = {
@@ -13,8 +13,6 @@
 #include <stdbool.h>
 #include <irq.h>
 
-extern csi_irqmap_t irq_map[];
-
 /** \brief irq enable
  * 
  *  Enable irq in INTERRUPT
@@ -24,18 +22,10 @@ extern csi_irqmap_t irq_map[];
  */
 void csi_irq_enable(uint32_t *pIpBase)
 {
-	csi_irqmap_t *ptMap = irq_map;
-
-    while(ptMap->wRegBase) 
-	{
-        if((uint32_t)pIpBase == ptMap->wRegBase) 
-		{
-			csi_vic_enable_irq((int32_t)ptMap->wIrqNum);
-            break;
-        }
-		
-        ptMap++;
-    }
+	int32_t iIrqNum = csi_irq_num(pIpBase);
+	
+	if(iIrqNum >= 0)
+		csi_vic_enable_irq(iIrqNum);
 	
 //	switch((uint32_t)pIpBase)
 //	{
@@ -110,18 +100,10 @@ void csi_irq_enable(uint32_t *pIpBase)
  */
 void csi_irq_disable(uint32_t *pIpBase)
 {
-	csi_irqmap_t *ptMap = irq_map;
-
-    while(ptMap->wRegBase) 
-	{
-        if((uint32_t)pIpBase == ptMap->wRegBase) 
-		{
-			csi_vic_disable_irq((int32_t)ptMap->wIrqNum);
-            break;
-        }
-		
-        ptMap++;
-    }
+	int32_t iIrqNum = csi_irq_num(pIpBase);
+	
+	if(iIrqNum >= 0)
+		csi_vic_disable_irq(iIrqNum);
 	
 //	switch((uint32_t)pIpBase)
 //	{
@@ -187,6 +169,56 @@ void csi_irq_disable(uint32_t *pIpBase)
 //	}
 }
 
+/** \brief irq attach
+ * 
+ *  Install the handler called by do_irq for an irq
+ * 
+ *  \param[in] irq_num: number of IRQ
+ *  \param[in] irq_handler: irq handler, NULL = detach
+ *  \param[in] pArg: context passed to irq_handler
+ *  \return none.
+ */
+void csi_irq_attach(uint32_t irq_num, csi_irq_handler_t irq_handler, void *pArg)
+{
+	uint32_t wIrqSta;
+	
+	if(irq_num >= CONFIG_IRQ_NUM)
+		return;
+	
+	wIrqSta = csi_irq_save();							//handler and context change together
+	g_tIrqVector[irq_num].handler = irq_handler;
+	g_tIrqVector[irq_num].pArg = pArg;
+	csi_irq_restore(wIrqSta);
+}
+
+/** \brief irq detach
+ * 
+ *  \param[in] irq_num: number of IRQ
+ *  \return none.
+ */
+void csi_irq_detach(uint32_t irq_num)
+{
+	csi_irq_attach(irq_num, NULL, NULL);
+}
+
+/** \brief common entry of the external interrupt vectors
+ * 
+ *  The vector number in PSR indexes g_tIrqVector directly. An irq without
+ *  handler is disabled, otherwise it would fire again at once.
+ * 
+ *  \return none.
+ */
+void do_irq(void)
+{
+	uint32_t wIrqNum = ((__get_PSR() >> 16) - 32) & (CONFIG_IRQ_NUM - 1);
+	csi_irq_vector_t *ptVector = &g_tIrqVector[wIrqNum];
+	
+	if(ptVector->handler)
+		ptVector->handler(ptVector->pArg);
+	else
+		csi_vic_disable_irq((int32_t)wIrqNum);
+}
+
 //void soc_irq_enable(uint32_t irq_num)
 //{
 //#ifdef CONFIG_SYSTEM_SECURE
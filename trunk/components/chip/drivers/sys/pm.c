@@ -9,11 +9,18 @@
  * *********************************************************************
 */
 
+#include <sys_clk.h>
 #include <drv/common.h>
+#include <drv/tick.h>
+#include <drv/irq.h>
+#include <drv/hwdiv.h>
 #include <csp_syscon.h>
+#include <csp.h>
 #include <soc.h>
 #include "pm.h"
 
+static bool s_bTickless = false;
+
 #ifdef CONFIG_USER_PM
 /// to make user defined prepaare_to_stop() and wkup_frm_stop() possible
 pm_core_t g_tPmCore;
@@ -60,6 +67,113 @@ static csi_error_t apt_sleep(csi_pm_mode_e eMode)
 	}
 	return ret;
 }
+/** \brief start LPT as a one shot wakeup timer on ISOSC, it keeps running in deepsleep
+ * 
+ *  \param[in] wMs: sleep time, not more than CONFIG_PM_TICKLESS_MAX_MS
+ *  \return prescaler shift in use
+ */
+static uint8_t apt_tickless_lpt_start(uint32_t wMs)
+{
+	uint32_t wCnt = ISOSC_VALUE / 1000U * wMs;
+	uint8_t byPsc = LPT_PSC_DIV1;
+	
+	while((wCnt >> byPsc) > 0xFFFFU && byPsc < LPT_PSC_DIV4096)
+		byPsc++;
+	
+	csi_clk_enable((uint32_t *)LPT);
+	csp_lpt_soft_rst(LPT);
+	csp_lpt_clk_enable(LPT, ENABLE);
+	csp_lpt_set_clk(LPT, LPT_ISCLK, (lpt_pscdiv_e)byPsc);
+	csp_lpt_set_opmd(LPT, LPT_OPM_ONCE);
+	csp_lpt_set_prdr(LPT, (uint16_t)(wCnt >> byPsc));
+	csp_lpt_clr_all_int(LPT);
+	csp_lpt_int_enable(LPT, LPT_PEND_INT, ENABLE);
+	csi_irq_enable((uint32_t *)LPT);
+	
+	csp_lpt_sw_start(LPT);
+	csp_lpt_set_start_im_enable(LPT, ENABLE);
+	return byPsc;
+}
+
+/** \brief stop LPT and convert the time it ran to us
+ * 
+ *  \param[in] byPsc: prescaler shift returned by apt_tickless_lpt_start
+ *  \return slept time(us)
+ */
+static uint32_t apt_tickless_lpt_stop(uint8_t byPsc)
+{
+	uint32_t wCnt;
+	hwdiv_urslt_t tSec;
+	
+	if(csp_lpt_get_work_state(LPT))						//woken up early
+		wCnt = csp_lpt_get_cnt(LPT);
+	else												//one shot expired
+		wCnt = csp_lpt_get_prdr(LPT);
+	
+	csp_lpt_stop(LPT);
+	csp_lpt_clr_all_int(LPT);
+	
+	wCnt <<= byPsc;
+	tSec = csi_hwdiv_unsigned_calc(wCnt, ISOSC_VALUE);
+	//1000000 = 125000 * 8, keeps wRem * 125000 inside 32 bit
+	return tSec.wQuot * 1000000U + (tSec.wRem * 125000U / ISOSC_VALUE) * 8U;
+}
+
+/** \brief sleep with the tick interrupt off until the next software deadline
+ * 
+ *  Interrupts stay masked from the idle check until the tick is resumed.
+ *  A pending interrupt still ends wait/stop with PSR.IE cleared, so an IRQ
+ *  that arms a timer after csi_tick_idle_ms() can not be slept through;
+ *  its handler runs at csi_irq_restore, with the tick already corrected.
+ * 
+ *  \param[in] eMode: low power mode
+ *  \return error code
+ */
+static csi_error_t apt_tickless_sleep(csi_pm_mode_e eMode)
+{
+	csi_error_t ret;
+	uint32_t wIrqFlag = csi_irq_save();
+	uint32_t wIdleMs = csi_tick_idle_ms();
+	uint8_t byPsc;
+	
+	if(wIdleMs < CONFIG_PM_TICKLESS_MIN_MS)				//not worth it, sleep with the tick
+	{
+		ret = apt_sleep(eMode);
+		csi_irq_restore(wIrqFlag);
+		return ret;
+	}
+	if(wIdleMs > CONFIG_PM_TICKLESS_MAX_MS)
+		wIdleMs = CONFIG_PM_TICKLESS_MAX_MS;
+	
+	csi_tick_suspend();
+	byPsc = apt_tickless_lpt_start(wIdleMs);
+	
+	ret = apt_sleep(eMode);								//LPT or any other pending interrupt ends the sleep
+	
+	csi_tick_resume(apt_tickless_lpt_stop(byPsc));
+	csi_irq_restore(wIrqFlag);
+	
+	return ret;
+}
+
+/**
+  \brief       enable tickless sleep, LPT is reserved as wakeup timer while enabled
+  \param[in]   bEnable    true: csi_pm_enter_sleep stops the tick, false: tick keeps running
+  \return      None.
+*/
+void csi_pm_tickless_enable(bool bEnable)
+{
+	s_bTickless = bEnable;
+	
+	csi_clk_pm_enable(ISOSC_STP, bEnable);				//LPT clock runs in deepsleep
+	csi_pm_config_wakeup_source(WKUP_LPT, bEnable);
+	if(!bEnable)
+	{
+		csp_lpt_stop(LPT);
+		csi_irq_disable((uint32_t *)LPT);
+	}
+}
+
 /**
   \brief       choose the pmu mode to enter
   \param[in]   handle  pmu handle to operate.
@@ -75,7 +189,10 @@ csi_error_t csi_pm_enter_sleep(csi_pm_mode_e eMode)
 			#ifdef CONFIG_USER_PM
 			g_tPmCore.prepare_to_sleep();
 			#endif
-			apt_sleep(PM_MODE_SLEEP);	
+			if(s_bTickless)
+				apt_tickless_sleep(PM_MODE_SLEEP);
+			else
+				apt_sleep(PM_MODE_SLEEP);	
 			#ifdef CONFIG_USER_PM
 			g_tPmCore.wkup_frm_sleep();		
 			#endif
@@ -84,7 +201,10 @@ csi_error_t csi_pm_enter_sleep(csi_pm_mode_e eMode)
 			#ifdef CONFIG_USER_PM
 			g_tPmCore.prepare_to_deepsleep();
 			#endif
-			apt_sleep(PM_MODE_DEEPSLEEP);	
+			if(s_bTickless)
+				apt_tickless_sleep(PM_MODE_DEEPSLEEP);
+			else
+				apt_sleep(PM_MODE_DEEPSLEEP);	
 			#ifdef CONFIG_USER_PM
 			g_tPmCore.wkup_frm_deepsleep();
 			#endif
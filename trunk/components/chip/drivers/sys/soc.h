@@ -456,6 +456,7 @@ typedef enum{
 #define APB_SPI0_BASE  		(APB_PERI_BASE + 0x90000)
 #define APB_I2C0_BASE   	(APB_PERI_BASE + 0xA0000)
 #define APB_SIO0_BASE  		(APB_PERI_BASE + 0xB0000)
+#define IRQ_SLOT_NUM		(((APB_SIO0_BASE - APB_PERI_BASE) >> 12) + 1)	//4K apb slots up to the last peripheral with irq
 //
 #define AHB_GPIO_BASE 		0x60000000
 #define APB_GPIOA0_BASE  	(AHB_GPIO_BASE + 0x0000) 	//A0  
@@ -520,31 +521,7 @@ void Trap3Handler(void) 		__attribute__((isr));
 void PendTrapHandler(void) 		__attribute__((isr));
 
 
-void CORETHandler(void) 		__attribute__((isr));
-void SYSCONIntHandler(void) 	__attribute__((isr));
-void csp_ifc_irq_handler(void) 	__attribute__((isr));
-void ADCIntHandler(void) 		__attribute__((isr));
-void EPT0IntHandler(void) 		__attribute__((isr));
-void WWDTHandler(void) 			__attribute__((isr));
-void EXI0IntHandler(void) 		__attribute__((isr));
-void EXI1IntHandler(void) 		__attribute__((isr));
-void EXI2to3IntHandler(void) 	__attribute__((isr));
-void EXI4to9IntHandler(void) 	__attribute__((isr));
-void EXI10to15IntHandler(void) 	__attribute__((isr));
-void UART0IntHandler(void) 		__attribute__((isr));
-void UART1IntHandler(void) 		__attribute__((isr));
-void UART2IntHandler(void) 		__attribute__((isr));
-void I2CIntHandler(void) 		__attribute__((isr));
-void GPT0IntHandler(void) 		__attribute__((isr));
-void LEDIntHandler(void) 		__attribute__((isr));
-void TKEYIntHandler(void) 		__attribute__((isr));
-void SPI0IntHandler(void) 		__attribute__((isr));
-void SIO0IntHandler(void) 		__attribute__((isr));
-void CNTAIntHandler(void) 		__attribute__((isr));
-void RTCIntHandler(void) 		__attribute__((isr));
-void LPTIntHandler(void) 		__attribute__((isr));
-void BT0IntHandler(void) 		__attribute__((isr));
-void BT1IntHandler(void) 		__attribute__((isr));
+//external interrupts all enter do_irq(irq.h) and are dispatched through g_tIrqVector
 
 
 #ifdef __cplusplus
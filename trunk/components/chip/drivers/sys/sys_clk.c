@@ -15,6 +15,7 @@
 #include "board_config.h"
 
 #include <csp.h>
+#include <drv/tick.h>
 
 
 //extern system_clk_config_t g_tSystemClkConfig[];
@@ -119,6 +120,8 @@ csi_error_t csi_sysclk_config(void)
 	//update wSclk and wPclk in tClkConfig
 	tClkConfig.wSclk = wHFreq;
 	tClkConfig.wPclk = tClkConfig.wSclk/(0x1<<tClkConfig.ePdiv);
+	
+	csi_tick_clk_update();					//keep tick rate and time scales in step with the new clock
 	return ret;
 }
 
@@ -314,4 +317,4 @@ uint32_t soc_get_bt_freq(uint8_t byIdx)
 	}
 	
 	return csi_get_pclk_freq()/(csp_bt_get_pscr(bt_base) + 1);
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -13,65 +13,147 @@
 #include <sys_clk.h>
 #include <drv/tick.h>
 #include <drv/pin.h>
-#include <drv/uart.h>
+#include <drv/hwdiv.h>
+#include <drv/swtimer.h>
 
 /* Private macro------------------------------------------------------*/
 #define __WEAK	__attribute__((weak))
 
 /* externs function---------------------------------------------------*/
-extern void csi_uart_recv_dynamic_scan(uint8_t byIdx);
 
 /* externs variablesr-------------------------------------------------*/
 /* Private variablesr-------------------------------------------------*/
 
 static volatile uint32_t csi_tick = 0U;
-static volatile uint32_t last_time_ms = 0U;
-static volatile uint64_t last_time_us = 0U;
+static volatile uint64_t s_dwTickUs = 0U;		//us at the start of the current tick
+static volatile uint64_t s_dwTickCyc = 0U;		//coret cycles at the start of the current tick
 
+static bool s_bTickInit = false;
+static uint32_t s_wCycPerTick = 0U;				//coret cycles per tick, LOAD + 1
+static uint32_t s_wUsScale = 0U;				//us per coret cycle, Q24
+static uint32_t s_wCycPerMs = 0U;				//coret cycles per ms
+static csi_udiv_t s_tCycPerMs;					//reciprocal of s_wCycPerMs
+static uint32_t s_wTickCarry = 0U;				//coret cycles of the interrupted period while suspended
+
+#define TICK_US_PER_TICK	(1000000U / CONFIG_SYSTICK_HZ)
+#define TICK_RESUME_MIN_CYC	64U							//shortest first period, has to outlast the LOAD update in csi_tick_resume
+
+/** \brief csi_tick doubles as the sequence counter of the snapshot below,
+ *         so it is only ever changed together with the us/cycle bases
+ */
+static inline void apt_tick_advance(void)
+{
+	s_dwTickUs += TICK_US_PER_TICK;
+	s_dwTickCyc += s_wCycPerTick;
+	csi_tick++;
+}
+
+/** \brief consistent view of tick count and coret progress, lock free
+ *
+ *  Retries when the tick ISR ran in between. With interrupts masked by the
+ *  caller the reload is caught through the pending bit instead, the counter
+ *  is then read again so that it belongs to the new period.
+ *
+ *  \param[out] pwTick: tick count
+ *  \param[out] pdwUs: us at the start of that tick, NULL = not needed
+ *  \param[out] pdwCyc: cycles at the start of that tick, NULL = not needed
+ *  \return coret cycles elapsed in that tick
+ */
+static uint32_t apt_tick_snapshot(uint32_t *pwTick, uint64_t *pdwUs, uint64_t *pdwCyc)
+{
+	uint32_t wTick, wElapsed, wWrap;
+	uint32_t wLoad = csi_coret_get_load();
+	uint64_t dwUs, dwCyc;
+
+	do {
+		wTick = csi_tick;
+		dwUs = s_dwTickUs;
+		dwCyc = s_dwTickCyc;
+		wElapsed = wLoad - csi_coret_get_value();
+		wWrap = csi_vic_get_pending_irq(CORET_IRQn);
+		if(wWrap)
+			wElapsed = wLoad - csi_coret_get_value();
+	} while(wTick != csi_tick);
+
+	if(wWrap)
+	{
+		wTick++;
+		dwUs += TICK_US_PER_TICK;
+		dwCyc += s_wCycPerTick;
+	}
+
+	*pwTick = wTick;
+	if(pdwUs)
+		*pdwUs = dwUs;
+	if(pdwCyc)
+		*pdwCyc = dwCyc;
+	return wElapsed;
+}
+
+/** \brief 2^24 * 1000000 / wFreq without a 64 bit division
+ */
+static uint32_t apt_tick_us_scale(uint32_t wFreq)
+{
+	hwdiv_urslt_t tDiv = csi_hwdiv_unsigned_calc(1000000U, wFreq);
+	uint32_t wScale = tDiv.wQuot;
+	uint32_t wRem = tDiv.wRem;
+	uint8_t i;
+
+	for(i = 0; i < 24; i++)
+	{
+		wRem <<= 1;
+		wScale <<= 1;
+		if(wRem >= wFreq)
+		{
+			wRem -= wFreq;
+			wScale |= 1U;
+		}
+	}
+	return wScale;
+}
+
+/** \brief program coret for CONFIG_SYSTICK_HZ and cache the conversion factors
+ */
+static void apt_tick_clk_config(void)
+{
+	uint32_t wFreq = soc_get_coret_freq();
+
+	s_wCycPerTick = wFreq / CONFIG_SYSTICK_HZ;
+	s_wUsScale = apt_tick_us_scale(wFreq);
+	s_wCycPerMs = wFreq / 1000U;
+	if(s_wCycPerMs == 0U)
+		s_wCycPerMs = 1U;
+	csi_udiv_init(&s_tCycPerMs, s_wCycPerMs);
+
+	csi_coret_config(s_wCycPerTick, CORET_IRQn);
+}
 
 void csi_tick_increase(void)
 {
-    csi_tick++;
+    apt_tick_advance();
 }
 
 void tick_irq_handler(void *arg)
 {
     //csi_tick_increase();
     //csi_coret_clear_irq();
-	csi_tick++;
+	apt_tick_advance();
 	CORET->CTRL;
 	
-	//uart receive timeout scan
-	if(g_tUartTran[0].byRecvMode == UART_RX_MODE_INT_DYN)
-		csi_uart_recv_dynamic_scan(0);		//uart0
-		
-	if(g_tUartTran[1].byRecvMode == UART_RX_MODE_INT_DYN)
-		csi_uart_recv_dynamic_scan(1);		//uart1
-	
-	if(g_tUartTran[2].byRecvMode == UART_RX_MODE_INT_DYN)
-		csi_uart_recv_dynamic_scan(2);		//uart1
-	
-//#if defined(CONFIG_UART0_DYNAMIC)
-//	csi_uart_recv_dynamic_scan(0);		//uart0
-//#endif
-//
-//#if defined(CONFIG_UART1_DYNAMIC)
-//	csi_uart_recv_dynamic_scan(1);		//uart1
-//#endif
-//
-//#if defined(CONFIG_UART2_DYNAMIC)
-//	csi_uart_recv_dynamic_scan(2);		//uart2
-//#endif
-
+	//software timers(uart receive timeout scan ...)
+	csi_swtimer_tick();
 }
 
 csi_error_t csi_tick_init(void)
 {
     csi_tick = 0U;
+	s_dwTickUs = 0U;
+	s_dwTickCyc = 0U;
 
     csi_vic_set_prio(CORET_IRQn, 0U);
-    csi_coret_config((soc_get_coret_freq()/ CONFIG_SYSTICK_HZ), CORET_IRQn);
+    apt_tick_clk_config();
     csi_vic_enable_irq((uint32_t)CORET_IRQn);
+	s_bTickInit = true;
 
     return CSI_OK;
 }
@@ -79,6 +161,79 @@ csi_error_t csi_tick_init(void)
 void csi_tick_uninit(void)
 {
     csi_vic_disable_irq((uint32_t)CORET_IRQn);
+	s_bTickInit = false;
+}
+
+void csi_tick_clk_update(void)
+{
+	uint32_t wIrqFlag;
+
+	if(!s_bTickInit)
+		return;
+
+	//restarting coret drops the running period, count it as a full tick to stay monotonic
+	wIrqFlag = csi_irq_save();
+	if(csi_vic_get_pending_irq(CORET_IRQn))
+	{
+		csi_vic_clear_pending_irq(CORET_IRQn);
+		apt_tick_advance();
+	}
+	apt_tick_advance();
+	apt_tick_clk_config();
+	csi_irq_restore(wIrqFlag);
+}
+
+uint32_t csi_tick_idle_ms(void)
+{
+	uint32_t wTicks = csi_swtimer_idle_ticks();
+
+	if(wTicks == 0xFFFFFFFFU)
+		return TICK_IDLE_FOREVER;
+	if(wTicks <= 1U)										//expires within the running tick
+		return 0U;
+	if(wTicks - 1U >= TICK_IDLE_FOREVER / (1000U / CONFIG_SYSTICK_HZ))
+		return TICK_IDLE_FOREVER - 1U;
+
+	//whole ticks only, the running one is partly gone
+	return (wTicks - 1U) * (1000U / CONFIG_SYSTICK_HZ);
+}
+
+void csi_tick_suspend(void)
+{
+	uint32_t wVal;
+
+	CORET->CTRL = 0U;										//stop counting, VAL is frozen
+	wVal = csi_coret_get_value();
+
+	if(csi_vic_get_pending_irq(CORET_IRQn))					//reload the ISR has not seen yet
+	{
+		csi_vic_clear_pending_irq(CORET_IRQn);
+		apt_tick_advance();
+	}
+	//stopped between the 1 -> 0 step and the reload: that period is complete and counted above
+	s_wTickCarry = wVal ? (csi_coret_get_load() - wVal) : 0U;
+}
+
+void csi_tick_resume(uint32_t wSleepUs)
+{
+	uint32_t wMs = csi_udiv_1000(wSleepUs);
+	uint32_t wCyc = s_wTickCarry + wMs * s_wCycPerMs + csi_udiv_1000((wSleepUs - wMs * 1000U) * s_wCycPerMs);
+	hwdiv_urslt_t tTicks = csi_hwdiv_unsigned_calc(wCyc, s_wCycPerTick);
+	uint32_t wFirst = s_wCycPerTick - tTicks.wRem;
+
+	s_dwTickUs += tTicks.wQuot * TICK_US_PER_TICK;
+	s_dwTickCyc += tTicks.wQuot * s_wCycPerTick;
+	csi_tick += tTicks.wQuot;
+	if(wFirst < TICK_RESUME_MIN_CYC)						//would expire before LOAD is restored, round up
+	{
+		apt_tick_advance();
+		wFirst = s_wCycPerTick;
+	}
+
+	//first period shortened by the remainder, so LOAD - VAL already includes it
+	csi_coret_config(wFirst, CORET_IRQn);
+	while(csi_coret_get_value() == 0U);						//wait for the first reload
+	CORET->LOAD = s_wCycPerTick - 1U;						//taken over at the next reload
 }
 
 uint32_t csi_tick_get(void)
@@ -88,39 +243,57 @@ uint32_t csi_tick_get(void)
 
 uint32_t csi_tick_get_ms(void)
 {
-    uint32_t time;
+	uint32_t wTick;
+	uint32_t wElapsed = apt_tick_snapshot(&wTick, NULL, NULL);
 
-    while (1) {
-        time = (csi_tick * (1000U / CONFIG_SYSTICK_HZ)) + ((csi_coret_get_load() - csi_coret_get_value()) / (soc_get_coret_freq() / 1000U));
+	return (wTick * (1000U / CONFIG_SYSTICK_HZ)) + csi_udiv(&s_tCycPerMs, wElapsed);
+}
 
-        if (time >= last_time_ms) {
-            break;
-        }
-    }
+uint64_t csi_tick_get_us(void)
+{
+	uint32_t wTick;
+	uint64_t dwUs;
+	uint32_t wElapsed = apt_tick_snapshot(&wTick, &dwUs, NULL);
 
-    last_time_ms = time;
-    return time;
+	//coret is 24 bit, wElapsed << 8 can not overflow
+	return dwUs + csi_umulhi(wElapsed << 8, s_wUsScale);
 }
 
-uint64_t csi_tick_get_us(void)
+uint64_t csi_tick_get_cycles(void)
 {
-    uint32_t temp;
-    uint64_t time;
+	uint32_t wTick;
+	uint64_t dwCyc;
+	uint32_t wElapsed = apt_tick_snapshot(&wTick, NULL, &dwCyc);
 
-    while (1) {
-        /* the time of coretim pass */
-        temp = csi_coret_get_load() - csi_coret_get_value();
-        time = ((uint64_t)temp * 1000U) / ((uint64_t)soc_get_coret_freq() / 1000U);
-        /* the time of csi_tick */
-        time += ((uint64_t)csi_tick * (1000000U / CONFIG_SYSTICK_HZ));
-
-        if (time >= last_time_us) {
-            break;
-        }
-    }
+	return dwCyc + wElapsed;
+}
+
+void csi_tick_deadline_start(csi_tick_deadline_t *ptDeadline, uint32_t wMs)
+{
+	uint32_t wCycPerMs = s_wCycPerMs ? s_wCycPerMs : (soc_get_coret_freq() / 1000U);
+
+	if(wMs > 0xFFFFFFFFU / wCycPerMs)
+		wMs = 0xFFFFFFFFU / wCycPerMs;
+	ptDeadline->wLeft = wMs * wCycPerMs;
+	ptDeadline->wLast = csi_coret_get_value();
+}
+
+bool csi_tick_deadline_expired(csi_tick_deadline_t *ptDeadline)
+{
+	uint32_t wCur = csi_coret_get_value();
+	uint32_t wLast = ptDeadline->wLast;
+	uint32_t wElapsed;
 
-    last_time_us = time;
-    return time;
+	//down counter, at most one reload since the last poll
+	wElapsed = (wLast >= wCur) ? (wLast - wCur) : (wLast + csi_coret_get_load() + 1U - wCur);
+	ptDeadline->wLast = wCur;
+	if(wElapsed >= ptDeadline->wLeft)
+	{
+		ptDeadline->wLeft = 0U;
+		return true;
+	}
+	ptDeadline->wLeft -= wElapsed;
+	return false;
 }
 
 static void _500usdelay(void)
@@ -128,7 +301,7 @@ static void _500usdelay(void)
     uint32_t load = csi_coret_get_load();
     uint32_t start = csi_coret_get_value();
     uint32_t cur;
-    uint32_t cnt = (soc_get_coret_freq() / 1000U / 2U);
+    uint32_t cnt = s_wCycPerMs ? (s_wCycPerMs >> 1) : (soc_get_coret_freq() / 1000U / 2U);	//before csi_tick_init: early board init
 
     while (1) {
         cur = csi_coret_get_value();
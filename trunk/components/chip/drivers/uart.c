@@ -14,6 +14,7 @@
 #include <drv/gpio.h>
 #include <drv/pin.h>
 #include <drv/tick.h>
+#include <drv/swtimer.h>
 
 /* Private macro------------------------------------------------------*/
 /* externs function---------------------------------------------------*/
@@ -21,25 +22,21 @@
 /* Private variablesr-------------------------------------------------*/
 csi_uart_trans_t g_tUartTran[UART_IDX_NUM];	
 static uint32_t s_wCtrlRegBack = 0;	
+static csi_swtimer_t s_tUartDynTimer[UART_IDX_NUM];			//dynamic receive idle scan, armed while data is coming in
 
-/** \brief get uart idx 
+/** \brief get uart idx, the uarts are 4K apart from APB_UART0_BASE
  * 
  *  \param[in] ptUartBase: pointer of uart register structure
  *  \return uart id number(0~2) or error(0xff)
  */ 
-static uint8_t apt_get_uart_idx(csp_uart_t *ptUartBase)
+static inline uint8_t apt_get_uart_idx(csp_uart_t *ptUartBase)
 {
-	switch((uint32_t)ptUartBase)
-	{
-		case APB_UART0_BASE:
-			return 0;
-		case APB_UART1_BASE:
-			return 1;
-		case APB_UART2_BASE:
-			return 2;
-		default:
-			return 0xff;		//error
-	}
+	uint32_t wOfs = (uint32_t)ptUartBase - APB_UART0_BASE;
+	
+	if(wOfs < (UART_IDX_NUM << 12) && !(wOfs & 0xfff))
+		return (uint8_t)(wOfs >> 12);
+	
+	return 0xff;		//error
 }
 /** \brief uart receive a bunch of data, dynamic scan
  * 
@@ -48,55 +45,123 @@ static uint8_t apt_get_uart_idx(csp_uart_t *ptUartBase)
  */ 
 void csi_uart_recv_dynamic_scan(uint8_t byIdx)
 {
-	if(g_tUartTran[byIdx].ptRingBuf->hwDataLen > 0)
+	uint16_t hwDataLen = ringbuffer_len(g_tUartTran[byIdx].ptRingBuf);
+	
+	if(hwDataLen > 0)
 	{
-		if(g_tUartTran[byIdx].hwRxSize == g_tUartTran[byIdx].ptRingBuf->hwDataLen)
+		if(g_tUartTran[byIdx].hwRxSize == hwDataLen)
 		{
 			g_tUartTran[byIdx].hwRxSize = 0;
 			g_tUartTran[byIdx].byRecvStat = UART_STATE_DONE;
 		}
 		else 
-			g_tUartTran[byIdx].hwRxSize = g_tUartTran[byIdx].ptRingBuf->hwDataLen;
+			g_tUartTran[byIdx].hwRxSize = hwDataLen;
+	}
+}
+/** \brief dynamic receive idle timer, one tick period, runs in the tick interrupt
+ * 
+ *  \param[in] pArg: uart id number(0~2)
+ *  \return none
+ */ 
+static void apt_uart_dyn_timeout(void *pArg)
+{
+	uint8_t byIdx = (uint8_t)(uint32_t)pArg;
+	
+	csi_uart_recv_dynamic_scan(byIdx);
+	
+	//frame done or already read, the rx interrupt arms the timer again
+	if(g_tUartTran[byIdx].byRecvStat == UART_STATE_DONE || 0 == ringbuffer_len(g_tUartTran[byIdx].ptRingBuf))
+	{
+		csi_swtimer_stop(&s_tUartDynTimer[byIdx]);
+		if(g_tUartTran[byIdx].byRecvStat != UART_STATE_DONE)
+			g_tUartTran[byIdx].hwRxSize = 0;
+	}
+}
+/** \brief uart rx fifo drain, move all bytes in the rx fifo into the ringbuffer
+ * 
+ *  \param[in] ptUartBase: pointer of uart register structure
+ *  \param[in] ptFifo: pointer of receive ringbuffer
+ *  \return none
+ */ 
+static inline void apt_uart_rx_drain(csp_uart_t *ptUartBase, ringbuffer_t *ptFifo)
+{
+	uint8_t byData;
+	uint16_t hwWrite = ptFifo->hwWrite;									//isr is the only producer
+	
+	while(csp_uart_get_sr(ptUartBase) & UART_RNE)						//rx fifo no empty
+	{
+		byData = csp_uart_get_data(ptUartBase);							//always read, fifo must be emptied to clear the interrupt
+		if((uint16_t)(hwWrite - ptFifo->hwRead) < ptFifo->hwSize)		//ringbuffer full, the byte is dropped
+			ptFifo->pbyBuf[(hwWrite ++) & ptFifo->hwMask] = byData;
 	}
+	
+	ringbuffer_barrier();
+	ptFifo->hwWrite = hwWrite;											//publish all bytes at once
 }
-/** \brief uart interrupt handle function
+/** \brief uart tx fifo fill, move bytes from the tx ringbuffer into the tx fifo until it is full
+ * 
+ *  \param[in] ptUartBase: pointer of uart register structure
+ *  \param[in] ptFifo: pointer of send ringbuffer
+ *  \return true: tx ringbuffer empty, all data has been moved into the tx fifo
+ */ 
+static inline bool apt_uart_tx_fill(csp_uart_t *ptUartBase, ringbuffer_t *ptFifo)
+{
+	uint16_t hwRead = ptFifo->hwRead;									//isr is the only consumer
+	uint16_t hwWrite = ptFifo->hwWrite;
+	
+	ringbuffer_barrier();
+	while(hwRead != hwWrite)
+	{
+		if(!(csp_uart_get_sr(ptUartBase) & UART_TNF))					//tx fifo full
+			break;
+			
+		csp_uart_set_data(ptUartBase, ptFifo->pbyBuf[(hwRead ++) & ptFifo->hwMask]);
+	}
+	
+	ringbuffer_barrier();
+	ptFifo->hwRead = hwRead;
+	
+	return (hwRead == ptFifo->hwWrite);
+}
+/** \brief uart interrupt handle function, attached to UARTx_IRQn with the uart base as context
  * 
  *  \param[in] ptUartBas: pointer of uart register structure
- *  \param[in] byIdx: uart id number(0~2)
  *  \return none
  */ 
-void apt_uart_irqhandler(csp_uart_t *ptUartBase,uint8_t byIdx)
+void apt_uart_irqhandler(csp_uart_t *ptUartBase)
 {
-	switch(csp_uart_get_isr(ptUartBase) & 0x080040)			//get RXFIFO/TXDONE interrupt
+	uint8_t byIdx = apt_get_uart_idx(ptUartBase);
+	uint32_t wIsr = csp_uart_get_isr(ptUartBase);
+	
+	if(wIsr & UART_RXFIFO_INT_S)										//rx fifo interrupt; recommended use RXFIFO interrupt
 	{
-		case UART_RXFIFO_INT_S:								//rx fifo interrupt; recommended use RXFIFO interrupt
+		//drain the whole rx fifo per interrupt, not only one byte
+		apt_uart_rx_drain(ptUartBase, g_tUartTran[byIdx].ptRingBuf);
 		
-			//if(csp_uart_get_sr(ptUartBase) & UART_RNE)	//rx fifo no empty		
-			{
-				//uint8_t byData = csp_uart_get_data(ptUartBase);
-				//ringbuffer_byte_in(g_tUartTran[byIdx].ptRingBuf, byData);
-				if(g_tUartTran[byIdx].ptRingBuf->hwDataLen < g_tUartTran[byIdx].ptRingBuf->hwSize)	//the same as previous line of code 
-				{
-					g_tUartTran[byIdx].ptRingBuf->pbyBuf[g_tUartTran[byIdx].ptRingBuf->hwWrite] = csp_uart_get_data(ptUartBase);
-					g_tUartTran[byIdx].ptRingBuf->hwWrite = (g_tUartTran[byIdx].ptRingBuf->hwWrite + 1) % g_tUartTran[byIdx].ptRingBuf->hwSize;
-					g_tUartTran[byIdx].ptRingBuf->hwDataLen ++;
-				}
-			}
-			break;
-		case UART_TXDONE_INT_S:													//tx send complete; recommended use TXDONE interrupt
+		if(g_tUartTran[byIdx].byRecvMode == UART_RX_MODE_INT_DYN && !csi_swtimer_is_active(&s_tUartDynTimer[byIdx]))
+			csi_swtimer_start(&s_tUartDynTimer[byIdx], 1000U / CONFIG_SYSTICK_HZ, 1000U / CONFIG_SYSTICK_HZ);
+	}
+	
+	if(wIsr & UART_TXFIFO_INT_S)										//tx fifo interrupt; UART_TX_MODE_INT_FIFO
+	{
+		csp_uart_clr_isr(ptUartBase,UART_TXFIFO_INT_S);
+		if(apt_uart_tx_fill(ptUartBase, g_tUartTran[byIdx].ptTxRingBuf))
+		{
+			csp_uart_int_enable(ptUartBase, UART_TXFIFO_INT, false);		//nothing left to send, stop tx fifo interrupt
+			g_tUartTran[byIdx].bySendStat = UART_STATE_DONE;				//send complete
+		}
+	}
+	
+	if(wIsr & UART_TXDONE_INT_S)										//tx send complete; recommended use TXDONE interrupt
+	{
+		csp_uart_clr_isr(ptUartBase,UART_TXDONE_INT_S);						//clear interrupt status
+		g_tUartTran[byIdx].hwTxSize --;
+		g_tUartTran[byIdx].pbyTxData ++;
 		
-			csp_uart_clr_isr(ptUartBase,UART_TXDONE_INT_S);						//clear interrupt status
-			g_tUartTran[byIdx].hwTxSize --;
-			g_tUartTran[byIdx].pbyTxData ++;
-			
-			if(g_tUartTran[byIdx].hwTxSize == 0)		
-				g_tUartTran[byIdx].bySendStat = UART_STATE_DONE;				//send complete
-			else
-				csp_uart_set_data(ptUartBase, *g_tUartTran[byIdx].pbyTxData);	//send data
-				
-			break;
-		default:
-			break;
+		if(g_tUartTran[byIdx].hwTxSize == 0)		
+			g_tUartTran[byIdx].bySendStat = UART_STATE_DONE;				//send complete
+		else
+			csp_uart_set_data(ptUartBase, *g_tUartTran[byIdx].pbyTxData);	//send data
 	}
 }
 /** \brief initialize uart parameter structure
@@ -139,14 +204,19 @@ csi_error_t csi_uart_init(csp_uart_t *ptUartBase, csi_uart_config_t *ptUartCfg)
 	g_tUartTran[byIdx].byRecvMode = ptUartCfg->byRxMode;			
 	g_tUartTran[byIdx].bySendMode = ptUartCfg->byTxMode;
 	
+	if(s_tUartDynTimer[byIdx].callback)									//re-init, unlink the old timer first
+		csi_swtimer_stop(&s_tUartDynTimer[byIdx]);
+	csi_swtimer_init(&s_tUartDynTimer[byIdx], apt_uart_dyn_timeout, (void *)(uint32_t)byIdx, SWTIMER_IN_ISR);
+	
 	//uart databits = 8 and stopbits = 1; fixed, can not be configured 
 	//set (parity/fx fifo = 1_8/fifo enable)
 	s_wCtrlRegBack = (eParity << UART_PARITY_POS) | (FIFO_RX_1_8 << UART_RXFIFO_POS) | (UART_FIFO_EN << UART_FIFO_POS);
 	csp_uart_set_ctrl(ptUartBase, s_wCtrlRegBack);		//set uart ctrl reg 
 	
-	if(ptUartCfg->wInter)
+	if(ptUartCfg->wInter || ptUartCfg->byTxMode == UART_TX_MODE_INT_FIFO)
 	{
-		s_wCtrlRegBack |= ptUartCfg->wInter;
+		//TXFIFO interrupt is enabled by csi_uart_send_async only while the tx ringbuffer holds data
+		s_wCtrlRegBack |= (ptUartCfg->wInter & ~UART_INTSRC_TXFIFO);
 		csp_uart_set_ctrl(ptUartBase, s_wCtrlRegBack);	//enable uart xxx interrupt
 		csi_irq_enable((uint32_t *)ptUartBase);			//enable uart irq			
 	}
@@ -177,17 +247,34 @@ void csi_uart_stop(csp_uart_t *ptUartBase)
  *  \param[in] ptUartBase: pointer of uart register structure
  *  \param[in] ptRingbuf: pointer of receive ringbuf structure
  *  \param[in] pbyRdBuf: pointer of uart receive buffer
- *  \param[in] hwLen: uart receive buffer length
+ *  \param[in] hwLen: uart receive buffer length, a power of two
+ *  \return error code \ref csi_error_t
+ */ 
+csi_error_t csi_uart_set_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyRdBuf,  uint16_t hwLen)
+{
+	uint8_t byIdx = apt_get_uart_idx(ptUartBase);
+	
+	if(!ringbuffer_init(ptRingbuf, pbyRdBuf, hwLen))	//ringbuf = pbyRdBuf, size = hwLen, a power of two
+		return CSI_ERROR;
+	g_tUartTran[byIdx].ptRingBuf = ptRingbuf;		//UARTx ringbuf assignment
+	return CSI_OK;
+}
+/** \brief set uart send buffer and buffer depth, used by UART_TX_MODE_INT_FIFO
+ * 
+ *  \param[in] ptUartBase: pointer of uart register structure
+ *  \param[in] ptRingbuf: pointer of send ringbuf structure
+ *  \param[in] pbyTxBuf: pointer of uart send buffer
+ *  \param[in] hwLen: uart send buffer length, a power of two
  *  \return error code \ref csi_error_t
  */ 
-void csi_uart_set_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyRdBuf,  uint16_t hwLen)
+csi_error_t csi_uart_set_tx_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyTxBuf,  uint16_t hwLen)
 {
 	uint8_t byIdx = apt_get_uart_idx(ptUartBase);
 	
-	ptRingbuf->pbyBuf = pbyRdBuf;					//assignment ringbuf = pbyRdBuf  
-	ptRingbuf->hwSize = hwLen;						//assignment ringbuf size = hwLen 
-	g_tUartTran[byIdx].ptRingBuf = ptRingbuf;		//UARTx ringbuf assignment	
-	ringbuffer_reset(g_tUartTran[byIdx].ptRingBuf);	//init UARTx ringbuf
+	if(!ringbuffer_init(ptRingbuf, pbyTxBuf, hwLen))	//ringbuf = pbyTxBuf, size = hwLen, a power of two
+		return CSI_ERROR;
+	g_tUartTran[byIdx].ptTxRingBuf = ptRingbuf;		//UARTx tx ringbuf assignment
+	return CSI_OK;
 }
 /** \brief uart send character
  * 
@@ -237,21 +324,12 @@ int32_t csi_uart_send(csp_uart_t *ptUartBase, const void *pData, uint16_t hwSize
 			}
 			return i;
 			
-		case UART_TX_MODE_INT:						//return CSI_ERROR or CSI_OK
-			if(hwSize == 0 || byIdx >= UART_IDX_NUM) 
+		case UART_TX_MODE_INT:						//return CSI_ERROR/CSI_BUSY or CSI_OK
+		case UART_TX_MODE_INT_FIFO:
+			if(byIdx >= UART_IDX_NUM) 
 				return CSI_ERROR;
 				
-			g_tUartTran[byIdx].pbyTxData =(uint8_t *)pData;
-			g_tUartTran[byIdx].hwTxSize = hwSize;
-	
-			if(g_tUartTran[byIdx].bySendStat == UART_STATE_SEND)				//uart sending?
-				return CSI_ERROR;
-			else
-			{
-				g_tUartTran[byIdx].bySendStat = UART_STATE_SEND;				//set uart send status, sending
-				csp_uart_set_data(ptUartBase, *g_tUartTran[byIdx].pbyTxData);	//start uart tx,send first byte
-			}
-			return CSI_OK;
+			return csi_uart_send_async(ptUartBase, pData, hwSize);
 			
 		default:
 			return CSI_ERROR;
@@ -264,27 +342,45 @@ int32_t csi_uart_send(csp_uart_t *ptUartBase, const void *pData, uint16_t hwSize
  *  \param[in] pData: pointer to buffer with data to send to uart transmitter.
  *  \param[in] hwSize: number of data to send (byte).
  *  \return  error code \ref csi_error_t
+ *  \note    UART_TX_MODE_INT_FIFO: data is copied into the tx ringbuffer, so it can be queued while
+ *           a transfer is running; CSI_BUSY if the ringbuffer has not enough room for hwSize bytes.
  */
 csi_error_t csi_uart_send_async(csp_uart_t *ptUartBase, const void *pData, uint16_t hwSize)
 {
-	csi_error_t ret = CSI_ERROR;
+	uint32_t wIrqSta;
 	uint8_t byIdx = apt_get_uart_idx(ptUartBase);
+	ringbuffer_t *ptTxFifo = g_tUartTran[byIdx].ptTxRingBuf;
 
 	if(hwSize == 0 || NULL == pData) 
 		return CSI_ERROR;
 	
-	g_tUartTran[byIdx].pbyTxData =(uint8_t *)pData;
-	g_tUartTran[byIdx].hwTxSize = hwSize;
-	
-	if(g_tUartTran[byIdx].bySendStat == UART_STATE_SEND)					//uart sending?
-		ret = CSI_ERROR;
-	else
+	if(g_tUartTran[byIdx].bySendMode == UART_TX_MODE_INT_FIFO)				//queue into tx ringbuffer, txfifo interrupt
 	{
+		if(NULL == ptTxFifo)
+			return CSI_ERROR;
+		
+		if(ringbuffer_avail(ptTxFifo) < hwSize)							//queue whole packet or nothing
+			return CSI_BUSY;
+			
+		ringbuffer_in(ptTxFifo, pData, hwSize);								//lock free, isr is the consumer
+		
+		wIrqSta = csi_irq_save();											//CTRL is also modified by uart isr
 		g_tUartTran[byIdx].bySendStat = UART_STATE_SEND;					//set uart send status, sending
-		csp_uart_set_data(ptUartBase, *g_tUartTran[byIdx].pbyTxData);		//start uart tx,send first byte
+		csp_uart_int_enable(ptUartBase, UART_TXFIFO_INT, true);				//isr fills tx fifo
+		csi_irq_restore(wIrqSta);
+		
+		return CSI_OK;
 	}
 	
-	return ret;
+	if(g_tUartTran[byIdx].bySendStat == UART_STATE_SEND)					//uart sending?
+		return CSI_BUSY;
+	
+	g_tUartTran[byIdx].pbyTxData =(uint8_t *)pData;
+	g_tUartTran[byIdx].hwTxSize = hwSize;
+	g_tUartTran[byIdx].bySendStat = UART_STATE_SEND;						//set uart send status, sending
+	csp_uart_set_data(ptUartBase, *g_tUartTran[byIdx].pbyTxData);			//start uart tx,send first byte
+	
+	return CSI_OK;
 }
 /** \brief receive data from uart, this function is polling(sync).
  * 
@@ -367,9 +463,7 @@ uint16_t csi_uart_receive(csp_uart_t *ptUartBase, void *pData, uint16_t hwSize,
 			 hwRecvNum = ringbuffer_len(g_tUartTran[byIdx].ptRingBuf);
 			if(hwRecvNum)
 			{
-				memcpy(pData, (void *)g_tUartTran[byIdx].ptRingBuf->pbyBuf, hwRecvNum);		//read receive data
-				//ringbuffer_out(g_tUartTran[byIdx].ptRingBuf, pData, hwRecvNum);			//the same as previous line of code 
-				ringbuffer_reset(g_tUartTran[byIdx].ptRingBuf);								//reset ringbuffer	
+				hwRecvNum = ringbuffer_out(g_tUartTran[byIdx].ptRingBuf, pData, hwRecvNum);	//read receive data
 				g_tUartTran[byIdx].byRecvStat = UART_STATE_IDLE;							//set uart receive status for idle				
 			}
 			break;
@@ -435,9 +529,7 @@ int16_t csi_uart_recv_dynamic(csp_uart_t *ptUartBase, void *pData)
 	
 	if(hwRecvNum)
 	{
-		memcpy(pData, (void *)g_tUartTran[byIdx].ptRingBuf->pbyBuf, hwRecvNum);		//read receive data
-		//ringbuffer_out(g_tUartTran[byIdx].ptRingBuf, pData, hwRecvNum);			//the same as previous line of code 
-		ringbuffer_reset(g_tUartTran[byIdx].ptRingBuf);								//reset ringbuffer para
+		hwRecvNum = ringbuffer_out(g_tUartTran[byIdx].ptRingBuf, pData, hwRecvNum);	//read receive data
 		g_tUartTran[byIdx].byRecvStat = UART_STATE_IDLE;							//set uart receive status for idle
 	}
 		
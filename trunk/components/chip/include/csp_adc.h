@@ -266,7 +266,7 @@ typedef enum{
 	ADC12_SEQ12   		= (0x01uL << 28),     
 	ADC12_SEQ13   		= (0x01uL << 29),     
 	ADC12_SEQ14   		= (0x01uL << 30),    
-	ADC12_SEQ15   		= (0x01uL << 30)
+	ADC12_SEQ15   		= (0x01uL << 31)
 }adc_sr_e;
 
 typedef enum{
@@ -627,6 +627,15 @@ static inline void csp_adc_rearm_sync(csp_adc_t *ptAdcBase, adc_sync_e eTrgIn)
 {
 	ptAdcBase->SYNCR |= (0x01 << (eTrgIn + ADC12_REARM_POS));
 }
+static inline void csp_adc_set_sync(csp_adc_t *ptAdcBase, adc_sync_e eTrgIn, adc_evtrg_mode_e eTrgMode)
+{
+	ptAdcBase->SYNCR = (ptAdcBase->SYNCR & ~(0x01ul << (eTrgIn + ADC12_EVTRG_MODE_POS))) |
+		(0x01ul << (eTrgIn + ADC12_SYNCEN_POS)) | ((uint32_t)eTrgMode << (eTrgIn + ADC12_EVTRG_MODE_POS));
+}
+static inline void csp_adc_sync_dis(csp_adc_t *ptAdcBase, adc_sync_e eTrgIn)
+{
+	ptAdcBase->SYNCR &= ~(0x01ul << (eTrgIn + ADC12_SYNCEN_POS));
+}
 
 #endif
 
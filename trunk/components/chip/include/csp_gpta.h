@@ -642,6 +642,14 @@ static inline uint16_t csp_gpta_get_cmpb(csp_gpta_t *ptGptaBase)
 {
 	return (ptGptaBase -> CMPB);
 }
+static inline uint16_t csp_gpta_get_cmpc(csp_gpta_t *ptGptaBase)
+{
+	return (ptGptaBase -> CMPC);
+}
+static inline uint16_t csp_gpta_get_cmpd(csp_gpta_t *ptGptaBase)
+{
+	return (ptGptaBase -> CMPD);
+}
 static inline void csp_gpta_set_prd(csp_gpta_t *ptGptaBase, uint16_t bwVal)
 {
 	ptGptaBase -> PRDR = bwVal;
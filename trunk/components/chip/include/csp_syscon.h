@@ -401,7 +401,7 @@ typedef enum{
 ///EVTRG: event triggger conig reg
 #define TRG_SRC0_3_POS(n)  ((n) << 2)
 #define TRG_SRC0_3_MSK(n)  (0xf << TRG_SRC0_3_POS(n))
-#define TRG_SRC4_5_POS(n)  ((16+(n-4))<<1)
+#define TRG_SRC4_5_POS(n)  (16+(((n)-4)<<1))
 #define TRG_SRC4_5_MSK(n)  (0x3 << TRG_SRC4_5_POS(n))
 
 
@@ -223,5 +223,12 @@ static inline void csp_uart_set_brdiv(csp_uart_t *ptUartBase, uint32_t wVal)
 {
 	ptUartBase->BRDIV = wVal;
 }
+static inline void csp_uart_int_enable(csp_uart_t *ptUartBase, uart_int_e eInt, bool bEnable)
+{
+	if(bEnable)
+		ptUartBase->CTRL |= eInt;
+	else
+		ptUartBase->CTRL &= ~eInt;
+}
 
 #endif
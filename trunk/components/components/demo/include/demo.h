@@ -24,6 +24,9 @@ extern int pin_output_demo(void);
 extern int pin_input_demo(void);
 extern int pin_irq_demo(void);
 
+//capture demo
+extern int capture_demo(void);
+
 //bt demo
 extern int bt_timer_demo(void);
 extern int bt_pwm_demo(void);
@@ -36,18 +39,24 @@ extern int iwdt_irq_demo(void);
 int etcb_one_trg_one_demo(void);
 int etcb_one_trg_more_demo(void);
 int etcb_more_trg_one_demo(void);
+int etcb_graph_demo(void);
 
 //uart demo
 //uart send
 int uart_char_demo(void);
 int uart_send_demo(void);
 int uart_send_intr_demo(void);
+int uart_send_fifo_intr_demo(void);
 //uart receive
 int uart_receive_demo(void);
 int uart_recv_intr_demo(void);
 int uart_recv_dynamic_demo(void);
 int uart_recv_dynamic_demo1(void);
 
+//crc demo
+int crc_demo(void);
+int crc_speed_demo(void);
+
 //adc demo
 //normal mode(no interrupt)
 int adc_samp_oneshot_demo(void);
@@ -55,6 +64,9 @@ int adc_samp_continuous_demo(void);
 //interrupt mode
 int adc_samp_oneshot_int_demo(void);
 int adc_samp_continuous_int_demo(void);
+//stream mode(double buffer)
+int adc_samp_stream_demo(void);
+int adc_samp_timer_demo(void);
 
 //sio demo
 //sio led
@@ -67,6 +79,14 @@ int sio_hdq_recv_wrcmd_demo(void);
 int sio_hdq_send_recv_demo(void);
 int sio_hdq_recv_rdcmd_demo(void);
 
+//ept demo
+int ept_duty_benchmark_demo(void);
+int ept_mc_demo(void);
+
+//foc demo
+int foc_benchmark_demo(void);
+int foc_openloop_demo(void);
+
 //lpt demo
 extern int lpt_timer_demo(void);
 extern int lpt_pwm_demo(void);
@@ -80,6 +100,8 @@ extern void emcm_demo(void);
 //ifc demo
 void ifc_read(void);
 void ifc_program(void);
+int ifc_kv_demo(void);
+int ifc_program_async_demo(void);
 
 //rtc_demo
 void rtc_set_time_demo(void);
@@ -92,6 +114,7 @@ void lp_exi_wakeup_demo(void);
 
 //iic demo
 extern void iic_master_demo(void);
+extern void iic_master_queue_demo(void);
 extern void iic_master_slave_demo(void);
 extern void iic_slave_demo(void);
 
@@ -108,6 +131,7 @@ extern void spi_master_sync_send_sync_receive(void); //主机示例1
 extern void spi_slave_sync_send_sync_receive(void);  //从机示例1
 extern void spi_master_sync_send_async_receive(void);//主机示例2
 extern void spi_slave_async_send_async_receive(void);//从机示例2
+extern int spiflash_driver_demo(void);
 
 //touch demo
 extern void touch_lowpower_demo(void);
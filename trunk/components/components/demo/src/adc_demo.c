@@ -409,3 +409,137 @@ int adc_samp_continuous_int_demo(void)
 	return iRet;
 }
 
+//ADC 双缓冲采样，每块采样深度(每通道采样次数)
+#define		ADC_STREAM_DEPTH	16
+
+static uint16_t	s_hwAdcStreamBuf[2][sizeof(tSeqCfg)/sizeof(tSeqCfg[0]) * ADC_STREAM_DEPTH];
+static volatile uint16_t *s_phwAdcBlk = NULL;
+
+/** \brief ADC采样块回调(中断中执行)，一块写满后ADC继续写另一块
+ *  
+ *  \param[in] phwBlock: 写满的采样块, 平面布局: 通道0 x 深度, 通道1 x 深度 ...
+ */
+static void adc_stream_block(csp_adc_t *ptAdcBase, uint16_t *phwBlock, uint8_t byBlkIdx, void *pArg)
+{
+	s_phwAdcBlk = phwBlock;							//通知主循环处理，下一块写满前有效
+}
+
+/** \brief ADC sample, countinuous mode, double buffered stream
+ *  \brief ADC采样，连续转换模式，双缓冲。采样与数据处理并行，块之间ADC不停止
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int adc_samp_stream_demo(void)
+{
+	int iRet = 0;
+	uint8_t i, j;
+	uint32_t wSum;
+	uint16_t *phwBlk;
+	csi_adc_config_t tAdcConfig;
+	csi_adc_stream_config_t tStreamCfg;
+	
+	//adc 输入管脚配置
+	csi_pin_set_mux(PA09, PA09_ADC_AIN10);				//ADC GPIO作为输入通道
+	csi_pin_set_mux(PA010, PA010_ADC_AIN11);
+	csi_pin_set_mux(PA011, PA011_ADC_AIN12);
+	
+	//adc 参数配置初始化
+	tAdcConfig.byClkDiv = 0x02;							//ADC clk两分频：clk = pclk/2
+	tAdcConfig.bySampHold = 0x06;						//ADC 采样时间： time = 16 + 6 = 22(ADC clk周期)
+	tAdcConfig.byConvMode = ADC_CONV_CONTINU;			//ADC 转换模式： 连续转换；
+	tAdcConfig.byVrefSrc = ADCVERF_VDD_VSS;				//ADC 参考电压： 系统VDD
+	tAdcConfig.wInter = ADC_INTSRC_NONE;				//ADC 中断配置： 由双缓冲采样设置
+	tAdcConfig.ptSeqCfg = (csi_adc_seq_t *)tSeqCfg;		//ADC 采样序列： 具体参考结构体变量 tSeqCfg
+	
+	csi_adc_init(ADC0, &tAdcConfig);							//初始化ADC参数配置	
+	csi_adc_set_seqx(ADC0, tAdcConfig.ptSeqCfg, byChnlNum);		//配置ADC采样序列
+	
+	tStreamCfg.phwBuf = &s_hwAdcStreamBuf[0][0];				//两块连续的采样buffer
+	tStreamCfg.hwDepth = ADC_STREAM_DEPTH;
+	tStreamCfg.byLayout = ADC_LAYOUT_PLANAR;					//每通道数据连续存放
+	tStreamCfg.callback = adc_stream_block;
+	tStreamCfg.pArg = NULL;
+	iRet = csi_adc_stream_start(ADC0, &tStreamCfg);				//启动ADC
+	
+	while(iRet == CSI_OK)
+	{
+		if(s_phwAdcBlk)
+		{
+			phwBlk = (uint16_t *)s_phwAdcBlk;
+			s_phwAdcBlk = NULL;
+			for(i = 0; i < byChnlNum; i++)						//每通道平均值
+			{
+				wSum = 0;
+				for(j = 0; j < ADC_STREAM_DEPTH; j++)
+					wSum += phwBlk[i * ADC_STREAM_DEPTH + j];
+				my_printf("ADC channel %d average: %d \n", i, wSum / ADC_STREAM_DEPTH);
+			}
+		}
+	}
+	
+	return iRet;
+}
+
+/** \brief ADC sample paced by BT1, double buffered stream
+ *  \brief ADC定时采样：BT1周期事件经ETCB触发ADC同步输入0，每100us采样一轮，采样时刻不受中断延迟影响
+ *  \brief 采样序列在16个序列项中重复多轮，ADC中断次数减少为每轮一次的1/4(3通道, 深度16)
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int adc_samp_timer_demo(void)
+{
+	int iRet = 0;
+	uint8_t i, j;
+	uint32_t wSum;
+	uint16_t *phwBlk;
+	csi_adc_config_t tAdcConfig;
+	csi_adc_sampler_config_t tSmplCfg;
+	
+	//adc 输入管脚配置
+	csi_pin_set_mux(PA09, PA09_ADC_AIN10);				//ADC GPIO作为输入通道
+	csi_pin_set_mux(PA010, PA010_ADC_AIN11);
+	csi_pin_set_mux(PA011, PA011_ADC_AIN12);
+	
+	//adc 参数配置初始化，转换模式和序列由定时采样设置
+	tAdcConfig.byClkDiv = 0x02;							//ADC clk两分频：clk = pclk/2
+	tAdcConfig.bySampHold = 0x06;						//ADC 采样时间： time = 16 + 6 = 22(ADC clk周期)
+	tAdcConfig.byConvMode = ADC_CONV_CONTINU;			//ADC 转换模式： 连续转换；
+	tAdcConfig.byVrefSrc = ADCVERF_VDD_VSS;				//ADC 参考电压： 系统VDD
+	tAdcConfig.wInter = ADC_INTSRC_NONE;				//ADC 中断配置： 由定时采样设置
+	tAdcConfig.ptSeqCfg = (csi_adc_seq_t *)tSeqCfg;
+	csi_adc_init(ADC0, &tAdcConfig);
+	
+	tSmplCfg.ptBtBase = BT1;							//BT1 作为采样定时器
+	tSmplCfg.wPeriodUs = 100;							//采样周期100us
+	tSmplCfg.ptSeqCfg = (csi_adc_seq_t *)tSeqCfg;		//一轮采样的通道
+	tSmplCfg.byChNum = byChnlNum;
+	tSmplCfg.byTrgIn = ADC_SYNCEN0;						//ADC 同步输入0
+	tSmplCfg.tStream.phwBuf = &s_hwAdcStreamBuf[0][0];
+	tSmplCfg.tStream.hwDepth = ADC_STREAM_DEPTH;
+	tSmplCfg.tStream.byLayout = ADC_LAYOUT_PLANAR;
+	tSmplCfg.tStream.callback = adc_stream_block;
+	tSmplCfg.tStream.pArg = NULL;
+	iRet = csi_adc_sampler_start(ADC0, &tSmplCfg);		//启动定时采样
+	
+	while(iRet == CSI_OK)
+	{
+		if(s_phwAdcBlk)
+		{
+			phwBlk = (uint16_t *)s_phwAdcBlk;
+			s_phwAdcBlk = NULL;
+			for(i = 0; i < byChnlNum; i++)						//每通道平均值
+			{
+				wSum = 0;
+				for(j = 0; j < ADC_STREAM_DEPTH; j++)
+					wSum += phwBlk[i * ADC_STREAM_DEPTH + j];
+				my_printf("ADC channel %d average: %d \n", i, wSum / ADC_STREAM_DEPTH);
+			}
+			if(csi_adc_stream_get_overrun(ADC0))
+				my_printf("ADC overrun: %d \n", csi_adc_stream_get_overrun(ADC0));
+		}
+	}
+	
+	return iRet;
+}
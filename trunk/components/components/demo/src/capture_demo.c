@@ -0,0 +1,68 @@
+/***********************************************************************//** 
+ * \file  capture_demo.c
+ * \brief  frequency/duty measurement of an input pin with the capture service
+ * \copyright Copyright (C) 2015-2020 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-28 <td>V0.0 <td>ZJY     <td>initial
+ * </table>
+ * *********************************************************************
+*/
+/* Includes ---------------------------------------------------------------*/
+#include <drv/capture.h>
+#include <drv/pin.h>
+#include <drv/etb.h>
+#include <iostring.h>
+#include "demo.h"
+
+/* externs function--------------------------------------------------------*/
+/* externs variablesr------------------------------------------------------*/
+/* Private macro-----------------------------------------------------------*/
+#define CAP_DEMO_SAMPLES	16
+
+/* Private variablesr------------------------------------------------------*/
+static csi_capture_t s_tCap;
+static csi_capture_sample_t s_tCapBuf[CAP_DEMO_SAMPLES];
+
+/** \brief 测量 PA05 输入信号(10Hz~100kHz)的频率与占空比: PA05 双边沿 -> EXI_TRGOUT0 -> ETB -> EPT0 SYNCIN2,
+ *  每 4 个边沿(CMPA~CMPD)一次中断, 平均值每 500ms 由串口打印
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int capture_demo(void)
+{
+	csi_capture_config_t tCapCfg;
+	csi_capture_sample_t tSample;
+	uint32_t wFreq, wCnt;
+	
+	csi_pin_set_mux(PA05, PA05_INPUT);							//PA05 配置为输入
+	csi_pin_irq_mode(PA05, EXI_GRP5, GPIO_IRQ_BOTH_EDGE);		//双边沿事件, 不使能 EXI 中断
+	csi_exi_set_evtrg(0, TRGSRC_EXI5, 0);						//EXI5 -> EXI_TRGOUT0
+	
+	tCapCfg.byTimer   = CAPTURE_EPT0;
+	tCapCfg.byEdge    = CAPTURE_EDGE_BOTH;						//周期与占空比
+	tCapCfg.bySrc     = ETB_EXI_TRGOUT0;
+	tCapCfg.byPin     = PA05;									//启动时读电平, 确定第一个边沿的极性
+	tCapCfg.wMinFreq  = 10;										//最低 10Hz
+	tCapCfg.ptBuf     = s_tCapBuf;
+	tCapCfg.hwBufLen  = CAP_DEMO_SAMPLES;
+	if(csi_capture_init(&s_tCap, &tCapCfg) != CSI_OK)
+		return -1;
+	if(csi_capture_start(&s_tCap) != CSI_OK)
+		return -1;
+	
+	while(1)
+	{
+		wCnt = 0;
+		while(csi_capture_read(&s_tCap, &tSample))				//逐周期样本, 此处只计数
+			wCnt++;
+		
+		wFreq = csi_capture_get_freq(&s_tCap);
+		my_printf("freq %d x0.01Hz, duty %d/32768, %d periods, overrun %d, lost %d\n", wFreq,
+					csi_capture_get_duty_q15(&s_tCap), wCnt, s_tCap.wOverrun, s_tCap.wLost);
+		mdelay(500);
+	}
+	
+	return 0;
+}
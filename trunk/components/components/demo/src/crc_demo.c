@@ -14,6 +14,8 @@
 
 #include "demo.h"
 #include "crc.h"
+#include "tick.h"
+#include "iostring.h"
 
 
 /* private function--------------------------------------------------------*/
@@ -57,4 +59,38 @@ int crc_demo(void)
 	
 	while(1);
 	return iRet;
-}
\ No newline at end of file
+}
+
+/**
+  \brief  CRC Example 2: hardware and software speed
+   *CRC-32 over 16B~4KB of flash(the 4KB SRAM is too small for the buffer), cycles from csi_tick_get_cycles()
+   *output: bytes per 1000 coret cycles for the hardware(word writes) and the software(nibble table) path
+  \return      csi_error_t
+*/
+int crc_speed_demo(void)
+{
+	const uint8_t *pbyData = (const uint8_t *)0x00000100;	//flash, behind the vector table
+	uint32_t wLen, wHwCyc, wSwCyc, wCrcHw, wCrcSw;
+	uint64_t dwStart;
+	int iRet = 0;
+	
+	csi_crc_init();                              //CRC module initialization
+	
+	for(wLen = 16; wLen <= 4096; wLen <<= 1)
+	{
+		dwStart = csi_tick_get_cycles();
+		wCrcHw = csi_crc32_be(0xffffffff, (uint8_t *)pbyData, wLen);
+		wHwCyc = (uint32_t)(csi_tick_get_cycles() - dwStart);
+		
+		dwStart = csi_tick_get_cycles();
+		wCrcSw = csi_crc_soft(CRC_TYPE_CRC32_BE, 0xffffffff, pbyData, wLen);
+		wSwCyc = (uint32_t)(csi_tick_get_cycles() - dwStart);
+		
+		if(wCrcHw != wCrcSw)                         //both paths must agree
+			iRet = -1;
+		
+		my_printf("%d B: hw %d cyc, %d B/kcyc; sw %d cyc, %d B/kcyc\n", wLen, wHwCyc, wLen * 1000 / wHwCyc, wSwCyc, wLen * 1000 / wSwCyc);
+	}
+	
+	return iRet;
+}
@@ -13,11 +13,53 @@
 #include <drv/ept.h>
 #include <drv/pin.h>
 #include "drv/etb.h"
+#include <drv/irq.h>
+#include <drv/gpio.h>
+#include <iostring.h>
 #include "demo.h"
 /* externs function--------------------------------------------------------*/
 /* externs variablesr------------------------------------------------------*/
 /* Private macro-----------------------------------------------------------*/
 /* Private variablesr------------------------------------------------------*/
+static volatile uint8_t s_byEptEvtCnt;
+static uint32_t s_wEptCapVal[4];
+
+/** \brief ept_demo1 中断处理函数, 通过 csi_irq_attach 安装到 EPT0_IRQn
+ * 
+ *  \param[in] pArg: EPT0
+ *  \return none
+ */
+static void ept_capture_irqhandler(void *pArg)
+{
+	csp_ept_t *ptEptBase = (csp_ept_t *)pArg;
+	uint32_t wMisr = csp_ept_get_misr(ptEptBase);
+	
+	if(csp_ept_get_emmisr(ptEptBase) & EPT_INT_EP1)				//紧急状态输入EP1
+	{
+		s_byEptEvtCnt++;
+		csp_ept_clr_emint(ptEptBase, EPT_INT_EP1);
+	}
+	
+	if(wMisr & EPTINT_TRGEV0)
+	{
+		csi_gpio_port_write(GPIOA0, (0x01ul << 2), 0);			//PA02 low, 观察中断时刻
+		s_byEptEvtCnt++;
+		csp_ept_clr_int(ptEptBase, EPTINT_TRGEV0);
+		csi_gpio_port_write(GPIOA0, (0x01ul << 2), 1);			//PA02 high
+	}
+	
+	if(wMisr & EPTINT_CAPLD3)									//4次捕获完成, CMPA~CMPD
+	{
+		s_byEptEvtCnt++;
+		s_wEptCapVal[0] = csp_ept_get_cmpa(ptEptBase);
+		s_wEptCapVal[1] = csp_ept_get_cmpb(ptEptBase);
+		s_wEptCapVal[2] = csp_ept_get_cmpc(ptEptBase);
+		s_wEptCapVal[3] = csp_ept_get_cmpd(ptEptBase);
+		csp_ept_clr_int(ptEptBase, EPTINT_CAPLD3);
+	}
+	
+	csp_ept_clr_int(ptEptBase, wMisr & (EPTINT_CAPLD0 | EPTINT_CAPLD1 | EPTINT_CAPLD2));
+}
 
 
 /** \brief ept
@@ -246,6 +288,7 @@ int ept_demo1(void)
 //------------------------------------------------------------------------------------------------------------------------	
     csi_ept_set_evtrg(EPT0, EPT_TRG_OUT0, EPT_TRGSRC_PE1);    //EP1用trg0输出，经过ETCB  触发sync2 捕获
 	csi_ept_set_sync (EPT0, EPT_TRGIN_SYNCEN2, EPT_TRG_CONTINU,EPT_AUTO_REARM_ZRO);
+	csi_irq_attach(EPT0_IRQn, ept_capture_irqhandler, EPT0);	//替换默认的EPT0中断处理
 	csi_ept_int_enable(EPT0, EPT_INT_TRGEV0,true);	
 	csi_ept_start(EPT0);//start  timer
     while(1){		
@@ -311,5 +354,114 @@ csi_ept_pwmconfig_t tPwmCfg;
 	return iRet;
 }
 
+/** \brief 占空比更新耗时对比(CORET 周期数): 每通道百分比接口 csi_ept_change_ch_duty 与
+ *  Q15 四通道接口 csi_ept_update_duty_q15; 关中断测量, 结果由串口打印
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int ept_duty_benchmark_demo(void)
+{
+	csi_ept_config_t tPwmCfg;
+	uint16_t hwDuty[4] = {0x2000, 0x4000, 0x6000, EPT_DUTY_Q15_MAX};	//25%, 50%, 75%, 100%
+	uint32_t wIrqSta, wStart, wPct, wQ15;
+	
+	memset(&tPwmCfg, 0, sizeof(tPwmCfg));
+	tPwmCfg.byWorkmod       = EPT_WAVE;
+	tPwmCfg.byCountingMode  = EPT_UPDNCNT;
+	tPwmCfg.byOneshotMode   = EPT_OP_CONT;
+	tPwmCfg.byStartSrc      = EPT_SYNC_START;
+	tPwmCfg.byPscld         = EPT_LDPSCR_ZRO;
+	tPwmCfg.byDutyCycle 	= 50;
+	tPwmCfg.wFreq 			= 20000;							//20kHz
+	tPwmCfg.byInter 		= 0;								//no interrupt
+	csi_ept_config_init(EPT0, &tPwmCfg);
+	
+	wIrqSta = csi_irq_save();
+	wStart = csi_coret_get_value();							//CORET 向下计数
+	csi_ept_change_ch_duty(EPT0, EPT_CH_A, 25);
+	csi_ept_change_ch_duty(EPT0, EPT_CH_B, 50);
+	csi_ept_change_ch_duty(EPT0, EPT_CH_C, 75);
+	csi_ept_change_ch_duty(EPT0, EPT_CH_D, 100);
+	csi_ept_global_sw(EPT0);
+	wPct = wStart - csi_coret_get_value();
+	
+	wStart = csi_coret_get_value();
+	csi_ept_update_duty_q15(EPT0, hwDuty);
+	wQ15 = wStart - csi_coret_get_value();
+	csi_irq_restore(wIrqSta);
+	
+	my_printf("4ch duty update: percent %d cycles, q15 %d cycles\n", wPct, wQ15);
+	
+	return 0;
+}
+
+/** \brief 三角波, 相位 0~0xffff -> 占空比(Q15) 0~0x7fff~0
+ * 
+ *  \param[in] hwPhase: 相位
+ *  \return duty in Q15
+ */
+static uint16_t ept_mc_triangle(uint16_t hwPhase)
+{
+	return (hwPhase & 0x8000) ? (uint16_t)~hwPhase : hwPhase;
+}
 
+/** \brief ept_mc_demo 周期回调(每个 PWM 周期 ZRO 时调用): 开环三角波, 三相相差 120°
+ * 
+ *  \param[in] pArg: 每周期的相位增量
+ *  \return none
+ */
+static void ept_mc_period_hook(void *pArg)
+{
+	static uint16_t s_hwPhase;
+	
+	s_hwPhase += (uint16_t)(uint32_t)pArg;
+	csi_ept_mc_update_q15(EPT0, ept_mc_triangle(s_hwPhase),
+							ept_mc_triangle(s_hwPhase + 0x5555),
+							ept_mc_triangle(s_hwPhase + 0xaaaa));
+}
 
+/** \brief 三相电机控制 PWM: 20kHz 中心对齐, 互补输出 500ns 死区, EPI1 高电平封锁六路输出,
+ *  计数器中点(PRD)经 ETB 触发 ADC SYNCIN0, 每周期回调写入三相占空比
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int ept_mc_demo(void)
+{
+	csi_ept_mc_config_t tMcCfg;
+	
+	csi_pin_set_mux(PA015, PA015_EPT_CHAX);
+	csi_pin_set_mux(PA014, PA014_EPT_CHBX);
+	csi_pin_set_mux(PB05, PB05_EPT_CHCX);
+	csi_pin_set_mux(PA012, PA012_EPT_CHAY);
+	csi_pin_set_mux(PA08, PA08_EPT_CHBY);
+	csi_pin_set_mux(PA04, PA04_EPT_CHCY);
+	csi_pin_set_mux(PA013,PA013_EPI1);
+	
+	tMcCfg.wFreq        = 20000;								//20kHz
+	tMcCfg.hwDeadTimeNs = 500;									//死区 500ns
+	tMcCfg.byEbi        = EBI1;									//紧急输入 EPI1
+	tMcCfg.byEbiPol     = EBI_POL_H;
+	tMcCfg.byEmLckmd    = EP_HLCK;								//硬锁止, 软件清除
+	tMcCfg.byEmOut      = EM_OUT_L;								//六路输出拉低
+	tMcCfg.byAdcTrgSrc  = EPT_TRGSRC_PRD;						//计数器中点触发 ADC
+	tMcCfg.byAdcSyncIn  = ETB_ADC_SYNCIN0;						//ADC 序列用 ADCSYNC_IN0, 并 csi_adc_set_sync(ADC0, ADC_SYNCEN0, ...)
+	tMcCfg.pfPeriod     = ept_mc_period_hook;
+	tMcCfg.pArg         = (void *)33;							//65536/33 约 1986 个周期, 电频率约 10Hz
+	if(csi_ept_mc_init(EPT0, &tMcCfg) != CSI_OK)
+		return -1;
+	
+	csi_ept_start(EPT0);
+	while(1)
+	{
+		if(csp_ept_get_emHdlck(EPT0) & EPT_INT_EP0)				//硬锁止, 故障解除后恢复输出
+		{
+			mdelay(10);
+			csp_ept_clr_emHdlck(EPT0, EP0);
+		}
+		mdelay(10);
+	}
+	
+	return 0;
+}
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include <string.h>
 #include "drv/etb.h"
 #include "drv/pin.h"
+#include <iostring.h>
 #include "demo.h"
 /* externs function--------------------------------------------------------*/
 /* externs variablesr------------------------------------------------------*/
@@ -107,5 +108,32 @@ int etcb_more_trg_one_demo(void)
 		
 	iRet = csi_etb_ch_config(ch,&tEtbConfig);	//配置并启动ETB通道
 			
+	return iRet;
+}
+
+/** \brief etcb graph: LPT period -> ADC start, ADC end -> EPT0 sync, EXI0 -> BT0 and EPT0
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int etcb_graph_demo(void)
+{
+	int iRet = 0;
+	static csi_etb_graph_t tGraph;				//图对象, 在释放之前一直有效
+	static const csi_etb_route_t tRoute[] = {	//源 -> 目标, 通道由驱动分配
+		{ETB_LPT_TRGOUT0, ETB_ADC_SYNCIN0},
+		{ETB_ADC_TRGOUT0, ETB_EPT0_SYNCIN0},
+		{ETB_EXI_TRGOUT0, ETB_BT0_SYNCIN0},
+		{ETB_EXI_TRGOUT0, ETB_EPT0_SYNCIN1},
+	};
+	
+	csi_etb_init();								//初始化(使能)ETB
+	iRet = csi_etb_graph_init(&tGraph, tRoute, sizeof(tRoute) / sizeof(tRoute[0]));
+	if(iRet < 0)
+		return -1;								//通道不足或目标已被其他通道占用
+	
+	my_printf("etb graph channels: %d, irqs: %d\n", tGraph.byChMsk, csi_etb_graph_irqs(&tGraph));
+	csi_etb_graph_start(&tGraph);				//同时使能所有通道
+	
 	return iRet;
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+/***********************************************************************//** 
+ * \file  foc_demo.c
+ * \brief  FOC kernels: cycle budget check and open loop SVPWM on EPT0
+ * \copyright Copyright (C) 2015-2020 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-24 <td>V0.0 <td>        <td>initial
+ * </table>
+ * *********************************************************************
+*/
+/* Includes ---------------------------------------------------------------*/
+#include <drv/ept.h>
+#include <drv/pin.h>
+#include <drv/etb.h>
+#include <iostring.h>
+#include "foc.h"
+#include "demo.h"
+
+/* Private macro-----------------------------------------------------------*/
+#define FOC_BENCH_RUNS		8
+
+/** 测量一条语句的 CORET 周期数(CORET 向下计数), 取 FOC_BENCH_RUNS 次中的最小值, 去掉测量本身的开销
+ */
+#define FOC_BENCH(wMin, stmt)	do{											\
+		uint32_t wT0, wCyc, i;												\
+		(wMin) = 0xffffffff;												\
+		for(i = 0; i < FOC_BENCH_RUNS; i++) {								\
+			wT0 = csi_coret_get_value();									\
+			stmt;															\
+			wCyc = wT0 - csi_coret_get_value();								\
+			if(wCyc < (wMin)) (wMin) = wCyc;								\
+		}																	\
+		(wMin) -= s_wBenchOfs;												\
+	}while(0)
+
+/* Private variablesr------------------------------------------------------*/
+static uint32_t s_wBenchOfs;
+
+static void foc_bench_print(const char *pName, uint32_t wCyc, uint32_t wBudget)
+{
+	my_printf("%s: %d cycles, budget %d %s\n", pName, wCyc, wBudget, (wCyc <= wBudget) ? "ok" : "OVER");
+}
+
+/** \brief FOC 内核周期数与预算(FOC_CYC_xxx)对比, 关中断测量, 结果由串口打印
+ * 
+ *  \param[in] none
+ *  \return 超出预算的内核个数
+ */
+int foc_benchmark_demo(void)
+{
+	foc_ab_t tIab = {3000, -12000};
+	foc_albe_t tIalbe, tValbe;
+	foc_dq_t tIdq, tVdq;
+	foc_sincos_t tSc;
+	foc_pi_t tPi;
+	uint16_t hwCmp[3];
+	uint32_t wIrqSta, wCyc, wTotal = 0;
+	int iOver = 0;
+	
+	foc_pi_init(&tPi, 2 << 12, 400, 12, -16000, 16000);
+	
+	wIrqSta = csi_irq_save();
+	s_wBenchOfs = 0;
+	FOC_BENCH(s_wBenchOfs, ;);
+	
+	FOC_BENCH(wCyc, foc_clarke(&tIab, &tIalbe));
+	foc_bench_print("clarke", wCyc, FOC_CYC_CLARKE);
+	iOver += (wCyc > FOC_CYC_CLARKE); wTotal += wCyc;
+	
+	FOC_BENCH(wCyc, foc_sincos(0x2345, &tSc));
+	foc_bench_print("sincos", wCyc, FOC_CYC_SINCOS);
+	iOver += (wCyc > FOC_CYC_SINCOS); wTotal += wCyc;
+	
+	FOC_BENCH(wCyc, foc_park(&tIalbe, &tSc, &tIdq));
+	foc_bench_print("park", wCyc, FOC_CYC_PARK);
+	iOver += (wCyc > FOC_CYC_PARK); wTotal += wCyc;
+	
+	FOC_BENCH(wCyc, tVdq.nD = foc_pi_run(&tPi, 0, tIdq.nD));
+	foc_bench_print("pi", wCyc, FOC_CYC_PI);
+	iOver += (wCyc > FOC_CYC_PI); wTotal += 2 * wCyc;					//d and q
+	tVdq.nQ = 6000;
+	
+	FOC_BENCH(wCyc, foc_ipark(&tVdq, &tSc, &tValbe));
+	foc_bench_print("ipark", wCyc, FOC_CYC_IPARK);
+	iOver += (wCyc > FOC_CYC_IPARK); wTotal += wCyc;
+	
+	FOC_BENCH(wCyc, foc_svpwm(&tValbe, 1200, hwCmp));
+	foc_bench_print("svpwm", wCyc, FOC_CYC_SVPWM);
+	iOver += (wCyc > FOC_CYC_SVPWM); wTotal += wCyc;
+	csi_irq_restore(wIrqSta);
+	
+	my_printf("current loop: %d cycles of %d at 20kHz\n", wTotal, csi_get_pclk_freq() / 20000);
+	
+	return iOver;
+}
+
+/** \brief 开环 SVPWM 周期回调: 电压矢量(Vd = 0, Vq)以固定步长旋转, 比较值直接写入 CMPA~CMPC
+ * 
+ *  \param[in] pArg: 每周期的角度增量
+ *  \return none
+ */
+static void foc_openloop_hook(void *pArg)
+{
+	static uint16_t s_hwTheta;
+	foc_dq_t tVdq = {0, 9000};										//|V| = 0.27 Vdc
+	foc_albe_t tValbe;
+	foc_sincos_t tSc;
+	uint16_t hwCmp[3];
+	
+	s_hwTheta += (uint16_t)(uint32_t)pArg;
+	foc_sincos(s_hwTheta, &tSc);
+	foc_ipark(&tVdq, &tSc, &tValbe);
+	foc_svpwm(&tValbe, (uint16_t)(gEptPrd + 1), hwCmp);
+	csi_ept_mc_update_cmp(EPT0, hwCmp[0], hwCmp[1], hwCmp[2]);
+}
+
+/** \brief 开环 SVPWM: EPT0 电机控制 PWM(20kHz, 500ns 死区, EPI1 封锁), 电频率约 10Hz
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int foc_openloop_demo(void)
+{
+	csi_ept_mc_config_t tMcCfg;
+	
+	csi_pin_set_mux(PA015, PA015_EPT_CHAX);
+	csi_pin_set_mux(PA014, PA014_EPT_CHBX);
+	csi_pin_set_mux(PB05, PB05_EPT_CHCX);
+	csi_pin_set_mux(PA012, PA012_EPT_CHAY);
+	csi_pin_set_mux(PA08, PA08_EPT_CHBY);
+	csi_pin_set_mux(PA04, PA04_EPT_CHCY);
+	csi_pin_set_mux(PA013,PA013_EPI1);
+	
+	tMcCfg.wFreq        = 20000;
+	tMcCfg.hwDeadTimeNs = 500;
+	tMcCfg.byEbi        = EBI1;
+	tMcCfg.byEbiPol     = EBI_POL_H;
+	tMcCfg.byEmLckmd    = EP_HLCK;
+	tMcCfg.byEmOut      = EM_OUT_L;
+	tMcCfg.byAdcTrgSrc  = EPT_TRGSRC_DIS;							//开环, 不采样
+	tMcCfg.byAdcSyncIn  = ETB_ADC_SYNCIN0;
+	tMcCfg.pfPeriod     = foc_openloop_hook;
+	tMcCfg.pArg         = (void *)33;									//65536/33 * 50us 约 0.1s
+	if(csi_ept_mc_init(EPT0, &tMcCfg) != CSI_OK)
+		return -1;
+	
+	csi_ept_start(EPT0);
+	while(1)
+	{
+		if(csp_ept_get_emHdlck(EPT0) & EPT_INT_EP0)
+		{
+			mdelay(10);
+			csp_ept_clr_emHdlck(EPT0, EP0);
+		}
+		mdelay(10);
+	}
+	
+	return 0;
+}
@@ -11,6 +11,7 @@
 
 /* include ----------------------------------------------------------------*/
 #include "ifc.h"
+#include "kvstore.h"
 #include "csp.h"
 #include "iostring.h"
 
@@ -53,4 +54,69 @@ void ifc_program(void)
 		my_printf("program fail!\n");
 	else
 		my_printf("program pass!\n");
+}
+
+/** \brief key-value store示例代码
+ *   		- 每次写入只编程环形区中的下一页，擦写分散到CONFIG_KV_PAGES页
+ *     		- 擦除/编程在IFC中断中完成，写入函数启动后即返回
+ *  \param[in] none
+ *  \return error code
+ */
+int ifc_kv_demo(void)
+{
+	uint32_t wCount = 0;
+	uint16_t hwCali[2] = {0x1234, 0x5678};
+	
+	if (csi_kv_init() != CSI_OK)							//扫描DFLASH，重建RAM索引
+		return -1;
+	
+	csi_kv_get(0, &wCount, sizeof(wCount));				//key0: 上电次数
+	wCount++;
+	csi_kv_set(0, &wCount, sizeof(wCount));				//启动编程后返回，CPU继续运行
+	csi_kv_set(1, hwCali, sizeof(hwCali));				//key1: 校准值，等待上一次编程结束后写入
+	
+	if (csi_kv_flush() != CSI_OK)							//等待编程结束并检查结果
+		my_printf("kv program fail!\n");
+	else
+		my_printf("power on count: %d\n", wCount);
+	
+	return 0;
+}
+
+static csi_ifc_xfer_t s_tImgXfer;
+
+static void ifc_image_done(csi_ifc_xfer_t *ptXfer, csi_error_t eResult)
+{
+	if (eResult != CSI_OK)									//中断中调用，wDone为已校验通过的word数
+		my_printf("image program fail at word %d!\n", ptXfer->wDone);
+}
+
+/** \brief flash异步写操作示例代码(固件升级暂存)
+ *   		- 请求排队后立即返回，擦除/编程/校验在IFC中断中逐页完成
+ *     		- 整页对齐的数据直接写入，不读回原页内容
+ * 			- 使用注意事项：请求及其数据在回调之前必须保持有效
+ *  \param[in] none
+ *  \return error code
+ */
+int ifc_program_async_demo(void)
+{
+	static uint32_t wImage[PFLASH_PAGE_SZ * 2];			//两整页，例如从串口收到的固件
+	uint32_t i;
+	
+	for (i = 0; i < PFLASH_PAGE_SZ * 2; i++)
+		wImage[i] = wWriteData[i & 7];
+	
+	s_tImgXfer.wAddr = 0xf000;								//PFLASH页对齐地址
+	s_tImgXfer.pwData = wImage;
+	s_tImgXfer.wDataNum = PFLASH_PAGE_SZ * 2;
+	s_tImgXfer.callback = ifc_image_done;
+	if (csi_ifc_program_async(IFC, &s_tImgXfer) != CSI_OK)
+		return -1;
+	
+	while (csi_ifc_xfer_busy(&s_tImgXfer))
+	{
+		//控制环路在此继续运行
+	}
+	
+	return (s_tImgXfer.byState == IFC_XFER_DONE) ? 0 : -1;
 }
\ No newline at end of file
@@ -51,6 +51,55 @@ void iic_master_demo(void)
 	}
 }
 
+/**************************************************
+*	队列传输: 多个从机读取在中断里连续完成，主循环不等待
+*	I2C_IRQn 默认由 csi_iic_master_irqhandler(I2C0) 处理(interrupt.c 中的 g_tIrqVector)
+***************************************************/
+static volatile uint8_t s_byXferOk = 0;
+
+static void iic_xfer_done(csi_iic_xfer_t *ptXfer, csi_error_t eResult)
+{
+	if(eResult == CSI_OK)
+		s_byXferOk++;
+}
+
+void iic_master_queue_demo(void)
+{
+	static uint8_t byTemp[2];
+	static uint8_t byAccel[6];
+	static uint8_t byCfg[2] = {0x20, 0x57};
+	static csi_iic_xfer_t tXfer[3] = {
+		{.hwDevAddr = 0x30, .byRegLen = 0, .pbyTxData = byCfg, .hwTxLen = 2},						//write config register
+		{.hwDevAddr = 0x90, .byRegLen = 1, .wRegAddr = 0x00, .pbyRxData = byTemp, .hwRxLen = 2},	//temperature sensor
+		{.hwDevAddr = 0x30, .byRegLen = 1, .wRegAddr = 0xa8, .pbyRxData = byAccel, .hwRxLen = 6, .callback = iic_xfer_done}	//accelerometer XYZ
+	};
+	uint8_t i;
+	
+	csi_pin_output_mode(PA014,GPIO_OPEN_DRAIN);
+	csi_pin_output_mode(PA015,GPIO_OPEN_DRAIN);
+	csi_pin_set_mux(PA014,PA014_I2C_SDA);
+	csi_pin_set_mux(PA015,PA015_I2C_SCL);
+	
+	tIicMasterCfg.byAddrMode = IIC_ADDRESS_7BIT;
+	tIicMasterCfg.byReStart = ENABLE;
+	tIicMasterCfg.bySpeedMode = IIC_BUS_SPEED_FAST;
+	tIicMasterCfg.hwInterrput = I2C_INTSRC_NONE;			//中断由传输队列管理
+	tIicMasterCfg.wSdaTimeout = 0XFFFF;
+	tIicMasterCfg.wSclTimeout = 0XFFFF;
+	csi_iic_master_init(I2C0,&tIicMasterCfg);
+	
+	csi_iic_master_xfer_async(I2C0, &tXfer[0]);
+	while(1)
+	{
+		if(!csi_iic_xfer_busy(&tXfer[2]))					//上一轮完成, 再次提交两个读取
+		{
+			for(i = 1; i < 3; i++)
+				csi_iic_master_xfer_async(I2C0, &tXfer[i]);
+		}
+		mdelay(10);											//CPU 空闲做其他事情
+	}
+}
+
 void iic_master_slave_demo(void)
 {
 	
@@ -84,12 +133,9 @@ void iic_master_slave_demo(void)
 	}
 }
 /**************************************************
-*	作为从机时需要在IIC中断里调用 csi_iic_slave_receive_send（）函数；
+*	作为从机时需要把IIC中断处理函数换成 csi_iic_slave_receive_send（）；
 * 	如下：
-*	void I2CIntHandler(void) 
-*	{
-*		csi_iic_slave_receive_send(I2C0);
-*	}
+*	csi_irq_attach(I2C_IRQn, (csi_irq_handler_t)csi_iic_slave_receive_send, I2C0);
 ***************************************************/
 void iic_slave_demo(void)
 {
@@ -21,6 +21,7 @@
 /* include ----------------------------------------------------------------*/
 #include "spi.h"
 #include "pin.h"
+#include "spiflash.h"
 #include <iostring.h>
 
 /** \brief spi sync mode send buff
@@ -89,9 +90,7 @@
 
 	while(1)
 	{
-		csi_spi_nss_low(PB05);
-		iRet = csi_spi_send_async(SPI0, (void *) bySendData, 8);//send first
-		//csi_spi_nss_high(PB05);  //when async send,put "set nss high" to interrupt
+		iRet = csi_spi_send_async(SPI0, (void *) bySendData, 8);//NSS(PB05) low here, released high in interrupt at the end
 		mdelay(100);		
 		nop;
 	}
@@ -512,5 +511,56 @@ int spi_w25q16jvsiq_write_read(void)
 	{
 		nop;
 	}
+	return iRet;
+}
+
+static csi_spiflash_t s_tSpiFlash;
+static volatile uint8_t s_byEraseDone;
+
+/** \brief spiflash async erase done callback, runs in csi_swtimer_process
+ * 
+ *  \param[in] spiflash: SPIFLASH handle
+ *  \param[in] result: erase result
+ *  \param[in] arg: para
+ *  \return none
+ */
+static void spiflash_erase_done(csi_spiflash_t *spiflash, csi_error_t result, void *arg)
+{
+	s_byEraseDone = (result == CSI_OK) ? 1 : 2;
+}
+
+/** \brief spiflash driver example: probe, async erase, page split program, fast read
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int spiflash_driver_demo(void)
+{
+	int iRet;
+	uint8_t byBuf[32];
+	uint8_t i;
+	csi_spiflash_info_t tInfo;
+	
+	iRet = csi_spiflash_spi_init(&s_tSpiFlash, 0, NULL);		//spi0, PB05 as cs; JEDEC id + SFDP
+	if(iRet < 0)
+		return -1;
+	
+	csi_spiflash_get_flash_info(&s_tSpiFlash, &tInfo);
+	my_printf("flash id:%x size:%d sector:%d page:%d\n", tInfo.flash_id, tInfo.flash_size, tInfo.sector_size, tInfo.page_size);
+	
+	s_byEraseDone = 0;
+	csi_spiflash_erase_async(&s_tSpiFlash, 0x10000, 0x11000, spiflash_erase_done, NULL);	//one 64K block + one 4K sector
+	while(s_byEraseDone == 0)
+	{
+		csi_swtimer_process();								//cpu is free while the flash erases
+	}
+	
+	for(i = 0; i < sizeof(byBuf); i++)
+		byBuf[i] = i;
+	csi_spiflash_program(&s_tSpiFlash, 0x100F0, byBuf, sizeof(byBuf));	//crosses a page boundary
+	
+	memset(byBuf, 0, sizeof(byBuf));
+	iRet = csi_spiflash_read(&s_tSpiFlash, 0x100F0, byBuf, sizeof(byBuf));
+	
 	return iRet;
 }
\ No newline at end of file
@@ -25,7 +25,7 @@
  * 该函数也可放置在主循环里调用，但是如果主循环的一个循环周期时间较长的话，会影响按键的触摸体验。
  *  定时器调用csi_tkey_timer_handler()函数使用方法，以CORET为例：
  * 	system_init()函数下调用的csi_tick_init()函数里，如果csi_vic_enable_irq((uint32_t)CORET_IRQn);该语句被注释掉则需要去掉注释。
- * 	然后在interrupt.c里的CORETHandler中断里调用csi_tkey_timer_handler();注意需要添加相应的头文件。
+ * 	然后在CORET中断处理函数tick_irq_handler()里调用csi_tkey_timer_handler();注意需要添加相应的头文件。
  * 	
  ********************************************/
 void touch_lowpower_demo(void){
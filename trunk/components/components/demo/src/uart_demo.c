@@ -22,6 +22,8 @@
 
 ringbuffer_t g_tRingbuf;						//循环buffer
 uint8_t 	 g_byRxBuf[UART_RECV_MAX_LEN];		//接收缓存
+ringbuffer_t g_tTxRingbuf;						//发送循环buffer
+uint8_t 	 g_byTxBuf[256];					//发送缓存，长度建议为2的幂
 
 /** \brief uart char receive and send 
  *  \brief 串口接收/发送一个字符，轮询方式
@@ -152,6 +154,46 @@ int uart_send_intr_demo(void)
 	return iRet;
 }
 
+/** \brief uart send a bunch of data; tx fifo interrupt mode, data queued in tx ringbuf
+ *  \brief 串口发送一串数据，TX使用TXFIFO中断，每次中断填满硬件FIFO；发送中可继续写入发送ringbuf
+ * 
+ *  \param[in] none
+ *  \return error code
+ */
+int uart_send_fifo_intr_demo(void)
+{
+	int iRet = 0;
+	uint8_t bySendData[20]={1,2,3,4,5,6,7,8,9,21,22,23,24,25,26,27,28,29};
+	csi_uart_config_t tUartConfig;				//UART1 参数配置结构体
+	
+	csi_pin_set_mux(PA013, PA013_UART1_RX);		//UART1 RX管脚配置
+	csi_pin_set_mux(PB00, PB00_UART1_TX);		//UART1 TX管脚配置
+	csi_pin_pull_mode(PA013,GPIO_PULLUP);		//RX管脚上拉使能, 建议配置
+	
+	//发送缓存配置，实例化发送ringbuf，将ringbuf发送数据缓存指向用户定义的的发送buffer(g_byTxBuf)
+	csi_uart_set_tx_buffer(UART1, &g_tTxRingbuf, g_byTxBuf, sizeof(g_byTxBuf));
+	
+	tUartConfig.byParity = UART_PARITY_ODD;		//校验位，奇校验
+	tUartConfig.wBaudRate = 115200;				//波特率，115200
+	tUartConfig.wInter = UART_INTSRC_NONE;		//TXFIFO中断由驱动在有数据发送时打开，无需配置
+	tUartConfig.byTxMode = UART_TX_MODE_INT_FIFO;//发送模式：TXFIFO中断模式
+	tUartConfig.byRxMode = UART_RX_MODE_POLL;	//接收模式：轮询模式
+	
+	csi_uart_init(UART1, &tUartConfig);			//初始化串口
+	csi_uart_start(UART1);
+
+	while(1)
+	{
+		//数据拷贝到发送ringbuf后立即返回；ringbuf空间不足时返回CSI_BUSY，整包不写入
+		if(csi_uart_send_async(UART1, (void *)bySendData, 16) == CSI_BUSY)
+			mdelay(1);
+		
+		//TODO
+	}
+	
+	return iRet;
+}
+
 /** \brief uart receive a bunch of data; polling(sync) mode
  *  \brief 串口接收指定长度数据，RX使用轮询(不使用中断)，带超时处理(单位：ms)
  * 
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015-2021 @ APTCHIP
+ */
+
+/******************************************************************************
+ * @file     dlog.h
+ * @brief    deferred(tokenised) logging on the console
+ * @version  V1.0
+ * @date     2021-06-10
+ ******************************************************************************/
+
+#ifndef _DLOG_H_
+#define _DLOG_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * DLOG("speed %d rpm, iq %f\n", hwSpeed, DLOG_F(fIq));
+ *
+ * The format string is not formatted nor sent by the target. It is placed in
+ * the non-loaded section .dlog (see gcc_flash.ld), its offset there is the id.
+ * The call site sends one frame with the id and the raw argument words through
+ * console_try_write(), console/tools/dlog_decode.py rebuilds the text from the elf.
+ *
+ * frame: 0xC0, number of args, id(u16), args(u32 each); little-endian.
+ * 0xC0 never appears in UTF-8 text, so frames and printf output can share the uart.
+ *
+ * - at most DLOG_MAX_ARGS arguments(checked at compile time), each one 32-bit
+ *   word: integers and pointers are cast to it one by one
+ * - float/double arguments must be wrapped in DLOG_F()
+ * - %s is resolved by the host only for strings in flash(const)
+ * - CONFIG_DLOG = 0 turns every DLOG into a printf
+ */
+#ifndef CONFIG_DLOG
+#define CONFIG_DLOG				1
+#endif
+
+#define DLOG_MAX_ARGS			6
+#define DLOG_FRAME_SYNC			0xC0
+
+#if (CONFIG_DLOG)
+
+#define DLOG(fmt, ...)	do { \
+	static const char s_achDlogFmt[] __attribute__((section(".dlog"), used)) = fmt; \
+	_Static_assert(DLOG_NARGS(__VA_ARGS__) <= DLOG_MAX_ARGS, "DLOG: more than DLOG_MAX_ARGS arguments"); \
+	const uint32_t wDlogArgs[DLOG_MAX_ARGS + 1] = { 0 DLOG_WORDS(DLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__) }; \
+	dlog_put((uint16_t)DLOG_WORD(s_achDlogFmt), DLOG_NARGS(__VA_ARGS__), &wDlogArgs[1]); \
+} while(0)
+
+#define DLOG_F(x)		dlog_float_word(x)
+
+#else
+
+#define DLOG(fmt, ...)	printf(fmt, ##__VA_ARGS__)
+#define DLOG_F(x)		((double)(x))
+
+#endif
+
+/// number of macro arguments, counts past DLOG_MAX_ARGS so that DLOG can reject too many
+#define DLOG_NARGS(...)	DLOG_NARGS_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, n, ...)	n
+
+/// one argument word, pointers included(no -Wint-conversion)
+#define DLOG_WORD(x)	((uint32_t)(uintptr_t)(x))
+
+/// ", word, word..." for n = DLOG_NARGS arguments, each one through DLOG_WORD
+#define DLOG_WORDS(n, ...)			DLOG_WORDS_(n, ##__VA_ARGS__)
+#define DLOG_WORDS_(n, ...)			DLOG_WORDS_##n(__VA_ARGS__)
+#define DLOG_WORDS_0(...)
+#define DLOG_WORDS_1(a)				, DLOG_WORD(a)
+#define DLOG_WORDS_2(a, ...)		, DLOG_WORD(a) DLOG_WORDS_1(__VA_ARGS__)
+#define DLOG_WORDS_3(a, ...)		, DLOG_WORD(a) DLOG_WORDS_2(__VA_ARGS__)
+#define DLOG_WORDS_4(a, ...)		, DLOG_WORD(a) DLOG_WORDS_3(__VA_ARGS__)
+#define DLOG_WORDS_5(a, ...)		, DLOG_WORD(a) DLOG_WORDS_4(__VA_ARGS__)
+#define DLOG_WORDS_6(a, ...)		, DLOG_WORD(a) DLOG_WORDS_5(__VA_ARGS__)
+#define DLOG_WORDS_7(...)							//7..12 are rejected by the _Static_assert in DLOG
+#define DLOG_WORDS_8(...)
+#define DLOG_WORDS_9(...)
+#define DLOG_WORDS_10(...)
+#define DLOG_WORDS_11(...)
+#define DLOG_WORDS_12(...)
+
+/** 
+  \brief  bit pattern of a float, passed to DLOG for %f/%e/%g
+  \param  [in] fVal: the value
+  \return the IEEE754 single precision word
+  */
+static inline uint32_t dlog_float_word(float fVal)
+{
+	union {
+		float f;
+		uint32_t w;
+	} tVal;
+	
+	tVal.f = fVal;
+	return tVal.w;
+}
+
+/** 
+  \brief  send one log frame, used by DLOG
+  \param  [in] hwId: format string id, offset in section .dlog
+  \param  [in] byArgs: number of argument words
+  \param  [in] pwArgs: argument words
+  \return none
+  \note   callable from isrs; the frame goes through console_try_write, so a full tx
+          ringbuffer drops it(counted by console_get_dropped) whatever the console
+          overflow policy is
+  */
+void dlog_put(uint16_t hwId, uint8_t byArgs, const uint32_t *pwArgs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DLOG_H_ */
@@ -13,6 +13,7 @@
 #define _SYS_CONSOLE_H_
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <soc.h>
 #include "drv/uart.h"
 
@@ -20,6 +21,20 @@
 extern "C" {
 #endif
 
+/// console tx ringbuffer size(power of two), 0: no buffer, every byte is sent by polling
+#ifndef CONFIG_CONSOLE_TXBUF_SIZE
+#define CONFIG_CONSOLE_TXBUF_SIZE	128
+#endif
+
+/// what console_putc does when the tx ringbuffer is full, by default no output is lost;
+/// DROP is opt-in for code that must never wait on the console
+#define CONSOLE_OVERFLOW_DROP		0		//drop the byte and count it, never waits
+#define CONSOLE_OVERFLOW_BLOCK		1		//wait for the uart isr to make room
+
+#ifndef CONFIG_CONSOLE_OVERFLOW
+#define CONFIG_CONSOLE_OVERFLOW		CONSOLE_OVERFLOW_BLOCK
+#endif
+
 typedef struct {
     pin_name_e pin;
     pin_func_e func;
@@ -37,6 +52,68 @@ extern sys_console_t console;
 
 int32_t console_init(sys_console_t *handle);
 
+/**
+  \brief       put one raw byte to the console, no '\n' expansion.
+               buffered: queued into the tx ringbuffer and sent by the uart isr;
+               sync mode: sent by polling after the bytes already queued; no room while
+               interrupts are masked: the oldest queued byte is sent by polling to make room.
+  \param[in]   byData   the byte to send
+  \return      none
+*/
+void console_putc(uint8_t byData);
+
+/**
+  \brief       put a block of raw bytes to the console, queued as a whole or not at all,
+               so it is never interleaved with output of an isr. Same fallbacks as console_putc;
+               with interrupts masked only the bytes the block lacks room for are sent by
+               polling. A block bigger than the tx ringbuffer is queued in chunks of the
+               ringbuffer size, those may interleave with isr output.
+  \param[in]   pData    the bytes to send
+  \param[in]   hwLen    number of bytes
+  \return      bytes queued, less than hwLen when(part of) the block was dropped
+               (CONSOLE_OVERFLOW_DROP)
+*/
+int32_t console_write(const void *pData, uint16_t hwLen);
+
+/**
+  \brief       like console_write, but a block that does not fit into the free part of the
+               tx ringbuffer is always dropped and counted, whatever the overflow policy.
+               Never waits nor polls(except in sync mode), for frames sent from isrs.
+  \param[in]   pData    the bytes to send
+  \param[in]   hwLen    number of bytes
+  \return      hwLen, 0 when the block was dropped
+*/
+int32_t console_try_write(const void *pData, uint16_t hwLen);
+
+/**
+  \brief       wait until everything queued has been moved into the uart tx fifo
+               and the tx fifo is empty.
+  \return      none
+*/
+void console_flush(void);
+
+/**
+  \brief       switch the console to synchronous output, for fault handlers and
+               asserts. Queued bytes are sent first, then every byte is sent by polling.
+  \param[in]   bSync    true: synchronous, false: buffered again
+  \return      none
+*/
+void console_set_sync(bool bSync);
+
+/**
+  \brief       set the tx ringbuffer overflow policy
+  \param[in]   byPolicy CONSOLE_OVERFLOW_DROP/CONSOLE_OVERFLOW_BLOCK
+  \return      none
+*/
+void console_set_overflow(uint8_t byPolicy);
+
+/**
+  \brief       get the number of bytes dropped by CONSOLE_OVERFLOW_DROP
+  \param[in]   bClear   true: clear the counter
+  \return      dropped bytes since init or the last clear
+*/
+uint32_t console_get_dropped(bool bClear);
+
 #ifdef __cplusplus
 }
 #endif
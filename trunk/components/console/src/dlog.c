@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2015-2021 @ APTCHIP
+ */
+
+/******************************************************************************
+ * @file     dlog.c
+ * @brief    deferred(tokenised) logging on the console
+ * @version  V1.0
+ * @date     2021-06-10
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "sys_console.h"
+#include "dlog.h"
+
+void dlog_put(uint16_t hwId, uint8_t byArgs, const uint32_t *pwArgs)
+{
+	uint8_t byFrame[4 + DLOG_MAX_ARGS * 4];
+	
+	if(byArgs > DLOG_MAX_ARGS)
+		byArgs = DLOG_MAX_ARGS;
+	
+	byFrame[0] = DLOG_FRAME_SYNC;
+	byFrame[1] = byArgs;
+	byFrame[2] = (uint8_t)hwId;
+	byFrame[3] = (uint8_t)(hwId >> 8);
+	memcpy(&byFrame[4], pwArgs, byArgs * 4);			//ck801 is little-endian
+	
+	console_try_write(byFrame, 4 + byArgs * 4);			//whole frame or nothing, never waits
+}
@@ -15,8 +15,28 @@
 #include <stdint.h>
 #include <drv/pin.h>
 #include <drv/uart.h>
+#include <csi_core.h>
 #include "sys_console.h"
 
+/*
+ * Buffered console: printf/putchar/fputc queue bytes into s_tConsoleTx and the
+ * uart TXFIFO interrupt moves them into the tx fifo, so a log line costs the
+ * formatting only, not ~87us per byte at 115200.
+ * The uart isr is the only consumer. Producers may be the main loop and isrs,
+ * so queueing runs with interrupts masked for a few instructions.
+ */
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+#if (CONFIG_CONSOLE_TXBUF_SIZE & (CONFIG_CONSOLE_TXBUF_SIZE - 1)) || (CONFIG_CONSOLE_TXBUF_SIZE > RINGBUF_MAX_SIZE)
+#error "CONFIG_CONSOLE_TXBUF_SIZE has to be a power of two"
+#endif
+static ringbuffer_t s_tConsoleTx;
+static uint8_t s_byConsoleTxBuf[CONFIG_CONSOLE_TXBUF_SIZE];
+#endif
+
+static volatile bool s_bConsoleSync = false;
+static uint8_t s_byConsoleOverflow = CONFIG_CONSOLE_OVERFLOW;
+static volatile uint32_t s_wConsoleDropped = 0;
+
 
 int32_t console_init(sys_console_t *handle)
 {
@@ -31,26 +51,218 @@ int32_t console_init(sys_console_t *handle)
 	tUartConfig.byParity = UART_PARITY_NONE;		//no parity
 	tUartConfig.wBaudRate = handle->baudrate;		//115200
 	tUartConfig.wInter = UART_INTSRC_NONE;			//no interrupt		
+	tUartConfig.byRxMode = UART_RX_MODE_POLL;		//fgetc polls
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	tUartConfig.byTxMode = UART_TX_MODE_INT_FIFO;	//tx ringbuffer drained by TXFIFO interrupt
+#else
+	tUartConfig.byTxMode = UART_TX_MODE_POLL;
+#endif
 
     ret = csi_uart_init(handle->uart, &tUartConfig);
 	
 	if(ret < 0)
 		return -1;
 	
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	if(csi_uart_set_tx_buffer(handle->uart, &s_tConsoleTx, s_byConsoleTxBuf, sizeof(s_byConsoleTxBuf)) != CSI_OK)
+		return -1;
+#endif
 	csi_uart_start(handle->uart);
 	
     return ret;
 }
 
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+/** \brief send the queued bytes, then pbyData, by polling(sync mode). Interrupts
+ *  are masked per queued byte only, so the uart isr and this never send the
+ *  same byte and the order is kept.
+ * 
+ *  \param[in] pbyData: the bytes to send after the queued ones
+ *  \param[in] hwLen: number of bytes
+ *  \return none
+ */ 
+static void apt_console_write_sync(const uint8_t *pbyData, uint16_t hwLen)
+{
+	uint32_t wIrqSta;
+	uint8_t byQueued;
+	bool bQueued;
+	
+	do
+	{
+		wIrqSta = csi_irq_save();
+		bQueued = ringbuffer_byte_out(&s_tConsoleTx, &byQueued);
+		if(bQueued)
+			csi_uart_putc(console.uart, byQueued);
+		csi_irq_restore(wIrqSta);
+	}while(bQueued);
+	
+	while(hwLen --)
+		csi_uart_putc(console.uart, *pbyData ++);
+}
+
+/** \brief queue a block that fits into the ringbuffer, as a whole or not at all
+ * 
+ *  No room and interrupts masked by the caller(isr/critical section): the uart
+ *  isr cannot make room, so only as many of the oldest queued bytes as the
+ *  block lacks are sent by polling, not the whole buffer.
+ * 
+ *  \param[in] pbyData: the bytes to queue
+ *  \param[in] hwLen: number of bytes, <= ringbuffer size
+ *  \param[in] byPolicy: CONSOLE_OVERFLOW_DROP/BLOCK
+ *  \return hwLen, 0 when the block was dropped(CONSOLE_OVERFLOW_DROP)
+ */ 
+static uint16_t apt_console_queue(const uint8_t *pbyData, uint16_t hwLen, uint8_t byPolicy)
+{
+	uint32_t wIrqSta = csi_irq_save();
+	uint8_t byQueued;
+	
+	while(ringbuffer_avail(&s_tConsoleTx) < hwLen)
+	{
+		if(byPolicy == CONSOLE_OVERFLOW_DROP)
+		{
+			s_wConsoleDropped += hwLen;
+			csi_irq_restore(wIrqSta);
+			return 0;
+		}
+		
+		if(!(wIrqSta & PSR_IE_Msk))						//called from an isr/critical section
+		{
+			while(ringbuffer_avail(&s_tConsoleTx) < hwLen && ringbuffer_byte_out(&s_tConsoleTx, &byQueued))
+				csi_uart_putc(console.uart, byQueued);
+			break;
+		}
+		
+		csi_irq_restore(wIrqSta);						//block, let the uart isr run
+		wIrqSta = csi_irq_save();
+	}
+	
+	csi_uart_send_async(console.uart, pbyData, hwLen);		//queue, start TXFIFO interrupt
+	csi_irq_restore(wIrqSta);
+	return hwLen;
+}
+#endif
+
+int32_t console_write(const void *pData, uint16_t hwLen)
+{
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	const uint8_t *pbyData = (const uint8_t *)pData;
+	uint16_t hwSize = ringbuffer_size(&s_tConsoleTx);
+	uint16_t hwChunk, hwDone = 0;
+	uint32_t wIrqSta;
+	
+	if(s_bConsoleSync)
+	{
+		apt_console_write_sync(pbyData, hwLen);
+		return hwLen;
+	}
+	
+	//a block bigger than the ringbuffer goes in chunks of its size, interrupts on in between
+	while(hwDone < hwLen)
+	{
+		hwChunk = (hwLen - hwDone > hwSize) ? hwSize : (hwLen - hwDone);
+		if(apt_console_queue(pbyData + hwDone, hwChunk, s_byConsoleOverflow) == 0)
+		{
+			wIrqSta = csi_irq_save();
+			s_wConsoleDropped += hwLen - hwDone - hwChunk;		//the rest goes as well
+			csi_irq_restore(wIrqSta);
+			break;
+		}
+		hwDone += hwChunk;
+	}
+	return hwDone;
+#else
+	csi_uart_send(console.uart, pData, hwLen);
+	return hwLen;
+#endif
+}
+
+int32_t console_try_write(const void *pData, uint16_t hwLen)
+{
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	uint32_t wIrqSta;
+	
+	if(s_bConsoleSync)
+	{
+		apt_console_write_sync((const uint8_t *)pData, hwLen);
+		return hwLen;
+	}
+	
+	if(hwLen > ringbuffer_size(&s_tConsoleTx))				//never fits
+	{
+		wIrqSta = csi_irq_save();
+		s_wConsoleDropped += hwLen;
+		csi_irq_restore(wIrqSta);
+		return 0;
+	}
+	return apt_console_queue((const uint8_t *)pData, hwLen, CONSOLE_OVERFLOW_DROP);
+#else
+	csi_uart_send(console.uart, pData, hwLen);
+	return hwLen;
+#endif
+}
+
+void console_putc(uint8_t byData)
+{
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	console_write(&byData, 1);
+#else
+	csi_uart_putc(console.uart, byData);
+#endif
+}
+
+void console_flush(void)
+{
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	uint32_t wIrqSta = csi_irq_save();
+	uint8_t byQueued;
+	
+	if(!(wIrqSta & PSR_IE_Msk))							//uart isr cannot run, send the rest here
+	{
+		while(ringbuffer_byte_out(&s_tConsoleTx, &byQueued))
+			csi_uart_putc(console.uart, byQueued);
+	}
+	csi_irq_restore(wIrqSta);
+	
+	while(!ringbuffer_is_empty(&s_tConsoleTx));
+#endif
+	while(!(csp_uart_get_sr(console.uart) & UART_TFE));
+}
+
+void console_set_sync(bool bSync)
+{
+	s_bConsoleSync = bSync;
+#if (CONFIG_CONSOLE_TXBUF_SIZE > 0)
+	if(bSync)
+		console_flush();
+#endif
+}
+
+void console_set_overflow(uint8_t byPolicy)
+{
+	s_byConsoleOverflow = byPolicy;
+}
+
+uint32_t console_get_dropped(bool bClear)
+{
+	uint32_t wIrqSta = csi_irq_save();
+	uint32_t wDropped = s_wConsoleDropped;
+	
+	if(bClear)
+		s_wConsoleDropped = 0;
+	csi_irq_restore(wIrqSta);
+	
+	return wDropped;
+}
+
 int fputc(int ch, FILE *stream)
 {
     (void)stream;
 
     if (ch == '\n') {
-        csi_uart_putc(console.uart, (uint8_t)'\r');
+        console_putc((uint8_t)'\r');
     }
 
-    csi_uart_putc(console.uart, (uint8_t)ch);
+    console_putc((uint8_t)ch);
 
     return 0;
 }
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Decode DLOG frames in a console capture.
+
+Usage: dlog_decode.py firmware.elf capture.bin
+       dlog_decode.py firmware.elf - < /dev/ttyUSB0
+
+The format strings are read from section .dlog of the elf, %s arguments
+from its loaded sections.  Plain printf text in the capture is passed
+through, frames start with 0xC0 (see console/include/dlog.h).
+"""
+
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xC0
+MAX_ARGS = 6
+
+SPEC = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(?:hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])")
+
+
+class Elf:
+    """Sections of a little-endian ELF32 file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s: not a little-endian ELF32 file" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        hdrs = [struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize)
+                for i in range(shnum)]
+        strtab = hdrs[shstrndx]
+        self.sections = {}
+        for name, typ, flags, addr, off, size, _, _, _, _ in hdrs:
+            end = self.data.index(b"\0", strtab[4] + name)
+            sname = self.data[strtab[4] + name:end].decode()
+            self.sections[sname] = (typ, flags, addr, off, size)
+
+    def section(self, name):
+        typ, _, addr, off, size = self.sections[name]
+        return addr, self.data[off:off + size]
+
+    def cstring(self, addr):
+        """String at a loaded (SHF_ALLOC, not NOBITS) address, None if unknown."""
+        for typ, flags, saddr, off, size in self.sections.values():
+            if flags & 2 and typ != 8 and saddr <= addr < saddr + size:
+                pos = off + addr - saddr
+                end = self.data.find(b"\0", pos, off + size)
+                if end >= 0:
+                    return self.data[pos:end].decode(errors="replace")
+        return None
+
+
+def format_frame(elf, fmts, fid, args):
+    base, blob = fmts
+    ofs = (fid - base) & 0xFFFF
+    if ofs >= len(blob):
+        return "<dlog: unknown id 0x%04x %s>\n" % (fid, " ".join("%08x" % a for a in args))
+    fmt = blob[ofs:blob.index(b"\0", ofs)].decode(errors="replace")
+    args = list(args)
+
+    def word():
+        return args.pop(0) if args else 0
+
+    def conv(m):
+        flags, width, prec, ch = m.groups()
+        if ch == "%":
+            return "%"
+        if width == "*":
+            width = str(struct.unpack("<i", struct.pack("<I", word()))[0])
+        if prec == "*":
+            prec = str(word())
+        spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+        w = word()
+        if ch in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", w))[0]
+        if ch in "uoxX":
+            return (spec + ("d" if ch == "u" else ch)) % w
+        if ch == "c":
+            return (spec + "c") % chr(w & 0xFF)
+        if ch in "fFeEgG":
+            return (spec + ch) % struct.unpack("<f", struct.pack("<I", w))[0]
+        if ch == "p":
+            return "0x%08x" % w
+        s = elf.cstring(w)
+        return (spec + "s") % (s if s is not None else "<0x%08x>" % w)
+
+    return SPEC.sub(conv, fmt)
+
+
+def decode(elf, data, out):
+    fmts = elf.section(".dlog")
+    text = bytearray()
+    pos = 0
+    while pos < len(data):
+        b = data[pos]
+        if b != FRAME_SYNC:
+            if b != 0x0D:
+                text.append(b)
+            pos += 1
+            continue
+        if len(data) - pos < 4 or data[pos + 1] > MAX_ARGS:
+            text.append(b)
+            pos += 1
+            continue
+        n = data[pos + 1]
+        if len(data) - pos < 4 + 4 * n:
+            break
+        fid, = struct.unpack_from("<H", data, pos + 2)
+        args = struct.unpack_from("<%dI" % n, data, pos + 4)
+        out.write(text.decode(errors="replace"))
+        text.clear()
+        out.write(format_frame(elf, fmts, fid, args))
+        pos += 4 + 4 * n
+    out.write(text.decode(errors="replace"))
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    elf = Elf(sys.argv[1])
+    if sys.argv[2] == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(sys.argv[2], "rb") as f:
+            data = f.read()
+    decode(elf, data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -281,6 +281,39 @@ typedef struct {
 
 extern csi_adc_samp_t g_tAdcSamp;
 
+/**
+ * \enum	csi_adc_layout_e
+ * \brief   sample layout of a stream block
+ */
+typedef enum{
+	ADC_LAYOUT_INTERLEAVED	= 0,	//ch0,ch1..chN, ch0,ch1..chN ...(one sequence round after the other)
+	ADC_LAYOUT_PLANAR				//ch0 x depth, ch1 x depth ...(one channel after the other)
+}csi_adc_layout_e;
+
+/// block callback, runs in the adc interrupt, phwBlock stays valid until the other block is full
+typedef void (*csi_adc_stream_cb_t)(csp_adc_t *ptAdcBase, uint16_t *phwBlock, uint8_t byBlkIdx, void *pArg);
+
+/// \struct csi_adc_stream_config_t
+/// \brief  double buffered sequence acquisition
+typedef struct {
+	uint16_t			*phwBuf;		//2 blocks of channel number * hwDepth samples
+	uint16_t			hwDepth;		//sequence rounds per block
+	uint8_t				byLayout;		//\ref csi_adc_layout_e
+	csi_adc_stream_cb_t	callback;		//called when a block is full
+	void				*pArg;			//argument of callback
+} csi_adc_stream_config_t;
+
+/// \struct csi_adc_sampler_config_t
+/// \brief  timer paced acquisition: BT period event -> ETCB -> adc sync input, no cpu per sample
+typedef struct {
+	csp_bt_t			*ptBtBase;		//BT0/BT1, owned by the sampler until csi_adc_sampler_stop
+	uint32_t			wPeriodUs;		//sequence round period(us), at least the conversion time of a round
+	csi_adc_seq_t		*ptSeqCfg;		//channels of one round, byTrgSrc is set by the sampler
+	uint8_t				byChNum;		//channels of one round, 1~16
+	uint8_t				byTrgIn;		//adc sync input the timer event goes to, \ref csi_adc_trgin_e
+	csi_adc_stream_config_t	tStream;	//blocks and callback, hwDepth = rounds per block
+} csi_adc_sampler_config_t;
+
 
 /**
   \brief       Initialize adc Interface. Initialize the resources needed for the adc interface
@@ -461,7 +494,58 @@ void csi_adc_fvrout_enable(csp_adc_t *ptAdcBase, csi_adc_fvrsel_e eLvl, bool bEn
   \return 	   none
  */
 void csi_adc_bufout_enable(csp_adc_t *ptAdcBase, bool bEnable);
+
+/** 
+  \brief 	   start double buffered acquisition of the configured sequence
+  
+  The results of a round are read at the interrupt of the last sequence
+  entry and written to the block being filled; when it is full the callback
+  gets it and the other block is filled without stopping the adc. Use
+  continuous conversion or a sync trigger(e.g. from the PWM) to pace the rounds.
+  
+  \param[in]   ptAdcBase	pointer of ADC reg structure.
+  \param[in]   ptStreamCfg	pointer of stream config
+  \return 	   error code \ref csi_error_t
+ */
+csi_error_t csi_adc_stream_start(csp_adc_t *ptAdcBase, csi_adc_stream_config_t *ptStreamCfg);
+
+/** 
+  \brief 	   stop double buffered acquisition
+  \param[in]   ptAdcBase	pointer of ADC reg structure.
+  \return 	   none
+ */
+void csi_adc_stream_stop(csp_adc_t *ptAdcBase);
+
+/** 
+  \brief 	   rounds lost because the adc data was overwritten before the interrupt read it
+  \param[in]   ptAdcBase	pointer of ADC reg structure.
+  \return 	   overrun count since csi_adc_stream_start
+ */
+uint32_t csi_adc_stream_get_overrun(csp_adc_t *ptAdcBase);
  
+/**
+  \brief 	   sample the channels every wPeriodUs, started by a timer through ETCB
+
+  The BT period event starts each round on the adc sync input, the timing
+  does not depend on interrupt latency. The round is repeated in the 16
+  entry sequence as often as hwDepth allows, so the adc interrupt comes
+  once per 16 samples(or per block) instead of once per round. The adc has
+  to be initialized(csi_adc_init: clock, hold time, vref) before; conversion
+  mode, sequence and sync input are set here.
+
+  \param[in]   ptAdcBase	pointer of ADC reg structure.
+  \param[in]   ptSmplCfg	pointer of sampler config
+  \return 	   error code \ref csi_error_t
+ */
+csi_error_t csi_adc_sampler_start(csp_adc_t *ptAdcBase, csi_adc_sampler_config_t *ptSmplCfg);
+
+/**
+  \brief 	   stop the timer, free its ETCB channel and stop the acquisition
+  \param[in]   ptAdcBase	pointer of ADC reg structure.
+  \return 	   none
+ */
+void csi_adc_sampler_stop(csp_adc_t *ptAdcBase);
+
  
 #ifdef __cplusplus
 }
@@ -180,6 +180,20 @@ void csi_bt_prdr_cmp_updata(csp_bt_t *ptBtBase, uint16_t hwPrdr, uint16_t hwCmp)
  */
 void csi_bt_pwm_duty_cycle_updata(csp_bt_t *ptBtBase, uint8_t byDutyCycle); 
 
+/** 
+  \brief  	   updata bt pwm duty, Q15 fraction of PRDR; one multiply, no division
+  \param[in]   ptBtBase		pointer of bt register structure
+  \param[in]   hwDuty		duty in Q15, 0 ~ 0x8000(100%)
+  \return 	   none
+ */
+static inline void csi_bt_pwm_duty_q15(csp_bt_t *ptBtBase, uint16_t hwDuty)
+{
+	if(hwDuty > 0x8000)
+		hwDuty = 0x8000;
+	
+	csp_bt_set_cmp(ptBtBase, (uint16_t)(((uint32_t)csp_bt_get_prdr(ptBtBase) * hwDuty) >> 15));
+}
+
 /** 
   \brief  	   updata bt pwm freq and duty cycle
   \param[in]   ptBtBase		pointer of bt register structure
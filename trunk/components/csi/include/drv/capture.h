@@ -0,0 +1,150 @@
+/***********************************************************************//**
+ * \file  capture.h
+ * \brief  period/duty/frequency measurement on the capture unit of EPT0 or GPTA0
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-28 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+
+#ifndef _DRV_CAPTURE_H_
+#define _DRV_CAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <drv/common.h>
+#include <drv/ringbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The edge events reach SYNCIN2 of the timer through an ETB channel, the
+ * counter runs free(0~0xFFFF) and every edge loads it into the next of
+ * CMPA~CMPD. One CAPLD3 interrupt delivers four edges; the period end
+ * interrupt counts the wraps, which extend the edge times to 32 bits.
+ *
+ * The prescaler is chosen so that one period of wMinFreq fits in 0xFFFF
+ * counts: edges are rebuilt backwards from CMPD, and two edges further
+ * apart than that are not measured(the signal is taken as lost).
+ */
+
+/// periods in the rolling average = 2^CONFIG_CAPTURE_AVG_SHIFT, 0~4
+#ifndef CONFIG_CAPTURE_AVG_SHIFT
+#define CONFIG_CAPTURE_AVG_SHIFT		3U
+#endif
+
+#define CAPTURE_AVG_LEN					(1U << CONFIG_CAPTURE_AVG_SHIFT)
+
+typedef enum {
+	CAPTURE_EPT0		= 0,
+	CAPTURE_GPTA0
+} csi_capture_timer_e;
+
+typedef enum {
+	CAPTURE_EDGE_RISE	= 0,		//one edge per period(rising or falling), period/frequency
+	CAPTURE_EDGE_BOTH				//both edges, period/frequency and duty
+} csi_capture_edge_e;
+
+/// one period, pushed into the sample buffer by the interrupt
+typedef struct {
+	uint32_t	wStamp;				//edge that starts the period, counter ticks(32 bit)
+	uint16_t	hwPeriod;			//ticks
+	uint16_t	hwHigh;				//high time in ticks, 0 in CAPTURE_EDGE_RISE mode
+} csi_capture_sample_t;
+
+typedef struct {
+	uint8_t		byTimer;			//\ref csi_capture_timer_e
+	uint8_t		byEdge;				//\ref csi_capture_edge_e, has to match the edge setting of the event source
+	uint8_t		bySrc;				//ETB source of the edge events, e.g. ETB_EXI_TRGOUT0(csi_exi_set_evtrg)
+	uint8_t		byPin;				//input pin, CAPTURE_EDGE_BOTH: its level at start tells the polarity of the first edge
+	uint32_t	wMinFreq;			//lowest frequency to measure(Hz), sets the counter clock
+	csi_capture_sample_t *ptBuf;	//sample buffer, NULL: averages only
+	uint16_t	hwBufLen;			//samples in ptBuf, power of two
+} csi_capture_config_t;
+
+/// measurement object, allocated by the user(static), contents are private to capture.c
+typedef struct {
+	ringbuffer_t		tFifo;						//samples, filled by the interrupt
+	void				*ptTimer;					//EPT0/GPT0
+	uint32_t			wTickFreq;					//counter clock(Hz)
+	uint32_t			wOvf;						//counter wraps, upper half of the edge times
+	uint32_t			wRise;						//last period start edge
+	uint32_t			wFall;						//last opposite edge after wRise
+	uint32_t			wPrdSum;					//sums over the averaging window
+	uint32_t			wHighSum;
+	uint16_t			hwPrdHist[CAPTURE_AVG_LEN];
+	uint16_t			hwHighHist[CAPTURE_AVG_LEN];
+	uint8_t				byAvgIdx;
+	uint8_t				byAvgCnt;					//periods in the window, 0 = no signal
+	uint8_t				byTimer;
+	uint8_t				byEdge;
+	uint8_t				byPin;
+	uint8_t				byState;					//edge tracking flags
+	uint8_t				byIdleOvf;					//wraps since the last four edges
+	volatile uint32_t	wOverrun;					//edge groups dropped, the next edge came before CMPA was read
+	volatile uint32_t	wLost;						//samples dropped, buffer full
+} csi_capture_t;
+
+/** \brief set up the timer in capture mode, the ETB route of the edge events and the interrupt
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[in] ptCfg: configuration \ref csi_capture_config_t
+ *  \return error code \ref csi_error_t, on error neither the timer nor an ETB channel is taken
+ */
+csi_error_t csi_capture_init(csi_capture_t *ptCap, csi_capture_config_t *ptCfg);
+
+/** \brief clear samples and averages and start the counter
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_capture_start(csi_capture_t *ptCap);
+
+/** \brief stop the counter, averages and samples are kept
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return none
+ */
+void csi_capture_stop(csi_capture_t *ptCap);
+
+/** \brief take the oldest sample, consumer side of the sample buffer(lock free)
+ *
+ *  \param[in] ptCap: measurement object
+ *  \param[out] ptSample: sample
+ *  \return true: one sample read; false: buffer empty
+ */
+bool csi_capture_read(csi_capture_t *ptCap, csi_capture_sample_t *ptSample);
+
+/** \brief frequency averaged over the last CAPTURE_AVG_LEN periods
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return frequency in 0.01Hz, 0 = no signal(or below wMinFreq)
+ */
+uint32_t csi_capture_get_freq(csi_capture_t *ptCap);
+
+/** \brief duty averaged over the last CAPTURE_AVG_LEN periods, CAPTURE_EDGE_BOTH mode
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return high time / period in Q15(0x8000 = 100%), 0 = no signal
+ */
+uint32_t csi_capture_get_duty_q15(csi_capture_t *ptCap);
+
+/** \brief counter clock, unit of the sample times
+ *
+ *  \param[in] ptCap: measurement object
+ *  \return ticks per second
+ */
+static inline uint32_t csi_capture_tick_freq(csi_capture_t *ptCap)
+{
+	return ptCap->wTickFreq;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRV_CAPTURE_H_ */
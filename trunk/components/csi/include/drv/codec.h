@@ -16,7 +16,7 @@
 #include <stdbool.h>
 #include <drv/common.h>
 #include <drv/dma.h>
-#include "drv/ringbuffer.h"
+#include "drv/ringbuf.h"
 
 typedef enum {
     CODEC_EVENT_PERIOD_READ_COMPLETE        = 0U,  ///< A peroid data read complete
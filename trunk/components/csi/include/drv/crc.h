@@ -16,6 +16,19 @@
 extern "C" {
 #endif
 
+typedef enum {
+	CRC_TYPE_CRC16		= 0,	//poly = 0x8005 refin = 1 refout = 1
+	CRC_TYPE_CCITT,				//poly = 0x1021 refin = 1 refout = 1
+	CRC_TYPE_ITU,				//poly = 0x1021 refin = 0 refout = 0(XMODEM)
+	CRC_TYPE_CRC32_BE			//poly = 0x04c11db7 refin = 0 refout = 0
+} csi_crc_type_e;
+
+/// streaming calculation, data may arrive in any number of parts
+typedef struct {
+	uint32_t	wCrc;			//running crc, without xorout
+	uint8_t		byType;			//\ref csi_crc_type_e
+} csi_crc_ctx_t;
+
 /**
   \brief       Initialize CRC Interface. 1. Initializes the resources needed for the CRC interface 2.registers event callback function
   \param[in]   crc  handle of crc instance
@@ -75,6 +88,46 @@ uint16_t csi_crc16_itu(uint16_t hwCrcSeed, uint8_t* pbyData, uint32_t wSize);
  */
 uint32_t csi_crc32_be(uint32_t wCrcSeed, uint8_t* pbyData, uint32_t wSize);
 
+/**
+ * \brief start a streaming calculation
+ * \param[in] ptCtx     :calculation context
+ * \param[in] eType     :crc type
+ * \param[in] wCrcSeed  :CRC seed value, or the result of an earlier calculation to continue it
+ * \return    none
+ */
+void csi_crc_start(csi_crc_ctx_t *ptCtx, csi_crc_type_e eType, uint32_t wCrcSeed);
+
+/**
+ * \brief feed the next part of the data
+ *  runs on the hardware(word writes where aligned), falls back to software when
+ *  the hardware is in use by an interrupted caller or its clock is off
+ * \param[in] ptCtx     :calculation context
+ * \param[in] pData     :data buf to be calculate
+ * \param[in] wSize     :data size
+ * \return    none
+ */
+void csi_crc_update(csi_crc_ctx_t *ptCtx, const void *pData, uint32_t wSize);
+
+/**
+ * \brief get the result of a streaming calculation
+ * \param[in] ptCtx     :calculation context
+ * \return    The computed CRC without xorout
+ */
+static inline uint32_t csi_crc_get(csi_crc_ctx_t *ptCtx)
+{
+	return ptCtx->wCrc;
+}
+
+/**
+ * \brief Compute a CRC in software only(nibble table), same results as the hardware
+ * \param[in] eType     :crc type
+ * \param[in] wCrcSeed  :CRC seed value
+ * \param[in] pData     :data buf to be calculate
+ * \param[in] wSize     :data size
+ * \return    The computed CRC without xorout
+ */
+uint32_t csi_crc_soft(csi_crc_type_e eType, uint32_t wCrcSeed, const void *pData, uint32_t wSize);
+
 
 
 
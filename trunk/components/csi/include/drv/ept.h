@@ -501,6 +501,123 @@ typedef enum{
 */
 csi_error_t csi_ept_change_ch_duty(csp_ept_t *ptEpt, csi_ept_chtype_e eCh, uint32_t wActiveTime);
 
+#define EPT_DUTY_Q15_MAX	0x8000			//duty 1.0(100%) in Q15
+
+/**
+ \brief convert a Q15 duty into a compare value, same mapping as csi_ept_change_ch_duty:
+        0 -> gEptPrd + 1(never active), EPT_DUTY_Q15_MAX -> 0(always active).
+        One multiply and one shift with the period scale gEptPrd + 1, no division.
+ \param hwDuty   duty in Q15, 0 ~ EPT_DUTY_Q15_MAX
+ \return compare value
+*/
+static inline uint16_t csi_ept_duty_q15_to_cmp(uint16_t hwDuty)
+{
+	uint32_t wScale = gEptPrd + 1;
+	
+	if(hwDuty > EPT_DUTY_Q15_MAX)
+		hwDuty = EPT_DUTY_Q15_MAX;
+	
+	return (uint16_t)(wScale - ((wScale * hwDuty) >> 15));
+}
+
+/**
+ \brief write the compare(shadow) register of one channel, no switch: CMPA~CMPD are consecutive
+ \param ptEptBase    pointer of ept register structure
+ \param eCh          EPT_CH_A ~ EPT_CH_D
+ \param hwCmp        compare value in timer ticks
+*/
+static inline void csi_ept_set_ch_cmp(csp_ept_t *ptEptBase, csi_ept_chtype_e eCh, uint16_t hwCmp)
+{
+	(&ptEptBase->CMPA)[eCh & 0x03] = hwCmp;
+}
+
+/**
+ \brief change the duty of one channel, Q15 fraction of the period
+ \param ptEptBase    pointer of ept register structure
+ \param eCh          EPT_CH_A ~ EPT_CH_D
+ \param hwDuty       duty in Q15, 0 ~ EPT_DUTY_Q15_MAX
+*/
+static inline void csi_ept_set_ch_duty_q15(csp_ept_t *ptEptBase, csi_ept_chtype_e eCh, uint16_t hwDuty)
+{
+	csi_ept_set_ch_cmp(ptEptBase, eCh, csi_ept_duty_q15_to_cmp(hwDuty));
+}
+
+/**
+ \brief write CMPA~CMPD and trigger the global load(csi_ept_global_sw), so that the four
+        channels change in the same period when CMPx use global load(csi_ept_global_config).
+ \param ptEptBase    pointer of ept register structure
+ \param hwCmp        compare values of channel A~D in timer ticks
+*/
+void csi_ept_update_cmp(csp_ept_t *ptEptBase, const uint16_t hwCmp[4]);
+
+/**
+ \brief change the duty of channel A~D in one call, Q15 fractions of the period; constant time
+        and no division. Latched together like csi_ept_update_cmp.
+ \param ptEptBase    pointer of ept register structure
+ \param hwDuty       duty of channel A~D in Q15, 0 ~ EPT_DUTY_Q15_MAX
+*/
+void csi_ept_update_duty_q15(csp_ept_t *ptEptBase, const uint16_t hwDuty[4]);
+
+/// period hook of the motor control profile, called from the EPT interrupt
+typedef void (*csi_ept_mc_hook_t)(void *pArg);
+
+/// \struct csi_ept_mc_config_t
+/// \brief  three-phase motor control PWM profile(csi_ept_mc_init): center aligned(up/down count),
+///         complementary pairs CHAX/CHAY, CHBX/CHBY, CHCX/CHCY driven by CMPA/CMPB/CMPC
+typedef struct {
+	uint32_t			wFreq;			//pwm frequency(Hz), one up/down count period
+	uint16_t			hwDeadTimeNs;	//dead time(ns) on both edges of each pair, rounded up to PCLK ticks
+	uint8_t				byEbi;			//emergency input EBI0~EBI4 on EP0, all six outputs forced to byEmOut; 0: none
+	uint8_t				byEbiPol;		//EBI_POL_H/EBI_POL_L
+	uint8_t				byEmLckmd;		//EP_SLCK(released at next ZRO)/EP_HLCK(released by csi_ept_clr_hdlck)
+	uint8_t				byEmOut;		//EM_OUT_L/EM_OUT_H/EM_OUT_HZ
+	uint8_t				byAdcTrgSrc;	//ADC trigger point, EPT_TRGSRC_PRD(counter midpoint)/EPT_TRGSRC_ZRO; EPT_TRGSRC_DIS: none
+	uint8_t				byAdcSyncIn;	//ETB_ADC_SYNCIN0~5, routed from EPT trigger out 0 through an ETB channel
+	csi_ept_mc_hook_t	pfPeriod;		//called once per period at ZRO(trigger out 1); NULL: none
+	void				*pArg;			//argument of pfPeriod
+} csi_ept_mc_config_t;
+
+/**
+ \brief  motor control PWM profile: up/down counting, complementary pairs with dead time, emergency
+         shutdown, ADC trigger and CMPA~CMPC latched together by a one-shot global load at ZRO.
+         Outputs start at duty 0(CHxX low, CHxY high); start with csi_ept_start.
+ \param  ptEptBase    	pointer of ept register structure
+ \param  ptMcCfg   	    refer to csi_ept_mc_config_t
+ \return CSI_OK /CSI_ERROR(wFreq is 0 or no free ETB channel)
+*/
+csi_error_t csi_ept_mc_init(csp_ept_t *ptEptBase, csi_ept_mc_config_t *ptMcCfg);
+
+/**
+ \brief write the compare values of the three phases of csi_ept_mc_init(e.g. from foc_svpwm).
+        They go to the CMPA~CMPC shadows and are latched together at the next ZRO.
+ \param ptEptBase    pointer of ept register structure
+ \param hwCmpU       compare value of phase U(CHAX) in timer ticks
+ \param hwCmpV       compare value of phase V(CHBX)
+ \param hwCmpW       compare value of phase W(CHCX)
+*/
+static inline void csi_ept_mc_update_cmp(csp_ept_t *ptEptBase, uint16_t hwCmpU, uint16_t hwCmpV, uint16_t hwCmpW)
+{
+	ptEptBase->CMPA = hwCmpU;
+	ptEptBase->CMPB = hwCmpV;
+	ptEptBase->CMPC = hwCmpW;
+	csp_ept_set_gldcr2(ptEptBase, EPT_OSREARM_EN);			//arm the global load
+}
+
+/**
+ \brief change the duty of the three phases of csi_ept_mc_init, Q15 fractions of the period.
+        The values go to the CMPA~CMPC shadows and are latched together at the next ZRO, so that
+        one period never mixes old and new duties; a second call before that ZRO replaces the first.
+ \param ptEptBase    pointer of ept register structure
+ \param hwDutyU      duty of phase U(CHAX) in Q15, 0 ~ EPT_DUTY_Q15_MAX
+ \param hwDutyV      duty of phase V(CHBX) in Q15
+ \param hwDutyW      duty of phase W(CHCX) in Q15
+*/
+static inline void csi_ept_mc_update_q15(csp_ept_t *ptEptBase, uint16_t hwDutyU, uint16_t hwDutyV, uint16_t hwDutyW)
+{
+	csi_ept_mc_update_cmp(ptEptBase, csi_ept_duty_q15_to_cmp(hwDutyU), csi_ept_duty_q15_to_cmp(hwDutyV),
+							csi_ept_duty_q15_to_cmp(hwDutyW));
+}
+
 /**
  \brief chopper configuration
  \param ptEpt    		ept handle to operate 
@@ -173,4 +173,77 @@ void csi_etb_ch_start(csi_etb_chid_e eChId);
 */
 void csi_etb_ch_stop(csi_etb_chid_e eChId);
 
+/*
+ * Event routing graph: a table of source -> destination routes is mapped
+ * onto the channels at once. A destination fed by 2~3 sources takes the
+ * many-to-one channel 0, the sources with the most destinations take the
+ * one-to-many channels 1~2(up to 3 destinations each), the rest goes to the
+ * one-to-one channels 3~7, then to whatever is left of 0~2. This is the
+ * least number of channels for the table.
+ */
+
+/// routes in one graph: 8 channels, at most 3 + 3 + 3 + 5 routes
+#define ETB_GRAPH_ROUTE_MAX		14
+
+/// one edge of the graph
+typedef struct {
+	uint8_t			bySrc;				//\ref csi_etb_src_e
+	uint8_t			byDst;				//\ref csi_etb_dst_e
+} csi_etb_route_t;
+
+/// graph object, allocated by the user, filled by csi_etb_graph_init
+typedef struct {
+	uint8_t			byChMsk;			//channels of the graph, bit n: channel n
+	uint32_t		wIrqMsk;			//bit n: interrupt n no longer needed to forward an event
+} csi_etb_graph_t;
+
+/**
+  \brief       validate a route table, allocate and configure its channels(stopped).
+               Fails with nothing allocated on: an invalid or repeated route, a
+               destination with more than 3 sources, two destinations with several
+               sources, a destination already driven by a channel outside the table,
+               or not enough free channels.
+  \param[out]  ptGraph		graph object
+  \param[in]   ptRoute		route table
+  \param[in]   byNum		routes in the table, 1~ETB_GRAPH_ROUTE_MAX
+  \return      error code \ref csi_error_t
+*/
+csi_error_t csi_etb_graph_init(csi_etb_graph_t *ptGraph, const csi_etb_route_t *ptRoute, uint8_t byNum);
+
+/**
+  \brief       enable all channels of a graph with interrupts masked
+  \param[in]   ptGraph		graph object
+  \return      none
+*/
+void csi_etb_graph_start(csi_etb_graph_t *ptGraph);
+
+/**
+  \brief       disable all channels of a graph with interrupts masked
+  \param[in]   ptGraph		graph object
+  \return      none
+*/
+void csi_etb_graph_stop(csi_etb_graph_t *ptGraph);
+
+/**
+  \brief       stop a graph and free its channels
+  \param[in]   ptGraph		graph object
+  \return      none
+*/
+void csi_etb_graph_free(csi_etb_graph_t *ptGraph);
+
+/**
+  \brief       interrupts the graph makes unnecessary: the ones of the source
+               peripherals, whose handlers would otherwise start the destinations
+  \param[in]   ptGraph		graph object
+  \return      bit n set: IRQ number n
+*/
+static inline uint32_t csi_etb_graph_irqs(csi_etb_graph_t *ptGraph)
+{
+	return ptGraph->wIrqMsk;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _CSI_ETB_H_ */
@@ -306,6 +306,17 @@ uint16_t csi_gpta_get_prd(csp_gpta_t *ptGpta);
 */
 csi_error_t csi_gpta_change_ch_duty(csp_gpta_t *ptGpta, csi_gpta_chtype_e eCh, uint32_t wActiveTime);
 
+#define GPTA_DUTY_Q15_MAX	0x8000			//duty 1.0(100%) in Q15
+
+/**
+ \brief change the duty of channel A and B in one call, Q15 fractions of the period;
+        same mapping as csi_gpta_change_ch_duty, one multiply per channel and no division.
+        Latched together by csi_gpta_global_sw when CMPx use global load.
+ \param ptGptaBase   pointer of gpta register structure
+ \param hwDuty       duty of channel A, B in Q15, 0 ~ GPTA_DUTY_Q15_MAX
+*/
+void csi_gpta_update_duty_q15(csp_gpta_t *ptGptaBase, const uint16_t hwDuty[2]);
+
 
 
  /** \brief  register gpta interrupt callback function
@@ -3,19 +3,131 @@
 #ifndef _DRV_HWDIV_H_
 #define _DRV_HWDIV_H_
 
+#include <stdint.h>
+#include <stdbool.h>
 
  typedef struct{
 	uint32_t wQuot;
 	uint32_t wRem;
  }hwdiv_urslt_t;
- 
+
   typedef struct{
 	int wQuot;
 	int wRem;
  }hwdiv_rslt_t;
 
+/// multiply-shift reciprocal of a fixed divisor, filled by csi_udiv_init
+ typedef struct{
+	uint32_t wMul;			//magic multiplier, 0 = divisor is a power of two
+	uint8_t  byShift;		//final right shift
+	uint8_t  byAdd;			//1 = 33 bit multiplier, use the add/shift fixup
+ }csi_udiv_t;
+
+#define CSI_DIV_IS_POW2(n)		(((n) != 0U) && (((n) & ((n) - 1U)) == 0U))
+
+/** \brief unsigned division, quotient and remainder from one HWDIV operation
+ *
+ *  PSR is only touched when interrupts are enabled, calling from an ISR
+ *  costs the three register accesses only.
+ *
+ *  \param[in] wDiviend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \return hwdiv_urslt_t
+ */
 hwdiv_urslt_t csi_hwdiv_unsigned_calc(uint32_t wDiviend, uint32_t wDivisor);
+
+/** \brief signed division, quotient and remainder from one HWDIV operation
+ *
+ *  \param[in] wDiviend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \return hwdiv_rslt_t
+ */
 hwdiv_rslt_t csi_hwdiv_signed_calc(int wDiviend, int wDivisor);
 
+/** \brief precompute the reciprocal of a divisor that rarely changes
+ *         (clock frequencies, baud divisors ...)
+ *
+ *  \param[out] ptDiv: reciprocal to be filled
+ *  \param[in] wDivisor: divisor, must not be 0
+ *  \return none
+ */
+void csi_udiv_init(csi_udiv_t *ptDiv, uint32_t wDivisor);
+
+/** \brief high 32 bits of a 32x32 bit product
+ *
+ *  CK801 has no widening multiply, four 16x16 products keep this
+ *  away from the __muldi3 library call.
+ *
+ *  \param[in] wA: factor
+ *  \param[in] wB: factor
+ *  \return (wA * wB) >> 32
+ */
+static inline uint32_t csi_umulhi(uint32_t wA, uint32_t wB)
+{
+	uint32_t wAl = wA & 0xffffU, wAh = wA >> 16;
+	uint32_t wBl = wB & 0xffffU, wBh = wB >> 16;
+	uint32_t wLH = wAl * wBh, wHL = wAh * wBl;
+	uint32_t wMid = ((wAl * wBl) >> 16) + (wLH & 0xffffU) + (wHL & 0xffffU);
+
+	return wAh * wBh + (wLH >> 16) + (wHL >> 16) + (wMid >> 16);
+}
+
+/** \brief divide by a divisor prepared with csi_udiv_init, no HWDIV access
+ *
+ *  \param[in] ptDiv: reciprocal of the divisor
+ *  \param[in] wDividend: dividend
+ *  \return wDividend / divisor
+ */
+static inline uint32_t csi_udiv(const csi_udiv_t *ptDiv, uint32_t wDividend)
+{
+	uint32_t wQuot;
+
+	if(ptDiv->wMul == 0U)
+		return wDividend >> ptDiv->byShift;
+
+	wQuot = csi_umulhi(wDividend, ptDiv->wMul);
+	if(ptDiv->byAdd)
+		wQuot = ((wDividend - wQuot) >> 1) + wQuot;
+
+	return wQuot >> ptDiv->byShift;
+}
+
+/** \brief wDividend / 1000, exact for every 32 bit value
+ */
+static inline uint32_t csi_udiv_1000(uint32_t wDividend)
+{
+	return csi_umulhi(wDividend, 0x10624DD3U) >> 6;
+}
+
+/** \brief wDividend / 1000000, exact for every 32 bit value
+ */
+static inline uint32_t csi_udiv_1000000(uint32_t wDividend)
+{
+	return csi_umulhi(wDividend, 0x431BDE83U) >> 18;
+}
+
+/** \brief unsigned division picking the cheapest form at compile time
+ *
+ *  Constant powers of two become a shift, constant 1000/1000000 the
+ *  multiply-shift helpers, anything else goes to the HWDIV.
+ *
+ *  \param[in] wDividend: dividend
+ *  \param[in] wDivisor: divisor
+ *  \return wDividend / wDivisor
+ */
+static inline __attribute__((always_inline)) uint32_t csi_udiv_fast(uint32_t wDividend, uint32_t wDivisor)
+{
+	if(__builtin_constant_p(wDivisor))
+	{
+		if(CSI_DIV_IS_POW2(wDivisor))
+			return wDividend >> __builtin_ctz(wDivisor);
+		if(wDivisor == 1000U)
+			return csi_udiv_1000(wDividend);
+		if(wDivisor == 1000000U)
+			return csi_udiv_1000000(wDividend);
+	}
+
+	return csi_hwdiv_unsigned_calc(wDividend, wDivisor).wQuot;
+}
 
-#endif /* _CSI_CLK_H_*/
\ No newline at end of file
+#endif /* _DRV_HWDIV_H_*/
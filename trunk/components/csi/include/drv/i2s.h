@@ -17,7 +17,7 @@
 #include <stdbool.h>
 #include <drv/common.h>
 #include <drv/dma.h>
-#include "drv/ringbuffer.h"
+#include "drv/ringbuf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,7 +31,34 @@ typedef struct {
     uint8_t error : 1;                   ///< Read/Program/Erase error flag (cleared on start of next operation)
 } csi_ifc_status_t;
 
-
+/**
+  \enum        csi_ifc_xfer_state_e
+  \brief       state of a queued program request
+ */
+typedef enum {
+	IFC_XFER_IDLE		= 0U,		///< never submitted
+	IFC_XFER_QUEUED,				///< waiting for the IFC
+	IFC_XFER_BUSY,					///< pages being programmed
+	IFC_XFER_DONE,					///< all pages programmed and checked
+	IFC_XFER_ERROR					///< page check failed, wDone words are good
+} csi_ifc_xfer_state_e;
+
+typedef struct csi_ifc_xfer csi_ifc_xfer_t;
+
+/// completion callback, runs in interrupt context and may submit the next request
+typedef void (*csi_ifc_xfer_cb_t)(csi_ifc_xfer_t *ptXfer, csi_error_t eResult);
+
+/// program request, may span pages of one flash(PFLASH or DFLASH)
+struct csi_ifc_xfer {
+	csi_ifc_xfer_t		*ptNext;		//queue link, private to the driver
+	uint32_t			wAddr;			//flash address, word aligned
+	const uint32_t		*pwData;		//data to program
+	uint32_t			wDataNum;		//number of data(WORDS)
+	volatile uint32_t	wDone;			//words programmed and checked
+	volatile uint8_t	byState;		//\ref csi_ifc_xfer_state_e
+	csi_ifc_xfer_cb_t	callback;		//NULL = poll byState
+	void				*pArg;			//user argument
+};
 
 // Function documentation
 
@@ -57,15 +84,54 @@ void csi_ifc_dflash_paramode_enable(csp_ifc_t *ptIfcBase, bool bEnable);
 csi_error_t csi_ifc_read(csp_ifc_t *ptIfcBase, uint32_t wAddr, uint32_t *data, uint32_t wDataNum);
 
 /**
-  \brief       Program data to Flash.
+  \brief       Program data to Flash, waits for the end of the program.
   \param[in]   ptEflash  ifc handle to operate.
   \param[in]   wAddr  Data address (SHOULD BE WORD ALLIGNED)
   \param[in]   data  Pointer to a buffer containing the data to be programmed to Flash.
-  \param[in]   wDataNum   Number of data(BYTES) items to program.
+  \param[in]   wDataNum   Number of data(WORDS) items to program.
   \return      error code
 */
 csi_error_t csi_ifc_program(csp_ifc_t *ptIfcBase, uint32_t wAddr, uint32_t *pwData, uint32_t wDataNum);
 
+/**
+  \brief       Queue a program request and return, the IFC interrupt(apt_ifc_irqhandler) erases,
+               programs and checks one page after the other, every page step is started from
+               the interrupt that ends the step before. Requests run in submit order, the
+               next one starts from the interrupt that ends the previous one. A whole aligned
+               page is programmed without reading the old page. DFLASH requests switch DFLASH
+               to para mode. PFLASH stalls instruction fetch while a page is erased/programmed,
+               the CPU runs between the steps.
+  \param[in]   ptIfcBase  ifc handle to operate.
+  \param[in]   ptXfer  request, it and its data must stay valid until byState is DONE/ERROR;
+               clear it(static or memset) before the first submit
+  \return      error code, CSI_BUSY = ptXfer is still queued
+*/
+csi_error_t csi_ifc_program_async(csp_ifc_t *ptIfcBase, csi_ifc_xfer_t *ptXfer);
+
+/** \brief request is waiting for or using the IFC
+ *  \param[in] ptXfer: request
+ *  \return true: busy
+ */
+static inline bool csi_ifc_xfer_busy(csi_ifc_xfer_t *ptXfer)
+{
+	return (ptXfer->byState == IFC_XFER_QUEUED) || (ptXfer->byState == IFC_XFER_BUSY);
+}
+
+/**
+  \brief       Wait for the end of a request. With interrupts masked(ISR, critical section)
+               the IFC handler is polled here instead, so this never deadlocks.
+  \param[in]   ptIfcBase  ifc handle to operate.
+  \param[in]   ptXfer  request submitted with csi_ifc_program_async
+  \return      error code, CSI_ERROR = the request ended in IFC_XFER_ERROR
+*/
+csi_error_t csi_ifc_wait(csp_ifc_t *ptIfcBase, csi_ifc_xfer_t *ptXfer);
+
+/** \brief ifc interrupt handle function, installed for IFC_IRQn by default
+ *  \param ptIfcBase ifc handle to operate.
+ *  \return none
+ */
+void apt_ifc_irqhandler(csp_ifc_t *ptIfcBase);
+
 
 
 /**
@@ -108,7 +174,7 @@ csi_error_t csi_ifc_swd_remap(csp_ifc_t *ptIfcBase, swd_grp_e eGrp);
  */
 csi_ifc_status_t csi_ifc_get_status(csp_ifc_t *ptIfcBase);
 
-extern bool g_bFlashCheckPass;
-extern bool g_bFlashPgmDne;
+extern volatile bool g_bFlashCheckPass;
+extern volatile bool g_bFlashPgmDne;
 
 #endif /* _CSI_EFLASH_H_ */
\ No newline at end of file
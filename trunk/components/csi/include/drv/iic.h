@@ -96,6 +96,44 @@ typedef enum {
     IIC_EVENT_ERROR                          ///< The receive buffer was completely filled to FIFO and more data arrived. That data is lost
 } csi_iic_event_t;
 
+/// time limit of one queued transfer(ms), the bus time of the data is added on top
+#ifndef CONFIG_IIC_XFER_TIMEOUT_MS
+#define CONFIG_IIC_XFER_TIMEOUT_MS		10U
+#endif
+
+/**
+  \enum        csi_iic_xfer_state_e
+  \brief       state of a queued master transfer
+ */
+typedef enum {
+	IIC_XFER_IDLE		= 0U,		///< never submitted
+	IIC_XFER_QUEUED,				///< waiting for the bus
+	IIC_XFER_BUSY,					///< on the bus
+	IIC_XFER_DONE,					///< finished with STOP, all data transferred
+	IIC_XFER_ERROR					///< NACK/arbitration lost/bus stuck/timeout, see wAbort
+} csi_iic_xfer_state_e;
+
+typedef struct csi_iic_xfer csi_iic_xfer_t;
+
+/// completion callback, runs in interrupt context and may submit the next transfer
+typedef void (*csi_iic_xfer_cb_t)(csi_iic_xfer_t *ptXfer, csi_error_t eResult);
+
+/// one master transaction: START, register address, tx data, RESTART, rx data, STOP
+struct csi_iic_xfer {
+	csi_iic_xfer_t		*ptNext;		//queue link, private to the driver
+	uint16_t			hwDevAddr;		//slave address, 8 bit form(same as csi_iic_write_nbyte)
+	uint8_t				byRegLen;		//register address bytes(MSB first), 0~4
+	volatile uint8_t	byState;		//\ref csi_iic_xfer_state_e
+	uint32_t			wRegAddr;		//register address
+	const uint8_t		*pbyTxData;		//written after the register address
+	uint8_t				*pbyRxData;		//read after the register address/tx data
+	uint16_t			hwTxLen;		//tx data length
+	uint16_t			hwRxLen;		//rx data length
+	csi_iic_xfer_cb_t	callback;		//NULL = poll byState
+	void				*pArg;			//user argument
+	uint32_t			wAbort;			//TX_ABRT source of a failed transfer \ref i2c_tx_abrt_e
+};
+
 
 /** \brief initialize iic slave
  * 
@@ -145,10 +183,10 @@ void csi_iic_write_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteA
  *  \param[in] wWriteAdds: Write address
  * 	\param[in] byWriteAddrNumByte: Write address length (unit byte)
  * 	\param[in] pbyIicData: pointer of Write data
- * 	\param[in] wNumByteToWrite: Write data length
- *  \return none
+ * 	\param[in] wNumByteToWrite: Write data length, at most 0xFFFF
+ *  \return error code \ref csi_error_t
  */ 
-void csi_iic_write_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteToWrite);
+csi_error_t csi_iic_write_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wWriteAdds, uint8_t byWriteAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteToWrite);
 
 /** \brief  iic  master  read 1 byte data
  * 
@@ -167,10 +205,10 @@ uint8_t csi_iic_read_byte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wRead
  *  \param[in] wReadAdds: Read address
  * 	\param[in] wReadAddrNumByte: Read address length (unit byte)
  * 	\param[in] pbyIicData: Read the address pointer of the data storage array
- * 	\param[in] wNumByteRead: Read data length
- *  \return none
+ * 	\param[in] wNumByteRead: Read data length, at most 0xFFFF
+ *  \return error code \ref csi_error_t
  */ 
-void csi_iic_read_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wReadAdds, uint8_t wReadAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteRead);
+csi_error_t csi_iic_read_nbyte(csp_i2c_t *ptIicBase,uint32_t wdevaddr, uint32_t wReadAdds, uint8_t wReadAddrNumByte,volatile uint8_t *pbyIicData,uint32_t wNumByteRead);
 
 
 /** \brief  IIC slave handler
@@ -190,6 +228,44 @@ void csi_iic_slave_receive_send(csp_i2c_t *ptIicBase);
  */ 
 void csi_iic_set_slave_buffer(volatile uint8_t *pbyIicRxBuf,uint16_t hwIicRxSize,volatile uint8_t *pbyIicTxBuf,uint16_t hwIicTxSize);
 
+/** \brief queue a master transfer, the bus is driven by the iic interrupt
+ * 
+ *  Transfers run back to back in submit order, the next one is started
+ *  from the interrupt that completes the previous one. The transfer object
+ *  and its buffers must stay valid until byState is DONE/ERROR; clear it
+ *  (static or memset) before the first submit.
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \param[in] ptXfer: transfer object
+ *  \return error code \ref csi_error_t, CSI_BUSY = ptXfer is still queued
+ */
+csi_error_t csi_iic_master_xfer_async(csp_i2c_t *ptIicBase, csi_iic_xfer_t *ptXfer);
+
+/** \brief run a master transfer and wait for it, polls the handler when interrupts are masked
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \param[in] ptXfer: transfer object
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_iic_master_xfer(csp_i2c_t *ptIicBase, csi_iic_xfer_t *ptXfer);
+
+/** \brief transfer is waiting for or using the bus
+ * 
+ *  \param[in] ptXfer: transfer object
+ *  \return true: busy
+ */
+static inline bool csi_iic_xfer_busy(csi_iic_xfer_t *ptXfer)
+{
+	return (ptXfer->byState == IIC_XFER_QUEUED) || (ptXfer->byState == IIC_XFER_BUSY);
+}
+
+/** \brief  IIC master handler, installed for I2C_IRQn by default(master mode)
+ * 
+ *  \param[in] ptIicBase: pointer of iic register structure
+ *  \return none
+ */ 
+void csi_iic_master_irqhandler(csp_i2c_t *ptIicBase);
+
 
 #ifdef __cplusplus
 }
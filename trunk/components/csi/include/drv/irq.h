@@ -20,6 +20,36 @@ typedef struct {
     uint32_t wIrqNum;
 } csi_irqmap_t;
 
+/// interrupt handler installed by csi_irq_attach, called by do_irq with its context
+typedef void (*csi_irq_handler_t)(void *pArg);
+
+/// one entry of the RAM vector table g_tIrqVector, indexed by IRQ number
+typedef struct {
+	csi_irq_handler_t	handler;
+	void				*pArg;
+} csi_irq_vector_t;
+
+/// peripheral base -> IRQ number + 1(0: no IRQ), indexed by (base - APB_PERI_BASE) >> 12; devices.c
+extern const uint8_t irq_slot_map[IRQ_SLOT_NUM];
+
+/// RAM vector table, initialized with the board defaults in interrupt.c
+extern csi_irq_vector_t g_tIrqVector[CONFIG_IRQ_NUM];
+
+/**
+  \brief       get the IRQ number of a peripheral, computed from the address bits.
+  \param[in]   pIpBase  pointer of devices Base address
+  \return      IRQ number, -1 when the peripheral has no IRQ.
+*/
+static inline int32_t csi_irq_num(uint32_t *pIpBase)
+{
+	uint32_t wSlot = ((uint32_t)pIpBase - APB_PERI_BASE) >> 12;
+	
+	if(wSlot < IRQ_SLOT_NUM)
+		return (int32_t)irq_slot_map[wSlot] - 1;
+	
+	return ((uint32_t)pIpBase == CK801_ADDR_BASE) ? (int32_t)CORET_IRQn : -1;
+}
+
 /**
   \brief       enable irq.
   \param[in]   irq_num Number of IRQ.
@@ -47,18 +77,18 @@ void csi_irq_disable(uint32_t *pIpBase);
 //}
 
 /**
-  \brief       attach irq handler.
+  \brief       attach irq handler, replaces the handler installed before(board default
+               or an earlier attach). Takes effect with the next interrupt.
   \param[in]   irq_num     Number of IRQ.
   \param[in]   irq_handler IRQ Handler.
-  \param[in]   dev         the dev to operate
+  \param[in]   pArg        context passed to the handler, usually the peripheral base
   \return      None.
 */
-void csi_irq_attach(uint32_t irq_num, void *irq_handler, csi_dev_t *dev);
+void csi_irq_attach(uint32_t irq_num, csi_irq_handler_t irq_handler, void *pArg);
 
 /**
-  \brief       detach irq handler.
+  \brief       detach irq handler, the irq is disabled when it occurs without handler.
   \param[in]   irq_num Number of IRQ.
-  \param[in]   irq_handler IRQ Handler.
   \return      None.
 */
 void csi_irq_detach(uint32_t irq_num);
@@ -118,10 +148,11 @@ __ALWAYS_STATIC_INLINE void csi_irq_disable_wakeup(uint32_t irq_num)
 bool csi_irq_context(void);
 
 /**
-  \brief       dispatching irq handlers
-  \return      true or false.
+  \brief       dispatching irq handlers, entry of all external interrupt vectors.
+               Calls g_tIrqVector[irq] with its context.
+  \return      None.
 */
-void do_irq(uint32_t irq_num) __attribute__((isr));
+void do_irq(void) __attribute__((isr));
 
 
 
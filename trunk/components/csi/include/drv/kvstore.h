@@ -0,0 +1,98 @@
+/***********************************************************************//**
+ * \file  kvstore.h
+ * \brief  log structured key-value store on the DFLASH data region
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-10 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+
+#ifndef _DRV_KVSTORE_H_
+#define _DRV_KVSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <drv/common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// first page of the store, DFLASH page aligned
+#ifndef CONFIG_KV_BASE
+#define CONFIG_KV_BASE			DFLASHBASE
+#endif
+
+/// DFLASH pages(64 bytes) used by the store, at least 3
+#ifndef CONFIG_KV_PAGES
+#define CONFIG_KV_PAGES			8U
+#endif
+
+/// keys are 0 ~ CONFIG_KV_KEYS-1, the RAM index takes 2 bytes per key
+#ifndef CONFIG_KV_KEYS
+#define CONFIG_KV_KEYS			16U
+#endif
+
+/// longest value(bytes), a record has to fit one page with the page header
+#define KV_VALUE_MAX			52U
+
+/** \brief mount the store: scan the pages, rebuild the RAM index
+ *
+ *  Pages that fail the header check(never written, power lost while
+ *  programming) are treated as free. DFLASH is switched to para mode.
+ *
+ *  \param[in] none
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_init(void);
+
+/** \brief write a value, returns once the page program is started
+ *
+ *  Waits for the program started by the previous write first. The
+ *  erase/program of this write runs in the IFC interrupt.
+ *
+ *  \param[in] byKey: key, 0 ~ CONFIG_KV_KEYS-1
+ *  \param[in] pValue: value
+ *  \param[in] byLen: value length(bytes), 0 ~ KV_VALUE_MAX
+ *  \return error code \ref csi_error_t, CSI_ERROR when the store is full
+ */
+csi_error_t csi_kv_set(uint8_t byKey, const void *pValue, uint8_t byLen);
+
+/** \brief read a value, O(1) through the RAM index
+ *
+ *  \param[in] byKey: key
+ *  \param[out] pValue: buffer of the value, NULL(bySize 0): length only
+ *  \param[in] bySize: buffer size, a longer value is cut
+ *  \return value length, or CSI_ERROR when the key is not stored
+ */
+int32_t csi_kv_get(uint8_t byKey, void *pValue, uint8_t bySize);
+
+/** \brief remove a key
+ *
+ *  \param[in] byKey: key
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_delete(uint8_t byKey);
+
+/** \brief wait for the running page program and check it, a failed
+ *         page is programmed once more
+ *
+ *  \param[in] none
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_kv_flush(void);
+
+/** \brief page program of the last write still running
+ *
+ *  \param[in] none
+ *  \return true: busy
+ */
+bool csi_kv_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRV_KVSTORE_H_ */
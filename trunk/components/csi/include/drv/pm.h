@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include <drv/common.h>
+#include <drv/tick.h>
 #include <soc.h>
 #include <csi_core.h>
 
@@ -21,6 +22,16 @@
 extern "C" {
 #endif
 
+/// tickless sleep is skipped below this idle time
+#ifndef CONFIG_PM_TICKLESS_MIN_MS
+#define CONFIG_PM_TICKLESS_MIN_MS		(2U * 1000U / CONFIG_SYSTICK_HZ)
+#endif
+
+/// longest single tickless sleep, at most 80s so that the slept coret cycles fit 32 bit at 48MHz
+#ifndef CONFIG_PM_TICKLESS_MAX_MS
+#define CONFIG_PM_TICKLESS_MAX_MS		(60000U)
+#endif
+
 #ifdef CONFIG_USER_PM
 typedef struct{
 	void (*prepare_to_sleep)(void );
@@ -73,6 +84,15 @@ csi_error_t csi_pm_config_wakeup_source(uint32_t wakeup_num, bool enable);
 */
 void csi_pm_attach_callback(csi_pm_mode_e eMd, void *pBeforeSlp, void *pWkup);
 
+/**
+  \brief       enable tickless sleep, LPT is reserved as wakeup timer while enabled
+   * csi_pm_enter_sleep then stops the tick until csi_tick_idle_ms() expires or
+   * another wakeup source fires, and accounts the slept time on csi_tick
+  \param[in]   bEnable    true: tickless, false: tick keeps running
+  \return      None.
+*/
+void csi_pm_tickless_enable(bool bEnable);
+
 #ifdef __cplusplus
 }
 #endif
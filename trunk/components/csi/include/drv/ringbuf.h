@@ -3,7 +3,7 @@
  */
 
 /******************************************************************************
-* @file     ringbuffer.h
+* @file     ringbuf.h
 * @brief    header file for ringbuffer Driver
 * @version  V1.0
 * @date     August 15.  2019
@@ -18,24 +18,45 @@ extern "C" {
 #include "stdint.h"
 #include <stdbool.h>
 
-
+/*
+ * Single-producer/single-consumer FIFO.
+ * hwWrite is only written by the producer and hwRead only by the consumer,
+ * both are free running and masked on buffer access, so an ISR and the
+ * main loop can share one FIFO without a critical section.
+ */
 typedef struct ringbuffer {
     uint8_t *pbyBuf;
-    uint16_t hwSize;
-    uint16_t hwWrite;
-    uint16_t hwRead;
-    uint16_t hwDataLen;
+    uint16_t hwSize;					//power of two
+    uint16_t hwMask;					//hwSize - 1
+    volatile uint16_t hwWrite;			//free running write index, producer side
+    volatile uint16_t hwRead;			//free running read index, consumer side
 } ringbuffer_t;
 
+#define RINGBUF_IS_POW2(n)		(((n) != 0U) && (((n) & ((n) - 1U)) == 0U))
+#define RINGBUF_MAX_SIZE		(0x8000U)
+
+/// keeps the compiler from moving data accesses across an index update
+#define ringbuffer_barrier()	__asm__ volatile("" ::: "memory")
+
+/** 
+  \brief  Initializes the FIFO on a user buffer.
+  \param  [in] ptFifo: The fifo to be initialized.
+  \param  [in] pbyBuf: The buffer used to store fifo data.
+  \param  [in] hwSize: The size of the buffer, a power of two(max RINGBUF_MAX_SIZE).
+  \return true: done, false: hwSize is 0 or not a power of two, ptFifo is left untouched.
+  */
+bool ringbuffer_init(ringbuffer_t *ptFifo, uint8_t *pbyBuf, uint16_t hwSize);
+
 /** 
   \brief  Removes the entire FIFO contents.
   \param  [in] ptFifo: The fifo to be emptied.
   \return None.
+  \note   Not safe against a running producer or consumer, use ringbuffer_out to discard data.
   */
 void ringbuffer_reset(ringbuffer_t *ptFifo);
 
 /** 
-  \brief  Puts some data into the FIFO.
+  \brief  Puts some data into the FIFO, producer side.
   \param  [in] ptFifo: The fifo to be used.
   \param  [in] pDataIn: The data to be added.
   \param  [in] hwLen: The length of the data to be added.
@@ -47,9 +68,9 @@ void ringbuffer_reset(ringbuffer_t *ptFifo);
 uint32_t ringbuffer_in(ringbuffer_t *ptFifo, const void *in, uint16_t len);
 
 /** 
-  \brief  Gets some data from the FIFO.
+  \brief  Gets some data from the FIFO, consumer side.
   \param  [in] ptFifo: The fifo to be used.
-  \param  [in] pOutBuf: Where the data must be copied.
+  \param  [in] pOutBuf: Where the data must be copied, NULL to discard.
   \param  [in] hwLen: The size of the destination buffer.
   \return The number of copied bytes.
   \note   This function copies at most @len bytes from the FIFO into
@@ -58,27 +79,53 @@ uint32_t ringbuffer_in(ringbuffer_t *ptFifo, const void *in, uint16_t len);
 uint32_t ringbuffer_out(ringbuffer_t *ptFifo, void *out, uint16_t len);
 
 /** 
-  \brief  Puts one byte data into the FIFO.
+  \brief  Puts one byte data into the FIFO, producer side.
   \param  [in] ptFifo: The fifo to be used.
-  \param  [in] pDataIn: The data to be added.
-  \param  [in] hwLen: The length of the data to be added.
-  \return The number of bytes copied.
-  \note   This function copies at most @len bytes from the @in into
-  *         the FIFO depending on the free space, and returns the number
-  *         of bytes copied.
+  \param  [in] byDataIn: The data to be added.
+  \return The number of bytes copied, 0/1
   */
-void ringbuffer_byte_in(ringbuffer_t *ptFifo, uint8_t in);
+uint8_t ringbuffer_byte_in(ringbuffer_t *ptFifo, uint8_t in);
 
 /** 
-  \brief  gets one byte data from the FIFO.
+  \brief  gets one byte data from the FIFO, consumer side.
   \param  [in] ptFifo: The fifo to be used.
   \param  [in] pOutBuf: Where the data must be copied.
   \return The number of read bytes, 0/1
-  \note   This function copies at most @len bytes from the FIFO into
-  *       the @out and returns the number of copied bytes.
   */
 uint8_t ringbuffer_byte_out(ringbuffer_t *ptFifo, void *pOutBuf);
 
+/** 
+  \brief  Gets the contiguous readable span at the read index, consumer side.
+  \param  [in] ptFifo: The fifo to be used.
+  \param  [out] ppbyData: Start of the span, data may be parsed in place.
+  \return The length of the span, data behind the buffer end is returned by the next call.
+  */
+uint16_t ringbuffer_out_span(ringbuffer_t *ptFifo, uint8_t **ppbyData);
+
+/** 
+  \brief  Releases bytes returned by ringbuffer_out_span, consumer side.
+  \param  [in] ptFifo: The fifo to be used.
+  \param  [in] hwLen: The number of bytes consumed, not more than the span length.
+  \return None.
+  */
+void ringbuffer_out_commit(ringbuffer_t *ptFifo, uint16_t hwLen);
+
+/** 
+  \brief  Gets the contiguous writable span at the write index, producer side.
+  \param  [in] ptFifo: The fifo to be used.
+  \param  [out] ppbyData: Start of the span, data may be written in place.
+  \return The length of the span.
+  */
+uint16_t ringbuffer_in_span(ringbuffer_t *ptFifo, uint8_t **ppbyData);
+
+/** 
+  \brief  Publishes bytes written into the span of ringbuffer_in_span, producer side.
+  \param  [in] ptFifo: The fifo to be used.
+  \param  [in] hwLen: The number of bytes written, not more than the span length.
+  \return None.
+  */
+void ringbuffer_in_commit(ringbuffer_t *ptFifo, uint16_t hwLen);
+
 /** 
   \brief  Returns the size of the FIFO in bytes.
   \param  [in] ptFifo: The fifo to be used.
@@ -96,7 +143,7 @@ static inline uint32_t ringbuffer_size(ringbuffer_t *ptFifo)
   */
 static inline uint16_t ringbuffer_len(ringbuffer_t *ptFifo)
 {
-    return ptFifo->hwDataLen;
+    return (uint16_t)(ptFifo->hwWrite - ptFifo->hwRead);
 }
 
 /** 
@@ -106,7 +153,7 @@ static inline uint16_t ringbuffer_len(ringbuffer_t *ptFifo)
   */
 static inline uint16_t ringbuffer_avail(ringbuffer_t *ptFifo)
 {
-    return (ptFifo->hwSize - ptFifo->hwDataLen);
+    return (ptFifo->hwSize - ringbuffer_len(ptFifo));
 }
 
 /** 
@@ -117,7 +164,7 @@ static inline uint16_t ringbuffer_avail(ringbuffer_t *ptFifo)
   */
 static inline bool ringbuffer_is_empty(ringbuffer_t *ptFifo)
 {
-    return (ringbuffer_len(ptFifo) == 0U);
+    return (ptFifo->hwWrite == ptFifo->hwRead);
 }
 /** 
   \brief  Is the FIFO full?
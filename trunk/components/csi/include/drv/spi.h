@@ -93,15 +93,28 @@ typedef struct
 	uint8_t             byInter;            //int source
 }csi_spi_config_t;
 
+/// NSS is not touched by the async transfers(user or hardware NSS)
+#define SPI_NSS_NONE		((pin_name_e)0xff)
+
+/// spi fifo depth(frames)
+#define SPI_FIFO_DEPTH		8U
+
+/// async transfer complete/error callback, runs in the spi interrupt
+typedef void (*csi_spi_callback_t)(csp_spi_t *ptSpiBase, csi_spi_event_e eEvent, void *pArg);
+
 typedef struct
 {
-	uint8_t             *pbyTxData;      ///< Output data buf
-	uint8_t             *pbyRxData;      ///< Input  data buf
-    uint8_t             byTxSize;        ///< Output data size specified by user
-    uint8_t             byRxSize;        ///< Input  data size specified by user
+	uint8_t             *pbyTxData;      ///< Output data buf, NULL = send 0x00
+	uint8_t             *pbyRxData;      ///< Input  data buf, NULL = discard
+    uint32_t            wTxSize;         ///< Output data left to write to the fifo
+    uint32_t            wRxSize;         ///< Input  data left to read from the fifo
 	uint8_t             byRxFifoLength;  ///< receive fifo length
 	uint8_t             byInter;  		 ///< interrupt
 	uint8_t             byWorkMode;      ///< master or slave
+	uint8_t             byAsync;         ///< async transfer running, \ref csi_spi_event_e on completion
+	pin_name_e          eNssPin;         ///< NSS pin driven by async transfers, SPI_NSS_NONE = not driven
+	csi_spi_callback_t  callback;        ///< async completion callback
+	void                *pArg;           ///< argument of callback
     csi_state_t         tState;          ///< Peripheral state
 }csi_spi_transmit_t;
 extern csi_spi_transmit_t g_tSpiTransmit; 
@@ -239,6 +252,23 @@ csi_error_t csi_spi_send_receive_async(csp_spi_t *ptSpiBase, void *pDataout, voi
  */ 
 csi_error_t csi_spi_Internal_variables_init(spi_rxifl_e eRxLen,uint8_t byInter,csi_spi_mode_e eMode);
 
+/** \brief attach the async transfer callback
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] callback: called in the spi interrupt when an async transfer ends, NULL = none
+ *  \param[in] pArg: argument of callback
+ *  \return none
+ */ 
+void csi_spi_attach_callback(csp_spi_t *ptSpiBase, csi_spi_callback_t callback, void *pArg);
+
+/** \brief select the NSS pin the async transfers pull low at start and release at the end
+ * 
+ *  \param[in] ptSpiBase: pointer of spi register structure
+ *  \param[in] eNssPin: gpio used as NSS, SPI_NSS_NONE = leave NSS to the user(default PB05 in master mode)
+ *  \return none
+ */ 
+void csi_spi_set_nss(csp_spi_t *ptSpiBase, pin_name_e eNssPin);
+
 //interrupt
 /** \brief spi interrupt handle function
  * 
@@ -19,6 +19,7 @@
 #include <drv/spi.h>
 #include <drv/qspi.h>
 #include <drv/common.h>
+#include <drv/swtimer.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,7 +31,20 @@ extern "C" {
 * \return    24bit flash id
 */
 
-#define FLASH_ID_BUILD(VENDOR_ID,DEVICE_ID)
+#define FLASH_ID_BUILD(VENDOR_ID,DEVICE_ID)	((((uint32_t)(VENDOR_ID) & 0xffU) << 16) | ((uint32_t)(DEVICE_ID) & 0xffffU))
+
+/// status register poll period of the async erase(ms)
+#ifndef CONFIG_SPIFLASH_POLL_MS
+#define CONFIG_SPIFLASH_POLL_MS		2U
+#endif
+
+/// spi clock used by csi_spiflash_spi_init
+#ifndef CONFIG_SPIFLASH_BAUD
+#define CONFIG_SPIFLASH_BAUD		12000000U
+#endif
+
+/// erase types kept from SFDP(4 at most)
+#define SPIFLASH_ERASE_TYPES		4U
 
 /**
 * \struct csi_spiflash_lock_info_t
@@ -92,11 +106,6 @@ typedef enum {
     SPIFLASH_DATA_4_LINES = 4
 } csi_spiflash_data_line_t;
 
-typedef union {
-    csi_spi_t   spi;
-    csi_qspi_t  qspi;
-} csi_spi_qspi_t;
-
 /**
 \brief Flash information
 */
@@ -109,23 +118,45 @@ typedef struct {
     uint32_t page_size;                   ///< Page size for read or program
 } csi_spiflash_info_t;
 
+typedef struct csi_spiflash csi_spiflash_t;
+
+/**
+\brief Async erase done callback, runs in csi_swtimer_process(main loop)
+*/
+typedef void (*csi_spiflash_cb_t)(csi_spiflash_t *spiflash, csi_error_t result, void *arg);
+
 /**
 \brief Flash control block
+
+ The chip has one register based spi controller and no qspi, the handle
+ keeps the register base instead of a csi_spi_t/csi_qspi_t union.
+ spi_send/spi_receive carry every flash command. A caller may set them
+ (e.g. to a flash model) before csi_spiflash_spi_init, the probe then
+ goes through them as well, NULL = spi0.
 */
-typedef struct {
-    csi_spi_qspi_t spi_qspi;               ///< Spi/qspi handle
-    void (*spi_cs_callback)(csi_gpio_pin_state_t value);
+struct csi_spiflash {
+    csp_spi_t      *spi_base;              ///< Spi register base
+    void (*spi_cs_callback)(csi_gpio_pin_state_e value);   ///< Chip select, NULL = PB05
     void           *flash_prv_info;        ///< Point to vendor private feature struct
     int32_t (*spi_send)(void *spi, uint8_t cmd, uint32_t addr, uint32_t addr_size, const void *data, uint32_t size);
     int32_t (*spi_receive)(void *spi, uint8_t cmD, uint32_t addr, uint32_t addr_size, void *data, uint32_t size);
     void           *priv;                  ///< User private param
-} csi_spiflash_t;
+    csi_spiflash_info_t info;              ///< Probed flash information
+    uint8_t        erase_cmd[SPIFLASH_ERASE_TYPES];     ///< Erase opcodes, largest size first, 0 = unused
+    uint8_t        erase_shift[SPIFLASH_ERASE_TYPES];   ///< log2 of the erase sizes
+    volatile uint8_t busy;                 ///< Async erase running
+    uint32_t       erase_addr;             ///< Async erase: next address
+    uint32_t       erase_end;              ///< Async erase: end address
+    csi_spiflash_cb_t callback;            ///< Async erase done callback
+    void           *arg;                   ///< Argument of callback
+    csi_swtimer_t  poll_timer;             ///< Status register poll of the async erase
+};
 
 /**
   \brief       Initialize SPIFLASH with spi controler  and probe flash device
   \param[in]   spi        SPIFLASH handle
   \param[in]   spi_idx    SPI controler index
-  \param[in]   spi_cs     GPIO info for chip select,if NULL, not use gpio cs
+  \param[in]   spi_cs     Chip select callback(csi_gpio_pin_state_e), NULL = PB05 as gpio cs
   \return      Error code
 */
 csi_error_t csi_spiflash_spi_init(csi_spiflash_t *spiflash, uint32_t spi_idx, void *spi_cs_callback);
@@ -194,6 +225,28 @@ int32_t csi_spiflash_program(csi_spiflash_t *spiflash, uint32_t offset, const vo
 */
 csi_error_t csi_spiflash_erase(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size);
 
+/**
+  \brief       Erase Flash without blocking, the busy poll runs on a software timer
+               (csi_swtimer_process must be called from the main loop)
+  \param[in]   spiflash  SPIFLASH handle to operate
+  \param[in]   offset    Data address, erase size aligned
+  \param[in]   size      Length to be erased, erase size aligned
+  \param[in]   callback  Called when the range is erased or failed, may be NULL
+  \param[in]   arg       Argument of callback
+  \return      Error code, CSI_BUSY while the previous async erase runs
+*/
+csi_error_t csi_spiflash_erase_async(csi_spiflash_t *spiflash, uint32_t offset, uint32_t size, csi_spiflash_cb_t callback, void *arg);
+
+/**
+  \brief       Check whether an async erase is running
+  \param[in]   spiflash  SPIFLASH handle to operate
+  \return      true: async erase running, other calls return CSI_BUSY
+*/
+static inline bool csi_spiflash_is_busy(csi_spiflash_t *spiflash)
+{
+    return spiflash->busy != 0U;
+}
+
 /**
   \brief       Read flash status register
   \param[in]   handle    SPIFLASH handle to operate
@@ -0,0 +1,113 @@
+/***********************************************************************//**
+ * \file  swtimer.h
+ * \brief  software timer service on the system tick(hierarchical timer wheel)
+ * \copyright Copyright (C) 2015-2021 @ APTCHIP
+ * <table>
+ * <tr><th> Date  <th>Version  <th>Author  <th>Description
+ * <tr><td> 2021-6-2 <td>V0.0  <td>ZJY   <td>initial
+ * </table>
+ * *********************************************************************
+*/
+
+#ifndef _DRV_SWTIMER_H_
+#define _DRV_SWTIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <drv/common.h>
+#include <drv/list.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// slots per wheel level = 2^CONFIG_SWTIMER_WHEEL_BITS
+#ifndef CONFIG_SWTIMER_WHEEL_BITS
+#define CONFIG_SWTIMER_WHEEL_BITS		3U
+#endif
+
+/// wheel levels, the wheel spans 2^(BITS*LEVELS) ticks, longer timers are cascaded again
+#ifndef CONFIG_SWTIMER_WHEEL_LEVELS
+#define CONFIG_SWTIMER_WHEEL_LEVELS		4U
+#endif
+
+typedef void (*csi_swtimer_cb_t)(void *pArg);
+
+typedef enum {
+	SWTIMER_DEFER		= 0,		//callback runs in csi_swtimer_process(main loop)
+	SWTIMER_IN_ISR		= 1			//callback runs in the tick interrupt, keep it short
+} csi_swtimer_ctx_e;
+
+/// timer object, allocated by the user(static), contents are private to swtimer.c
+typedef struct {
+	dlist_t				tNode;			//wheel slot
+	dlist_t				tPend;			//deferred callback queue
+	uint32_t			wExpire;		//expiry tick
+	uint32_t			wPeriod;		//reload(ticks), 0 = one shot
+	csi_swtimer_cb_t	callback;
+	void				*pArg;
+	uint8_t				byCtx;			//\ref csi_swtimer_ctx_e
+} csi_swtimer_t;
+
+/** \brief initialize a timer object
+ *
+ *  \param[in] ptTimer: timer object
+ *  \param[in] callback: function called on expiry
+ *  \param[in] pArg: argument of callback
+ *  \param[in] eCtx: where the callback runs \ref csi_swtimer_ctx_e
+ *  \return none
+ */
+void csi_swtimer_init(csi_swtimer_t *ptTimer, csi_swtimer_cb_t callback, void *pArg, csi_swtimer_ctx_e eCtx);
+
+/** \brief (re)start a timer, O(1), ISR safe
+ *
+ *  \param[in] ptTimer: timer object
+ *  \param[in] wTimeMs: time to the first expiry(ms), resolution is one tick
+ *  \param[in] wPeriodMs: period after the first expiry(ms), 0 = one shot
+ *  \return error code \ref csi_error_t
+ */
+csi_error_t csi_swtimer_start(csi_swtimer_t *ptTimer, uint32_t wTimeMs, uint32_t wPeriodMs);
+
+/** \brief stop a timer and drop a queued callback, O(1), ISR safe
+ *
+ *  \param[in] ptTimer: timer object
+ *  \return none
+ */
+void csi_swtimer_stop(csi_swtimer_t *ptTimer);
+
+/** \brief timer is waiting for its expiry
+ *
+ *  \param[in] ptTimer: timer object
+ *  \return true: armed; false: stopped or one shot expired
+ */
+static inline bool csi_swtimer_is_active(csi_swtimer_t *ptTimer)
+{
+	return !dlist_empty(&ptTimer->tNode);
+}
+
+/** \brief run the deferred callbacks of expired timers, call it from the main loop
+ *
+ *  \param[in] none
+ *  \return none
+ */
+void csi_swtimer_process(void);
+
+/** \brief advance the wheel up to the current tick, called by the tick interrupt
+ *
+ *  \param[in] none
+ *  \return none
+ */
+void csi_swtimer_tick(void);
+
+/** \brief ticks until the next timer expires(tickless sleep)
+ *
+ *  \param[in] none
+ *  \return ticks, 0 = expired/deferred callbacks waiting, 0xFFFFFFFF = no timer
+ */
+uint32_t csi_swtimer_idle_ticks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DRV_SWTIMER_H_ */
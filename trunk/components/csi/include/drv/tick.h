@@ -20,6 +20,14 @@
 #define CONFIG_SYSTICK_HZ  100U
 #endif
 
+#define TICK_IDLE_FOREVER	(0xFFFFFFFFU)
+
+/// timeout counted on the coret counter, for busy-waits that may run with interrupts masked
+typedef struct {
+	uint32_t wLast;			//coret value at the last poll
+	uint32_t wLeft;			//cycles left
+} csi_tick_deadline_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -53,6 +61,50 @@ uint32_t csi_tick_get_ms(void);
 */
 uint64_t csi_tick_get_us(void);
 
+/**
+  \brief       Get the coret cycles which start from csi_tick_init, for latency profiling
+  \return      the cycles which start from csi_tick_init, rate is soc_get_coret_freq()
+*/
+uint64_t csi_tick_get_cycles(void);
+
+/**
+  \brief       Reprogram the tick and its cached time scales after the system clock changed,
+               called by csi_sysclk_config, does nothing before csi_tick_init
+*/
+void csi_tick_clk_update(void);
+
+/**
+  \brief       Get how long the tick interrupt may stay off
+  \return      ms until the next software deadline, 0 = tick needed, TICK_IDLE_FOREVER = none
+*/
+uint32_t csi_tick_idle_ms(void);
+
+/**
+  \brief       Stop CORET for a tickless sleep, call with interrupts disabled
+*/
+void csi_tick_suspend(void);
+
+/**
+  \brief       Restart CORET after a tickless sleep and account for the time slept,
+               call with interrupts disabled
+  \param[in]   wSleepUs   time spent with the tick suspended(us), measured by LPT/RTC
+*/
+void csi_tick_resume(uint32_t wSleepUs);
+
+/**
+  \brief       Start a busy-wait timeout, independent of the tick interrupt
+  \param[in]   ptDeadline  deadline to start
+  \param[in]   wMs         timeout(ms), at most 80s at 48MHz
+*/
+void csi_tick_deadline_start(csi_tick_deadline_t *ptDeadline, uint32_t wMs);
+
+/**
+  \brief       Check a busy-wait timeout, has to be polled at least once per tick period
+  \param[in]   ptDeadline  deadline started by csi_tick_deadline_start
+  \return      true: timeout elapsed
+*/
+bool csi_tick_deadline_expired(csi_tick_deadline_t *ptDeadline);
+
 /**
   \brief       Increase the sys-tick
 */
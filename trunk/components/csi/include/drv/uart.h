@@ -104,6 +104,7 @@ typedef enum{
 	//send mode
 	UART_TX_MODE_POLL		=	0,	//polling mode, no interrupt
 	UART_TX_MODE_INT		=	1,	//tx use interrupt mode(TXDONE)
+	UART_TX_MODE_INT_FIFO	=	2,	//tx use interrupt mode(TXFIFO), fill tx fifo from tx ringbuffer
 	//receive
 	UART_RX_MODE_POLL		=	0,	//polling mode, no interrupt
 	UART_RX_MODE_INT_FIX	=	1,	//rx use interrupt mode(RXFIFO), receive assign(fixed) length data		
@@ -132,6 +133,7 @@ typedef struct {
 	uint16_t            hwRxSize;			//tx send data size
 	uint8_t				*pbyTxData;			//pointer of send buf 
 	ringbuffer_t		*ptRingBuf;			//pointer of ringbuffer		
+	ringbuffer_t		*ptTxRingBuf;		//pointer of tx ringbuffer, UART_TX_MODE_INT_FIFO
 } csi_uart_trans_t;
 
 extern csi_uart_trans_t g_tUartTran[UART_IDX_NUM];	
@@ -163,10 +165,20 @@ void csi_uart_stop(csp_uart_t *ptUartBase);
   \param[in]   ptUartBase	pointer of uart register structure
   \param[in]   ptRingbuf	pointer of receive ringbuf
   \param[in]   pbyRdBuf		pointer of uart receive buffer
-  \param[in]   hwLen		uart  receive buffer length
-  \return 	   error code \ref csi_error_t
+  \param[in]   hwLen		uart  receive buffer length, a power of two
+  \return 	   error code \ref csi_error_t, CSI_ERROR: hwLen is not a power of two
  */ 
-void csi_uart_set_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyRdBuf,  uint16_t hwLen);
+csi_error_t csi_uart_set_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyRdBuf,  uint16_t hwLen);
+
+/** 
+  \brief 	   set uart send buffer and buffer depth, used by UART_TX_MODE_INT_FIFO
+  \param[in]   ptUartBase	pointer of uart register structure
+  \param[in]   ptRingbuf	pointer of send ringbuf
+  \param[in]   pbyTxBuf		pointer of uart send buffer
+  \param[in]   hwLen		uart send buffer length, a power of two
+  \return 	   error code \ref csi_error_t, CSI_ERROR: hwLen is not a power of two
+ */ 
+csi_error_t csi_uart_set_tx_buffer(csp_uart_t *ptUartBase, ringbuffer_t *ptRingbuf, uint8_t *pbyTxBuf,  uint16_t hwLen);
 
 /**
   \brief       Start send data to UART transmitter, this function is blocking.
@@ -183,7 +195,7 @@ int32_t csi_uart_send(csp_uart_t *ptUartBase, const void *pData, uint16_t hwSize
   \param[in]   ptUartBase	pointer of uart register structure
   \param[in]   pData		pointer to buffer with data to send to uart transmitter.
   \param[in]   wSize		number of data to send (byte).
-  \return      error code \ref csi_error_t
+  \return      error code \ref csi_error_t, CSI_BUSY: sending(TXDONE mode) or not enough room in tx ringbuffer(TXFIFO mode)
  */
 csi_error_t csi_uart_send_async(csp_uart_t *ptUartBase, const void *pData, uint16_t hwSize);
 
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2015-2021 @ APTCHIP
+ */
+
+/******************************************************************************
+ * @file     foc.h
+ * @brief    field oriented control kernels, Q15 fixed point
+ * @version  V1.0
+ * @date     2021-06-24
+ ******************************************************************************/
+
+#ifndef _FOC_H_
+#define _FOC_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Values are Q15(0x7fff = 0.99997), products are kept in 32 bits(Q30) and
+ * rounded back to Q15 with saturation. No division, no float; ck801 has
+ * neither FPU nor DSP instructions.
+ *
+ * angle: uint16_t, 0x10000 = one electrical turn(0x4000 = 90 degree).
+ * voltage: 1.0 = Vdc, the linear range of foc_svpwm is |v| <= 1/sqrt(3).
+ *
+ * One current loop, at 20kHz on the 48MHz ck801 there are 2400 cycles per period:
+ *   foc_clarke -> foc_sincos -> foc_park -> foc_pi_run(d, q) -> foc_ipark -> foc_svpwm
+ * FOC_CYC_xxx is the cycle budget of each kernel(call included), together
+ * 530 cycles or 22% of the period; foc_benchmark_demo() measures them with CORET.
+ */
+#define FOC_CYC_SINCOS			60
+#define FOC_CYC_CLARKE			40
+#define FOC_CYC_PARK			60
+#define FOC_CYC_IPARK			60
+#define FOC_CYC_PI				80
+#define FOC_CYC_SVPWM			150
+
+#define FOC_Q15_MAX				0x7fff
+#define FOC_Q15_MIN				(-0x8000)
+#define FOC_DUTY_MAX			0x8000			//duty 1.0 of foc_svpwm, same as EPT_DUTY_Q15_MAX
+
+typedef struct {
+	int16_t		nA;				//phase a
+	int16_t		nB;				//phase b
+} foc_ab_t;
+
+typedef struct {
+	int16_t		nAlpha;
+	int16_t		nBeta;
+} foc_albe_t;
+
+typedef struct {
+	int16_t		nD;
+	int16_t		nQ;
+} foc_dq_t;
+
+typedef struct {
+	int16_t		nSin;
+	int16_t		nCos;
+} foc_sincos_t;
+
+/// saturating PI controller, gains are nKp / 2^byShift and nKi / 2^byShift
+typedef struct {
+	int16_t		nKp;			//proportional gain, >= 0
+	int16_t		nKi;			//integral gain per call, >= 0
+	uint8_t		byShift;		//gain scale 0~15, e.g. 12: gains up to 8.0 in steps of 1/4096
+	int16_t		nOutMin;		//output limits, the integrator is clamped to them as well
+	int16_t		nOutMax;
+	int32_t		iInteg;			//integrator, scaled by 2^byShift
+} foc_pi_t;
+
+/**
+  \brief       saturate to Q15
+  \param[in]   iVal		value
+  \return      iVal limited to FOC_Q15_MIN ~ FOC_Q15_MAX
+*/
+static inline int16_t foc_sat_q15(int32_t iVal)
+{
+	if(iVal > FOC_Q15_MAX)
+		return FOC_Q15_MAX;
+	if(iVal < FOC_Q15_MIN)
+		return FOC_Q15_MIN;
+	return (int16_t)iVal;
+}
+
+/**
+  \brief       sin and cos of an angle, 256 entry table with linear interpolation,
+               error below 9e-5(3 LSB)
+  \param[in]   hwTheta	angle, 0x10000 = one turn
+  \param[out]  ptSc		sin and cos in Q15
+  \return      none
+*/
+void foc_sincos(uint16_t hwTheta, foc_sincos_t *ptSc);
+
+/**
+  \brief       Clarke transform of two phase currents(ia + ib + ic = 0)
+               alpha = ia, beta = (ia + 2 * ib) / sqrt(3)
+  \param[in]   ptIab	phase currents in Q15
+  \param[out]  ptOut	alpha/beta in Q15
+  \return      none
+*/
+void foc_clarke(const foc_ab_t *ptIab, foc_albe_t *ptOut);
+
+/**
+  \brief       Park transform, d = alpha * cos + beta * sin, q = beta * cos - alpha * sin
+  \param[in]   ptIn		alpha/beta in Q15
+  \param[in]   ptSc		sin/cos of the rotor angle(foc_sincos)
+  \param[out]  ptOut	d/q in Q15
+  \return      none
+*/
+void foc_park(const foc_albe_t *ptIn, const foc_sincos_t *ptSc, foc_dq_t *ptOut);
+
+/**
+  \brief       inverse Park transform, alpha = d * cos - q * sin, beta = d * sin + q * cos
+  \param[in]   ptIn		d/q in Q15
+  \param[in]   ptSc		sin/cos of the rotor angle(foc_sincos)
+  \param[out]  ptOut	alpha/beta in Q15
+  \return      none
+*/
+void foc_ipark(const foc_dq_t *ptIn, const foc_sincos_t *ptSc, foc_albe_t *ptOut);
+
+/**
+  \brief       space vector PWM, min-max zero sequence injection(same duties as the
+               sector/dwell time method). The compare values follow the mapping of
+               csi_ept_duty_q15_to_cmp and go straight to csi_ept_mc_update_cmp.
+  \param[in]   ptV		alpha/beta voltage in Q15, 1.0 = Vdc
+  \param[in]   hwScale	period scale of the timer, gEptPrd + 1 for EPT
+  \param[out]  hwCmp	compare values of phase a, b, c(CMPA~CMPC)
+  \return      sector 1~6(sector 1: 0~60 degree), 0 for a zero vector
+*/
+uint8_t foc_svpwm(const foc_albe_t *ptV, uint16_t hwScale, uint16_t hwCmp[3]);
+
+/**
+  \brief       init a PI controller, integrator cleared
+  \param[in]   ptPi		PI controller
+  \param[in]   nKp		proportional gain * 2^byShift
+  \param[in]   nKi		integral gain * 2^byShift
+  \param[in]   byShift	gain scale 0~15
+  \param[in]   nOutMin	lower output limit
+  \param[in]   nOutMax	upper output limit
+  \return      none
+*/
+void foc_pi_init(foc_pi_t *ptPi, int16_t nKp, int16_t nKi, uint8_t byShift, int16_t nOutMin, int16_t nOutMax);
+
+/**
+  \brief       one step of the PI controller. The integrator is clamped to the
+               output limits and holds while the output is saturated in the
+               direction of the error(anti windup).
+  \param[in]   ptPi		PI controller
+  \param[in]   nRef		reference in Q15
+  \param[in]   nFb		feedback in Q15
+  \return      output, nOutMin ~ nOutMax
+*/
+int16_t foc_pi_run(foc_pi_t *ptPi, int16_t nRef, int16_t nFb);
+
+/**
+  \brief       clear the integrator of a PI controller
+  \param[in]   ptPi		PI controller
+  \return      none
+*/
+static inline void foc_pi_reset(foc_pi_t *ptPi)
+{
+	ptPi->iInteg = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FOC_H_ */
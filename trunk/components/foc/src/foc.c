@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2015-2021 @ APTCHIP
+ */
+
+/******************************************************************************
+ * @file     foc.c
+ * @brief    field oriented control kernels, Q15 fixed point
+ * @version  V1.0
+ * @date     2021-06-24
+ ******************************************************************************/
+
+#include <stdint.h>
+#include "foc.h"
+
+#define FOC_INV_SQRT3			18919			//1/sqrt(3) in Q15
+#define FOC_SQRT3_2				28378			//sqrt(3)/2 in Q15
+
+/// sin(2 * pi * i / 256) in Q15, entry 256 repeats entry 0 for the interpolation. The entries are
+/// scaled by 1 + h^2 / 12(h = 2 * pi / 256) to spread the chord error of the interpolation to both sides.
+static const int16_t s_nSinTab[257] = {
+	     0,    804,   1608,   2411,   3212,   4011,   4808,   5602,
+	  6393,   7180,   7962,   8740,   9513,  10279,  11040,  11794,
+	 12540,  13280,  14011,  14734,  15448,  16152,  16847,  17532,
+	 18206,  18869,  19521,  20161,  20789,  21404,  22007,  22596,
+	 23172,  23733,  24281,  24813,  25331,  25834,  26321,  26792,
+	 27247,  27686,  28107,  28512,  28900,  29271,  29623,  29958,
+	 30275,  30574,  30854,  31116,  31359,  31583,  31788,  31973,
+	 32140,  32287,  32415,  32523,  32612,  32681,  32730,  32760,
+	 32767,  32760,  32730,  32681,  32612,  32523,  32415,  32287,
+	 32140,  31973,  31788,  31583,  31359,  31116,  30854,  30574,
+	 30275,  29958,  29623,  29271,  28900,  28512,  28107,  27686,
+	 27247,  26792,  26321,  25834,  25331,  24813,  24281,  23733,
+	 23172,  22596,  22007,  21404,  20789,  20161,  19521,  18869,
+	 18206,  17532,  16847,  16152,  15448,  14734,  14011,  13280,
+	 12540,  11794,  11040,  10279,   9513,   8740,   7962,   7180,
+	  6393,   5602,   4808,   4011,   3212,   2411,   1608,    804,
+	     0,   -804,  -1608,  -2411,  -3212,  -4011,  -4808,  -5602,
+	 -6393,  -7180,  -7962,  -8740,  -9513, -10279, -11040, -11794,
+	-12540, -13280, -14011, -14734, -15448, -16152, -16847, -17532,
+	-18206, -18869, -19521, -20161, -20789, -21404, -22007, -22596,
+	-23172, -23733, -24281, -24813, -25331, -25834, -26321, -26792,
+	-27247, -27686, -28107, -28512, -28900, -29271, -29623, -29958,
+	-30275, -30574, -30854, -31116, -31359, -31583, -31788, -31973,
+	-32140, -32287, -32415, -32523, -32612, -32681, -32730, -32760,
+	-32768, -32760, -32730, -32681, -32612, -32523, -32415, -32287,
+	-32140, -31973, -31788, -31583, -31359, -31116, -30854, -30574,
+	-30275, -29958, -29623, -29271, -28900, -28512, -28107, -27686,
+	-27247, -26792, -26321, -25834, -25331, -24813, -24281, -23733,
+	-23172, -22596, -22007, -21404, -20789, -20161, -19521, -18869,
+	-18206, -17532, -16847, -16152, -15448, -14734, -14011, -13280,
+	-12540, -11794, -11040, -10279,  -9513,  -8740,  -7962,  -7180,
+	 -6393,  -5602,  -4808,  -4011,  -3212,  -2411,  -1608,   -804,
+	     0
+};
+
+/// sector of the sign pattern N = (v1 > 0) + 2 * (v2 > 0) + 4 * (v3 > 0)
+static const uint8_t s_bySectorMap[8] = {0, 2, 6, 1, 4, 3, 5, 0};
+
+/**
+  \brief       Q30 product sum to Q15, rounded and saturated
+  \param[in]   iVal		value in Q30
+  \return      value in Q15
+*/
+static inline int16_t apt_foc_q30_to_q15(int32_t iVal)
+{
+	return foc_sat_q15((iVal + 0x4000) >> 15);
+}
+
+static inline int16_t apt_foc_sin(uint16_t hwTheta)
+{
+	const int16_t *pnTab = &s_nSinTab[hwTheta >> 8];
+	int32_t iFrac = hwTheta & 0xff;
+	
+	return (int16_t)(pnTab[0] + (((pnTab[1] - pnTab[0]) * iFrac + 0x80) >> 8));
+}
+
+void foc_sincos(uint16_t hwTheta, foc_sincos_t *ptSc)
+{
+	ptSc->nSin = apt_foc_sin(hwTheta);
+	ptSc->nCos = apt_foc_sin((uint16_t)(hwTheta + 0x4000));
+}
+
+void foc_clarke(const foc_ab_t *ptIab, foc_albe_t *ptOut)
+{
+	int32_t iSum = (int32_t)ptIab->nA + 2 * (int32_t)ptIab->nB;
+	
+	ptOut->nAlpha = ptIab->nA;
+	ptOut->nBeta  = apt_foc_q30_to_q15(iSum * FOC_INV_SQRT3);
+}
+
+void foc_park(const foc_albe_t *ptIn, const foc_sincos_t *ptSc, foc_dq_t *ptOut)
+{
+	int32_t iAlpha = ptIn->nAlpha;
+	int32_t iBeta  = ptIn->nBeta;
+	
+	ptOut->nD = apt_foc_q30_to_q15(iAlpha * ptSc->nCos + iBeta * ptSc->nSin);
+	ptOut->nQ = apt_foc_q30_to_q15(iBeta * ptSc->nCos - iAlpha * ptSc->nSin);
+}
+
+void foc_ipark(const foc_dq_t *ptIn, const foc_sincos_t *ptSc, foc_albe_t *ptOut)
+{
+	int32_t iD = ptIn->nD;
+	int32_t iQ = ptIn->nQ;
+	
+	ptOut->nAlpha = apt_foc_q30_to_q15(iD * ptSc->nCos - iQ * ptSc->nSin);
+	ptOut->nBeta  = apt_foc_q30_to_q15(iD * ptSc->nSin + iQ * ptSc->nCos);
+}
+
+/**
+  \brief       duty in Q15 -> compare value, as csi_ept_duty_q15_to_cmp
+  \param[in]   iDuty	duty in Q15, clamped to 0 ~ FOC_DUTY_MAX
+  \param[in]   wScale	period scale
+  \return      compare value
+*/
+static inline uint16_t apt_foc_duty_to_cmp(int32_t iDuty, uint32_t wScale)
+{
+	if(iDuty < 0)
+		iDuty = 0;
+	else if(iDuty > FOC_DUTY_MAX)
+		iDuty = FOC_DUTY_MAX;
+	
+	return (uint16_t)(wScale - ((wScale * (uint32_t)iDuty) >> 15));
+}
+
+uint8_t foc_svpwm(const foc_albe_t *ptV, uint16_t hwScale, uint16_t hwCmp[3])
+{
+	int32_t iAlpha = ptV->nAlpha;
+	int32_t iBeta  = ptV->nBeta;
+	int32_t iHalfA = iAlpha >> 1;
+	int32_t iB3    = (iBeta * FOC_SQRT3_2 + 0x4000) >> 15;		//sqrt(3)/2 * beta
+	int32_t iA3    = (iAlpha * FOC_SQRT3_2 + 0x4000) >> 15;		//sqrt(3)/2 * alpha
+	int32_t iVa, iVb, iVc, iMax, iMin, iOfs;
+	uint8_t byN;
+	
+	//phase voltages
+	iVa = iAlpha;
+	iVb = iB3 - iHalfA;
+	iVc = -iB3 - iHalfA;
+	
+	//zero sequence -(max + min) / 2 centers the three duties
+	iMax = iVa;
+	iMin = iVa;
+	if(iVb > iMax)
+		iMax = iVb;
+	else
+		iMin = iVb;
+	if(iVc > iMax)
+		iMax = iVc;
+	else if(iVc < iMin)
+		iMin = iVc;
+	iOfs = (FOC_DUTY_MAX >> 1) - ((iMax + iMin) >> 1);
+	
+	hwCmp[0] = apt_foc_duty_to_cmp(iVa + iOfs, hwScale);
+	hwCmp[1] = apt_foc_duty_to_cmp(iVb + iOfs, hwScale);
+	hwCmp[2] = apt_foc_duty_to_cmp(iVc + iOfs, hwScale);
+	
+	//sector: v1 = beta, v2 = sqrt(3)/2 * alpha - beta / 2, v3 = -sqrt(3)/2 * alpha - beta / 2
+	byN = (iBeta > 0) | ((iA3 > (iBeta >> 1)) << 1) | ((-iA3 > (iBeta >> 1)) << 2);
+	
+	return s_bySectorMap[byN];
+}
+
+void foc_pi_init(foc_pi_t *ptPi, int16_t nKp, int16_t nKi, uint8_t byShift, int16_t nOutMin, int16_t nOutMax)
+{
+	ptPi->nKp     = nKp;
+	ptPi->nKi     = nKi;
+	ptPi->byShift = byShift;
+	ptPi->nOutMin = nOutMin;
+	ptPi->nOutMax = nOutMax;
+	ptPi->iInteg  = 0;
+}
+
+int16_t foc_pi_run(foc_pi_t *ptPi, int16_t nRef, int16_t nFb)
+{
+	int32_t iErr = foc_sat_q15((int32_t)nRef - nFb);
+	int32_t iInteg = ptPi->iInteg + ptPi->nKi * iErr;
+	int32_t iMax = (int32_t)ptPi->nOutMax << ptPi->byShift;
+	int32_t iMin = (int32_t)ptPi->nOutMin << ptPi->byShift;
+	int32_t iOut;
+	
+	if(iInteg > iMax)
+		iInteg = iMax;
+	else if(iInteg < iMin)
+		iInteg = iMin;
+	
+	iOut = (ptPi->nKp * iErr + iInteg) >> ptPi->byShift;
+	if(iOut > ptPi->nOutMax)
+	{
+		iOut = ptPi->nOutMax;
+		if(iErr > 0)
+			iInteg = ptPi->iInteg;							//hold, the output cannot follow
+	}
+	else if(iOut < ptPi->nOutMin)
+	{
+		iOut = ptPi->nOutMin;
+		if(iErr < 0)
+			iInteg = ptPi->iInteg;
+	}
+	
+	ptPi->iInteg = iInteg;
+	return (int16_t)iOut;
+}
@@ -39,7 +39,7 @@
  * Included Files
  ****************************************************************************/
 #include <stdint.h>
-#include "mm.h"
+#include "mm.h"          /* CONFIG_MM_* defaults, CONFIG_MM_POOL below */
 
 #ifdef __cplusplus
 extern "C" {
@@ -80,6 +80,9 @@ extern "C" {
  ****************************************************************************/
 void mm_heap_initialize(void);
 int32_t mm_get_mallinfo(int32_t *total, int32_t *used, int32_t *free, int32_t *peak);
+#if (CONFIG_MM_POOL)
+int32_t mm_get_poolinfo(int32_t ndx, int32_t *blksize, int32_t *total, int32_t *used, int32_t *peak);
+#endif
 void mm_leak_dump(void);
 
 #ifdef __cplusplus
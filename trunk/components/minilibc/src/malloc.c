@@ -26,12 +26,39 @@
 #define MALLOC_WEAK __attribute__((weak))
 #endif
 
+#ifdef CONFIG_KERNEL_NONE
+/* Small requests go to the fixed-size block pools, the rest and the
+ * overflow of an empty pool to the heap.
+ */
+static inline void *umm_malloc(size_t size, void *caller)
+{
+#if (CONFIG_MM_POOL)
+    void *ret = mm_pool_alloc(size);
+
+    if (ret) {
+        return ret;
+    }
+#endif
+    return mm_malloc(USR_HEAP, size, caller);
+}
+
+static inline void umm_free(void *ptr, void *caller)
+{
+#if (CONFIG_MM_POOL)
+    if (ptr && mm_pool_free(ptr)) {
+        return;
+    }
+#endif
+    mm_free(USR_HEAP, ptr, caller);
+}
+#endif
+
 MALLOC_WEAK void *malloc(size_t size)
 {
     void *ret;
 
 #ifdef CONFIG_KERNEL_NONE
-    ret = mm_malloc(USR_HEAP, size, __builtin_return_address(0U));
+    ret = umm_malloc(size, __builtin_return_address(0U));
 #else
     ret = csi_kernel_malloc(size, __builtin_return_address(0U));
 #endif
@@ -42,7 +69,7 @@ MALLOC_WEAK void *malloc(size_t size)
 MALLOC_WEAK void free(void *ptr)
 {
 #ifdef CONFIG_KERNEL_NONE
-    mm_free(USR_HEAP, ptr, __builtin_return_address(0U));
+    umm_free(ptr, __builtin_return_address(0U));
 #else
     csi_kernel_free(ptr, __builtin_return_address(0U));
 #endif
@@ -53,10 +80,34 @@ MALLOC_WEAK void *realloc(void *ptr, size_t size)
     void *new_ptr;
 
 #ifdef CONFIG_KERNEL_NONE
-    new_ptr = mm_malloc(USR_HEAP, size, __builtin_return_address(0U));
+#if (CONFIG_MM_POOL)
+    size_t blksize = ptr ? mm_pool_size(ptr) : 0;
+
+    if (ptr == NULL) {
+        return umm_malloc(size, __builtin_return_address(0U));
+    }
+
+    if (blksize) {
+        /* A pool block keeps serving what fits in it */
+        if (size == 0) {
+            mm_pool_free(ptr);
+            return NULL;
+        }
+        if (size <= blksize) {
+            return ptr;
+        }
+
+        new_ptr = umm_malloc(size, __builtin_return_address(0U));
+        if (new_ptr) {
+            memcpy(new_ptr, ptr, blksize);
+            mm_pool_free(ptr);
+        }
+        return new_ptr;
+    }
+#endif
+    new_ptr = mm_realloc(USR_HEAP, ptr, size, __builtin_return_address(0U));
 #else
     new_ptr = csi_kernel_malloc(size, __builtin_return_address(0U));
-#endif
 
     if (new_ptr == NULL) {
         return new_ptr;
@@ -64,13 +115,9 @@ MALLOC_WEAK void *realloc(void *ptr, size_t size)
 
     if (ptr) {
         memcpy(new_ptr, ptr, size);
-
-#ifdef CONFIG_KERNEL_NONE
-        mm_free(USR_HEAP, ptr, __builtin_return_address(0U));
-#else
         csi_kernel_free(ptr, __builtin_return_address(0U));
-#endif
     }
+#endif
 
     return new_ptr;
 }
@@ -80,7 +127,7 @@ MALLOC_WEAK void *calloc(size_t nmemb, size_t size)
     void *ptr = NULL;
 
 #ifdef CONFIG_KERNEL_NONE
-    ptr = mm_malloc(USR_HEAP, size * nmemb, __builtin_return_address(0U));
+    ptr = umm_malloc(size * nmemb, __builtin_return_address(0U));
 #else
     ptr = csi_kernel_malloc(size * nmemb, __builtin_return_address(0U));
 #endif
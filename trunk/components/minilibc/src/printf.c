@@ -142,10 +142,10 @@ int puts(const char *s)
 void _putchar(char character)
 {
     if (character == '\n') {
-        csi_uart_putc(console.uart, '\r');
+        console_putc('\r');
     }
 
-    csi_uart_putc(console.uart, character);
+    console_putc(character);
 
 }
 
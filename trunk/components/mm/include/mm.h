@@ -52,6 +52,11 @@
 #define CONFIG_MM_MAX_USED 1
 #endif 
 
+/* Fixed-size block pools in front of the heap, see mm_pool.c */
+#ifndef CONFIG_MM_POOL
+#define CONFIG_MM_POOL 0
+#endif
+
 #define true  1
 #define false 0
 #define OK  0
@@ -204,8 +209,8 @@ struct mallinfo
    typedef uint16_t mmsize_t;
 #  define MMSIZE_MAX 0xffff
 #else
-   typedef size_t mmsize_t;
-#  define MMSIZE_MAX SIZE_MAX
+   typedef uint32_t mmsize_t;
+#  define MMSIZE_MAX UINT32_MAX
 #endif
 
 /* This describes an allocated chunk.  An allocated chunk is
@@ -458,6 +463,80 @@ int mm_get_max_usedsize(void);
 int mm_max_usedsize_update(struct mm_heap_s *heap);
 #endif
 
+/* Functions contained in mm_pool.c *****************************************/
+
+/* Fixed-size block pools.  malloc() serves requests up to the largest block
+ * size from the smallest pool that fits, in O(1) and from interrupt context
+ * as well; it falls back to the heap when the pools are empty.  The storage
+ * of the pools is taken from the heap once by mm_pool_initialize().
+ */
+
+#if (CONFIG_MM_POOL)
+#ifndef CONFIG_MM_POOL_BLKSIZE
+#  define CONFIG_MM_POOL_BLKSIZE {16, 32, 64, 128} /* Ascending, multiples of 8 */
+#endif
+#ifndef CONFIG_MM_POOL_BLKNUM
+#  define CONFIG_MM_POOL_BLKNUM  {8, 8, 4, 2}      /* Blocks of each pool */
+#endif
+
+struct mm_pool_s
+{
+  void     *free;     /* First free block, holds the link to the next one */
+  uint8_t  *start;    /* Block storage */
+  uint8_t  *end;
+  uint16_t blksize;   /* Block size in bytes */
+  uint16_t nblks;     /* Blocks of the pool, 0 if the heap was too small */
+  uint16_t used;      /* Blocks handed out */
+  uint16_t peak;      /* High-water mark of used */
+  uint32_t fails;     /* Requests that found the pool empty */
+};
+
+int  mm_pool_initialize(struct mm_heap_s *heap);
+void *mm_pool_alloc(size_t size);
+bool mm_pool_free(void *mem);
+size_t mm_pool_size(void *mem);
+const struct mm_pool_s *mm_pool_info(int ndx);
+#endif
+
+/* Functions contained in mm_prof.c *****************************************/
+
+/* Profiling of mm_malloc/mm_free, off by default: the fragmentation sample
+ * walks the heap after every call.
+ */
+
+#ifndef CONFIG_MM_PROFILE
+#define CONFIG_MM_PROFILE 0
+#endif
+
+#if (CONFIG_MM_PROFILE)
+#define MM_PROF_MALLOC 0
+#define MM_PROF_FREE   1
+
+struct mm_prof_s
+{
+  uint32_t calls[2];            /* Calls of mm_malloc, mm_free */
+  uint32_t cycles[2];           /* CORET cycles spent in them */
+  uint32_t cycles_max[2];       /* Slowest call */
+  uint32_t fails;               /* mm_malloc that returned NULL */
+  uint32_t fail_size;           /* Chunk size of the last failure */
+  uint32_t fail_free;           /* Free space at the last failure */
+  uint32_t fail_largest;        /* Largest free chunk at the last failure */
+  uint32_t frag_min;            /* Lowest largest/total free ratio, 1/256 */
+  uint32_t req[MM_NNODES];      /* mm_malloc calls per mm_size2ndx bucket */
+  uint32_t walk[MM_NNODES];     /* Free nodes visited per bucket */
+  uint16_t walk_max[MM_NNODES]; /* Longest search per bucket */
+};
+
+extern struct mm_prof_s g_mmprof;
+
+uint32_t mm_prof_stamp(void);
+void mm_prof_malloc(struct mm_heap_s *heap, uint32_t stamp, int ndx,
+                    size_t size, uint32_t walk, void *ret);
+void mm_prof_free(struct mm_heap_s *heap, uint32_t stamp);
+void mm_prof_reset(void);
+int  mm_prof_dump(struct mm_heap_s *heap, void (*out)(uint8_t ch));
+#endif
+
 /* Functions contained in kmm_malloc.c **************************************/
 
 #ifdef CONFIG_MM_KERNEL_HEAP
@@ -477,7 +556,7 @@ void kmm_free(void *mem);
 /* Functions contained in mm_realloc.c **************************************/
 
 void *mm_realloc(struct mm_heap_s *heap, void *oldmem,
-                     size_t size);
+                     size_t size, void *caller);
 
 /* Functions contained in kmm_realloc.c *************************************/
 
@@ -32,4 +32,18 @@ int32_t mm_get_mallinfo(int32_t *total, int32_t *used, int32_t *free, int32_t *p
     return 0;
 }
 
+#if (CONFIG_MM_POOL)
+int32_t mm_get_poolinfo(int32_t ndx, int32_t *blksize, int32_t *total, int32_t *used, int32_t *peak)
+{
+    const struct mm_pool_s *pool = mm_pool_info(ndx);
 
+    if (pool == NULL) {
+        return -1;
+    }
+    *blksize = pool->blksize;
+    *total = pool->nblks;
+    *used = pool->used;
+    *peak = pool->peak;
+    return 0;
+}
+#endif
@@ -72,6 +72,9 @@ void mm_free(struct mm_heap_s *heap, void *mem, void *caller)
   struct mm_freenode_s *node;
   struct mm_freenode_s *prev;
   struct mm_freenode_s *next;
+#if (CONFIG_MM_PROFILE)
+  uint32_t stamp = mm_prof_stamp();
+#endif
 
   (void)caller;
   //mvdbg("Freeing %p\n", mem);
@@ -174,4 +177,7 @@ void mm_free(struct mm_heap_s *heap, void *mem, void *caller)
 
   mm_addfreechunk(heap, node);
   mm_givesemaphore(heap);
+#if (CONFIG_MM_PROFILE)
+  mm_prof_free(heap, stamp);
+#endif
 }
@@ -219,5 +219,8 @@ void mm_initialize(struct mm_heap_s *heap, void *heapstart,
 void mm_heap_initialize(void)
 {
     mm_initialize(&g_mmheap, &__heap_start, (uint32_t)(&__heap_end) - (uint32_t)(&__heap_start));
+#if (CONFIG_MM_POOL)
+    mm_pool_initialize(&g_mmheap);
+#endif
 }
 
@@ -98,6 +98,10 @@ void *mm_malloc(struct mm_heap_s *heap, size_t size, void *caller)
 #if defined(CONFIG_MM_DETECT_ERROR)
   size_t real_size;
 #endif
+#if (CONFIG_MM_PROFILE)
+  uint32_t stamp = mm_prof_stamp();
+  uint32_t walk = 0;
+#endif
 
   /* Handle bad sizes */
 
@@ -144,7 +148,12 @@ void *mm_malloc(struct mm_heap_s *heap, size_t size, void *caller)
 
   for (node = heap->mm_nodelist[ndx].flink;
        node && node->size < size;
-       node = node->flink);
+       node = node->flink)
+    {
+#if (CONFIG_MM_PROFILE)
+      walk++;
+#endif
+    }
 
   /* If we found a node with non-zero size, then this is one to use. Since
    * the list is ordered, we know that is must be best fitting chunk
@@ -223,12 +232,19 @@ void *mm_malloc(struct mm_heap_s *heap, size_t size, void *caller)
   }
 #endif
   mm_givesemaphore(heap);
+#if (CONFIG_MM_PROFILE)
+  mm_prof_malloc(heap, stamp, ndx, size, walk, ret);
+#endif
+#if defined(CONFIG_DEBUG_MM_WARN) || defined(CONFIG_MM_DETECT_ERROR)
   if (!ret) {
+#ifdef CONFIG_DEBUG_MM_WARN
     printf("Allocation failed, size %d\n", size);
+#endif
 #if defined(CONFIG_MM_DETECT_ERROR)
     mm_leak_dump();
 #endif
   }
+#endif
 
 #if (CONFIG_MM_MAX_USED)
   mm_max_usedsize_update(heap);
@@ -0,0 +1,242 @@
+/****************************************************************************
+ * mm/src/mm_pool.c
+ *
+ *   Copyright (C) 2015-2021 @ APTCHIP
+ *
+ * Fixed-size block pools in front of the heap.  Every pool is one heap
+ * chunk cut into equal blocks; the free blocks are kept in a singly linked
+ * list threaded through the blocks themselves, so allocation and release
+ * are a pop/push with no search, no split and no per-block header.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+//#include <csi_config.h>
+
+#include <csi_core.h>
+#include <assert.h>
+#include "mm.h"
+
+#if (CONFIG_MM_POOL)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint16_t g_pool_blksize[] = CONFIG_MM_POOL_BLKSIZE;
+static const uint16_t g_pool_blknum[]  = CONFIG_MM_POOL_BLKNUM;
+
+#define MM_NPOOLS (sizeof(g_pool_blksize) / sizeof(g_pool_blksize[0]))
+
+static struct mm_pool_s g_mmpool[MM_NPOOLS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pool_pop
+ *
+ * Description:
+ *   Take the first free block of a pool.  The core has no compare-and-swap,
+ *   so the list update runs with interrupts masked for a few instructions,
+ *   which makes it safe against an ISR using the same pool.
+ *
+ ****************************************************************************/
+
+static void *mm_pool_pop(struct mm_pool_s *pool)
+{
+  uint32_t flags = csi_irq_save();
+  void **blk = pool->free;
+
+  if (blk)
+    {
+      pool->free = *blk;
+      if (++pool->used > pool->peak)
+        {
+          pool->peak = pool->used;
+        }
+    }
+  else
+    {
+      pool->fails++;
+    }
+
+  csi_irq_restore(flags);
+  return blk;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_pool_initialize
+ *
+ * Description:
+ *   Take the storage of every pool from the heap and chain its blocks.
+ *   A pool whose storage does not fit is left empty; its requests go to
+ *   the next larger pool or to the heap.
+ *
+ ****************************************************************************/
+
+int mm_pool_initialize(struct mm_heap_s *heap)
+{
+  struct mm_pool_s *pool;
+  uint8_t *blk;
+  int ndx;
+  int i;
+
+  for (ndx = 0; ndx < MM_NPOOLS; ndx++)
+    {
+      pool = &g_mmpool[ndx];
+      pool->blksize = g_pool_blksize[ndx];
+      pool->start   = mm_malloc(heap, (size_t)pool->blksize * g_pool_blknum[ndx], NULL);
+      if (pool->start == NULL)
+        {
+          continue;
+        }
+
+      pool->nblks = g_pool_blknum[ndx];
+      pool->end   = pool->start + (size_t)pool->blksize * pool->nblks;
+
+      for (i = 0, blk = pool->start; i < pool->nblks - 1; i++, blk += pool->blksize)
+        {
+          *(void **)blk = blk + pool->blksize;
+        }
+
+      *(void **)blk = NULL;
+      pool->free = pool->start;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mm_pool_alloc
+ *
+ * Description:
+ *   Allocate from the smallest pool whose blocks hold size bytes, trying
+ *   the larger pools when it is empty.  Safe in interrupt context.
+ *   Returns NULL when size is bigger than the largest block or all fitting
+ *   pools are empty.
+ *
+ ****************************************************************************/
+
+void *mm_pool_alloc(size_t size)
+{
+  void *ret;
+  int ndx;
+
+  if (size < 1)
+    {
+      return NULL;
+    }
+
+  for (ndx = 0; ndx < MM_NPOOLS; ndx++)
+    {
+      if (size <= g_mmpool[ndx].blksize && g_mmpool[ndx].nblks)
+        {
+          ret = mm_pool_pop(&g_mmpool[ndx]);
+          if (ret)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_pool_free
+ *
+ * Description:
+ *   Return a block to its pool.  Safe in interrupt context.  Returns false
+ *   when mem does not belong to any pool, the caller then hands it to
+ *   mm_free().  With CONFIG_DEBUG_MM a pointer into the middle of a block
+ *   or a block that is already free trips an assertion; the list walk
+ *   that finds the latter is too slow to keep in a release build.
+ *
+ ****************************************************************************/
+
+bool mm_pool_free(void *mem)
+{
+  struct mm_pool_s *pool;
+  uint32_t flags;
+  int ndx;
+
+  for (ndx = 0; ndx < MM_NPOOLS; ndx++)
+    {
+      pool = &g_mmpool[ndx];
+      if ((uint8_t *)mem >= pool->start && (uint8_t *)mem < pool->end)
+        {
+          flags = csi_irq_save();
+#ifdef CONFIG_DEBUG_MM
+          {
+            void **blk;
+
+            assert(((uint8_t *)mem - pool->start) % pool->blksize == 0);
+            for (blk = pool->free; blk; blk = *blk)
+              {
+                assert(blk != mem);
+              }
+          }
+#endif
+          *(void **)mem = pool->free;
+          pool->free = mem;
+          pool->used--;
+          csi_irq_restore(flags);
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: mm_pool_size
+ *
+ * Description:
+ *   Block size of the pool mem belongs to, 0 when it is not a pool block.
+ *
+ ****************************************************************************/
+
+size_t mm_pool_size(void *mem)
+{
+  int ndx;
+
+  for (ndx = 0; ndx < MM_NPOOLS; ndx++)
+    {
+      if ((uint8_t *)mem >= g_mmpool[ndx].start &&
+          (uint8_t *)mem < g_mmpool[ndx].end)
+        {
+          return g_mmpool[ndx].blksize;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: mm_pool_info
+ *
+ * Description:
+ *   Statistics of pool ndx, NULL past the last pool.
+ *
+ ****************************************************************************/
+
+const struct mm_pool_s *mm_pool_info(int ndx)
+{
+  if (ndx < 0 || ndx >= MM_NPOOLS)
+    {
+      return NULL;
+    }
+
+  return &g_mmpool[ndx];
+}
+
+#endif /* CONFIG_MM_POOL */
@@ -0,0 +1,259 @@
+/****************************************************************************
+ * mm/src/mm_prof.c
+ *
+ *   Copyright (C) 2015-2021 @ APTCHIP
+ *
+ * Allocator profiling (CONFIG_MM_PROFILE): cycle counts of mm_malloc and
+ * mm_free taken from CORET, free-list walk lengths and request counts per
+ * mm_size2ndx() bucket, and the fragmentation of the heap as the ratio of
+ * the largest free chunk to the total free space.  mm_prof_dump() writes
+ * everything as one binary frame, mm/tools/mm_prof_decode.py prints it on
+ * the host.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+//#include <csi_config.h>
+
+#include <string.h>
+#include <csi_core.h>
+#include "mm.h"
+
+#if (CONFIG_MM_PROFILE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MM_PROF_MAGIC    0x504d     /* "MP" */
+#define MM_PROF_VERSION  1
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct mm_prof_s g_mmprof =
+{
+  .frag_min = 256,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_prof_frag
+ *
+ * Description:
+ *   Largest free chunk over total free space in 1/256, updates the lowest
+ *   value seen.  Walks the heap, so it runs outside the timed section.
+ *
+ ****************************************************************************/
+
+static uint32_t mm_prof_frag(struct mm_heap_s *heap, struct mallinfo *info)
+{
+  uint32_t ratio = 256;
+
+  mm_mallinfo(heap, info);
+  if (info->fordblks > 0)
+    {
+      ratio = ((uint32_t)info->mxordblk << 8) / (uint32_t)info->fordblks;
+    }
+
+  if (ratio < g_mmprof.frag_min)
+    {
+      g_mmprof.frag_min = ratio;
+    }
+
+  return ratio;
+}
+
+/****************************************************************************
+ * Name: mm_prof_cycles
+ *
+ * Description:
+ *   Record the CORET cycles since stamp for one call of op.  CORET counts
+ *   down and reloads every tick, one wrap is taken into account.
+ *
+ ****************************************************************************/
+
+static void mm_prof_cycles(int op, uint32_t stamp)
+{
+  uint32_t now = csi_coret_get_value();
+  uint32_t cycles;
+
+  if (stamp >= now)
+    {
+      cycles = stamp - now;
+    }
+  else
+    {
+      cycles = stamp + csi_coret_get_load() + 1 - now;
+    }
+
+  g_mmprof.calls[op]++;
+  g_mmprof.cycles[op] += cycles;
+  if (cycles > g_mmprof.cycles_max[op])
+    {
+      g_mmprof.cycles_max[op] = cycles;
+    }
+}
+
+static void mm_prof_put(void (*out)(uint8_t ch), uint32_t *sum,
+                        uint32_t val, int bytes)
+{
+  while (bytes--)
+    {
+      out((uint8_t)val);
+      *sum += (uint8_t)val;
+      val >>= 8;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_prof_stamp
+ *
+ * Description:
+ *   CORET value at the start of a profiled call.
+ *
+ ****************************************************************************/
+
+uint32_t mm_prof_stamp(void)
+{
+  return csi_coret_get_value();
+}
+
+/****************************************************************************
+ * Name: mm_prof_malloc
+ *
+ * Description:
+ *   Account one mm_malloc(): chunk size (allocnode included), its bucket
+ *   and the free nodes visited by the best-fit search.  A failure keeps a
+ *   snapshot of the heap for the post-mortem.
+ *
+ ****************************************************************************/
+
+void mm_prof_malloc(struct mm_heap_s *heap, uint32_t stamp, int ndx,
+                    size_t size, uint32_t walk, void *ret)
+{
+  struct mallinfo info;
+
+  mm_prof_cycles(MM_PROF_MALLOC, stamp);
+
+  g_mmprof.req[ndx]++;
+  g_mmprof.walk[ndx] += walk;
+  if (walk > g_mmprof.walk_max[ndx])
+    {
+      g_mmprof.walk_max[ndx] = walk > 0xffff ? 0xffff : walk;
+    }
+
+  mm_prof_frag(heap, &info);
+  if (ret == NULL)
+    {
+      g_mmprof.fails++;
+      g_mmprof.fail_size    = size;
+      g_mmprof.fail_free    = info.fordblks;
+      g_mmprof.fail_largest = info.mxordblk;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_prof_free
+ ****************************************************************************/
+
+void mm_prof_free(struct mm_heap_s *heap, uint32_t stamp)
+{
+  struct mallinfo info;
+
+  mm_prof_cycles(MM_PROF_FREE, stamp);
+  mm_prof_frag(heap, &info);
+}
+
+/****************************************************************************
+ * Name: mm_prof_reset
+ ****************************************************************************/
+
+void mm_prof_reset(void)
+{
+  memset(&g_mmprof, 0, sizeof(g_mmprof));
+  g_mmprof.frag_min = 256;
+}
+
+/****************************************************************************
+ * Name: mm_prof_dump
+ *
+ * Description:
+ *   Write the profile as one little-endian frame through out(), which has
+ *   to send raw bytes (console_putc(), not fputc() that expands '\n').
+ *   Layout, decoded by mm_prof_decode.py:
+ *
+ *     u16 magic, u8 version, u8 buckets, u8 MM_MIN_SHIFT, u8 reserved
+ *     u32 calls[2], cycles[2], cycles_max[2]  (malloc, free)
+ *     u32 fails, fail_size, fail_free, fail_largest
+ *     u32 arena, uordblks, fordblks, mxordblk, ordblks  (now)
+ *     u16 frag_min, u16 frag_now  (largest/total free, 1/256)
+ *     per bucket: u32 req, u32 walk, u16 walk_max
+ *     u16 sum of all bytes before it
+ *
+ ****************************************************************************/
+
+int mm_prof_dump(struct mm_heap_s *heap, void (*out)(uint8_t ch))
+{
+  struct mallinfo info;
+  uint32_t frag = mm_prof_frag(heap, &info);
+  uint32_t sum = 0;
+  int i;
+
+  mm_prof_put(out, &sum, MM_PROF_MAGIC, 2);
+  mm_prof_put(out, &sum, MM_PROF_VERSION, 1);
+  mm_prof_put(out, &sum, MM_NNODES, 1);
+  mm_prof_put(out, &sum, MM_MIN_SHIFT, 1);
+  mm_prof_put(out, &sum, 0, 1);
+
+  for (i = 0; i < 2; i++)
+    {
+      mm_prof_put(out, &sum, g_mmprof.calls[i], 4);
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      mm_prof_put(out, &sum, g_mmprof.cycles[i], 4);
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      mm_prof_put(out, &sum, g_mmprof.cycles_max[i], 4);
+    }
+
+  mm_prof_put(out, &sum, g_mmprof.fails, 4);
+  mm_prof_put(out, &sum, g_mmprof.fail_size, 4);
+  mm_prof_put(out, &sum, g_mmprof.fail_free, 4);
+  mm_prof_put(out, &sum, g_mmprof.fail_largest, 4);
+
+  mm_prof_put(out, &sum, info.arena, 4);
+  mm_prof_put(out, &sum, info.uordblks, 4);
+  mm_prof_put(out, &sum, info.fordblks, 4);
+  mm_prof_put(out, &sum, info.mxordblk, 4);
+  mm_prof_put(out, &sum, info.ordblks, 4);
+  mm_prof_put(out, &sum, g_mmprof.frag_min, 2);
+  mm_prof_put(out, &sum, frag, 2);
+
+  for (i = 0; i < MM_NNODES; i++)
+    {
+      mm_prof_put(out, &sum, g_mmprof.req[i], 4);
+      mm_prof_put(out, &sum, g_mmprof.walk[i], 4);
+      mm_prof_put(out, &sum, g_mmprof.walk_max[i], 2);
+    }
+
+  mm_prof_put(out, &sum, sum, 2);
+  return OK;
+}
+
+#endif /* CONFIG_MM_PROFILE */
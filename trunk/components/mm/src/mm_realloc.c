@@ -0,0 +1,150 @@
+/****************************************************************************
+ * mm/src/mm_realloc.c
+ *
+ *   Copyright (C) 2015-2021 @ APTCHIP
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+//#include <csi_config.h>
+
+#include <string.h>
+#include "mm.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_realloc
+ *
+ * Description:
+ *   Change the size of an allocation, keeping its content up to the
+ *   smaller of the old and the new size.
+ *
+ *   - A smaller size is served in place, the tail goes back to the heap.
+ *   - A bigger size is served in place when the next physical chunk is
+ *     free and makes up the difference; the part of it that is not needed
+ *     stays free.
+ *   - Otherwise a new chunk is allocated, the old content (old size only)
+ *     copied and the old chunk freed.  NULL is returned and oldmem left
+ *     alone when the heap cannot hold the new size.
+ *
+ *   oldmem == NULL is mm_malloc(), size == 0 is mm_free().  With
+ *   CONFIG_MM_DETECT_ERROR every call takes the allocate-copy-free path so
+ *   that the chunk gets new guard words; caller is recorded for the new
+ *   chunk like for mm_malloc().
+ *
+ ****************************************************************************/
+
+void *mm_realloc(struct mm_heap_s *heap, void *oldmem, size_t size,
+                 void *caller)
+{
+#if !defined(CONFIG_MM_DETECT_ERROR)
+  struct mm_allocnode_s *oldnode;
+  struct mm_freenode_s *next;
+  struct mm_freenode_s *remainder;
+  struct mm_allocnode_s *andbeyond;
+  size_t newsize;
+#endif
+  size_t oldsize;
+  void *newmem;
+
+  if (oldmem == NULL)
+    {
+      return mm_malloc(heap, size, caller);
+    }
+
+  if (size < 1)
+    {
+      mm_free(heap, oldmem, caller);
+      return NULL;
+    }
+
+#if defined(CONFIG_MM_DETECT_ERROR)
+  oldsize = ((struct m_dbg_hdr *)oldmem - 1)->size;
+#else
+  newsize = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+  if (newsize >= MM_MAX_CHUNK)
+    {
+      return NULL;
+    }
+
+  oldnode = (struct mm_allocnode_s *)((char *)oldmem - SIZEOF_MM_ALLOCNODE);
+  oldsize = oldnode->size;
+
+  mm_takesemaphore(heap);
+
+  if (newsize <= oldsize)
+    {
+      /* Shrink in place, also when the size did not change */
+
+      if (newsize < oldsize)
+        {
+          mm_shrinkchunk(heap, oldnode, newsize);
+        }
+
+      mm_givesemaphore(heap);
+      return oldmem;
+    }
+
+  next = (struct mm_freenode_s *)((char *)oldnode + oldsize);
+  if ((next->preceding & MM_ALLOC_BIT) == 0 &&
+      oldsize + next->size >= newsize)
+    {
+      /* Grow in place into the free next chunk.  The tail chunk of the
+       * region is always allocated, so andbeyond is a real node.
+       */
+
+      andbeyond = (struct mm_allocnode_s *)((char *)next + next->size);
+
+      next->blink->flink = next->flink;
+      if (next->flink)
+        {
+          next->flink->blink = next->blink;
+        }
+
+      if (oldsize + next->size - newsize >= SIZEOF_MM_FREENODE)
+        {
+          remainder            = (struct mm_freenode_s *)((char *)oldnode + newsize);
+          remainder->size      = oldsize + next->size - newsize;
+          remainder->preceding = newsize;
+          andbeyond->preceding = remainder->size |
+                                 (andbeyond->preceding & MM_ALLOC_BIT);
+          oldnode->size        = newsize;
+
+          mm_addfreechunk(heap, remainder);
+        }
+      else
+        {
+          oldnode->size       += next->size;
+          andbeyond->preceding = oldnode->size |
+                                 (andbeyond->preceding & MM_ALLOC_BIT);
+        }
+
+      mm_givesemaphore(heap);
+
+#if (CONFIG_MM_MAX_USED)
+      mm_max_usedsize_update(heap);
+#endif
+      return oldmem;
+    }
+
+  mm_givesemaphore(heap);
+  oldsize -= SIZEOF_MM_ALLOCNODE;
+#endif
+
+  /* Allocate, copy what the old chunk holds, free */
+
+  newmem = mm_malloc(heap, size, caller);
+  if (newmem)
+    {
+      memcpy(newmem, oldmem, oldsize < size ? oldsize : size);
+      mm_free(heap, oldmem, caller);
+    }
+
+  return newmem;
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+ * mm/src/mm_shrinkchunk.c
+ *
+ *   Copyright (C) 2015-2021 @ APTCHIP
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+//#include <csi_config.h>
+
+#include "mm.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_remfreechunk
+ *
+ * Description:
+ *   Unlink a free chunk from its node list.  There is always a
+ *   predecessor, there may not be a successor.
+ *
+ ****************************************************************************/
+
+static inline void mm_remfreechunk(struct mm_freenode_s *node)
+{
+  node->blink->flink = node->flink;
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_shrinkchunk
+ *
+ * Description:
+ *   Reduce the size of the allocated chunk node to size (allocnode
+ *   included, granule aligned) and give the tail back to the heap.  The
+ *   tail is merged into the next chunk when that one is free; otherwise
+ *   it becomes a free chunk of its own if it is big enough for a free
+ *   node, or stays with the allocation.  The caller holds the mm semaphore.
+ *
+ ****************************************************************************/
+
+void mm_shrinkchunk(struct mm_heap_s *heap,
+                    struct mm_allocnode_s *node, size_t size)
+{
+  struct mm_freenode_s *next;
+  struct mm_freenode_s *newnode;
+  struct mm_allocnode_s *andbeyond;
+
+  next = (struct mm_freenode_s *)((char *)node + node->size);
+
+  if ((next->preceding & MM_ALLOC_BIT) == 0)
+    {
+      /* Move the start of the free next chunk back to the new end */
+
+      andbeyond = (struct mm_allocnode_s *)((char *)next + next->size);
+      mm_remfreechunk(next);
+
+      newnode            = (struct mm_freenode_s *)((char *)node + size);
+      newnode->size      = next->size + node->size - size;
+      newnode->preceding = size;
+      node->size         = size;
+      andbeyond->preceding = newnode->size |
+                             (andbeyond->preceding & MM_ALLOC_BIT);
+
+      mm_addfreechunk(heap, newnode);
+    }
+  else if (node->size >= size + SIZEOF_MM_FREENODE)
+    {
+      /* The next chunk is in use, the tail becomes a chunk of its own */
+
+      newnode            = (struct mm_freenode_s *)((char *)node + size);
+      newnode->size      = node->size - size;
+      newnode->preceding = size;
+      node->size         = size;
+      next->preceding    = newnode->size | MM_ALLOC_BIT;
+
+      mm_addfreechunk(heap, newnode);
+    }
+}
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Decode the allocator profile frame written by mm_prof_dump().
+
+Usage: mm_prof_decode.py capture.bin
+
+The capture is the raw console UART output, the frame is found by its
+magic; text printed around it is skipped.
+"""
+
+import struct
+import sys
+
+MAGIC = b"MP"
+VERSION = 1
+
+
+def decode(data, pos):
+    ver, nb, min_shift, _ = struct.unpack_from("<BBBB", data, pos + 2)
+    if ver != VERSION:
+        raise ValueError("unknown frame version %d" % ver)
+    size = 6 + 6 * 4 + 4 * 4 + 5 * 4 + 2 * 2 + nb * 10
+    frame = data[pos:pos + size + 2]
+    if len(frame) < size + 2:
+        raise ValueError("frame truncated")
+    (chk,) = struct.unpack_from("<H", frame, size)
+    if sum(frame[:size]) & 0xFFFF != chk:
+        raise ValueError("checksum mismatch")
+
+    off = 6
+    calls = struct.unpack_from("<2I", frame, off); off += 8
+    cycles = struct.unpack_from("<2I", frame, off); off += 8
+    cmax = struct.unpack_from("<2I", frame, off); off += 8
+    fails, fsize, ffree, flarge = struct.unpack_from("<4I", frame, off); off += 16
+    arena, used, free, largest, nfree = struct.unpack_from("<5I", frame, off); off += 20
+    frag_min, frag_now = struct.unpack_from("<2H", frame, off); off += 4
+
+    print("heap      arena %d  used %d  free %d in %d chunks  largest %d"
+          % (arena, used, free, nfree, largest))
+    print("frag      largest/free now %.1f%%  lowest %.1f%%"
+          % (frag_now * 100.0 / 256, frag_min * 100.0 / 256))
+    for name, i in (("mm_malloc", 0), ("mm_free", 1)):
+        avg = cycles[i] / calls[i] if calls[i] else 0
+        print("%-9s %d calls  avg %.0f  max %d cycles" % (name, calls[i], avg, cmax[i]))
+    if fails:
+        print("failures  %d, last: chunk %d, free %d, largest %d"
+              % (fails, fsize, ffree, flarge))
+
+    print("\nbucket  chunk size      requests  avg walk  max walk")
+    for ndx in range(nb):
+        req, walk, wmax = struct.unpack_from("<IIH", frame, off); off += 10
+        if not req:
+            continue
+        lo = 1 << (ndx + min_shift)
+        hi = "+" if ndx == nb - 1 else "-%d" % ((lo << 1) - 1)
+        print("%6d  %-14s  %8d  %8.1f  %8d"
+              % (ndx, "%d%s" % (lo, hi), req, walk / req, wmax))
+    return pos + size + 2
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    pos = data.find(MAGIC)
+    found = 0
+    while pos >= 0:
+        try:
+            nxt = decode(data, pos)
+            found += 1
+            print()
+        except (ValueError, struct.error):
+            nxt = pos + 1
+        pos = data.find(MAGIC, nxt)
+    if not found:
+        sys.exit("no profile frame found")
+
+
+if __name__ == "__main__":
+    main()
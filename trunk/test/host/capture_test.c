@@ -0,0 +1,400 @@
+/***********************************************************************//**
+ * \file  capture_test.c
+ * \brief  host test of chip/drivers/capture.c on a simulated capture unit
+ *
+ * capture.c is built unchanged on the chip headers, stub/sdk only makes ICR
+ * clear RISR at once and takes the core intrinsics. The model runs the
+ * counter one tick at a time: every edge that reaches the timer loads CNT
+ * into the next of CMPA~CMPD and raises its CAPLD flag, a wrap raises PEND,
+ * the interrupt is taken a random latency after RISR & IMCR is set.
+ *
+ * Every sample is checked against the exact edge times of the signal, so a
+ * wrong wrap count in the 32 bit extension or a group mixed up with the
+ * next edges shows at once. A group is an overrun when an edge came after
+ * CMPD before the handler ran; the model counts them, the handler has to
+ * find the same ones from CMPA against CNT.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <soc.h>
+#include <drv/capture.h>
+#include <drv/ept.h>
+#include <drv/gpta.h>
+#include <drv/etb.h>
+#include <drv/pin.h>
+#include <drv/irq.h>
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define PCLK			48000000U
+#define INT_CAPLD0		(0x01ul << 4)
+#define INT_CAPLD3		(0x01ul << 7)
+#define INT_PEND		(0x01ul << 16)
+
+typedef struct {
+	volatile uint32_t	*pwCnt;
+	volatile uint32_t	*pwCmp[4];
+	volatile uint32_t	*pwRisr;
+	volatile uint32_t	*pwMisr;
+	volatile uint32_t	*pwImcr;
+	uint64_t	dwNow;					//counter ticks since start
+	bool		bRun;
+	uint8_t		bySlot;					//next of CMPA~CMPD
+	double		dPeriod;				//signal, counter ticks
+	double		dHigh;
+	double		dFirst;					//first rising edge, < 0: high at start
+	bool		bBoth;					//falling edges reach the timer too
+	bool		bStop;					//signal lost
+	uint32_t	wK;						//next edge: period wK, rising or falling
+	bool		bFall;
+	uint32_t	wLatMax;				//interrupt latency, ticks
+	bool		bIrq;
+	uint64_t	dwIrqAt;
+	uint32_t	wOverrun;				//groups the handler has to drop
+	uint32_t	wWrapLate;				//groups read with the wrap after CMPD still pending
+	csi_irq_handler_t handler;
+	void		*pArg;
+} cap_model_t;
+
+static unsigned long s_wErr;
+static cap_model_t s_tM;
+static csp_ept_t s_tEpt;
+static csp_gpta_t s_tGpta;
+static bool s_bIe = true;
+static uint32_t s_wTimerInit, s_wEtbAlloc, s_wEtbFree, s_wEtbCh;
+static int32_t s_iEtbAlloc = 5;
+static csi_error_t s_eEtbCfg = CSI_OK;
+
+csp_ept_t *EPT0 = &s_tEpt;
+csp_gpta_t *GPT0 = &s_tGpta;
+const uint8_t irq_slot_map[IRQ_SLOT_NUM];
+
+/* the signal ---------------------------------------------------------*/
+static int64_t edge_time(int64_t lK, bool bFall)
+{
+	return (int64_t)floor(s_tM.dFirst + lK * s_tM.dPeriod + (bFall ? s_tM.dHigh : 0.0));
+}
+
+static bool signal_level(int64_t lTime)
+{
+	int64_t lK = (int64_t)floor((lTime - s_tM.dFirst) / s_tM.dPeriod);
+
+	return lTime >= edge_time(lK, false) && lTime < edge_time(lK, true);
+}
+
+static void edge_next(void)
+{
+	if(s_tM.bFall)
+		s_tM.wK++;
+	s_tM.bFall = !s_tM.bFall;
+}
+
+/* the capture unit ---------------------------------------------------*/
+static void model_bind(volatile uint32_t *pwCnt, volatile uint32_t *pwCmpa, volatile uint32_t *pwRisr,
+	volatile uint32_t *pwMisr, volatile uint32_t *pwImcr)
+{
+	int i;
+
+	s_tM.pwCnt = pwCnt;
+	for(i = 0; i < 4; i++)
+		s_tM.pwCmp[i] = pwCmpa + i;
+	s_tM.pwRisr = pwRisr;
+	s_tM.pwMisr = pwMisr;
+	s_tM.pwImcr = pwImcr;
+}
+
+static void model_start(void)
+{
+	s_tM.dwNow = 0;
+	s_tM.bySlot = 0;
+	s_tM.bRun = true;
+	s_tM.bIrq = false;
+	*s_tM.pwCnt = 0;
+	s_tM.wK = 0;
+	s_tM.bFall = false;
+	while(edge_time(s_tM.wK, s_tM.bFall) <= 0)
+		edge_next();
+}
+
+static void model_irq(void)
+{
+	if((*s_tM.pwMisr & INT_CAPLD3) && s_tM.bySlot != 0)
+		s_tM.wOverrun++;
+	else if((*s_tM.pwMisr & INT_CAPLD3) && (*s_tM.pwRisr & INT_PEND) && *s_tM.pwCmp[3] < 0x8000)
+		s_tM.wWrapLate++;
+
+	s_bIe = false;
+	s_tM.handler(s_tM.pArg);
+	s_bIe = true;
+}
+
+static void model_run(uint32_t wTicks)
+{
+	while(wTicks-- && s_tM.bRun)
+	{
+		s_tM.dwNow++;
+		*s_tM.pwCnt = (uint16_t)s_tM.dwNow;
+		if(*s_tM.pwCnt == 0)
+			*s_tM.pwRisr |= INT_PEND;
+
+		while(!s_tM.bStop && edge_time(s_tM.wK, s_tM.bFall) == (int64_t)s_tM.dwNow)
+		{
+			if(!s_tM.bFall || s_tM.bBoth)
+			{
+				*s_tM.pwCmp[s_tM.bySlot] = *s_tM.pwCnt;
+				*s_tM.pwRisr |= INT_CAPLD0 << s_tM.bySlot;
+				s_tM.bySlot = (s_tM.bySlot + 1) & 3;
+			}
+			edge_next();
+		}
+
+		*s_tM.pwMisr = *s_tM.pwRisr & *s_tM.pwImcr;
+		if(*s_tM.pwMisr && !s_tM.bIrq)
+		{
+			s_tM.bIrq = true;
+			s_tM.dwIrqAt = s_tM.dwNow + (uint32_t)rand() % (s_tM.wLatMax + 1);
+		}
+		if(s_tM.bIrq && s_tM.dwNow >= s_tM.dwIrqAt && s_bIe)
+		{
+			s_tM.bIrq = false;
+			model_irq();
+		}
+	}
+}
+
+/* what capture.c needs from the rest of the sdk ----------------------*/
+uint32_t __get_PSR(void) { return s_bIe ? PSR_IE_Msk : 0; }
+void __disable_irq(void) { s_bIe = false; }
+void __set_PSR(uint32_t psr) { s_bIe = (psr & PSR_IE_Msk) != 0; }
+uint32_t csi_get_pclk_freq(void) { return PCLK; }
+uint32_t csi_pin_read(pin_name_e ePinName) { return signal_level((int64_t)s_tM.dwNow); }
+void csi_irq_enable(uint32_t *pIpBase) {}
+void csi_etb_init(void) {}
+void csi_ept_set_sync(csp_ept_t *ptEptBase, csi_ept_trgin_e eTrgIn, csi_ept_trgmode_e eTrgMode, csi_ept_arearm_e eAutoRearm) {}
+void csi_gpta_set_sync(csp_gpta_t *ptGptaBase, csi_gpta_trgin_e eTrgIn, csi_gpta_trgmode_e eTrgMode, csi_gpta_arearm_e eAutoRearm) {}
+
+void csi_irq_attach(uint32_t irq_num, csi_irq_handler_t irq_handler, void *pArg)
+{
+	s_tM.handler = irq_handler;
+	s_tM.pArg = pArg;
+}
+
+int32_t csi_etb_ch_alloc(csi_etb_ch_type_e eChType)
+{
+	if(s_iEtbAlloc >= 0)
+		s_wEtbAlloc++;
+	return s_iEtbAlloc;
+}
+
+void csi_etb_ch_free(csi_etb_chid_e eChId)
+{
+	CHECK((int32_t)eChId == s_iEtbAlloc);
+	s_wEtbFree++;
+}
+
+csi_error_t csi_etb_ch_config(csi_etb_chid_e eChId, csi_etb_config_t *ptConfig)
+{
+	s_wEtbCh = eChId;
+	return s_eEtbCfg;
+}
+
+csi_error_t csi_ept_capture_init(csp_ept_t *ptEptBase, csi_ept_captureconfig_t *pteptPwmCfg)
+{
+	s_wTimerInit++;
+	model_bind(&ptEptBase->CNT, &ptEptBase->CMPA, (volatile uint32_t *)&ptEptBase->RISR,
+		(volatile uint32_t *)&ptEptBase->MISR, &ptEptBase->IMCR);
+	return CSI_OK;
+}
+
+csi_error_t csi_gpta_capture_init(csp_gpta_t *ptGptaBase, csi_gpta_captureconfig_t *ptGptaPwmCfg)
+{
+	s_wTimerInit++;
+	model_bind(&ptGptaBase->CNT, &ptGptaBase->CMPA, (volatile uint32_t *)&ptGptaBase->RISR,
+		(volatile uint32_t *)&ptGptaBase->MISR, &ptGptaBase->IMCR);
+	return CSI_OK;
+}
+
+csi_error_t csi_ept_start(csp_ept_t *pteptBase)
+{
+	pteptBase->RSSR |= EPT_START;
+	model_start();
+	return CSI_OK;
+}
+
+csi_error_t csi_gpta_start(csp_gpta_t *ptgptaBase)
+{
+	ptgptaBase->RSSR |= GPTA_START;
+	model_start();
+	return CSI_OK;
+}
+
+/* checks -------------------------------------------------------------*/
+static csi_capture_t s_tCap;
+static csi_capture_sample_t s_tBuf[64];
+static uint32_t s_wSmpK;				//period of the last sample
+static uint32_t s_wSmpNum;
+
+/** \brief every sample starts at a rising edge, period and high time exact
+ */
+static void samples_check(void)
+{
+	csi_capture_sample_t tSmp;
+	uint32_t wK;
+
+	while(csi_capture_read(&s_tCap, &tSmp))
+	{
+		for(wK = s_wSmpK; wK < s_wSmpK + 64; wK++)
+		{
+			if((uint32_t)edge_time(wK, false) == tSmp.wStamp)
+				break;
+		}
+		s_wSmpNum++;
+		if(wK == s_wSmpK + 64)
+		{
+			printf("sample at %u: no rising edge there\n", tSmp.wStamp);
+			s_wErr++;
+			continue;
+		}
+		CHECK(tSmp.hwPeriod == edge_time(wK + 1, false) - edge_time(wK, false));
+		CHECK(tSmp.hwHigh == (s_tM.bBoth ? edge_time(wK, true) - edge_time(wK, false) : 0));
+		s_wSmpK = wK + 1;
+	}
+}
+
+static void cap_cfg(csi_capture_config_t *ptCfg, uint8_t byTimer, uint8_t byEdge, uint32_t wMinFreq)
+{
+	memset(ptCfg, 0, sizeof(csi_capture_config_t));
+	ptCfg->byTimer  = byTimer;
+	ptCfg->byEdge   = byEdge;
+	ptCfg->bySrc    = ETB_EXI_TRGOUT0;
+	ptCfg->wMinFreq = wMinFreq;
+	ptCfg->ptBuf    = s_tBuf;
+	ptCfg->hwBufLen = sizeof(s_tBuf) / sizeof(s_tBuf[0]);
+}
+
+static void model_signal(double dPeriod, double dHigh, double dFirst, bool bBoth, uint32_t wLatMax)
+{
+	memset(&s_tM, 0, sizeof(s_tM));
+	s_tM.dPeriod = dPeriod;
+	s_tM.dHigh = dHigh;
+	s_tM.dFirst = dFirst;
+	s_tM.bBoth = bBoth;
+	s_tM.wLatMax = wLatMax;
+	s_wSmpK = 0;
+	s_wSmpNum = 0;
+}
+
+/** \brief a refused configuration takes neither the timer nor an ETB channel
+ */
+static void test_init_errors(void)
+{
+	static const uint8_t s_byBad[] = {0, 1, 2, 3, 4, 5, 6};
+	csi_capture_config_t tCfg;
+	csp_ept_t tZero;
+	uint32_t i;
+
+	memset(&tZero, 0, sizeof(tZero));
+	for(i = 0; i < sizeof(s_byBad); i++)
+	{
+		cap_cfg(&tCfg, CAPTURE_EPT0, CAPTURE_EDGE_BOTH, 1000);
+		s_iEtbAlloc = 5;
+		s_eEtbCfg = CSI_OK;
+		switch(s_byBad[i])
+		{
+			case 0: tCfg.wMinFreq = 0; break;
+			case 1: tCfg.byTimer = CAPTURE_GPTA0 + 1; break;
+			case 2: tCfg.byEdge = CAPTURE_EDGE_BOTH + 1; break;
+			case 3: tCfg.hwBufLen = 48; break;
+			case 4: tCfg.hwBufLen = 0; break;
+			case 5: s_iEtbAlloc = -1; break;
+			default: s_eEtbCfg = CSI_ERROR; break;
+		}
+		CHECK(csi_capture_init(&s_tCap, &tCfg) == CSI_ERROR);
+		CHECK(s_wTimerInit == 0 && s_tM.handler == NULL);
+		CHECK(s_wEtbAlloc == s_wEtbFree);
+		CHECK(memcmp(&s_tEpt, &tZero, sizeof(tZero)) == 0);
+	}
+	CHECK(s_wEtbFree == 1);
+	s_iEtbAlloc = 5;
+	s_eEtbCfg = CSI_OK;
+}
+
+/** \brief 100kHz 30% on EPT0, both edges, started with the input high
+ */
+static void test_100k(void)
+{
+	csi_capture_config_t tCfg;
+	uint32_t i;
+
+	model_signal(480.0, 144.0, -50.0, true, 200);				//48MHz counter, latency up to 200 ticks
+	cap_cfg(&tCfg, CAPTURE_EPT0, CAPTURE_EDGE_BOTH, 1000);
+	CHECK(csi_capture_init(&s_tCap, &tCfg) == CSI_OK);
+	CHECK(s_wEtbCh == 5 && s_wTimerInit == 1);
+	CHECK(csi_capture_tick_freq(&s_tCap) == PCLK);
+	CHECK(csi_capture_start(&s_tCap) == CSI_OK);
+
+	for(i = 0; i < 200; i++)
+	{
+		model_run(4800);
+		samples_check();
+	}
+	CHECK(s_tCap.wLost == 0);
+	model_run(480 * 200);											//nobody reads: buffer full
+	CHECK(s_tCap.wLost > 0);
+	samples_check();
+
+	printf("100kHz: %u samples, %u overruns, %u lost\n", s_wSmpNum, s_tCap.wOverrun, s_tCap.wLost);
+	CHECK(s_wSmpNum > 1000);
+	CHECK(s_tM.wOverrun > 0 && s_tCap.wOverrun == s_tM.wOverrun);
+	CHECK(csi_capture_get_freq(&s_tCap) == 10000000);
+	CHECK(csi_capture_get_duty_q15(&s_tCap) == 9830);
+
+	csi_capture_stop(&s_tCap);
+	CHECK((s_tEpt.RSSR & EPT_START) == 0);
+}
+
+/** \brief 10.5Hz on GPTA0, rising edges, about one wrap per period
+ */
+static void test_10hz(void)
+{
+	csi_capture_config_t tCfg;
+	uint32_t i, wFreq;
+
+	//latency up to 8000 ticks: the age of CMPD plus 3 periods(54256 mod 0x10000) stays below 0x10000
+	model_signal((PCLK / 74) / 10.5, 20000.0, 1000.0, false, 8000);
+	cap_cfg(&tCfg, CAPTURE_GPTA0, CAPTURE_EDGE_RISE, 10);
+	CHECK(csi_capture_init(&s_tCap, &tCfg) == CSI_OK);
+	CHECK(csi_capture_tick_freq(&s_tCap) == PCLK / 74);			//one period of 10Hz within 0xFFFF counts
+	CHECK(csi_capture_start(&s_tCap) == CSI_OK);
+
+	for(i = 0; i < 300; i++)
+	{
+		model_run(0x8000);
+		samples_check();
+	}
+	wFreq = csi_capture_get_freq(&s_tCap);
+	printf("10.5Hz: %u samples, %u read with the wrap pending, %u.%02uHz\n",
+		s_wSmpNum, s_tM.wWrapLate, wFreq / 100, wFreq % 100);
+	CHECK(s_wSmpNum > 140 && s_tCap.wOverrun == 0 && s_tM.wOverrun == 0);
+	CHECK(s_tM.wWrapLate > 0);
+	CHECK(wFreq >= 1049 && wFreq <= 1051);
+	CHECK(csi_capture_get_duty_q15(&s_tCap) == 0);
+
+	s_tM.bStop = true;												//signal lost: averages cleared
+	model_run(7 * 0x10000);
+	CHECK(csi_capture_get_freq(&s_tCap) == 0);
+}
+
+int main(void)
+{
+	srand(1);
+	test_init_errors();
+	test_100k();
+	test_10hz();
+
+	printf("capture: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
@@ -0,0 +1,296 @@
+/***********************************************************************//**
+ * \file  etb_test.c
+ * \brief  host test of the route graph of chip/drivers/etb.c on fake registers
+ *
+ * etb.c is built unchanged on the chip headers, ETCB and SYSCON are plain
+ * structures. After each csi_etb_graph_init the channel registers are
+ * decoded again and every route of the table has to be found in exactly
+ * the channels of the graph, with the channel count of the layout. A
+ * refused table must leave every channel as it was.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <soc.h>
+#include <csp.h>
+#include <drv/etb.h>
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define FIELD(reg, name)	(((reg) & name##_MSK) >> name##_POS)
+#define ROUTES(tab)			(tab), (uint8_t)(sizeof(tab) / sizeof((tab)[0]))
+
+static unsigned long s_wErr;
+static csp_etb_t s_tEtcb;
+static csp_syscon_t s_tSyscon;
+static bool s_bIe = true;
+
+csp_etb_t *ETCB = &s_tEtcb;
+csp_syscon_t *SYSCON = &s_tSyscon;
+
+/* what etb.c needs from the rest of the sdk --------------------------*/
+uint32_t __get_PSR(void) { return s_bIe ? PSR_IE_Msk : 0; }
+void __disable_irq(void) { s_bIe = false; }
+void __set_PSR(uint32_t psr) { s_bIe = (psr & PSR_IE_Msk) != 0; }
+void soc_clk_enable(int32_t module) {}
+
+/* channel registers, decoded -----------------------------------------*/
+static bool ch_enabled(uint8_t byCh)
+{
+	if(byCh == ETB_CH0_ID)
+		return s_tEtcb.CFG1_CH0 & ETB_CH_EN_MSK;
+	if(byCh <= ETB_CH2_ID)
+		return s_tEtcb.CH1_2[byCh-1].CFG1 & ETB_CH_EN_MSK;
+	return s_tEtcb.CFG_CHX[byCh-3] & ETB_CH_EN_MSK;
+}
+
+/** \brief routes bySrc -> byDst, as the hardware reads the channel
+ */
+static bool ch_routes(uint8_t byCh, uint8_t bySrc, uint8_t byDst)
+{
+	uint32_t wCfg0, wCfg1;
+
+	if(byCh == ETB_CH0_ID)
+	{
+		wCfg0 = s_tEtcb.CFG0_CH0;
+		if(FIELD(s_tEtcb.CFG1_CH0, ETB_CH0_TRG_DST) != byDst)
+			return false;
+		return ((wCfg0 & ETB_CH0_SRC0_EN_MSK) && FIELD(wCfg0, ETB_CH0_TRG_SRC0) == bySrc) ||
+			((wCfg0 & ETB_CH0_SRC1_EN_MSK) && FIELD(wCfg0, ETB_CH0_TRG_SRC1) == bySrc) ||
+			((wCfg0 & ETB_CH0_SRC2_EN_MSK) && FIELD(wCfg0, ETB_CH0_TRG_SRC2) == bySrc);
+	}
+	if(byCh <= ETB_CH2_ID)
+	{
+		wCfg0 = s_tEtcb.CH1_2[byCh-1].CFG0;
+		wCfg1 = s_tEtcb.CH1_2[byCh-1].CFG1;
+		if(FIELD(wCfg1, ETB_CH1_2_TRG_SRC) != bySrc)
+			return false;
+		return ((wCfg0 & ETB_CH1_2_DST0_EN_MSK) && FIELD(wCfg0, ETB_CH1_2_TRG_DST0) == byDst) ||
+			((wCfg0 & ETB_CH1_2_DST1_EN_MSK) && FIELD(wCfg0, ETB_CH1_2_TRG_DST1) == byDst) ||
+			((wCfg0 & ETB_CH1_2_DST2_EN_MSK) && FIELD(wCfg0, ETB_CH1_2_TRG_DST2) == byDst);
+	}
+	wCfg0 = s_tEtcb.CFG_CHX[byCh-3];
+	return FIELD(wCfg0, ETB_CHX_TRG_SRC) == bySrc && FIELD(wCfg0, ETB_CHX_TRG_DST) == byDst;
+}
+
+/** \brief every route in one channel of the graph, the graph takes byChMsk
+ */
+static void graph_check(csi_etb_graph_t *ptGraph, const csi_etb_route_t *ptRoute, uint8_t byNum, uint8_t byChMsk)
+{
+	uint8_t i, byCh, byHit;
+
+	CHECK(ptGraph->byChMsk == byChMsk);
+	for(i = 0; i < byNum; i++)
+	{
+		for(byCh = 0, byHit = 0; byCh < 8; byCh++)
+		{
+			if((ptGraph->byChMsk & (1U << byCh)) && ch_routes(byCh, ptRoute[i].bySrc, ptRoute[i].byDst))
+				byHit++;
+		}
+		if(byHit != 1)
+		{
+			printf("route %u(%u -> %u) in %u channels\n", i, ptRoute[i].bySrc, ptRoute[i].byDst, byHit);
+			s_wErr++;
+		}
+	}
+	for(byCh = 0; byCh < 8; byCh++)
+	{
+		if(ptGraph->byChMsk & (1U << byCh))
+			CHECK(!ch_enabled(byCh));								//configured stopped
+	}
+}
+
+/* layouts ------------------------------------------------------------*/
+static void test_layouts(void)
+{
+	static const csi_etb_route_t s_tOne[] = {
+		{ETB_EXI_TRGOUT0, ETB_BT0_SYNCIN0}, {ETB_EXI_TRGOUT1, ETB_BT1_SYNCIN0}, {ETB_BT_TRGOUT0, ETB_ADC_SYNCIN0}
+	};
+	static const csi_etb_route_t s_tFan[] = {
+		{ETB_ETP0_TRGOUT0, ETB_ADC_SYNCIN0}, {ETB_ETP0_TRGOUT0, ETB_ADC_SYNCIN1}, {ETB_GPT0_TRGOUT0, ETB_EPT0_SYNCIN0},
+		{ETB_ETP0_TRGOUT0, ETB_BT0_SYNCIN0}, {ETB_ETP0_TRGOUT0, ETB_BT0_SYNCIN1}, {ETB_GPT0_TRGOUT0, ETB_EPT0_SYNCIN1}
+	};
+	static const csi_etb_route_t s_tMerge[] = {
+		{ETB_EXI_TRGOUT0, ETB_ADC_SYNCIN2}, {ETB_EXI_TRGOUT1, ETB_ADC_SYNCIN2}, {ETB_EXI_TRGOUT2, ETB_ADC_SYNCIN2}
+	};
+	static const csi_etb_route_t s_tFull[] = {
+		{ETB_EXI_TRGOUT0, ETB_ADC_SYNCIN0}, {ETB_EXI_TRGOUT1, ETB_ADC_SYNCIN0}, {ETB_EXI_TRGOUT2, ETB_ADC_SYNCIN0},
+		{ETB_ETP0_TRGOUT0, ETB_BT0_SYNCIN0}, {ETB_ETP0_TRGOUT0, ETB_BT0_SYNCIN1}, {ETB_ETP0_TRGOUT0, ETB_BT1_SYNCIN0},
+		{ETB_GPT0_TRGOUT0, ETB_EPT0_SYNCIN0}, {ETB_GPT0_TRGOUT0, ETB_EPT0_SYNCIN1}, {ETB_GPT0_TRGOUT0, ETB_EPT0_SYNCIN2},
+		{ETB_RTC_TRGOUT0, ETB_LPT_SYNCIN0}, {ETB_RTC_TRGOUT1, ETB_BT1_SYNCIN1}, {ETB_BT_TRGOUT0, ETB_GPT0_SYNCIN0},
+		{ETB_BT_TRGOUT1, ETB_GPT0_SYNCIN1}, {ETB_ADC_TRGOUT0, ETB_TOUCH_SYNCIN}
+	};
+	static const csi_etb_route_t s_tSpill[] = {
+		{ETB_EXI_TRGOUT0, ETB_BT0_SYNCIN0}, {ETB_EXI_TRGOUT1, ETB_BT0_SYNCIN1}, {ETB_EXI_TRGOUT2, ETB_BT1_SYNCIN0},
+		{ETB_EXI_TRGOUT3, ETB_BT1_SYNCIN1}, {ETB_EXI_TRGOUT4, ETB_ADC_SYNCIN0}, {ETB_EXI_TRGOUT5, ETB_ADC_SYNCIN1},
+		{ETB_RTC_TRGOUT0, ETB_ADC_SYNCIN2}, {ETB_RTC_TRGOUT1, ETB_ADC_SYNCIN3}
+	};
+	csi_etb_graph_t tGraph;
+	uint8_t byCh;
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tOne)) == CSI_OK);		//one to one: 3~7 first
+	graph_check(&tGraph, ROUTES(s_tOne), 0x38);
+	CHECK(tGraph.wIrqMsk == ((1UL << EXI0_IRQn) | (1UL << BT0_IRQn)));	//EVTRG 0: EXI group 0
+	csi_etb_graph_start(&tGraph);
+	for(byCh = 3; byCh < 6; byCh++)
+		CHECK(ch_enabled(byCh));
+	csi_etb_graph_free(&tGraph);
+	for(byCh = 3; byCh < 6; byCh++)
+		CHECK(!ch_enabled(byCh));
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tFan)) == CSI_OK);		//3 of EPT0 on 1, GPT0 on 2, 4th EPT0 on 3
+	graph_check(&tGraph, ROUTES(s_tFan), 0x0E);
+	CHECK(FIELD(s_tEtcb.CH1_2[0].CFG1, ETB_CH1_2_TRG_SRC) == ETB_ETP0_TRGOUT0);
+	CHECK(!(s_tEtcb.CH1_2[1].CFG0 & ETB_CH1_2_DST2_EN_MSK));
+	csi_etb_graph_free(&tGraph);
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tMerge)) == CSI_OK);		//many to one: channel 0
+	graph_check(&tGraph, ROUTES(s_tMerge), 0x01);
+	csi_etb_graph_free(&tGraph);
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tFull)) == CSI_OK);		//3 + 3 + 3 + 5 routes on 8 channels
+	graph_check(&tGraph, ROUTES(s_tFull), 0xFF);
+	csi_etb_graph_free(&tGraph);
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tSpill)) == CSI_OK);		//one to one on 3~7, then 1, 2, 0
+	graph_check(&tGraph, ROUTES(s_tSpill), 0xFF);
+	CHECK((s_tEtcb.CH1_2[0].CFG0 & (ETB_CH1_2_DST1_EN_MSK | ETB_CH1_2_DST2_EN_MSK)) == 0);
+	CHECK((s_tEtcb.CFG0_CH0 & (ETB_CH0_SRC1_EN_MSK | ETB_CH0_SRC2_EN_MSK)) == 0);
+	csi_etb_graph_free(&tGraph);
+}
+
+/* rejections ---------------------------------------------------------*/
+static void reject(const csi_etb_route_t *ptRoute, uint8_t byNum)
+{
+	static const csi_etb_route_t s_tAll[] = {
+		{ETB_EXI_TRGOUT0, ETB_BT0_SYNCIN0}, {ETB_EXI_TRGOUT1, ETB_BT0_SYNCIN1}, {ETB_EXI_TRGOUT2, ETB_BT1_SYNCIN0},
+		{ETB_EXI_TRGOUT3, ETB_BT1_SYNCIN1}, {ETB_EXI_TRGOUT4, ETB_ADC_SYNCIN0}
+	};
+	csi_etb_graph_t tGraph;
+	csp_etb_t tRegs = s_tEtcb;
+	uint8_t byFree;
+	int32_t iCh;
+
+	CHECK(csi_etb_graph_init(&tGraph, ptRoute, byNum) == CSI_ERROR);
+	CHECK(tGraph.byChMsk == 0 && memcmp(&tRegs, &s_tEtcb, sizeof(tRegs)) == 0);
+
+	//nothing taken: the one to one channels still there
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tAll)) == CSI_OK);
+	byFree = tGraph.byChMsk;
+	csi_etb_graph_free(&tGraph);
+	CHECK(byFree == 0xF8);
+	iCh = csi_etb_ch_alloc(ETB_MORE_TRG_ONE);
+	CHECK(iCh == ETB_CH0_ID);
+	if(iCh >= 0)
+		csi_etb_ch_free((csi_etb_chid_e)iCh);
+}
+
+static void test_rejects(void)
+{
+	csi_etb_route_t tRoute[ETB_GRAPH_ROUTE_MAX + 1];
+	csi_etb_config_t tCfg;
+	uint8_t i;
+	int32_t iCh;
+
+	for(i = 0; i < ETB_GRAPH_ROUTE_MAX + 1; i++)
+	{
+		tRoute[i].bySrc = i;
+		tRoute[i].byDst = 16 + i;
+	}
+	reject(tRoute, 0);
+	reject(tRoute, ETB_GRAPH_ROUTE_MAX + 1);
+	reject(tRoute, 9);														//one to one only, 8 channels
+
+	tRoute[1].bySrc = 0x40;
+	reject(tRoute, 3);
+	tRoute[1].bySrc = 1;
+	tRoute[1].byDst = 0x40;
+	reject(tRoute, 3);
+	tRoute[1] = tRoute[0];													//same route twice
+	reject(tRoute, 3);
+	tRoute[1].bySrc = 1;
+
+	for(i = 0; i < 4; i++)													//4 sources, one destination
+		tRoute[i].byDst = ETB_ADC_SYNCIN0;
+	reject(tRoute, 4);
+	tRoute[2].byDst = tRoute[3].byDst = ETB_ADC_SYNCIN1;					//2 merges, one channel 0
+	reject(tRoute, 4);
+
+	//destination driven by a channel of someone else: one to one, then a fan out channel
+	iCh = csi_etb_ch_alloc(ETB_ONE_TRG_ONE);
+	memset(&tCfg, 0, sizeof(tCfg));
+	tCfg.byChType  = ETB_ONE_TRG_ONE;
+	tCfg.bySrcIp   = ETB_BT_TRGOUT1;
+	tCfg.byDstIp   = ETB_ADC_SYNCIN3;
+	tCfg.byTrgMode = ETB_HARDWARE_TRG;
+	CHECK(iCh == ETB_CH3_ID && csi_etb_ch_config((csi_etb_chid_e)iCh, &tCfg) == CSI_OK);
+	tRoute[0].bySrc = ETB_EXI_TRGOUT0;
+	tRoute[0].byDst = ETB_ADC_SYNCIN3;
+	CHECK(csi_etb_graph_init(&(csi_etb_graph_t){0}, tRoute, 1) == CSI_ERROR);
+	csi_etb_ch_free((csi_etb_chid_e)iCh);
+
+	iCh = csi_etb_ch_alloc(ETB_ONE_TRG_MORE);
+	tCfg.byChType = ETB_ONE_TRG_MORE;
+	tCfg.byDstIp  = ETB_BT0_SYNCIN0;
+	tCfg.byDstIp1 = ETB_ADC_SYNCIN3;
+	tCfg.byDstIp2 = DST_NOT_USE;
+	CHECK(iCh == ETB_CH1_ID && csi_etb_ch_config((csi_etb_chid_e)iCh, &tCfg) == CSI_OK);
+	CHECK(csi_etb_graph_init(&(csi_etb_graph_t){0}, tRoute, 1) == CSI_ERROR);
+	tRoute[0].byDst = ETB_BT1_SYNCIN0;
+	{
+		csi_etb_graph_t tGraph;
+
+		CHECK(csi_etb_graph_init(&tGraph, tRoute, 1) == CSI_OK);
+		csi_etb_graph_free(&tGraph);
+	}
+	csi_etb_ch_free((csi_etb_chid_e)iCh);
+}
+
+/* destination 0 of an allocated, not yet configured channel ----------*/
+static void test_reset_dst(void)
+{
+	static const csi_etb_route_t s_tLpt[] = {{ETB_RTC_TRGOUT0, ETB_LPT_SYNCIN0}};
+	csi_etb_graph_t tGraph;
+	csi_etb_config_t tCfg;
+	int32_t iCh0, iCh3;
+
+	memset(&s_tEtcb, 0, sizeof(s_tEtcb));									//reset: every destination field 0
+	iCh0 = csi_etb_ch_alloc(ETB_MORE_TRG_ONE);
+	iCh3 = csi_etb_ch_alloc(ETB_ONE_TRG_ONE);
+	CHECK(iCh0 == ETB_CH0_ID && iCh3 == ETB_CH3_ID);
+	CHECK(ETB_LPT_SYNCIN0 == 0);
+
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tLpt)) == CSI_OK);
+	graph_check(&tGraph, ROUTES(s_tLpt), 0x10);
+	csi_etb_graph_free(&tGraph);
+
+	memset(&tCfg, 0, sizeof(tCfg));											//now channel 3 really drives it
+	tCfg.byChType  = ETB_ONE_TRG_ONE;
+	tCfg.bySrcIp   = ETB_BT_TRGOUT0;
+	tCfg.byDstIp   = ETB_LPT_SYNCIN0;
+	tCfg.byTrgMode = ETB_HARDWARE_TRG;
+	CHECK(csi_etb_ch_config((csi_etb_chid_e)iCh3, &tCfg) == CSI_OK);
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tLpt)) == CSI_ERROR);
+
+	csi_etb_ch_free((csi_etb_chid_e)iCh3);									//register unchanged, owner gone
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tLpt)) == CSI_OK);
+	graph_check(&tGraph, ROUTES(s_tLpt), 0x08);
+	csi_etb_graph_free(&tGraph);
+
+	iCh3 = csi_etb_ch_alloc(ETB_ONE_TRG_ONE);								//new owner, old value in the register
+	CHECK(csi_etb_graph_init(&tGraph, ROUTES(s_tLpt)) == CSI_OK);
+	csi_etb_graph_free(&tGraph);
+	csi_etb_ch_free((csi_etb_chid_e)iCh3);
+	csi_etb_ch_free((csi_etb_chid_e)iCh0);
+}
+
+int main(void)
+{
+	test_layouts();
+	test_rejects();
+	test_reset_dst();
+
+	printf("etb: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
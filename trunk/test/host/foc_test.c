@@ -0,0 +1,224 @@
+/***********************************************************************//**
+ * \file  foc_test.c
+ * \brief  host test of the Q15 FOC kernels(foc/src/foc.c) against a double
+ *         precision reference
+ *
+ * Each kernel gets inputs over its whole range and is compared with the
+ * same formula in double; the error limits are those documented in foc.h
+ * (3 LSB for foc_sincos, rounding for the rest). foc_park/foc_ipark get
+ * exact sin/cos so that only their own error is measured. foc_svpwm is
+ * checked against min-max injection and the sector of the angle, foc_pi_run
+ * against a double PI with the same clamps and anti windup, closed over a
+ * first order plant.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "foc.h"
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define LSB				(1.0 / 32768.0)
+#define TEST_RUNS		200000
+
+static unsigned long s_wErr;
+
+static double q15(int32_t iVal)
+{
+	return iVal / 32768.0;
+}
+
+static double turn(uint32_t wTheta)
+{
+	return 2.0 * M_PI * wTheta / 65536.0;
+}
+
+/** \brief sin/cos in Q15 rounded from double
+ */
+static foc_sincos_t sincos_exact(uint16_t hwTheta)
+{
+	foc_sincos_t tSc;
+
+	tSc.nSin = (int16_t)lround(sin(turn(hwTheta)) * 32767.0);
+	tSc.nCos = (int16_t)lround(cos(turn(hwTheta)) * 32767.0);
+	return tSc;
+}
+
+static void test_sincos(void)
+{
+	foc_sincos_t tSc;
+	double dErr = 0.0;
+	uint32_t t;
+
+	for(t = 0; t < 0x10000; t++)
+	{
+		foc_sincos((uint16_t)t, &tSc);
+		dErr = fmax(dErr, fabs(q15(tSc.nSin) - sin(turn(t))));
+		dErr = fmax(dErr, fabs(q15(tSc.nCos) - cos(turn(t))));
+	}
+	printf("sincos  max err %.2f LSB\n", dErr / LSB);
+	CHECK(dErr <= 3.0 * LSB);
+}
+
+static void test_clarke(void)
+{
+	foc_ab_t tIab;
+	foc_albe_t tOut;
+	double dBeta, dErr = 0.0;
+	int i;
+
+	for(i = 0; i < TEST_RUNS; i++)
+	{
+		tIab.nA = (int16_t)(rand() % 43690 - 21845);
+		tIab.nB = (int16_t)(rand() % 43690 - 21845);
+		if(abs(tIab.nA + tIab.nB) > FOC_Q15_MAX)					//ic out of range
+			continue;
+		dBeta = (q15(tIab.nA) + 2.0 * q15(tIab.nB)) / sqrt(3.0);
+		if(dBeta >= 1.0 || dBeta < -1.0)
+			continue;
+
+		foc_clarke(&tIab, &tOut);
+		dErr = fmax(dErr, fabs(q15(tOut.nAlpha) - q15(tIab.nA)));
+		dErr = fmax(dErr, fabs(q15(tOut.nBeta) - dBeta));
+	}
+	printf("clarke  max err %.2f LSB\n", dErr / LSB);
+	CHECK(dErr <= 1.5 * LSB);
+}
+
+static void test_park(void)
+{
+	foc_albe_t tIn, tOut;
+	foc_sincos_t tSc;
+	foc_dq_t tDq;
+	double dSin, dCos, dErrP = 0.0, dErrI = 0.0;
+	int i;
+
+	for(i = 0; i < TEST_RUNS; i++)
+	{
+		tIn.nAlpha = (int16_t)(rand() % 46000 - 23000);
+		tIn.nBeta = (int16_t)(rand() % 46000 - 23000);
+		tSc = sincos_exact((uint16_t)rand());
+		dSin = q15(tSc.nSin);
+		dCos = q15(tSc.nCos);
+
+		foc_park(&tIn, &tSc, &tDq);
+		dErrP = fmax(dErrP, fabs(q15(tDq.nD) - (q15(tIn.nAlpha) * dCos + q15(tIn.nBeta) * dSin)));
+		dErrP = fmax(dErrP, fabs(q15(tDq.nQ) - (q15(tIn.nBeta) * dCos - q15(tIn.nAlpha) * dSin)));
+
+		foc_ipark(&tDq, &tSc, &tOut);
+		dErrI = fmax(dErrI, fabs(q15(tOut.nAlpha) - (q15(tDq.nD) * dCos - q15(tDq.nQ) * dSin)));
+		dErrI = fmax(dErrI, fabs(q15(tOut.nBeta) - (q15(tDq.nD) * dSin + q15(tDq.nQ) * dCos)));
+	}
+	printf("park    max err %.2f LSB\nipark   max err %.2f LSB\n", dErrP / LSB, dErrI / LSB);
+	CHECK(dErrP <= 1.0 * LSB);
+	CHECK(dErrI <= 1.0 * LSB);
+
+	//-1 * -0.7071 * 2 = 1.414: d saturates, q is exactly 0
+	tIn.nAlpha = FOC_Q15_MIN;
+	tIn.nBeta = FOC_Q15_MIN;
+	tSc.nSin = -23170;
+	tSc.nCos = -23170;
+	foc_park(&tIn, &tSc, &tDq);
+	CHECK(tDq.nD == FOC_Q15_MAX && tDq.nQ == 0);
+}
+
+static void test_svpwm(void)
+{
+	const uint16_t hwScale = 1200;
+	foc_albe_t tV;
+	uint16_t hwCmp[3];
+	double dMod, dAng, dVa, dVb, dVc, dOfs, dFrac, dErr = 0.0;
+	uint32_t wBadSector = 0;
+	uint8_t bySector;
+	int i, k;
+
+	for(i = 0; i < TEST_RUNS; i++)
+	{
+		dMod = (rand() % 10000) / 10000.0 / sqrt(3.0) * 0.999;		//linear range
+		dAng = turn((uint32_t)rand() % 0x10000U);
+		tV.nAlpha = (int16_t)lround(dMod * cos(dAng) * 32768.0);
+		tV.nBeta = (int16_t)lround(dMod * sin(dAng) * 32768.0);
+		bySector = foc_svpwm(&tV, hwScale, hwCmp);
+
+		//phase voltages, min-max zero sequence, compare = scale * (1 - duty)
+		dVa = q15(tV.nAlpha);
+		dVb = -q15(tV.nAlpha) / 2.0 + sqrt(3.0) / 2.0 * q15(tV.nBeta);
+		dVc = -q15(tV.nAlpha) / 2.0 - sqrt(3.0) / 2.0 * q15(tV.nBeta);
+		dOfs = 0.5 - (fmax(dVa, fmax(dVb, dVc)) + fmin(dVa, fmin(dVb, dVc))) / 2.0;
+		dErr = fmax(dErr, fabs(hwScale * (1.0 - (dVa + dOfs)) - hwCmp[0]));
+		dErr = fmax(dErr, fabs(hwScale * (1.0 - (dVb + dOfs)) - hwCmp[1]));
+		dErr = fmax(dErr, fabs(hwScale * (1.0 - (dVc + dOfs)) - hwCmp[2]));
+
+		//sector of the angle, away from the borders
+		dAng = atan2(q15(tV.nBeta), q15(tV.nAlpha));
+		if(dAng < 0.0)
+			dAng += 2.0 * M_PI;
+		dFrac = fmod(dAng, M_PI / 3.0);
+		if(dMod > 0.01 && dFrac > 0.01 && dFrac < M_PI / 3.0 - 0.01 && bySector != (int)(dAng / (M_PI / 3.0)) + 1)
+			wBadSector++;
+	}
+	printf("svpwm   max cmp err %.2f ticks of %u, %u sector mismatches\n", dErr, hwScale, wBadSector);
+	CHECK(dErr <= 1.5);
+	CHECK(wBadSector == 0);
+
+	tV.nAlpha = 0;
+	tV.nBeta = 0;
+	CHECK(foc_svpwm(&tV, hwScale, hwCmp) == 0);
+	for(k = 0; k < 3; k++)
+		CHECK(hwCmp[k] == hwScale / 2);
+}
+
+static void test_pi(void)
+{
+	const double dKp = 2.0, dKi = 410.0 / 4096.0, dLim = 20000.0 / 32768.0;
+	double dInteg = 0.0, dIntegNew, dOut, dErr, dPlant = 0.0, dMax = 0.0;
+	int16_t nRef, nOut, nFb = 0;
+	foc_pi_t tPi;
+	int k;
+
+	foc_pi_init(&tPi, 2 * 4096, 410, 12, -20000, 20000);
+	for(k = 0; k < 5000; k++)
+	{
+		nRef = (k < 2500) ? 16000 : -30000;							//the second step saturates
+		nOut = foc_pi_run(&tPi, nRef, nFb);
+
+		//double PI: integrator and output clamped, integrator held while saturated
+		dErr = q15(nRef) - q15(nFb);
+		dIntegNew = fmin(fmax(dInteg + dKi * dErr, -dLim), dLim);
+		dOut = dKp * dErr + dIntegNew;
+		if(dOut > dLim)
+		{
+			dOut = dLim;
+			if(dErr > 0.0)
+				dIntegNew = dInteg;
+		}
+		else if(dOut < -dLim)
+		{
+			dOut = -dLim;
+			if(dErr < 0.0)
+				dIntegNew = dInteg;
+		}
+		dInteg = dIntegNew;
+		dMax = fmax(dMax, fabs(q15(nOut) - dOut));
+
+		dPlant += (q15(nOut) - dPlant) * 0.01;							//first order plant
+		nFb = (int16_t)lround(dPlant * 32768.0);
+	}
+	printf("pi      max err %.2f LSB, final %.4f\n", dMax / LSB, dPlant);
+	CHECK(dMax <= 1.5 * LSB);
+	CHECK(fabs(dPlant + dLim) < 0.001);								//settles on the lower limit
+}
+
+int main(void)
+{
+	srand(1);
+	test_sincos();
+	test_clarke();
+	test_park();
+	test_svpwm();
+	test_pi();
+
+	printf("foc: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+/***********************************************************************//**
+ * \file  ifc_model.c
+ * \brief  simulated IFC with its DFLASH, and the CPU interrupt state around it
+ *
+ * DFLASH is mapped at DFLASHBASE, so the drivers read it and load the page
+ * latches through the real addresses. A page is written by the sequence
+ * PAGE_LAT_CLR, latch load, PRE_PGM, PROGRAM(pre-program), PAGE_ERASE,
+ * PROGRAM; each command runs a few ticks with CR set and raises its end
+ * flag in RISR, IFC_IRQn is pending while RISR & IMCR; csp_ifc_clr_int of
+ * stub/csp_ifc.h clears RISR bits at once. A command sent
+ * without the key, with the clock off, outside DFLASH or out of sequence is
+ * counted in wViolation, the driver must never send one.
+ *
+ * Time only passes in model_run(), which __get_PSR() calls once: the wait
+ * loops of the drivers spin on it. A pending interrupt is taken after each
+ * tick when PSR.IE and the IRQ are enabled and no handler is running.
+ *
+ * At the tick dwCut the power fails: a program/erase in progress has
+ * changed the first words of the page only, the word it was at holds
+ * garbage; then cut() is called.
+ * *********************************************************************
+*/
+#define _GNU_SOURCE									//MAP_FIXED_NOREPLACE
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <drv/ifc.h>
+#include "ifc_model.h"
+
+#define RW(reg)			(*(volatile uint32_t *)&(reg))		//write the read-only registers
+#define PAGE_BYTES		(DFLASH_PAGE_SZ * 4U)
+
+ifc_model_t g_tIfcModel;
+uint32_t g_wIfcReg[16];
+
+static uint32_t *model_page(void)
+{
+	return &MODEL_DFLASH[(g_tIfcModel.wPage - DFLASHBASE) / 4U];
+}
+
+static uint32_t model_garbage(void)
+{
+	return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+/** \brief cell changes of the running command, on the first wWords words
+ */
+static void model_cmd_apply(uint32_t wWords)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+	uint32_t *pwPage = model_page();
+	uint32_t *pwStuck = &ptM->wStuck[(ptM->wPage - DFLASHBASE) / 4U];
+	uint32_t i, wNew;
+
+	if(ptM->byCmd != PROGRAM && ptM->byCmd != PAGE_ERASE)
+		return;
+
+	for(i = 0; i < DFLASH_PAGE_SZ && i <= wWords; i++)
+	{
+		if(ptM->byCmd == PAGE_ERASE)
+			wNew = 0xFFFFFFFFU;
+		else if(ptM->bPre)
+			wNew = pwPage[i] & pwStuck[i];
+		else
+			wNew = pwPage[i] & (ptM->wLatch[i] | pwStuck[i]);
+		pwPage[i] = (i < wWords) ? wNew : model_garbage();
+	}
+}
+
+static void model_power_cut(void)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+	uint8_t byCmd = ptM->wBusy ? ptM->byCmd : 0;
+
+	if(byCmd)
+		model_cmd_apply((uint32_t)rand() % (DFLASH_PAGE_SZ + 1U));
+	if(ptM->byExpect == PRE_PGM)							//latches loaded through the page
+		memcpy(model_page(), ptM->wCell, PAGE_BYTES);
+	ptM->cut(byCmd);
+}
+
+static void model_cmd_start(void)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+	uint32_t wAddr = IFC->ADDR;
+	uint8_t byCmd = (uint8_t)IFC->CMR;
+
+	if(RW(IFC->KR) != IFC_USER_KEY || IFC->CEDR != IFC_CLKEN)
+		ptM->wViolation++;
+	RW(IFC->KR) = 0;										//the key opens one command
+	if(wAddr < DFLASHBASE || wAddr >= DFLASHLIMIT || (wAddr % PAGE_BYTES))
+	{
+		ptM->wViolation++;
+		wAddr = DFLASHBASE;
+	}
+	if(byCmd == PAGE_LAT_CLR)
+		ptM->wPage = wAddr;
+	else if(byCmd != ptM->byExpect || wAddr != ptM->wPage)
+		ptM->wViolation++;
+
+	ptM->byCmd = byCmd;
+	ptM->wBusy = (byCmd == PAGE_ERASE) ? 4U : (byCmd == PROGRAM) ? 3U : 2U;
+}
+
+static void model_cmd_end(void)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+	uint32_t *pwPage = model_page();
+	uint32_t wEnd = 0;
+
+	switch(ptM->byCmd)
+	{
+		case PAGE_LAT_CLR:
+			memcpy(ptM->wCell, pwPage, PAGE_BYTES);
+			ptM->byExpect = PRE_PGM;
+			break;
+		case PRE_PGM:
+			memcpy(ptM->wLatch, pwPage, PAGE_BYTES);
+			memcpy(pwPage, ptM->wCell, PAGE_BYTES);
+			ptM->bPre = true;
+			ptM->byExpect = PROGRAM;
+			break;
+		case PAGE_ERASE:
+			model_cmd_apply(DFLASH_PAGE_SZ);
+			wEnd = IFCINT_ERS_END;
+			ptM->byExpect = PROGRAM;
+			break;
+		case PROGRAM:
+			model_cmd_apply(DFLASH_PAGE_SZ);
+			if(ptM->bPre)
+			{
+				wEnd = (IFC->MR & DFLASH_PMODE) ? IFCINT_PEP_END : IFCINT_PGM_END;
+				ptM->byExpect = PAGE_ERASE;
+			}
+			else
+			{
+				wEnd = IFCINT_PGM_END;
+				ptM->byExpect = 0;
+			}
+			ptM->bPre = false;
+			break;
+		default:
+			ptM->wViolation++;
+			break;
+	}
+	ptM->wCmd[ptM->byCmd & 0x0F]++;
+	RW(IFC->RISR) |= wEnd;
+	RW(IFC->CR) = 0;
+}
+
+static void model_tick(void)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+
+	ptM->dwTick++;
+	if(ptM->dwTick == ptM->dwCut)
+		model_power_cut();
+
+	if(ptM->wBusy)
+	{
+		if(--ptM->wBusy == 0)
+			model_cmd_end();
+	}
+	else if(IFC->CR & IFC_START)
+		model_cmd_start();
+
+	RW(IFC->MISR) = IFC->RISR & IFC->IMCR;
+	if(IFC->MISR)
+		ptM->bPending = true;
+}
+
+static void model_irq_take(void)
+{
+	ifc_model_t *ptM = &g_tIfcModel;
+
+	if(!ptM->bPending || !ptM->bIrqEn || !ptM->bIe || ptM->bInIsr)
+		return;
+	ptM->bPending = false;
+	ptM->bInIsr = true;
+	ptM->bIe = false;										//masked in the handler
+	ptM->wIsr++;
+	apt_ifc_irqhandler(IFC);
+	ptM->bIe = true;
+	ptM->bInIsr = false;
+}
+
+void model_init(void)
+{
+	void *pMap = mmap((void *)DFLASHBASE, DFLASHSIZE, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if(pMap != (void *)DFLASHBASE)
+		abort();
+	memset(pMap, 0xFF, DFLASHSIZE);
+}
+
+void model_reset(void)
+{
+	memset(g_wIfcReg, 0, sizeof(g_wIfcReg));
+	memset(&g_tIfcModel, 0, sizeof(g_tIfcModel));
+	g_tIfcModel.bIe = true;
+}
+
+void model_run(uint32_t wTicks)
+{
+	while(wTicks--)
+	{
+		model_tick();
+		model_irq_take();
+	}
+}
+
+/* the CPU side of the interrupts -------------------------------------*/
+uint32_t __get_PSR(void)
+{
+	model_run(1);
+	return g_tIfcModel.bIe ? PSR_IE_Msk : 0;
+}
+
+uint32_t csi_irq_save(void)
+{
+	uint32_t wFlag = g_tIfcModel.bIe ? PSR_IE_Msk : 0;
+
+	g_tIfcModel.bIe = false;
+	return wFlag;
+}
+
+void csi_irq_restore(uint32_t wIrqFlag)
+{
+	g_tIfcModel.bIe = (wIrqFlag & PSR_IE_Msk) != 0;
+	model_irq_take();
+}
+
+void csi_vic_enable_irq(int32_t IRQn)
+{
+	if(IRQn == IFC_IRQn)
+		g_tIfcModel.bIrqEn = true;
+}
+
+void csi_vic_set_pending_irq(int32_t IRQn)
+{
+	if(IRQn != IFC_IRQn)
+		return;
+	g_tIfcModel.bPending = true;
+	model_irq_take();
+}
@@ -0,0 +1,53 @@
+/***********************************************************************//**
+ * \file  ifc_model.h
+ * \brief  simulated IFC with its DFLASH, and the CPU interrupt state around it
+ * *********************************************************************
+*/
+#ifndef _IFC_MODEL_H_
+#define _IFC_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <soc.h>
+#include <csp.h>
+
+#define MODEL_DFLASH_WORDS	(DFLASHSIZE / 4U)
+#define MODEL_DFLASH		((uint32_t *)DFLASHBASE)
+
+typedef struct {
+	uint32_t	wBusy;							//ticks left of the running command, 0: idle
+	uint8_t		byCmd;							//running command
+	uint8_t		byExpect;						//next command of the page sequence, 0: LAT_CLR
+	bool		bPre;							//the next PROGRAM is the pre-program
+	uint32_t	wPage;							//page of the sequence
+	uint32_t	wLatch[DFLASH_PAGE_SZ];
+	uint32_t	wCell[DFLASH_PAGE_SZ];			//cells of wPage while the latches are loaded
+	uint32_t	wStuck[MODEL_DFLASH_WORDS];		//bits that never program to 0
+	uint32_t	wCmd[16];						//commands done, by CMR value
+	uint32_t	wViolation;						//commands the IFC would reject or misread
+	uint32_t	wIsr;							//IFC interrupts taken
+	uint64_t	dwTick;
+	uint64_t	dwCut;							//power fails at this tick, 0: never
+	void		(*cut)(uint8_t byCmd);			//called at the cut with the running command(0: none), must not return
+	bool		bIe;							//PSR.IE
+	bool		bIrqEn;
+	bool		bPending;
+	bool		bInIsr;
+} ifc_model_t;
+
+extern ifc_model_t g_tIfcModel;
+
+/** \brief map DFLASH at DFLASHBASE, shared with forked children, and erase it
+ */
+void model_init(void);
+
+/** \brief power on: registers, CPU state and counters cleared, DFLASH kept;
+ *         interrupts enabled as after the startup code
+ */
+void model_reset(void);
+
+/** \brief let the IFC run, an interrupt pending and enabled is taken after each tick
+ */
+void model_run(uint32_t wTicks);
+
+#endif
@@ -0,0 +1,246 @@
+/***********************************************************************//**
+ * \file  ifc_test.c
+ * \brief  host test of the interrupt driven page program of chip/drivers/ifc.c
+ *
+ * ifc.c is built unchanged on the IFC/DFLASH model(ifc_model.c). Checked:
+ *  - csi_ifc_program_async returns with the first step issued, every later
+ *    step is started by the IFC interrupt: the request completes from
+ *    model_run() alone, nothing polls
+ *  - csi_ifc_wait with interrupts masked runs the handler itself, no
+ *    interrupt is taken and PSR.IE stays clear
+ *  - read-modify-write: random word ranges, across page ends, against a
+ *    shadow of DFLASH; the words outside a range keep their value
+ *  - the queue: requests run in submit order, a callback may submit the
+ *    next one, a queued request is refused with CSI_BUSY
+ *  - a bit that does not program fails the page check: the request ends in
+ *    IFC_XFER_ERROR with wDone at the page, the next request still runs
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <drv/ifc.h>
+#include "ifc_model.h"
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define TEST_RMW		2000U
+#define PAGE_BYTES		(DFLASH_PAGE_SZ * 4U)
+
+static unsigned long s_wErr;
+static uint32_t s_wShadow[MODEL_DFLASH_WORDS];
+static uint32_t s_wData[3 * DFLASH_PAGE_SZ];
+
+static csi_ifc_xfer_t s_tXfer[4];
+static uint8_t s_byOrder[8];
+static uint8_t s_byDone;
+static csi_error_t s_eResult[4];
+
+static void xfer_cb(csi_ifc_xfer_t *ptXfer, csi_error_t eResult)
+{
+	uint8_t byIdx = (uint8_t)(ptXfer - s_tXfer);
+
+	s_byOrder[s_byDone++] = byIdx;
+	s_eResult[byIdx] = eResult;
+	if(ptXfer->pArg)													//chain the next request
+		CHECK(csi_ifc_program_async(IFC, (csi_ifc_xfer_t *)ptXfer->pArg) == CSI_OK);
+}
+
+static void xfer_set(csi_ifc_xfer_t *ptXfer, uint32_t wWord, const uint32_t *pwData, uint32_t wNum)
+{
+	memset(ptXfer, 0, sizeof(csi_ifc_xfer_t));
+	ptXfer->wAddr = DFLASHBASE + wWord * 4U;
+	ptXfer->pwData = pwData;
+	ptXfer->wDataNum = wNum;
+}
+
+static void data_fill(uint32_t wNum)
+{
+	uint32_t i;
+
+	for(i = 0; i < wNum; i++)
+		s_wData[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static void flash_fresh(void)
+{
+	uint32_t i;
+
+	model_reset();
+	for(i = 0; i < MODEL_DFLASH_WORDS; i++)
+		s_wShadow[i] = MODEL_DFLASH[i] = 0xA5000000U | i;
+}
+
+/** \brief the whole page sequence runs from the IFC interrupt
+ */
+static void test_irq_steps(void)
+{
+	csi_ifc_xfer_t tXfer;
+	uint32_t wTicks = 0;
+
+	flash_fresh();
+	data_fill(DFLASH_PAGE_SZ * 2);
+	xfer_set(&tXfer, DFLASH_PAGE_SZ, s_wData, DFLASH_PAGE_SZ * 2);		//two whole pages
+	CHECK(csi_ifc_program_async(IFC, &tXfer) == CSI_OK);
+	CHECK(csi_ifc_xfer_busy(&tXfer) && !g_bFlashPgmDne);
+	CHECK(IFC->CR == IFC_START && IFC->CMR == PAGE_LAT_CLR);			//step1 issued, nothing waited
+	CHECK(g_tIfcModel.wIsr == 1);
+
+	while(csi_ifc_xfer_busy(&tXfer) && wTicks < 1000)
+	{
+		model_run(1);
+		wTicks++;
+	}
+	CHECK(tXfer.byState == IFC_XFER_DONE && tXfer.wDone == DFLASH_PAGE_SZ * 2);
+	CHECK(g_bFlashPgmDne && g_bFlashCheckPass);
+	CHECK(memcmp(&MODEL_DFLASH[DFLASH_PAGE_SZ], s_wData, PAGE_BYTES * 2) == 0);
+	CHECK(MODEL_DFLASH[0] == s_wShadow[0] && MODEL_DFLASH[3 * DFLASH_PAGE_SZ] == s_wShadow[3 * DFLASH_PAGE_SZ]);
+	CHECK(g_tIfcModel.wCmd[PAGE_LAT_CLR] == 2 && g_tIfcModel.wCmd[PRE_PGM] == 2);
+	CHECK(g_tIfcModel.wCmd[PAGE_ERASE] == 2 && g_tIfcModel.wCmd[PROGRAM] == 4);
+	CHECK(g_tIfcModel.wIsr > 10);										//one or more per step
+	CHECK((IFC->MR & DFLASH_PMODE) && IFC->IMCR == 0);
+	CHECK(g_tIfcModel.wViolation == 0);
+	printf("irq steps: 2 pages in %u ticks, %u interrupts\n", wTicks, g_tIfcModel.wIsr);
+}
+
+/** \brief csi_ifc_wait in a critical section polls the handler itself
+ */
+static void test_wait_masked(void)
+{
+	csi_ifc_xfer_t tXfer;
+	uint32_t wIrqSta, wIsr;
+
+	flash_fresh();
+	data_fill(5);
+	xfer_set(&tXfer, 2 * DFLASH_PAGE_SZ + 7, s_wData, 5);
+
+	wIrqSta = csi_irq_save();
+	wIsr = g_tIfcModel.wIsr;
+	CHECK(csi_ifc_program_async(IFC, &tXfer) == CSI_OK);
+	CHECK(csi_ifc_wait(IFC, &tXfer) == CSI_OK);
+	CHECK(g_tIfcModel.wIsr == wIsr && !g_tIfcModel.bIe);				//no interrupt taken
+	csi_irq_restore(wIrqSta);
+
+	CHECK(memcmp(&MODEL_DFLASH[2 * DFLASH_PAGE_SZ + 7], s_wData, 5 * 4) == 0);
+	CHECK(MODEL_DFLASH[2 * DFLASH_PAGE_SZ + 6] == s_wShadow[2 * DFLASH_PAGE_SZ + 6]);
+	CHECK(MODEL_DFLASH[2 * DFLASH_PAGE_SZ + 12] == s_wShadow[2 * DFLASH_PAGE_SZ + 12]);
+
+	CHECK(csi_ifc_program(IFC, DFLASHBASE + 4, s_wData, 1) == CSI_OK);	//blocking, interrupts on
+	CHECK(MODEL_DFLASH[1] == s_wData[0]);
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+/** \brief random ranges, words around them keep their value
+ */
+static void test_rmw(void)
+{
+	csi_ifc_xfer_t tXfer;
+	uint32_t i, wWord, wNum, wBad = 0;
+
+	flash_fresh();
+	for(i = 0; i < TEST_RMW; i++)
+	{
+		wNum = 1 + (uint32_t)rand() % (3 * DFLASH_PAGE_SZ);
+		wWord = (uint32_t)rand() % (MODEL_DFLASH_WORDS - wNum + 1);
+		data_fill(wNum);
+		xfer_set(&tXfer, wWord, s_wData, wNum);
+		if(rand() % 2)
+			CHECK(csi_ifc_program_async(IFC, &tXfer) == CSI_OK && csi_ifc_wait(IFC, &tXfer) == CSI_OK);
+		else
+			CHECK(csi_ifc_program(IFC, tXfer.wAddr, s_wData, wNum) == CSI_OK);
+		memcpy(&s_wShadow[wWord], s_wData, wNum * 4);
+		if(memcmp(MODEL_DFLASH, s_wShadow, DFLASHSIZE) != 0)
+		{
+			wBad++;
+			memcpy(s_wShadow, MODEL_DFLASH, DFLASHSIZE);
+		}
+	}
+	printf("rmw: %u ranges, %u pages erased\n", TEST_RMW, g_tIfcModel.wCmd[PAGE_ERASE]);
+	CHECK(wBad == 0);
+	CHECK(g_bFlashCheckPass);
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+/** \brief submit order, chaining from the callback, CSI_BUSY, argument checks
+ */
+static void test_queue(void)
+{
+	static uint32_t s_wPat[4][DFLASH_PAGE_SZ];
+	uint32_t i, k;
+
+	flash_fresh();
+	for(k = 0; k < 4; k++)
+	{
+		for(i = 0; i < DFLASH_PAGE_SZ; i++)
+			s_wPat[k][i] = (k << 24) | i;
+		xfer_set(&s_tXfer[k], (k * 3 + 1) * DFLASH_PAGE_SZ + 2, s_wPat[k], DFLASH_PAGE_SZ - 4);
+		s_tXfer[k].callback = xfer_cb;
+		s_eResult[k] = CSI_BUSY;
+	}
+	s_tXfer[1].pArg = &s_tXfer[3];										//3 is submitted by the callback of 1
+	s_byDone = 0;
+
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[0]) == CSI_OK);
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[1]) == CSI_OK);
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[2]) == CSI_OK);
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[1]) == CSI_BUSY);
+	CHECK(s_tXfer[2].byState == IFC_XFER_QUEUED);
+	model_run(500);
+
+	CHECK(s_byDone == 4);
+	CHECK(s_byOrder[0] == 0 && s_byOrder[1] == 1 && s_byOrder[2] == 2 && s_byOrder[3] == 3);
+	for(k = 0; k < 4; k++)
+	{
+		CHECK(s_eResult[k] == CSI_OK && s_tXfer[k].byState == IFC_XFER_DONE);
+		CHECK(memcmp(&MODEL_DFLASH[(k * 3 + 1) * DFLASH_PAGE_SZ + 2], s_wPat[k], (DFLASH_PAGE_SZ - 4) * 4) == 0);
+	}
+	CHECK(g_bFlashPgmDne);
+
+	xfer_set(&s_tXfer[0], 1, NULL, 1);
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[0]) == CSI_ERROR);
+	xfer_set(&s_tXfer[0], 0, s_wData, 0);
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[0]) == CSI_ERROR);
+	xfer_set(&s_tXfer[0], MODEL_DFLASH_WORDS - 1, s_wData, 2);			//past the end of DFLASH
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[0]) == CSI_ERROR);
+	s_tXfer[0].wAddr = DFLASHBASE + 2;
+	CHECK(csi_ifc_program_async(IFC, &s_tXfer[0]) == CSI_ERROR);
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+/** \brief failed page check ends the request, the queue goes on
+ */
+static void test_check_fail(void)
+{
+	csi_ifc_xfer_t tBad, tGood;
+	uint32_t wPage = 5 * DFLASH_PAGE_SZ;
+
+	flash_fresh();
+	data_fill(2 * DFLASH_PAGE_SZ);
+	s_wData[DFLASH_PAGE_SZ + 3] &= ~1U;
+	g_tIfcModel.wStuck[wPage + DFLASH_PAGE_SZ + 3] = 1U;				//bit 0 of the word stays 1
+
+	xfer_set(&tBad, wPage, s_wData, 2 * DFLASH_PAGE_SZ);
+	xfer_set(&tGood, 0, s_wData, 4);
+	CHECK(csi_ifc_program_async(IFC, &tBad) == CSI_OK);
+	CHECK(csi_ifc_program_async(IFC, &tGood) == CSI_OK);
+	CHECK(csi_ifc_wait(IFC, &tBad) == CSI_ERROR);
+	CHECK(tBad.byState == IFC_XFER_ERROR && tBad.wDone == DFLASH_PAGE_SZ);
+	CHECK(csi_ifc_wait(IFC, &tGood) == CSI_OK);
+	CHECK(g_bFlashCheckPass && g_bFlashPgmDne);							//set again by the good request
+	CHECK(memcmp(&MODEL_DFLASH[wPage], s_wData, PAGE_BYTES) == 0);
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+int main(void)
+{
+	srand(1);
+	model_init();
+	test_irq_steps();
+	test_wait_masked();
+	test_rmw();
+	test_queue();
+	test_check_fail();
+
+	printf("ifc: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
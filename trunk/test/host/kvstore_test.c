@@ -0,0 +1,313 @@
+/***********************************************************************//**
+ * \file  kvstore_test.c
+ * \brief  host test of chip/drivers/kvstore.c on the simulated IFC/DFLASH
+ *
+ * kvstore.c and ifc.c are built unchanged, every page program runs through
+ * the IFC model(ifc_model.c) from the IFC interrupt. Checked:
+ *  - set/get/delete/remount, the argument checks, csi_kv_get(key, NULL, 0)
+ *  - a write whose carried victim records do not fit with the new record:
+ *    the carry page is written first, the values stay intact
+ *  - power cuts: each run is a child process that mounts the shared DFLASH,
+ *    checks it against the shadow of the committed values, and writes until
+ *    the power fails at a random tick. A write is committed once
+ *    csi_kv_flush returned; the one in progress may be found either way,
+ *    every other key must hold its committed value. The cuts are counted by
+ *    the command running(none, PAGE_LAT_CLR, PRE_PGM, pre-program,
+ *    PAGE_ERASE, PROGRAM), each one has to be hit.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <drv/kvstore.h>
+#include <drv/crc.h>
+#include "ifc_model.h"
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define TEST_KEYS		8U						//keys of the power cut runs
+#define TEST_RUNS		3000U
+#define TEST_OPS		40U
+#define CUT_KINDS		6U
+
+typedef struct {
+	int16_t		nLen;							//-1: not stored
+	uint8_t		byVal[KV_VALUE_MAX];
+} kv_val_t;
+
+/// shared by the power cut runs
+typedef struct {
+	kv_val_t	tVal[CONFIG_KV_KEYS];			//committed values
+	kv_val_t	tPend;							//write in progress
+	int16_t		nPendKey;						//-1: none
+	uint32_t	wCut[CUT_KINDS];				//cuts by command running
+	uint32_t	wPendFound;						//writes in progress found after the cut
+	uint32_t	wFull;							//writes rejected, store full
+} shadow_t;
+
+static unsigned long s_wErr;
+static shadow_t *s_ptSh;
+
+/* what kvstore.c needs from the rest of the sdk ------------------------*/
+uint32_t csi_crc_soft(csi_crc_type_e eType, uint32_t wCrcSeed, const void *pData, uint32_t wSize)
+{
+	const uint8_t *pbyData = (const uint8_t *)pData;
+	uint32_t i;
+
+	while(wSize--)												//CCITT, reflected
+	{
+		wCrcSeed ^= *pbyData++;
+		for(i = 0; i < 8; i++)
+			wCrcSeed = (wCrcSeed & 1) ? (wCrcSeed >> 1) ^ 0x8408U : (wCrcSeed >> 1);
+	}
+	return wCrcSeed & 0xFFFFU;
+}
+
+static bool kv_same(int32_t nLen, const uint8_t *pbyVal, const kv_val_t *ptVal)
+{
+	if(ptVal->nLen < 0)
+		return nLen < 0;
+	return nLen == ptVal->nLen && memcmp(pbyVal, ptVal->byVal, (size_t)nLen) == 0;
+}
+
+static bool kv_matches(uint8_t byKey, const kv_val_t *ptVal)
+{
+	uint8_t byBuf[KV_VALUE_MAX];
+
+	return kv_same(csi_kv_get(byKey, byBuf, sizeof(byBuf)), byBuf, ptVal);
+}
+
+static void kv_rand_val(kv_val_t *ptVal)
+{
+	int16_t i;
+
+	ptVal->nLen = (rand() % 8 == 0) ? (int16_t)KV_VALUE_MAX : (int16_t)(rand() % 33);
+	for(i = 0; i < ptVal->nLen; i++)
+		ptVal->byVal[i] = (uint8_t)rand();
+}
+
+/** \brief erased DFLASH, IFC after reset, store mounted
+ */
+static void kv_fresh(void)
+{
+	memset(MODEL_DFLASH, 0xFF, DFLASHSIZE);
+	model_reset();
+	CHECK(csi_kv_init() == CSI_OK);
+}
+
+static void test_basic(void)
+{
+	uint8_t byBuf[KV_VALUE_MAX];
+	uint8_t byBig[KV_VALUE_MAX + 1] = {0};
+
+	kv_fresh();
+	CHECK(csi_kv_get(1, byBuf, sizeof(byBuf)) == CSI_ERROR);
+	CHECK(csi_kv_set(1, "abc", 3) == CSI_OK);
+	CHECK(csi_kv_get(1, byBuf, sizeof(byBuf)) == 3 && memcmp(byBuf, "abc", 3) == 0);
+	CHECK(csi_kv_get(1, NULL, 0) == 3);							//length only
+	CHECK(csi_kv_get(1, byBuf, 2) == 3);						//cut to the buffer
+	CHECK(csi_kv_set(2, NULL, 0) == CSI_OK);
+	CHECK(csi_kv_get(2, byBuf, sizeof(byBuf)) == 0);
+	CHECK(csi_kv_set(3, "xyz", 3) == CSI_OK);
+	CHECK(csi_kv_delete(3) == CSI_OK);
+	CHECK(csi_kv_get(3, NULL, 0) == CSI_ERROR);
+	CHECK(csi_kv_delete(4) == CSI_OK);							//never stored
+
+	CHECK(csi_kv_set(CONFIG_KV_KEYS, "a", 1) == CSI_ERROR);
+	CHECK(csi_kv_set(5, byBig, KV_VALUE_MAX + 1) == CSI_ERROR);
+	CHECK(csi_kv_set(5, NULL, 1) == CSI_ERROR);
+	CHECK(csi_kv_get(CONFIG_KV_KEYS, byBuf, sizeof(byBuf)) == CSI_ERROR);
+	CHECK(csi_kv_delete(CONFIG_KV_KEYS) == CSI_ERROR);
+	CHECK(csi_kv_flush() == CSI_OK);
+	CHECK(!csi_kv_busy());
+
+	model_reset();												//remount
+	CHECK(csi_kv_init() == CSI_OK);
+	CHECK(csi_kv_get(1, byBuf, sizeof(byBuf)) == 3 && memcmp(byBuf, "abc", 3) == 0);
+	CHECK(csi_kv_get(2, NULL, 0) == 0);
+	CHECK(csi_kv_get(3, NULL, 0) == CSI_ERROR);
+
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+/** \brief full page values: once the ring comes round to the pages holding
+ *         them, the victim records and the new one do not fit a page, so the
+ *         carry page is written on its own first
+ */
+static void test_carry_only(void)
+{
+	kv_val_t tVal[5];
+	uint32_t wErase, wMaxPages = 0;
+	uint8_t i, k, byRound;
+
+	kv_fresh();
+	for(k = 0; k < 5; k++)
+	{
+		tVal[k].nLen = KV_VALUE_MAX;
+		memset(tVal[k].byVal, 0x10 + k, KV_VALUE_MAX);
+		CHECK(csi_kv_set(k, tVal[k].byVal, KV_VALUE_MAX) == CSI_OK);
+	}
+
+	for(byRound = 0; byRound < 3 * CONFIG_KV_PAGES; byRound++)	//only key 0 changes
+	{
+		memset(tVal[0].byVal, byRound, KV_VALUE_MAX);
+		CHECK(csi_kv_flush() == CSI_OK);
+		wErase = g_tIfcModel.wCmd[PAGE_ERASE];
+		CHECK(csi_kv_set(0, tVal[0].byVal, KV_VALUE_MAX) == CSI_OK);
+		CHECK(csi_kv_flush() == CSI_OK);
+		if(g_tIfcModel.wCmd[PAGE_ERASE] - wErase > wMaxPages)
+			wMaxPages = g_tIfcModel.wCmd[PAGE_ERASE] - wErase;
+		for(i = 0; i < 5; i++)
+			CHECK(kv_matches(i, &tVal[i]));
+	}
+	printf("carry only: up to %u pages for one write\n", wMaxPages);
+	CHECK(wMaxPages > 1);
+
+	model_reset();
+	CHECK(csi_kv_init() == CSI_OK);
+	for(i = 0; i < 5; i++)
+		CHECK(kv_matches(i, &tVal[i]));
+	CHECK(g_tIfcModel.wViolation == 0);
+}
+
+/* power cut runs -------------------------------------------------------*/
+static void cut_exit(uint8_t byCmd)
+{
+	uint8_t byKind;
+
+	switch(byCmd)
+	{
+		case PAGE_LAT_CLR:	byKind = 1; break;
+		case PRE_PGM:		byKind = 2; break;
+		case PROGRAM:		byKind = g_tIfcModel.bPre ? 3 : 5; break;
+		case PAGE_ERASE:	byKind = 4; break;
+		default:			byKind = 0; break;
+	}
+	s_ptSh->wCut[byKind]++;
+	fflush(stdout);
+	_exit(s_wErr ? 1 : 0);
+}
+
+/** \brief mounted store against the shadow, the write in progress at the
+ *         cut may have made it
+ */
+static void run_mount_check(void)
+{
+	uint8_t byBuf[KV_VALUE_MAX];
+	int32_t nLen;
+	uint8_t k;
+
+	for(k = 0; k < CONFIG_KV_KEYS; k++)
+	{
+		nLen = csi_kv_get(k, byBuf, sizeof(byBuf));
+		if(kv_same(nLen, byBuf, &s_ptSh->tVal[k]))
+			continue;
+		if(k == s_ptSh->nPendKey && kv_same(nLen, byBuf, &s_ptSh->tPend))
+		{
+			s_ptSh->tVal[k] = s_ptSh->tPend;
+			s_ptSh->wPendFound++;
+			continue;
+		}
+		printf("key %u: %d bytes, committed %d\n", k, nLen, s_ptSh->tVal[k].nLen);
+		s_wErr++;
+	}
+	s_ptSh->nPendKey = -1;
+}
+
+static void run_child(uint32_t wRun)
+{
+	csi_error_t tRet;
+	uint32_t i;
+	uint8_t k;
+
+	srand(wRun + 1);
+	model_reset();
+	g_tIfcModel.cut = cut_exit;
+	CHECK(csi_kv_init() == CSI_OK);
+	run_mount_check();
+
+	g_tIfcModel.dwCut = 1 + (uint32_t)rand() % (TEST_OPS * 30U);
+	for(i = 0; i < TEST_OPS; i++)
+	{
+		CHECK(csi_kv_flush() == CSI_OK);						//the write before is committed
+		if(s_ptSh->nPendKey >= 0)
+			s_ptSh->tVal[s_ptSh->nPendKey] = s_ptSh->tPend;
+
+		k = (uint8_t)(rand() % TEST_KEYS);
+		if(rand() % 8 == 0)
+		{
+			s_ptSh->tPend.nLen = -1;
+			s_ptSh->nPendKey = k;
+			tRet = csi_kv_delete(k);
+		}
+		else
+		{
+			kv_rand_val(&s_ptSh->tPend);
+			s_ptSh->nPendKey = k;
+			tRet = csi_kv_set(k, s_ptSh->tPend.byVal, (uint8_t)s_ptSh->tPend.nLen);
+		}
+
+		if(tRet != CSI_OK)										//full, nothing written
+		{
+			s_ptSh->nPendKey = -1;
+			s_ptSh->wFull++;
+			CHECK(kv_matches(k, &s_ptSh->tVal[k]));
+		}
+		else
+			CHECK(kv_matches(k, &s_ptSh->tPend));
+
+		model_run((uint32_t)rand() % 16U);						//main loop, the IFC goes on
+	}
+	CHECK(g_tIfcModel.wViolation == 0);
+	fflush(stdout);
+	_exit(s_wErr ? 1 : 0);
+}
+
+static void test_power_cut(void)
+{
+	uint32_t i, wFailed = 0;
+	int nStatus;
+	pid_t tPid;
+
+	s_ptSh = mmap(NULL, sizeof(shadow_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	CHECK(s_ptSh != MAP_FAILED);
+	memset(s_ptSh, 0, sizeof(shadow_t));
+	for(i = 0; i < CONFIG_KV_KEYS; i++)
+		s_ptSh->tVal[i].nLen = -1;
+	s_ptSh->nPendKey = -1;
+	memset(MODEL_DFLASH, 0xFF, DFLASHSIZE);
+
+	for(i = 0; i < TEST_RUNS; i++)
+	{
+		fflush(stdout);
+		tPid = fork();
+		if(tPid == 0)
+			run_child(i);
+		if(waitpid(tPid, &nStatus, 0) != tPid || !WIFEXITED(nStatus) || WEXITSTATUS(nStatus) != 0)
+		{
+			printf("run %u failed\n", i);
+			wFailed++;
+		}
+	}
+	CHECK(wFailed == 0);
+
+	printf("%u runs, cuts: %u idle, %u lat_clr, %u pre_pgm, %u pre-program, %u erase, %u program; "
+		"%u writes in progress found, %u full\n", TEST_RUNS, s_ptSh->wCut[0], s_ptSh->wCut[1],
+		s_ptSh->wCut[2], s_ptSh->wCut[3], s_ptSh->wCut[4], s_ptSh->wCut[5], s_ptSh->wPendFound, s_ptSh->wFull);
+	for(i = 0; i < CUT_KINDS; i++)
+		CHECK(s_ptSh->wCut[i] > 0);
+}
+
+int main(void)
+{
+	model_init();
+	test_basic();
+	test_carry_only();
+	test_power_cut();
+
+	printf("kvstore: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
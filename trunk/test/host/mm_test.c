@@ -0,0 +1,451 @@
+/***********************************************************************//**
+ * \file  mm_test.c
+ * \brief  host test of mm_realloc/mm_shrinkchunk on a heap in a static arena
+ *
+ * mm_initialize/mm_malloc/mm_free/mm_realloc run unchanged on the arena.
+ * Random malloc/realloc/free sequences are checked against a shadow list of
+ * the live blocks:
+ *  - a block keeps its content up to the smaller of the old and new size
+ *  - live blocks never overlap, their fill pattern stays intact
+ *  - the chunk chain covers the region, sizes and preceding sizes agree,
+ *    no two free chunks are neighbours, the node lists hold exactly the
+ *    free chunks
+ * Built with CONFIG_MM_DETECT_ERROR as well(mm_dbg_test): then every chunk
+ * has to carry the caller handed to mm_realloc.
+ * Built with CONFIG_MM_POOL and CONFIG_DEBUG_MM(mm_pool_test): the block
+ * pools are cut from the same heap and checked first:
+ *  - a request is served by the smallest fitting pool, then the larger ones
+ *  - every pop/push masks IE once and restores it as it was
+ *  - used/peak/fails and mm_get_poolinfo follow the allocations
+ *  - a double free or a pointer into a block aborts on the assertion
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mm.h"
+#if CONFIG_MM_POOL
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <csi_core.h>
+#include "umm_heap.h"
+#endif
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+#define TEST_ARENA		(128U * 1024U)
+#define TEST_BLOCKS		64U
+#define TEST_OPS		200000U
+
+typedef struct {
+	uint8_t		*pbyMem;
+	size_t		wSize;
+	uint8_t		bySeed;
+	void		*pCaller;
+} blk_t;
+
+size_t __heap_start, __heap_end;				//only looked at by mm_heap_initialize, mm_max_usedsize_update
+
+static uint64_t s_dwArena[TEST_ARENA / 8U];
+static blk_t s_tBlk[TEST_BLOCKS];
+static unsigned long s_wErr;
+
+#if defined(CONFIG_MM_DETECT_ERROR)
+/* the leak list of mm_leak.c scans the linker sections, not needed here */
+void mm_leak_add_chunk(struct m_dbg_hdr *chunk) {}
+void mm_leak_del_chunk(struct m_dbg_hdr *chunk) {}
+void mm_leak_dump(void) {}
+void mm_leak_search_chunk(void *mem) {}
+void mm_record_minfree(void) {}
+#endif
+
+#if CONFIG_MM_POOL
+#define POOL_NUM		4U
+#define POOL_BLKS		(8U + 8U + 4U + 2U)
+
+static const uint32_t s_wPoolSize[POOL_NUM] = {16, 32, 64, 128};
+static const uint32_t s_wPoolNum[POOL_NUM] = {8, 8, 4, 2};
+
+/* the PSR of the core, mm_pool masks IE through csi_irq_save/csi_irq_restore */
+static bool s_bIe = true;
+static uint32_t s_wIrqSave, s_wIrqRestore;
+
+uint32_t __get_PSR(void) { return s_bIe ? PSR_IE_Msk : 0; }
+void __disable_irq(void) { s_bIe = false; s_wIrqSave++; }
+void __set_PSR(uint32_t psr) { s_bIe = (psr & PSR_IE_Msk) != 0; s_wIrqRestore++; }
+#endif
+
+static void blk_fill(blk_t *ptBlk)
+{
+	size_t i;
+
+	for(i = 0; i < ptBlk->wSize; i++)
+		ptBlk->pbyMem[i] = (uint8_t)(ptBlk->bySeed + i);
+}
+
+static bool blk_intact(blk_t *ptBlk, size_t wSize)
+{
+	size_t i;
+
+	for(i = 0; i < wSize; i++)
+	{
+		if(ptBlk->pbyMem[i] != (uint8_t)(ptBlk->bySeed + i))
+			return false;
+	}
+	return true;
+}
+
+/** \brief walk the chunk chain and the node lists
+ */
+static void heap_check(struct mm_heap_s *ptHeap)
+{
+	struct mm_allocnode_s *ptNode = ptHeap->mm_heapstart[0];
+	struct mm_allocnode_s *ptNext;
+	struct mm_freenode_s *ptFree;
+	uint32_t wFree = 0, wListed = 0;
+	bool bPrevFree = false, bFree;
+	size_t wTotal = 0;
+
+	while(ptNode < ptHeap->mm_heapend[0])
+	{
+		ptNext = (struct mm_allocnode_s *)((char *)ptNode + ptNode->size);
+		CHECK(ptNode->size >= SIZEOF_MM_ALLOCNODE);
+		CHECK((ptNext->preceding & ~MM_ALLOC_BIT) == ptNode->size);
+		bFree = (ptNode->preceding & MM_ALLOC_BIT) == 0;
+		CHECK(!(bFree && bPrevFree));
+		if(bFree)
+		{
+			CHECK(ptNode->size >= SIZEOF_MM_FREENODE);
+			wFree++;
+		}
+		bPrevFree = bFree;
+		wTotal += ptNode->size;
+		ptNode = ptNext;
+		if(s_wErr > 10)
+			exit(1);
+	}
+	CHECK(ptNode == ptHeap->mm_heapend[0]);
+	CHECK(wTotal + SIZEOF_MM_ALLOCNODE == ptHeap->mm_heapsize);
+
+	for(ptFree = ptHeap->mm_nodelist[0].flink; ptFree; ptFree = ptFree->flink)
+	{
+		CHECK(ptFree->blink->flink == ptFree);
+		if(ptFree->size == 0)									//list head of the next size
+			continue;
+		CHECK((ptFree->preceding & MM_ALLOC_BIT) == 0);
+		wListed++;
+	}
+	CHECK(wListed == wFree);
+}
+
+/** \brief live blocks intact and apart from each other
+ */
+static void blk_check(void)
+{
+	uint32_t i, k;
+
+	for(i = 0; i < TEST_BLOCKS; i++)
+	{
+		if(s_tBlk[i].pbyMem == NULL)
+			continue;
+		CHECK(blk_intact(&s_tBlk[i], s_tBlk[i].wSize));
+#if defined(CONFIG_MM_DETECT_ERROR)
+		CHECK(((struct m_dbg_hdr *)s_tBlk[i].pbyMem - 1)->caller == s_tBlk[i].pCaller);
+#endif
+		for(k = i + 1; k < TEST_BLOCKS; k++)
+		{
+			if(s_tBlk[k].pbyMem == NULL)
+				continue;
+			CHECK(s_tBlk[i].pbyMem + s_tBlk[i].wSize <= s_tBlk[k].pbyMem ||
+				s_tBlk[k].pbyMem + s_tBlk[k].wSize <= s_tBlk[i].pbyMem);
+		}
+	}
+}
+
+static size_t rand_size(void)
+{
+	switch(rand() % 4)
+	{
+		case 0:		return 1 + (size_t)rand() % 16U;
+		case 1:		return 1 + (size_t)rand() % 256U;
+		case 2:		return 1 + (size_t)rand() % 2048U;
+		default:	return 1 + (size_t)rand() % 8192U;
+	}
+}
+
+static void test_random(void)
+{
+	struct mm_heap_s *ptHeap = &g_mmheap;
+	uint32_t i, wInPlace = 0, wMoved = 0, wFailed = 0;
+	blk_t *ptBlk, tOld;
+	void *pCaller;
+	size_t wSize;
+
+	for(i = 0; i < TEST_OPS; i++)
+	{
+		ptBlk = &s_tBlk[(uint32_t)rand() % TEST_BLOCKS];
+		pCaller = (void *)(uintptr_t)(0x1000U + i);
+		wSize = rand_size();
+		if(ptBlk->pbyMem && rand() % 4 == 0)				//small change, mostly in place
+		{
+			wSize = ptBlk->wSize + (size_t)(rand() % 97) - 48;
+			if((ssize_t)wSize < 1)
+				wSize = 1;
+		}
+
+		switch(rand() % 8)
+		{
+			case 0:												//free
+				mm_free(ptHeap, ptBlk->pbyMem, pCaller);
+				ptBlk->pbyMem = NULL;
+				break;
+			case 1:												//realloc to 0 frees
+				if(ptBlk->pbyMem == NULL)
+					break;
+				CHECK(mm_realloc(ptHeap, ptBlk->pbyMem, 0, pCaller) == NULL);
+				ptBlk->pbyMem = NULL;
+				break;
+			default:											//realloc, NULL is malloc
+				tOld = *ptBlk;
+				ptBlk->pbyMem = mm_realloc(ptHeap, tOld.pbyMem, wSize, pCaller);
+				if(ptBlk->pbyMem == NULL)						//full, the old block stays
+				{
+					*ptBlk = tOld;
+					wFailed++;
+					if(tOld.pbyMem)
+						CHECK(blk_intact(ptBlk, ptBlk->wSize));
+					break;
+				}
+				if(tOld.pbyMem)
+				{
+					ptBlk->wSize = tOld.wSize < wSize ? tOld.wSize : wSize;
+					CHECK(blk_intact(ptBlk, ptBlk->wSize));
+					if(ptBlk->pbyMem == tOld.pbyMem)
+						wInPlace++;
+					else
+						wMoved++;
+				}
+				ptBlk->wSize = wSize;
+				ptBlk->bySeed = (uint8_t)rand();
+				ptBlk->pCaller = pCaller;
+				blk_fill(ptBlk);
+				break;
+		}
+
+		heap_check(ptHeap);
+		if(i % 64 == 0)
+			blk_check();
+	}
+	blk_check();
+
+	for(i = 0; i < TEST_BLOCKS; i++)
+	{
+		mm_free(ptHeap, s_tBlk[i].pbyMem, NULL);
+		s_tBlk[i].pbyMem = NULL;
+	}
+	heap_check(ptHeap);
+
+	printf("%u ops, realloc %u in place, %u moved, %u full\n", TEST_OPS, wInPlace, wMoved, wFailed);
+}
+
+/** \brief the in place cases of mm_realloc: shrink, grow into the free next chunk
+ */
+static void test_in_place(void)
+{
+	struct mm_heap_s *ptHeap = &g_mmheap;
+	uint8_t *pbyA, *pbyB, *pbyC;
+	struct mallinfo tInfo;
+	int wFree;
+
+	pbyA = mm_malloc(ptHeap, 1000, NULL);
+	pbyB = mm_malloc(ptHeap, 1000, NULL);
+	pbyC = mm_malloc(ptHeap, 100, NULL);						//keeps B away from the big free chunk
+	CHECK(pbyA && pbyB && pbyC);
+	memset(pbyA, 0xA5, 1000);
+
+#if !defined(CONFIG_MM_DETECT_ERROR)
+	mm_mallinfo(ptHeap, &tInfo);
+	wFree = tInfo.fordblks;
+
+	CHECK(mm_realloc(ptHeap, pbyA, 200, NULL) == pbyA);		//the tail goes back to the heap
+	mm_mallinfo(ptHeap, &tInfo);
+	CHECK(tInfo.fordblks >= wFree + 700);
+	heap_check(ptHeap);
+
+	mm_free(ptHeap, pbyB, NULL);
+	CHECK(mm_realloc(ptHeap, pbyA, 1800, NULL) == pbyA);		//into the freed B
+	heap_check(ptHeap);
+	CHECK(mm_realloc(ptHeap, pbyA, 1000000, NULL) == NULL);	//too big, A stays
+	pbyB = NULL;
+#else
+	(void)tInfo;
+	(void)wFree;
+	CHECK((pbyB = mm_realloc(ptHeap, pbyB, 200, (void *)0x55AA)) != NULL);
+	CHECK(((struct m_dbg_hdr *)pbyB - 1)->caller == (void *)0x55AA);
+	heap_check(ptHeap);
+#endif
+	for(size_t i = 0; i < 200; i++)
+		CHECK(pbyA[i] == 0xA5);
+
+	mm_free(ptHeap, pbyA, NULL);
+	mm_free(ptHeap, pbyB, NULL);
+	mm_free(ptHeap, pbyC, NULL);
+	heap_check(ptHeap);
+}
+
+#if CONFIG_MM_POOL
+/** \brief one pool operation: IE masked once and restored, returns IE as it was
+ */
+static void pool_irq_check(uint32_t wSave, bool bIe)
+{
+	CHECK(s_wIrqSave == wSave + 1);
+	CHECK(s_wIrqRestore == wSave + 1);
+	CHECK(s_bIe == bIe);
+}
+
+/** \brief pool ndx holds the expected counters, seen directly and by mm_get_poolinfo
+ */
+static void pool_info_check(uint32_t ndx, uint32_t wUsed, uint32_t wPeak, uint32_t wFails)
+{
+	const struct mm_pool_s *ptPool = mm_pool_info((int)ndx);
+	int32_t wBlkSize, wTotal, wInUse, wMax;
+
+	CHECK(ptPool->blksize == s_wPoolSize[ndx] && ptPool->nblks == s_wPoolNum[ndx]);
+	CHECK(ptPool->used == wUsed && ptPool->peak == wPeak && ptPool->fails == wFails);
+	CHECK(mm_get_poolinfo((int32_t)ndx, &wBlkSize, &wTotal, &wInUse, &wMax) == 0);
+	CHECK(wBlkSize == (int32_t)s_wPoolSize[ndx] && wTotal == (int32_t)s_wPoolNum[ndx]);
+	CHECK(wInUse == (int32_t)wUsed && wMax == (int32_t)wPeak);
+}
+
+/** \brief the child frees pbyMem twice or frees a pointer into it, the assertion has to abort it
+ */
+static bool pool_free_aborts(uint8_t *pbyMem, bool bTwice)
+{
+	int iStatus;
+	pid_t tPid;
+
+	fflush(stdout);
+	tPid = fork();
+	if(tPid == 0)
+	{
+		freopen("/dev/null", "w", stderr);				//the assert message is expected
+		if(bTwice)
+		{
+			mm_pool_free(pbyMem);
+			mm_pool_free(pbyMem);
+		}
+		else
+			mm_pool_free(pbyMem + 4);
+		_exit(0);
+	}
+	if(tPid < 0 || waitpid(tPid, &iStatus, 0) != tPid)
+		return false;
+	return WIFSIGNALED(iStatus) && WTERMSIG(iStatus) == SIGABRT;
+}
+
+static void test_pool(void)
+{
+	uint8_t *pbyBlk[POOL_BLKS + 1], *pbyHeap;
+	uint32_t i, k, wSave;
+	int32_t wDummy;
+
+	for(i = 0; i < POOL_NUM; i++)
+		pool_info_check(i, 0, 0, 0);
+	CHECK(mm_pool_info(POOL_NUM) == NULL && mm_pool_info(-1) == NULL);
+	CHECK(mm_get_poolinfo(POOL_NUM, &wDummy, &wDummy, &wDummy, &wDummy) == -1);
+	CHECK(mm_pool_alloc(0) == NULL);
+	CHECK(mm_pool_alloc(129) == NULL);
+
+	//size 1 drains the pools smallest first, IE on
+	for(i = 0; i < POOL_BLKS; i++)
+	{
+		wSave = s_wIrqSave;
+		s_wIrqRestore = wSave;
+		pbyBlk[i] = mm_pool_alloc(1);
+		CHECK(pbyBlk[i] != NULL);
+		k = i < 8 ? 0 : i < 16 ? 1 : i < 20 ? 2 : 3;
+		CHECK(mm_pool_size(pbyBlk[i]) == s_wPoolSize[k]);
+		CHECK((pbyBlk[i] - mm_pool_info((int)k)->start) % s_wPoolSize[k] == 0);
+		//the fallback to pool k tried every smaller, empty pool once first
+		CHECK(s_wIrqSave == wSave + 1 + k && s_wIrqRestore == s_wIrqSave && s_bIe);
+		memset(pbyBlk[i], (int)i, s_wPoolSize[k]);
+	}
+	pool_info_check(0, 8, 8, 8 + 4 + 2);
+	pool_info_check(1, 8, 8, 4 + 2);
+	pool_info_check(2, 4, 4, 2);
+	pool_info_check(3, 2, 2, 0);
+
+	//all empty, IE already masked stays masked
+	s_bIe = false;
+	wSave = s_wIrqSave;
+	s_wIrqRestore = wSave;
+	pbyBlk[POOL_BLKS] = mm_pool_alloc(100);
+	CHECK(pbyBlk[POOL_BLKS] == NULL);
+	pool_irq_check(wSave, false);
+	s_bIe = true;
+	pool_info_check(3, 2, 2, 1);
+
+	for(i = 0; i < POOL_BLKS; i++)								//no block overlapped another
+	{
+		k = i < 8 ? 0 : i < 16 ? 1 : i < 20 ? 2 : 3;
+		for(wSave = 0; wSave < s_wPoolSize[k]; wSave++)
+			CHECK(pbyBlk[i][wSave] == (uint8_t)i);
+	}
+
+	//push in an odd order, masked and not
+	for(i = 0; i < POOL_BLKS; i += 2)
+	{
+		s_bIe = (i & 2) != 0;
+		wSave = s_wIrqSave;
+		s_wIrqRestore = wSave;
+		CHECK(mm_pool_free(pbyBlk[i]));
+		pool_irq_check(wSave, (i & 2) != 0);
+	}
+	s_bIe = true;
+	pool_info_check(0, 4, 8, 14);
+	pool_info_check(3, 1, 2, 1);
+
+	//a freed block is handed out again, peak holds
+	pbyBlk[0] = mm_pool_alloc(16);
+	CHECK(mm_pool_size(pbyBlk[0]) == 16);
+	pool_info_check(0, 5, 8, 14);
+	for(i = 1; i < POOL_BLKS; i += 2)
+		CHECK(mm_pool_free(pbyBlk[i]));
+	CHECK(mm_pool_free(pbyBlk[0]));
+	for(i = 0; i < POOL_NUM; i++)
+		CHECK(mm_pool_info((int)i)->used == 0);
+
+	//heap blocks are not pool blocks
+	pbyHeap = mm_malloc(&g_mmheap, 16, NULL);
+	CHECK(pbyHeap != NULL);
+	wSave = s_wIrqSave;
+	CHECK(!mm_pool_free(pbyHeap) && mm_pool_size(pbyHeap) == 0);
+	CHECK(s_wIrqSave == wSave);
+	mm_free(&g_mmheap, pbyHeap, NULL);
+
+	pbyBlk[0] = mm_pool_alloc(40);
+	CHECK(pool_free_aborts(pbyBlk[0], true));
+	CHECK(pool_free_aborts(pbyBlk[0], false));
+	CHECK(mm_pool_free(pbyBlk[0]));								//the children did not touch it
+	pool_info_check(2, 0, 4, 2);
+	heap_check(&g_mmheap);
+}
+#endif
+
+int main(void)
+{
+	srand(1);
+	mm_initialize(&g_mmheap, s_dwArena, sizeof(s_dwArena));
+#if CONFIG_MM_POOL
+	mm_pool_initialize(&g_mmheap);
+	test_pool();
+#endif
+	heap_check(&g_mmheap);
+
+	test_in_place();
+	test_random();
+
+	printf("mm: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
@@ -0,0 +1,278 @@
+/***********************************************************************//**
+ * \file  ringbuffer_test.c
+ * \brief  host stress test of the SPSC ringbuffer under simulated ISR preemption
+ *
+ * A periodic SIGALRM handler plays the interrupt: it preempts the main loop
+ * at arbitrary instructions, like the UART ISR preempts the application.
+ * Bytes carry a running sequence number, so any loss, duplicate or reorder
+ * is seen by the consumer. Both directions are run: ISR producer(RX) and
+ * ISR consumer(TX), with the byte, bulk and span APIs mixed.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <drv/ringbuf.h>
+
+#define TEST_BUF_SIZE		64			//small, so the buffer runs full and wraps often
+#define TEST_BYTES			400000UL	//well beyond the 16 bit index wrap
+
+static ringbuffer_t s_tFifo;
+static uint8_t s_byBuf[TEST_BUF_SIZE];
+
+static volatile uint8_t s_byIsrSeq;		//next byte the ISR produces / expects
+static volatile unsigned long s_wIsrCnt;	//bytes moved by the ISR
+static volatile unsigned long s_wIsrRuns;
+static volatile int s_iIsrErr;
+static volatile int s_iMode;			//0: ISR produces, 1: ISR consumes
+
+static void isr_produce(void)
+{
+	uint8_t *pbySpan;
+	uint8_t byTmp[7];
+	uint16_t hwLen, i;
+
+	switch(s_wIsrRuns % 3)
+	{
+		case 0:								//byte by byte, like the RX FIFO drain
+			while(ringbuffer_byte_in(&s_tFifo, s_byIsrSeq))
+			{
+				s_byIsrSeq++;
+				s_wIsrCnt++;
+			}
+			break;
+		case 1:								//bulk
+			for(i = 0; i < sizeof(byTmp); i++)
+				byTmp[i] = (uint8_t)(s_byIsrSeq + i);
+			hwLen = ringbuffer_in(&s_tFifo, byTmp, sizeof(byTmp));
+			s_byIsrSeq += hwLen;
+			s_wIsrCnt += hwLen;
+			break;
+		default:							//zero copy span
+			hwLen = ringbuffer_in_span(&s_tFifo, &pbySpan);
+			if(hwLen > 5)
+				hwLen = 5;
+			for(i = 0; i < hwLen; i++)
+				pbySpan[i] = (uint8_t)(s_byIsrSeq + i);
+			ringbuffer_in_commit(&s_tFifo, hwLen);
+			s_byIsrSeq += hwLen;
+			s_wIsrCnt += hwLen;
+			break;
+	}
+}
+
+static void isr_consume(void)
+{
+	uint8_t *pbySpan;
+	uint8_t byTmp[5];
+	uint16_t hwLen, i;
+
+	if(s_wIsrRuns & 1)
+	{
+		hwLen = ringbuffer_out(&s_tFifo, byTmp, sizeof(byTmp));
+		pbySpan = byTmp;
+	}
+	else
+		hwLen = ringbuffer_out_span(&s_tFifo, &pbySpan);
+
+	for(i = 0; i < hwLen; i++)
+	{
+		if(pbySpan[i] != (uint8_t)(s_byIsrSeq + i))
+			s_iIsrErr = 1;
+	}
+	if(!(s_wIsrRuns & 1))
+		ringbuffer_out_commit(&s_tFifo, hwLen);
+	s_byIsrSeq += hwLen;
+	s_wIsrCnt += hwLen;
+}
+
+static void isr(int iSig)
+{
+	(void)iSig;
+	if(s_iMode == 0)
+		isr_produce();
+	else
+		isr_consume();
+	s_wIsrRuns++;
+}
+
+static void isr_mask(int iMask)
+{
+	sigset_t tSet;
+
+	sigemptyset(&tSet);
+	sigaddset(&tSet, SIGALRM);
+	sigprocmask(iMask ? SIG_BLOCK : SIG_UNBLOCK, &tSet, NULL);
+}
+
+static void timer_set(long lUs)
+{
+	struct itimerval tIt;
+
+	tIt.it_interval.tv_sec = 0;
+	tIt.it_interval.tv_usec = lUs;
+	tIt.it_value = tIt.it_interval;
+	setitimer(ITIMER_REAL, &tIt, NULL);
+}
+
+/** \brief main loop consumes what the ISR produces(UART RX)
+ */
+static int test_isr_producer(void)
+{
+	uint8_t bySeq = 0, byTmp[11], *pbySpan;
+	unsigned long wCnt = 0, wIter = 0;
+	uint16_t hwLen, i;
+
+	isr_mask(1);								//a late interrupt of the previous test must not run in the setup
+	ringbuffer_init(&s_tFifo, s_byBuf, sizeof(s_byBuf));
+	s_byIsrSeq = 0;
+	s_wIsrCnt = 0;
+	s_wIsrRuns = 0;
+	s_iMode = 0;
+	timer_set(20);
+	isr_mask(0);
+
+	while(wCnt < TEST_BYTES)
+	{
+		switch(wIter++ % 3)
+		{
+			case 0:
+				hwLen = ringbuffer_byte_out(&s_tFifo, byTmp);
+				pbySpan = byTmp;
+				break;
+			case 1:
+				hwLen = ringbuffer_out(&s_tFifo, byTmp, sizeof(byTmp));
+				pbySpan = byTmp;
+				break;
+			default:
+				hwLen = ringbuffer_out_span(&s_tFifo, &pbySpan);
+				break;
+		}
+		for(i = 0; i < hwLen; i++, bySeq++)
+		{
+			if(pbySpan[i] != bySeq)
+			{
+				timer_set(0);
+				printf("FAIL rx: byte %lu is %u, expected %u\n", wCnt + i, pbySpan[i], bySeq);
+				return 1;
+			}
+		}
+		if(pbySpan != byTmp)
+			ringbuffer_out_commit(&s_tFifo, hwLen);
+		wCnt += hwLen;
+	}
+	isr_mask(1);
+	timer_set(0);
+	printf("rx: %lu bytes, %lu interrupts, ok\n", wCnt, s_wIsrRuns);
+	return 0;
+}
+
+/** \brief main loop produces what the ISR consumes(UART TX)
+ */
+static int test_isr_consumer(void)
+{
+	uint8_t bySeq = 0, byTmp[13], *pbySpan;
+	unsigned long wCnt = 0, wIter = 0;
+	uint16_t hwLen, i;
+
+	isr_mask(1);								//a late interrupt of the previous test must not run in the setup
+	ringbuffer_init(&s_tFifo, s_byBuf, sizeof(s_byBuf));
+	s_byIsrSeq = 0;
+	s_wIsrCnt = 0;
+	s_wIsrRuns = 0;
+	s_iIsrErr = 0;
+	s_iMode = 1;
+	timer_set(20);
+	isr_mask(0);
+
+	while(wCnt < TEST_BYTES)
+	{
+		switch(wIter++ % 3)
+		{
+			case 0:
+				hwLen = ringbuffer_byte_in(&s_tFifo, bySeq);
+				break;
+			case 1:
+				for(i = 0; i < sizeof(byTmp); i++)
+					byTmp[i] = (uint8_t)(bySeq + i);
+				hwLen = ringbuffer_in(&s_tFifo, byTmp, sizeof(byTmp));
+				break;
+			default:
+				hwLen = ringbuffer_in_span(&s_tFifo, &pbySpan);
+				for(i = 0; i < hwLen; i++)
+					pbySpan[i] = (uint8_t)(bySeq + i);
+				ringbuffer_in_commit(&s_tFifo, hwLen);
+				break;
+		}
+		bySeq += hwLen;
+		wCnt += hwLen;
+	}
+	while(s_wIsrCnt < wCnt && !s_iIsrErr);		//ISR drains the rest
+	isr_mask(1);
+	timer_set(0);
+
+	if(s_iIsrErr || s_wIsrCnt != wCnt)
+	{
+		printf("FAIL tx: ISR got %lu of %lu bytes, sequence error %d\n", s_wIsrCnt, wCnt, s_iIsrErr);
+		return 1;
+	}
+	printf("tx: %lu bytes, %lu interrupts, ok\n", wCnt, s_wIsrRuns);
+	return 0;
+}
+
+/** \brief only power of two sizes are taken, the span stops at the buffer end
+ */
+static int test_init_span(void)
+{
+	uint8_t *pbySpan;
+	uint8_t byTmp[40];
+
+	static const uint16_t hwBad[] = {0, 3, 50, 0x7FFF, 0x8001, 0xFFFF};
+	uint8_t i;
+
+	memset(&s_tFifo, 0xA5, sizeof(s_tFifo));
+	for(i = 0; i < sizeof(hwBad) / sizeof(hwBad[0]); i++)
+	{
+		if(ringbuffer_init(&s_tFifo, s_byBuf, hwBad[i]) || s_tFifo.hwSize != 0xA5A5)
+		{
+			printf("FAIL init: size %u taken\n", hwBad[i]);
+			return 1;
+		}
+	}
+	if(!ringbuffer_init(&s_tFifo, s_byBuf, 0x8000) || s_tFifo.hwMask != 0x7FFF ||
+		!ringbuffer_init(&s_tFifo, s_byBuf, 1) || s_tFifo.hwMask != 0)
+	{
+		printf("FAIL init: limits\n");
+		return 1;
+	}
+	if(!ringbuffer_init(&s_tFifo, s_byBuf, 32) || s_tFifo.hwSize != 32 || s_tFifo.hwMask != 31)
+	{
+		printf("FAIL init: size %u\n", s_tFifo.hwSize);
+		return 1;
+	}
+	if(ringbuffer_in(&s_tFifo, byTmp, sizeof(byTmp)) != 32 || ringbuffer_byte_in(&s_tFifo, 0) != 0)
+	{
+		printf("FAIL full\n");
+		return 1;
+	}
+	ringbuffer_out(&s_tFifo, NULL, 30);
+	ringbuffer_in(&s_tFifo, byTmp, 10);
+	if(ringbuffer_out_span(&s_tFifo, &pbySpan) != 2 || pbySpan != &s_byBuf[30])
+	{
+		printf("FAIL span at wrap\n");
+		return 1;
+	}
+	printf("init/span: ok\n");
+	return 0;
+}
+
+int main(void)
+{
+	signal(SIGALRM, isr);
+
+	if(test_init_span() || test_isr_producer() || test_isr_consumer())
+		return 1;
+	return 0;
+}
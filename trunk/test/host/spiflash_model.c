@@ -0,0 +1,190 @@
+/***********************************************************************//**
+ * \file  spiflash_model.c
+ * \brief  simulated 25-series SPI NOR flash behind the csi_spiflash_t hooks
+ *
+ * Behaves like the part on the bus: program only clears bits and wraps at
+ * the page end, erases are aligned down to their unit, write commands need
+ * WREN first and clear WEL, WIP stays set for a few status reads, BP2..0 all
+ * set protects the whole array. Commands that a real flash would ignore
+ * (written while busy, without WREN, bad address/dummy length) are counted
+ * in wViolation, the driver must never send them.
+ * *********************************************************************
+*/
+#include <string.h>
+#include "spiflash_model.h"
+
+#define SR_WIP		0x01
+#define SR_WEL		0x02
+#define SR_BP_MSK	0x1C
+
+spiflash_model_t g_tModel;
+
+/* JEDEC basic flash parameter table, 11 dwords at 0x30 */
+static const uint8_t s_bySfdp[] = {
+	'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xFF,		//signature, rev 1.6, 1 header
+	0x00, 0x06, 0x01, 11, 0x30, 0x00, 0x00, 0xFF,	//basic table, 11 dwords at 0x30
+	[0x30] = 0xE5, 0x20, 0xF1, 0xFF,				//DW1: 4K erase, opcode 0x20
+	0xFF, 0xFF, 0x7F, 0x00,							//DW2: 8M bits - 1
+	0x44, 0xEB, 0x08, 0x6B,							//DW3
+	0x08, 0x3B, 0x42, 0xBB,							//DW4
+	0xEE, 0xFF, 0xFF, 0xFF,							//DW5
+	0xFF, 0xFF, 0x00, 0x00,							//DW6
+	0xFF, 0xFF, 0x00, 0xFF,							//DW7
+	0x0C, 0x20, 0x0F, 0x52,							//DW8: 4K 0x20, 32K 0x52
+	0x10, 0xD8, 0x00, 0xFF,							//DW9: 64K 0xD8
+	0x00, 0x00, 0x00, 0x00,							//DW10
+	0x81, 0x00, 0x00, 0x00,							//DW11: page 2^8
+};
+
+void model_reset(bool bNoSfdp)
+{
+	memset(&g_tModel, 0, sizeof(g_tModel));
+	memset(g_tModel.byMem, 0xFF, sizeof(g_tModel.byMem));
+	g_tModel.bNoSfdp = bNoSfdp;
+}
+
+static bool model_busy(void)
+{
+	return g_tModel.bStuck || g_tModel.wBusy;
+}
+
+/** \brief write command accepted: WEL was set and the part is idle
+ */
+static bool model_write_ok(void)
+{
+	bool bOk = !model_busy() && (g_tModel.bySr & SR_WEL);
+
+	if(!bOk)
+		g_tModel.wViolation++;
+	g_tModel.bySr &= ~SR_WEL;
+	return bOk;
+}
+
+static void model_erase(uint32_t wAddr, uint32_t wSize, uint8_t byIdx)
+{
+	wAddr &= ~(wSize - 1) & (MODEL_FLASH_SIZE - 1);
+	if((g_tModel.bySr & SR_BP_MSK) != SR_BP_MSK)
+		memset(&g_tModel.byMem[wAddr], 0xFF, wSize);
+	g_tModel.wErase[byIdx]++;
+	g_tModel.wBusy = 5U;
+}
+
+int32_t model_spi_send(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, const void *pData, uint32_t wSize)
+{
+	const uint8_t *pbyData = (const uint8_t *)pData;
+	uint32_t i, wPage;
+
+	switch(byCmd)
+	{
+		case 0x06:													//WREN
+			if(model_busy())
+				g_tModel.wViolation++;
+			else
+				g_tModel.bySr |= SR_WEL;
+			break;
+		case 0xAB:													//RES
+			break;
+		case 0x01:													//WRSR
+			if(model_write_ok() && wSize)
+			{
+				g_tModel.bySr = (g_tModel.bySr & ~SR_BP_MSK) | (pbyData[0] & SR_BP_MSK);
+				g_tModel.wBusy = 2U;
+			}
+			break;
+		case 0x02:													//PP
+			if(wAddrSize != 3U)
+				g_tModel.wViolation++;
+			if(!model_write_ok())
+				break;
+			if(wSize > MODEL_PAGE_SIZE)								//only the last page worth is latched
+			{
+				pbyData += wSize - MODEL_PAGE_SIZE;
+				wAddr += wSize - MODEL_PAGE_SIZE;
+				wSize = MODEL_PAGE_SIZE;
+			}
+			wAddr &= MODEL_FLASH_SIZE - 1;
+			wPage = wAddr & ~(MODEL_PAGE_SIZE - 1);
+			if((g_tModel.bySr & SR_BP_MSK) != SR_BP_MSK)
+			{
+				for(i = 0; i < wSize; i++)							//wraps at the page end
+					g_tModel.byMem[wPage | ((wAddr + i) & (MODEL_PAGE_SIZE - 1))] &= pbyData[i];
+			}
+			g_tModel.wProgram++;
+			g_tModel.wBusy = 2U;
+			break;
+		case 0x20:
+			if(wAddrSize != 3U)
+				g_tModel.wViolation++;
+			if(model_write_ok())
+				model_erase(wAddr, 1UL << 12, 0);
+			break;
+		case 0x52:
+			if(wAddrSize != 3U)
+				g_tModel.wViolation++;
+			if(model_write_ok())
+				model_erase(wAddr, 1UL << 15, 1);
+			break;
+		case 0xD8:
+			if(wAddrSize != 3U)
+				g_tModel.wViolation++;
+			if(model_write_ok())
+				model_erase(wAddr, 1UL << 16, 2);
+			break;
+		case 0xC7:
+			if(model_write_ok())
+			{
+				model_erase(0, MODEL_FLASH_SIZE, 3);
+				g_tModel.wBusy = 20U;
+			}
+			break;
+		default:
+			g_tModel.wViolation++;
+			break;
+	}
+	return (int32_t)wSize;
+}
+
+int32_t model_spi_receive(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, void *pData, uint32_t wSize)
+{
+	uint8_t *pbyData = (uint8_t *)pData;
+	uint32_t i;
+
+	if(byCmd == 0x05)												//RDSR, the only command while busy
+	{
+		for(i = 0; i < wSize; i++)
+			pbyData[i] = g_tModel.bySr | (model_busy() ? SR_WIP : 0);
+		if(g_tModel.wBusy)
+			g_tModel.wBusy--;
+		return (int32_t)wSize;
+	}
+	if(model_busy())
+		g_tModel.wViolation++;
+
+	switch(byCmd)
+	{
+		case 0x9F:													//RDID: winbond, W25Q80
+			for(i = 0; i < wSize; i++)
+				pbyData[i] = (i < 3) ? ((const uint8_t[]){0xEF, 0x40, 0x14})[i] : 0xFF;
+			break;
+		case 0x5A:													//SFDP: 3 address bytes + dummy
+			if(wAddrSize != 4U)
+				g_tModel.wViolation++;
+			for(i = 0; i < wSize; i++)
+			{
+				uint32_t wIdx = (wAddr >> 8) + i;
+				pbyData[i] = (!g_tModel.bNoSfdp && wIdx < sizeof(s_bySfdp)) ? s_bySfdp[wIdx] : 0xFF;
+			}
+			break;
+		case 0x0B:													//fast read: 3 address bytes + dummy
+			if(wAddrSize != 4U)
+				g_tModel.wViolation++;
+			for(i = 0; i < wSize; i++)
+				pbyData[i] = g_tModel.byMem[((wAddr >> 8) + i) & (MODEL_FLASH_SIZE - 1)];
+			break;
+		default:
+			g_tModel.wViolation++;
+			memset(pbyData, 0xFF, wSize);
+			break;
+	}
+	return (int32_t)wSize;
+}
@@ -0,0 +1,35 @@
+/***********************************************************************//**
+ * \file  spiflash_model.h
+ * \brief  simulated 25-series SPI NOR flash behind the csi_spiflash_t hooks
+ * *********************************************************************
+*/
+#ifndef _SPIFLASH_MODEL_H_
+#define _SPIFLASH_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MODEL_FLASH_SIZE	(1UL << 20)		//W25Q80 like, 1MB
+#define MODEL_PAGE_SIZE		256U
+
+typedef struct {
+	uint8_t		byMem[MODEL_FLASH_SIZE];
+	uint8_t		bySr;						//BP bits, WEL
+	uint32_t	wBusy;						//status reads left with WIP set
+	bool		bStuck;						//WIP never clears
+	bool		bNoSfdp;					//old part, SFDP reads 0xFF
+	uint32_t	wErase[4];					//erases done: 4K, 32K, 64K, chip
+	uint32_t	wProgram;					//page programs done
+	uint32_t	wViolation;					//commands a real part would ignore or misread
+} spiflash_model_t;
+
+extern spiflash_model_t g_tModel;
+
+/** \brief erase the array, clear status and counters
+ */
+void model_reset(bool bNoSfdp);
+
+int32_t model_spi_send(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, const void *pData, uint32_t wSize);
+int32_t model_spi_receive(void *pSpi, uint8_t byCmd, uint32_t wAddr, uint32_t wAddrSize, void *pData, uint32_t wSize);
+
+#endif
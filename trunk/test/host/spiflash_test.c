@@ -0,0 +1,250 @@
+/***********************************************************************//**
+ * \file  spiflash_test.c
+ * \brief  host test of chip/drivers/spiflash.c on the simulated NOR flash
+ *
+ * The driver is built unchanged, spi_send/spi_receive are set to the flash
+ * model before csi_spiflash_spi_init. Every access is checked against a
+ * shadow copy of the array, and the model counts the commands a real part
+ * would reject.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <drv/spiflash.h>
+#include "spiflash_model.h"
+
+#define CHECK(cond)		do{ if(!(cond)){ printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); s_wErr++; } }while(0)
+
+csp_spi_t *SPI0;								//never touched, the model replaces the spi hooks
+
+static unsigned long s_wErr;
+static uint32_t s_wMs;
+static uint8_t s_byShadow[MODEL_FLASH_SIZE];
+static uint8_t s_byBuf[MODEL_FLASH_SIZE];
+
+/* what spiflash.c needs from the rest of the sdk ----------------------*/
+uint32_t csi_tick_get_ms(void) { return s_wMs++; }	//every status poll takes a ms
+void udelay(uint32_t us) {}
+csi_error_t csi_spi_init(csp_spi_t *ptSpiBase, csi_spi_config_t *ptSpiCfg) { return CSI_OK; }
+void csi_spi_nss_high(pin_name_e ePinName) {}
+void csi_spi_nss_low(pin_name_e ePinName) {}
+void csi_spi_clr_rxfifo(csp_spi_t *ptSpiBase) {}
+
+csi_error_t csi_spi_get_state(csi_state_t *ptState)
+{
+	ptState->readable = 1;
+	ptState->writeable = 1;
+	return CSI_OK;
+}
+
+/* the async erase timer is run by the test itself */
+void csi_swtimer_init(csi_swtimer_t *ptTimer, csi_swtimer_cb_t callback, void *pArg, csi_swtimer_ctx_e eCtx)
+{
+	ptTimer->callback = callback;
+	ptTimer->pArg = pArg;
+	ptTimer->wPeriod = 0;
+}
+
+csi_error_t csi_swtimer_start(csi_swtimer_t *ptTimer, uint32_t wTimeMs, uint32_t wPeriodMs)
+{
+	ptTimer->wPeriod = wPeriodMs;
+	return CSI_OK;
+}
+
+void csi_swtimer_stop(csi_swtimer_t *ptTimer)
+{
+	ptTimer->wPeriod = 0;
+}
+
+static void cs_callback(csi_gpio_pin_state_e eLevel) {}
+
+static void flash_init(csi_spiflash_t *ptFlash, bool bNoSfdp)
+{
+	memset(ptFlash, 0, sizeof(csi_spiflash_t));
+	model_reset(bNoSfdp);
+	memset(s_byShadow, 0xFF, sizeof(s_byShadow));
+	ptFlash->spi_send = model_spi_send;
+	ptFlash->spi_receive = model_spi_receive;
+	CHECK(csi_spiflash_spi_init(ptFlash, 0, (void *)cs_callback) == CSI_OK);
+}
+
+static void shadow_check(csi_spiflash_t *ptFlash)
+{
+	CHECK(csi_spiflash_read(ptFlash, 0, s_byBuf, MODEL_FLASH_SIZE) == (int32_t)MODEL_FLASH_SIZE);
+	CHECK(memcmp(s_byBuf, s_byShadow, MODEL_FLASH_SIZE) == 0);
+	CHECK(memcmp(g_tModel.byMem, s_byShadow, MODEL_FLASH_SIZE) == 0);
+}
+
+static void test_probe(void)
+{
+	csi_spiflash_t tFlash;
+	csi_spiflash_info_t tInfo;
+
+	flash_init(&tFlash, false);								//SFDP
+	csi_spiflash_get_flash_info(&tFlash, &tInfo);
+	CHECK(tInfo.flash_id == FLASH_ID_BUILD(0xEF, 0x4014));
+	CHECK(tInfo.flash_size == MODEL_FLASH_SIZE);
+	CHECK(tInfo.page_size == MODEL_PAGE_SIZE);
+	CHECK(tInfo.sector_size == 4096);
+	CHECK(tFlash.erase_cmd[0] == 0xD8 && tFlash.erase_shift[0] == 16);
+	CHECK(tFlash.erase_cmd[1] == 0x52 && tFlash.erase_shift[1] == 15);
+	CHECK(tFlash.erase_cmd[2] == 0x20 && tFlash.erase_shift[2] == 12);
+	CHECK(tFlash.erase_cmd[3] == 0);
+
+	flash_init(&tFlash, true);								//capacity byte fallback
+	csi_spiflash_get_flash_info(&tFlash, &tInfo);
+	CHECK(tInfo.flash_size == MODEL_FLASH_SIZE);
+	CHECK(tInfo.sector_size == 4096);
+	CHECK(tFlash.erase_cmd[0] == 0xD8 && tFlash.erase_cmd[1] == 0x52 && tFlash.erase_cmd[2] == 0x20);
+	CHECK(g_tModel.wViolation == 0);
+}
+
+static void test_program(void)
+{
+	csi_spiflash_t tFlash;
+	uint32_t i, wOff, wLen, wPages;
+	uint8_t byData[1000];
+
+	flash_init(&tFlash, false);
+	for(i = 0; i < 2000; i++)
+	{
+		wOff = (uint32_t)rand() % MODEL_FLASH_SIZE;
+		wLen = 1 + (uint32_t)rand() % sizeof(byData);
+		if(wLen > MODEL_FLASH_SIZE - wOff)
+			wLen = MODEL_FLASH_SIZE - wOff;
+		for(wPages = 0; wPages < wLen; wPages++)
+			byData[wPages] = (uint8_t)rand();
+
+		wPages = ((wOff + wLen - 1) >> 8) - (wOff >> 8) + 1;	//pages touched
+		g_tModel.wProgram = 0;
+		CHECK(csi_spiflash_program(&tFlash, wOff, byData, wLen) == (int32_t)wLen);
+		CHECK(g_tModel.wProgram == wPages);
+		for(wPages = 0; wPages < wLen; wPages++)
+			s_byShadow[wOff + wPages] &= byData[wPages];
+	}
+	shadow_check(&tFlash);
+
+	//random reads, any offset and length
+	for(i = 0; i < 200; i++)
+	{
+		wOff = (uint32_t)rand() % MODEL_FLASH_SIZE;
+		wLen = 1 + (uint32_t)rand() % (MODEL_FLASH_SIZE - wOff);
+		CHECK(csi_spiflash_read(&tFlash, wOff, s_byBuf, wLen) == (int32_t)wLen);
+		CHECK(memcmp(s_byBuf, &s_byShadow[wOff], wLen) == 0);
+	}
+
+	CHECK(csi_spiflash_program(&tFlash, MODEL_FLASH_SIZE - 2, byData, 3) == CSI_ERROR);
+	CHECK(csi_spiflash_read(&tFlash, MODEL_FLASH_SIZE, s_byBuf, 1) == CSI_ERROR);
+	CHECK(g_tModel.wViolation == 0);
+}
+
+static void erase_done(csi_spiflash_t *ptFlash, csi_error_t eResult, void *pArg)
+{
+	CHECK(eResult == CSI_OK);
+	*(volatile bool *)pArg = true;
+}
+
+/** \brief erase a range and check the erase types used: largest aligned unit first
+ */
+static void erase_range(csi_spiflash_t *ptFlash, uint32_t wOff, uint32_t wLen, bool bAsync)
+{
+	uint32_t wWant[4] = {0, 0, 0, 0};
+	uint32_t wAddr = wOff, wEnd = wOff + wLen;
+	volatile bool bDone = false;
+
+	if(wOff == 0 && wLen == MODEL_FLASH_SIZE)
+		wWant[3] = 1;
+	else while(wAddr < wEnd)
+	{
+		if((wAddr & 0xFFFF) == 0 && wEnd - wAddr >= 0x10000)		{ wWant[2]++; wAddr += 0x10000; }
+		else if((wAddr & 0x7FFF) == 0 && wEnd - wAddr >= 0x8000)	{ wWant[1]++; wAddr += 0x8000; }
+		else														{ wWant[0]++; wAddr += 0x1000; }
+	}
+
+	memset(g_tModel.wErase, 0, sizeof(g_tModel.wErase));
+	if(bAsync)
+	{
+		CHECK(csi_spiflash_erase_async(ptFlash, wOff, wLen, erase_done, (void *)&bDone) == CSI_OK);
+		CHECK(csi_spiflash_is_busy(ptFlash));
+		CHECK(csi_spiflash_read(ptFlash, 0, s_byBuf, 1) == CSI_BUSY);
+		while(ptFlash->poll_timer.wPeriod)							//csi_swtimer_process
+			ptFlash->poll_timer.callback(ptFlash->poll_timer.pArg);
+		CHECK(bDone && !csi_spiflash_is_busy(ptFlash));
+	}
+	else
+		CHECK(csi_spiflash_erase(ptFlash, wOff, wLen) == CSI_OK);
+
+	CHECK(memcmp(g_tModel.wErase, wWant, sizeof(wWant)) == 0);
+	memset(&s_byShadow[wOff], 0xFF, wLen);
+}
+
+static void test_erase(void)
+{
+	csi_spiflash_t tFlash;
+	uint32_t i, wOff, wLen;
+
+	flash_init(&tFlash, false);
+	memset(s_byShadow, 0x00, sizeof(s_byShadow));
+	memset(g_tModel.byMem, 0x00, sizeof(g_tModel.byMem));
+
+	for(i = 0; i < 300; i++)
+	{
+		wOff = ((uint32_t)rand() % 256U) << 12;
+		wLen = (1 + (uint32_t)rand() % 64U) << 12;
+		if(wLen > MODEL_FLASH_SIZE - wOff)
+			wLen = MODEL_FLASH_SIZE - wOff;
+		erase_range(&tFlash, wOff, wLen, i & 1);
+		if(i % 10 == 0)
+		{
+			memset(s_byShadow, 0x00, sizeof(s_byShadow));			//dirty again
+			memset(g_tModel.byMem, 0x00, sizeof(g_tModel.byMem));
+		}
+	}
+	shadow_check(&tFlash);
+
+	erase_range(&tFlash, 0, MODEL_FLASH_SIZE, false);				//chip erase
+	erase_range(&tFlash, 0, MODEL_FLASH_SIZE, true);
+	shadow_check(&tFlash);
+
+	CHECK(csi_spiflash_erase(&tFlash, 0x800, 0x1000) == CSI_ERROR);	//not sector aligned
+	CHECK(csi_spiflash_erase(&tFlash, 0x1000, 0x800) == CSI_ERROR);
+	CHECK(csi_spiflash_erase(&tFlash, MODEL_FLASH_SIZE - 0x1000, 0x2000) == CSI_ERROR);
+	CHECK(g_tModel.wViolation == 0);
+}
+
+static void test_lock_timeout(void)
+{
+	csi_spiflash_t tFlash;
+	uint8_t byData[16];
+
+	flash_init(&tFlash, false);
+	memset(byData, 0x5A, sizeof(byData));
+
+	CHECK(csi_spiflash_is_locked(&tFlash, 0, MODEL_FLASH_SIZE) == 0);
+	CHECK(csi_spiflash_lock(&tFlash, 0, MODEL_FLASH_SIZE) == CSI_OK);
+	CHECK(csi_spiflash_is_locked(&tFlash, 0, MODEL_FLASH_SIZE) == 1);
+	CHECK(csi_spiflash_lock(&tFlash, 0, 0x1000) == CSI_UNSUPPORTED);
+	csi_spiflash_program(&tFlash, 0x100, byData, sizeof(byData));	//the part ignores it
+	CHECK(csi_spiflash_unlock(&tFlash, 0, MODEL_FLASH_SIZE) == CSI_OK);
+	CHECK(csi_spiflash_is_locked(&tFlash, 0, MODEL_FLASH_SIZE) == 0);
+	shadow_check(&tFlash);
+	CHECK(g_tModel.wViolation == 0);
+
+	g_tModel.bStuck = true;											//WIP never clears
+	CHECK(csi_spiflash_program(&tFlash, 0x100, byData, sizeof(byData)) == CSI_TIMEOUT);
+	CHECK(csi_spiflash_erase(&tFlash, 0, 0x1000) == CSI_TIMEOUT);
+	g_tModel.bStuck = false;
+}
+
+int main(void)
+{
+	srand(1);
+	test_probe();
+	test_program();
+	test_erase();
+	test_lock_timeout();
+
+	printf("spiflash: %lu errors\n", s_wErr);
+	return s_wErr ? 1 : 0;
+}
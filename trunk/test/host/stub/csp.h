@@ -0,0 +1,11 @@
+/* host stand-in for chip/include/csp.h: the IFC registers only, simulated by ifc_model.c */
+#ifndef _HOST_CSP_H_
+#define _HOST_CSP_H_
+
+#include <drv/common.h>
+#include <csp_ifc.h>
+
+extern uint32_t g_wIfcReg[16];
+#define IFC					((csp_ifc_t *)g_wIfcReg)
+
+#endif
@@ -0,0 +1,16 @@
+/* host stand-in around chip/include/csp_ifc.h: ICR clears the RISR bits at once,
+   as on the chip, the registers are plain memory here(ifc_model.c) */
+#ifndef _HOST_CSP_IFC_H_
+#define _HOST_CSP_IFC_H_
+
+#define csp_ifc_clr_int		csp_ifc_clr_int_chip
+#include_next <csp_ifc.h>
+#undef csp_ifc_clr_int
+
+static inline void csp_ifc_clr_int(csp_ifc_t *ptIfcBase, ifc_int_e eInt)
+{
+	ptIfcBase->ICR = eInt;
+	*(volatile uint32_t *)&ptIfcBase->RISR &= ~(uint32_t)eInt;
+}
+
+#endif
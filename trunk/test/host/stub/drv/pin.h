@@ -0,0 +1 @@
+/* host stand-in, tick.c needs nothing from the pin driver */
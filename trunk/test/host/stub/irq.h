@@ -0,0 +1,2 @@
+/* host stand-in for csi/include/drv/irq.h, the interrupts are simulated by the tests */
+#include <soc.h>
@@ -0,0 +1,34 @@
+/* host stand-in for csi/include/core/csi_gcc.h, for the tests built on the
+   real chip headers: the PSR access is a function of the test, the other
+   intrinsics are only declared */
+#ifndef _CSI_GCC_H_
+#define _CSI_GCC_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define __ASM                   __asm
+#define __INLINE                inline
+#define __ALWAYS_STATIC_INLINE  static inline
+#define __STATIC_INLINE         static inline
+
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_PSR(void);
+void __set_PSR(uint32_t psr);
+
+void __NOP(void);
+void __DSB(void);
+uint32_t __get_VBR(void);
+uint32_t __get_CCR(void);
+void __set_CCR(uint32_t ccr);
+uint32_t __get_CAPR(void);
+void __set_CAPR(uint32_t capr);
+uint32_t __get_CHR(void);
+void __set_CHR(uint32_t chr);
+uint32_t __get_PACR(void);
+void __set_PACR(uint32_t pacr);
+uint32_t __get_PRSR(void);
+void __set_PRSR(uint32_t prsr);
+
+#endif
@@ -0,0 +1,17 @@
+/* host stand-in around chip/include/csp_ept.h: ICR clears the RISR/MISR bits
+   at once, as on the chip, the registers are plain memory here */
+#ifndef _HOST_CSP_EPT_H_
+#define _HOST_CSP_EPT_H_
+
+#define csp_ept_clr_int		csp_ept_clr_int_chip
+#include_next <csp_ept.h>
+#undef csp_ept_clr_int
+
+static inline void csp_ept_clr_int(csp_ept_t *ptEptBase, csp_ept_int_e eInt)
+{
+	ptEptBase->ICR = eInt;
+	*(volatile uint32_t *)&ptEptBase->RISR &= ~(uint32_t)eInt;
+	*(volatile uint32_t *)&ptEptBase->MISR &= ~(uint32_t)eInt;
+}
+
+#endif
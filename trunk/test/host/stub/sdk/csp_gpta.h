@@ -0,0 +1,17 @@
+/* host stand-in around chip/include/csp_gpta.h: ICR clears the RISR/MISR bits
+   at once, as on the chip, the registers are plain memory here */
+#ifndef _HOST_CSP_GPTA_H_
+#define _HOST_CSP_GPTA_H_
+
+#define csp_gpta_clr_int		csp_gpta_clr_int_chip
+#include_next <csp_gpta.h>
+#undef csp_gpta_clr_int
+
+static inline void csp_gpta_clr_int(csp_gpta_t *ptGptaBase, csp_gpta_int_e eInt)
+{
+	ptGptaBase->ICR = eInt;
+	*(volatile uint32_t *)&ptGptaBase->RISR &= ~(uint32_t)eInt;
+	*(volatile uint32_t *)&ptGptaBase->MISR &= ~(uint32_t)eInt;
+}
+
+#endif
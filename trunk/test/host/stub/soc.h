@@ -0,0 +1,58 @@
+/* host stand-in for chip/drivers/sys/soc.h: simulated CORET and VIC, see tick_pm_test.c;
+   IFC, DFLASH and the PSR interrupt enable, see ifc_model.c */
+#ifndef _HOST_SOC_H_
+#define _HOST_SOC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;
+} host_coret_t;
+
+typedef enum {
+	CORET_IRQn = 1,
+	IFC_IRQn = 2,
+} IRQn_Type;
+
+#define PFLASHBASE			0x00000000
+#define PFLASHSIZE			0x00010000
+#define PFLASHLIMIT			(PFLASHBASE + PFLASHSIZE)
+#define DFLASHBASE			0x10000000					//mapped by ifc_model.c
+#define DFLASHSIZE			0x00000800
+#define DFLASHLIMIT			(DFLASHBASE + DFLASHSIZE)
+
+typedef enum {
+	SWD_GRP0 = 0,
+	SWD_GRP1,
+	SWD_GRP2
+} swd_grp_e;
+
+#define __IM				volatile const				//register access qualifiers of csi_core.h
+#define __OM				volatile
+#define __IOM				volatile
+
+#define PSR_IE_Msk			(1UL << 6)
+#define NVIC_EnableIRQ		csi_vic_enable_irq
+#define NVIC_SetPendingIRQ	csi_vic_set_pending_irq
+
+extern host_coret_t g_tCoret;
+#define CORET				(&g_tCoret)
+
+uint32_t csi_irq_save(void);
+void csi_irq_restore(uint32_t wIrqFlag);
+void csi_vic_set_prio(int32_t IRQn, uint32_t priority);
+void csi_vic_enable_irq(int32_t IRQn);
+void csi_vic_disable_irq(int32_t IRQn);
+uint32_t csi_vic_get_pending_irq(int32_t IRQn);
+void csi_vic_clear_pending_irq(int32_t IRQn);
+void csi_vic_set_pending_irq(int32_t IRQn);
+uint32_t __get_PSR(void);
+uint32_t csi_coret_config(uint32_t ticks, int32_t IRQn);
+uint32_t csi_coret_get_load(void);
+uint32_t csi_coret_get_value(void);
+uint32_t soc_get_coret_freq(void);
+
+#endif
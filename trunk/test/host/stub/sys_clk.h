@@ -0,0 +1,2 @@
+/* host stand-in, everything lives in soc.h */
+#include <soc.h>
@@ -0,0 +1,295 @@
+/***********************************************************************//**
+ * \file  tick_pm_test.c
+ * \brief  host simulation of the system tick across tickless sleep
+ *
+ * tick.c runs unchanged on a simulated CORET(24 bit down counter, pending
+ * bit on the 1 -> 0 step, LOAD taken over at the reload). Register reads
+ * cost cycles, and the tick interrupt is taken whenever it is pending and
+ * not masked, also between two reads inside the timebase functions.
+ *
+ * The sleep sequence is the one of apt_tickless_sleep in pm.c: suspend with
+ * interrupts masked, sleep for the programmed time or less(early wakeup),
+ * report the slept time at LPT resolution, resume, unmask. Checked after
+ * every step:
+ *  - csi_tick_get_ms/us/cycles never go backwards
+ *  - csi_tick_get_cycles equals the simulated time, less the cycles spent
+ *    with CORET stopped and plus the sleep the LPT reported,
+ *    csi_tick_get_us/ms follow from it
+ *
+ * csi_tick_deadline_* is checked last, polled with interrupts masked
+ * over many tick periods, i.e. without any help of the tick interrupt.
+ * *********************************************************************
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <soc.h>
+#include <drv/tick.h>
+#include <drv/hwdiv.h>
+
+#define TEST_FREQ			48000000U
+#define TEST_CYC_PER_US		(TEST_FREQ / 1000000U)
+#define TEST_SLEEPS			20000U
+#define TEST_ROUND_UP		64U			//TICK_RESUME_MIN_CYC of tick.c
+
+host_coret_t g_tCoret;
+
+static uint64_t s_dwNow;				//simulated time, cycles
+static uint64_t s_dwStopped;			//cycles CORET did not count
+static bool s_bFirstReload;
+static bool s_bPending;
+static bool s_bIrqEn;
+static bool s_bMasked;
+static bool s_bInIsr;
+static uint32_t s_wIsrRuns;
+
+void tick_irq_handler(void *arg);
+
+/* simulated hardware ------------------------------------------------*/
+static void sim_count(uint32_t wCyc)
+{
+	s_dwNow += wCyc;
+	while((g_tCoret.CTRL & 1U) && wCyc)
+	{
+		if(g_tCoret.VAL == 0U)					//reload
+		{
+			g_tCoret.VAL = g_tCoret.LOAD;
+			wCyc--;
+			if(s_bFirstReload)					//VAL write to first reload is outside any period
+			{
+				s_bFirstReload = false;
+				s_dwStopped++;
+			}
+		}
+		else
+		{
+			uint32_t wStep = wCyc < g_tCoret.VAL ? wCyc : g_tCoret.VAL;
+			g_tCoret.VAL -= wStep;
+			wCyc -= wStep;
+			if(g_tCoret.VAL == 0U)
+				s_bPending = true;
+		}
+	}
+	s_dwStopped += wCyc;
+}
+
+static void sim_irq_take(void)
+{
+	if(s_bPending && s_bIrqEn && !s_bMasked && !s_bInIsr)
+	{
+		s_bPending = false;
+		sim_count(4U);							//entry latency
+		s_bInIsr = true;
+		tick_irq_handler(NULL);
+		s_bInIsr = false;
+		s_wIsrRuns++;
+	}
+}
+
+static void sim_run(uint32_t wCyc)
+{
+	sim_count(wCyc);
+	sim_irq_take();
+}
+
+uint32_t csi_irq_save(void)
+{
+	uint32_t wFlag = s_bMasked;
+	s_bMasked = true;
+	return wFlag;
+}
+
+void csi_irq_restore(uint32_t wIrqFlag)
+{
+	s_bMasked = wIrqFlag;
+	sim_irq_take();
+}
+
+void csi_vic_set_prio(int32_t IRQn, uint32_t priority) {}
+void csi_vic_enable_irq(int32_t IRQn) { s_bIrqEn = true; }
+void csi_vic_disable_irq(int32_t IRQn) { s_bIrqEn = false; }
+void csi_vic_clear_pending_irq(int32_t IRQn) { s_bPending = false; }
+
+uint32_t csi_vic_get_pending_irq(int32_t IRQn)
+{
+	uint32_t wPending = s_bPending;
+	sim_run(1U);
+	return wPending;
+}
+
+uint32_t csi_coret_config(uint32_t ticks, int32_t IRQn)
+{
+	g_tCoret.LOAD = ticks - 1U;
+	g_tCoret.VAL = 0U;
+	g_tCoret.CTRL = 7U;
+	s_bFirstReload = true;
+	sim_run(1U);
+	return 0U;
+}
+
+uint32_t csi_coret_get_load(void)
+{
+	return g_tCoret.LOAD;
+}
+
+uint32_t csi_coret_get_value(void)
+{
+	uint32_t wVal = g_tCoret.VAL;
+	sim_run(1U + (uint32_t)rand() % 3U);
+	return wVal;
+}
+
+uint32_t soc_get_coret_freq(void)
+{
+	return TEST_FREQ;
+}
+
+/* the divider is hardware too, the reciprocal is the plain 64 bit one */
+hwdiv_urslt_t csi_hwdiv_unsigned_calc(uint32_t wDiviend, uint32_t wDivisor)
+{
+	hwdiv_urslt_t tRslt = {wDiviend / wDivisor, wDiviend % wDivisor};
+	return tRslt;
+}
+
+void csi_udiv_init(csi_udiv_t *ptDiv, uint32_t wDivisor)
+{
+	uint8_t byLog2 = 31 - __builtin_clz(wDivisor);
+
+	ptDiv->wMul = 0U;
+	ptDiv->byAdd = 0U;
+	ptDiv->byShift = byLog2;
+	if(CSI_DIV_IS_POW2(wDivisor))
+		return;
+	//round-up reciprocal with the add/shift fixup: l = log2 + 1, shift = l - 1
+	ptDiv->wMul = (uint32_t)((((uint64_t)1U << 32) * ((2ULL << byLog2) - wDivisor)) / wDivisor + 1U);
+	ptDiv->byAdd = 1U;
+}
+
+void csi_swtimer_tick(void) {}
+uint32_t csi_swtimer_idle_ticks(void) { return 0xFFFFFFFFU; }
+
+/* checks -------------------------------------------------------------*/
+static uint64_t s_dwSlept;				//cycles reported by the LPT
+static uint64_t s_dwLastCyc, s_dwLastUs;
+static uint32_t s_wLastMs;
+static unsigned long s_wErr;
+
+static uint64_t check(const char *pStep, uint32_t wAhead)
+{
+	uint64_t dwNow, dwCyc, dwUs, dwTrue;
+	uint32_t wMs;
+
+	dwNow = s_dwNow;
+	dwCyc = csi_tick_get_cycles();
+	dwUs = csi_tick_get_us();
+	wMs = csi_tick_get_ms();
+	dwTrue = dwNow - s_dwStopped + s_dwSlept;
+
+	if(dwCyc < s_dwLastCyc || dwUs < s_dwLastUs || (int32_t)(wMs - s_wLastMs) < 0)
+	{
+		if(s_wErr++ < 10)
+			printf("%s: backwards, cyc %llu -> %llu, us %llu -> %llu, ms %u -> %u\n", pStep,
+				(unsigned long long)s_dwLastCyc, (unsigned long long)dwCyc,
+				(unsigned long long)s_dwLastUs, (unsigned long long)dwUs, s_wLastMs, wMs);
+	}
+	//the read itself takes a few cycles, a resume may round up a too short first period
+	if(dwCyc < dwTrue || dwCyc > dwTrue + 8U + wAhead)
+	{
+		if(s_wErr++ < 10)
+			printf("%s: cycles %llu, simulated %llu\n", pStep,
+				(unsigned long long)dwCyc, (unsigned long long)dwTrue);
+	}
+	if(dwUs + 1U < dwCyc / TEST_CYC_PER_US || dwUs > dwCyc / TEST_CYC_PER_US + 1U)
+	{
+		if(s_wErr++ < 10)
+			printf("%s: us %llu for %llu cycles\n", pStep,
+				(unsigned long long)dwUs, (unsigned long long)dwCyc);
+	}
+	s_dwLastCyc = dwCyc;
+	s_dwLastUs = dwUs;
+	s_wLastMs = wMs;
+	return dwCyc - dwTrue;
+}
+
+/** \brief apt_tickless_sleep of pm.c with the LPT and the core simulated
+ */
+static void sleep_tickless(uint32_t wIdleMs, uint32_t wLptUs)
+{
+	uint32_t wIrqFlag = csi_irq_save();
+	uint32_t wSleepUs, wSlept;
+
+	sim_run((uint32_t)rand() % 4U);						//csi_tick_idle_ms(), interrupts masked
+	csi_tick_suspend();
+
+	//LPT wakeup or an early one from any other source
+	wSleepUs = wIdleMs * 1000U;
+	if(rand() % 4 == 0)
+		wSleepUs = (uint32_t)rand() % wSleepUs;
+	sim_run(wSleepUs * TEST_CYC_PER_US + (uint32_t)rand() % TEST_CYC_PER_US);
+
+	//LPT counts whole periods only
+	wSlept = wSleepUs / wLptUs * wLptUs;
+	s_dwSlept += (uint64_t)wSlept * TEST_CYC_PER_US;
+
+	csi_tick_resume(wSlept);
+	csi_irq_restore(wIrqFlag);
+}
+
+/** \brief busy-wait with interrupts masked until the deadline, it has to end on time
+ */
+static void check_deadline(uint32_t wMs)
+{
+	csi_tick_deadline_t tDeadline;
+	uint32_t wIrqFlag = csi_irq_save();
+	uint64_t dwStart = s_dwNow;
+	uint64_t dwWant = (uint64_t)wMs * (TEST_FREQ / 1000U);
+	uint32_t wStep = 0U;
+
+	csi_tick_deadline_start(&tDeadline, wMs);
+	while(!csi_tick_deadline_expired(&tDeadline))
+	{
+		wStep = (uint32_t)rand() % 100000U;
+		sim_run(wStep);
+	}
+	if(s_dwNow - dwStart < dwWant || s_dwNow - dwStart > dwWant + wStep + 8U)
+	{
+		if(s_wErr++ < 10)
+			printf("deadline %u ms: ended after %llu cycles\n", wMs, (unsigned long long)(s_dwNow - dwStart));
+	}
+	csi_irq_restore(wIrqFlag);
+}
+
+int main(void)
+{
+	static const uint32_t wLptUs[] = {1U, 37U, 296U, 4740U};
+	uint32_t i, k;
+
+	srand(1);
+	csi_tick_init();
+	check("init", 0U);
+
+	for(i = 0; i < TEST_SLEEPS; i++)
+	{
+		//awake: run in small steps, the tick interrupt comes in between
+		for(k = (uint32_t)rand() % 50U; k; k--)
+		{
+			sim_run((uint32_t)rand() % 20000U);
+			check("awake", 0U);
+		}
+
+		//the suspend also has to hit the last cycles of a period and the reload itself
+		if(i % 5 == 0 && g_tCoret.VAL > 3U)
+			sim_run(g_tCoret.VAL - (uint32_t)rand() % 4U);
+		sleep_tickless(2U + (uint32_t)rand() % 3000U, wLptUs[i % 4]);
+		s_dwSlept += check("resume", TEST_ROUND_UP);	//accepted, checked against from here on
+	}
+
+	//last: masked for that long the tick itself loses periods
+	for(i = 0; i < 200U; i++)
+		check_deadline(1U + (uint32_t)rand() % 200U);
+
+	printf("%u sleeps, %u tick interrupts, %llu ms simulated, %lu errors\n", TEST_SLEEPS, s_wIsrRuns,
+		(unsigned long long)(s_dwNow / (TEST_FREQ / 1000U)), s_wErr);
+	return s_wErr ? 1 : 0;
+}